@@ -0,0 +1,73 @@
+#pragma once
+
+/*
+	NOTE:
+	Benchmark registry for the headless bench program. Each BENCHMARK
+	prints its own table. MeasureNs() repeats a call until minMs have passed
+	and returns the mean time per call, so results are only as steady as the
+	machine. Benchmarks run from the repository root.
+*/
+
+struct Benchmark
+{
+    const char* Name{};
+    void (*Function)(){};
+};
+
+std::vector<Benchmark>& GetBenchmarks();
+
+struct BenchmarkRegistrar
+{
+    BenchmarkRegistrar(const char* name, void (*function)())
+    {
+        GetBenchmarks().push_back({ name, function });
+    }
+};
+
+#define BENCHMARK(name) \
+    static void name(); \
+    static BenchmarkRegistrar name##Registrar{ #name, name }; \
+    static void name()
+
+// Keeps value, and the work that produced it, from being optimized away.
+template <typename T>
+inline void DoNotOptimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <typename Function>
+double MeasureNs(Function&& function, double minMs = 100.0)
+{
+    using Clock = std::chrono::steady_clock;
+
+    // One untimed call warms caches and lazily built state
+    function();
+
+    uint64_t calls = 0;
+    const auto start = Clock::now();
+    auto now = start;
+    do
+    {
+        function();
+        calls++;
+        now = Clock::now();
+    } while (std::chrono::duration<double, std::milli>(now - start).count() < minMs);
+
+    return std::chrono::duration<double, std::nano>(now - start).count() / calls;
+}
+
+// Milliseconds of the fastest of a few calls. For work, such as loads, too slow
+// and too verbose to repeat for MeasureNs' 100 ms.
+template <typename Function>
+double MeasureBestMs(Function&& function, int runs = 5)
+{
+    double best = std::numeric_limits<double>::max();
+    for (int run = 0; run < runs; run++)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
@@ -0,0 +1,163 @@
+#include "pch.h"
+#include "bench.h"
+#include "assets/animator.h"
+#include "assets/model_loader.h"
+#include "assets/texture_registry.h"
+
+static Model LoadBenchModel(bool compressAnimations)
+{
+    TextureRegistry textures{};
+    ModelLoadOptions options{};
+    options.CompressAnimations = compressAnimations;
+    options.GenerateLods = false;
+    return ModelLoader::LoadGLTFModel("assets/models/dummy_platformer.gltf", textures, options);
+}
+
+BENCHMARK(AnimationSampling)
+{
+    for (const bool compressed : { false, true })
+    {
+        Model model = LoadBenchModel(compressed);
+        Animator& animator = model.Animator;
+        PlayAnimation(animator, &model.Animations[0], &model.Skeletons[0], 1.0f, true);
+
+        const size_t boneCount = model.Skeletons[0].Bones.size();
+        const double ns = MeasureNs([&]()
+            {
+                UpdateAnimator(animator, 1.0f / 60.0f);
+                DoNotOptimize(animator.FinalBoneTransforms[0]);
+            });
+
+        std::println("{:<12} {} bones, {} channels: {:8.0f} ns/update, {:5.1f} ns/bone",
+            compressed ? "compressed" : "raw", boneCount, model.Animations[0].Channels.size(), ns, ns / boneCount);
+    }
+}
+
+// Playback lookups on one channel of keyCount keys, advancing by 1/60 s per
+// lookup. The linear scan is what InterpolateVec3 did before the cursor.
+BENCHMARK(KeyframeLookup)
+{
+    std::println("{:>8} {:>12} {:>12} {:>12}", "keys", "linear ns", "binary ns", "cursor ns");
+
+    for (const size_t keyCount : { 100, 1000, 10000, 100000 })
+    {
+        std::vector<float> times(keyCount);
+        for (size_t i = 0; i < keyCount; ++i)
+            times[i] = static_cast<float>(i) / 30.0f;
+
+        const float duration = times.back();
+        const auto measure = [&](auto&& lookup)
+        {
+            float time = 0.0f;
+            size_t sink = 0;
+            const double ns = MeasureNs([&]()
+                {
+                    time += 1.0f / 60.0f;
+                    if (time >= duration)
+                        time = 1.0f / 120.0f;
+                    sink += lookup(time);
+                });
+            DoNotOptimize(sink);
+            return ns;
+        };
+
+        const double linear = measure([&](float time)
+            {
+                size_t i = 0;
+                while (i + 2 < times.size() && time >= times[i + 1])
+                    i++;
+                return i;
+            });
+        const double binary = measure([&](float time)
+            {
+                return static_cast<size_t>(std::upper_bound(times.begin(), times.end(), time) - times.begin()) - 1;
+            });
+        uint32_t cursor = 0;
+        const double cached = measure([&](float time) { return FindKeyframe(times, time, cursor); });
+
+        std::println("{:>8} {:>12.1f} {:>12.1f} {:>12.1f}", keyCount, linear, binary, cached);
+    }
+}
+
+// 1,000 characters sharing one skeleton and clip, each with its own animator
+// at a different point in the clip.
+BENCHMARK(AnimateInstances)
+{
+    constexpr size_t instanceCount = 1000;
+
+    Model model = LoadBenchModel(true);
+    Animation& clip = model.Animations[0];
+
+    std::vector<Animator> animators(instanceCount);
+    for (size_t i = 0; i < instanceCount; ++i)
+    {
+        PlayAnimation(animators[i], &clip, &model.Skeletons[0], 1.0f, true);
+        animators[i].Layers[0].Time = clip.Duration * static_cast<float>(i) / instanceCount;
+    }
+
+    const double ns = MeasureNs([&]()
+        {
+            for (Animator& animator : animators)
+                UpdateAnimator(animator, 1.0f / 60.0f);
+            DoNotOptimize(animators.back().FinalBoneTransforms[0]);
+        }, 500.0);
+
+    std::println("{} instances, {} bones: {:.2f} ms/frame, {:.2f} us/instance",
+        instanceCount, model.Skeletons[0].Bones.size(), ns / 1e6, ns / 1e3 / instanceCount);
+}
+
+// The pose-to-palette pass of UpdateAnimation on its own, over a sampled pose
+// of the bench skeleton. "m4" is the path before the affine bone transforms:
+// three M4s and two full products per local pose, then M4 products through
+// the hierarchy and with the inverse bind.
+BENCHMARK(BoneTransforms)
+{
+    Model model = LoadBenchModel(true);
+    Animator& animator = model.Animator;
+    Skeleton& skeleton = model.Skeletons[0];
+    PlayAnimation(animator, &model.Animations[0], &skeleton, 1.0f, true);
+    UpdateAnimator(animator, 0.5f);
+
+    const size_t boneCount = skeleton.Bones.size();
+    std::vector<M4> inverseBinds(boneCount);
+    for (size_t i = 0; i < boneCount; ++i)
+        inverseBinds[i] = M4FromAffine(skeleton.Bones[i].InverseBindMatrix);
+
+    std::array<M4, MAX_BONES> palette{};
+    const double m4 = MeasureNs([&]()
+        {
+            std::array<M4, MAX_BONES> globalTransforms;
+            for (size_t i = 0; i < boneCount; ++i)
+            {
+                const BoneTransform& pose = animator.BlendedPose[i];
+                const M4 local =
+                    MatrixScaling(pose.Scale.X, pose.Scale.Y, pose.Scale.Z) *
+                    MatrixFromQuaternion(NormalizeQuat(pose.Rotation)) *
+                    MatrixTranslation(pose.Translation.X, pose.Translation.Y, pose.Translation.Z);
+
+                const int32_t parent = skeleton.ParentIndices[i];
+                globalTransforms[i] = parent >= 0 ? local * globalTransforms[parent] : local;
+                palette[skeleton.Bones[i].JointIndex] = inverseBinds[i] * globalTransforms[i];
+            }
+            DoNotOptimize(palette);
+        });
+
+    const double affine = MeasureNs([&]()
+        {
+            std::array<M4x3, MAX_BONES> globalTransforms;
+            for (size_t i = 0; i < boneCount; ++i)
+            {
+                const BoneTransform& pose = animator.BlendedPose[i];
+                const M4x3 local = AffineFromTRS(pose.Translation, NormalizeQuat(pose.Rotation), pose.Scale);
+
+                const int32_t parent = skeleton.ParentIndices[i];
+                globalTransforms[i] = parent >= 0 ? local * globalTransforms[parent] : local;
+                const BoneInfo& bone = skeleton.Bones[i];
+                palette[bone.JointIndex] = M4FromAffine(bone.InverseBindMatrix * globalTransforms[i]);
+            }
+            DoNotOptimize(palette);
+        });
+
+    std::println("{} bones: m4 {:5.1f} ns/bone, affine {:5.1f} ns/bone ({:.2f}x)",
+        boneCount, m4 / boneCount, affine / boneCount, m4 / affine);
+}
@@ -0,0 +1,120 @@
+#include "pch.h"
+#include "bench.h"
+#include "world/bvh.h"
+
+namespace
+{
+    // Uniform in [0, 1), deterministic so every run builds the same tree.
+    float NextRandom(uint32_t& state)
+    {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<float>(state >> 8) / 16777216.0f;
+    }
+
+    // Entity sized boxes at a constant density, so queries of a fixed size
+    // find about as many entities at every count.
+    std::vector<AABB> MakeBoxes(size_t count, float worldSize)
+    {
+        std::vector<AABB> boxes(count);
+        uint32_t state = 3;
+        for (AABB& box : boxes)
+        {
+            const V3 center = { NextRandom(state) * worldSize, NextRandom(state) * 20.0f, NextRandom(state) * worldSize };
+            const V3 extents = { 0.3f + NextRandom(state), 0.5f + NextRandom(state), 0.3f + NextRandom(state) };
+            box = { center - extents, center + extents };
+        }
+        return boxes;
+    }
+}
+
+// Build, update and query cost of the entity tree at 1k, 10k and 100k
+// entities. "update small" moves every box by less than the margin, which
+// only rewrites the leaf; "update large" moves 1% of them to random places,
+// which reinserts. Queries use a fixed size, so the costs show the depth of
+// the tree rather than the number of results.
+BENCHMARK(EntityBvh)
+{
+    std::println("{:>7} {:>9} {:>7} {:>13} {:>13} {:>11} {:>11} {:>11} {:>8}",
+        "count", "build ms", "height", "update small", "update large", "frustum us", "aabb us", "ray us", "visible");
+    std::println("{:>7} {:>9} {:>7} {:>13} {:>13} {:>11} {:>11} {:>11} {:>8}",
+        "", "", "", "(ns/entity)", "(ns/move)", "", "", "", "");
+
+    for (const size_t count : { size_t{ 1000 }, size_t{ 10000 }, size_t{ 100000 } })
+    {
+        const float worldSize = 20.0f * sqrtf(static_cast<float>(count));
+        std::vector<AABB> boxes = MakeBoxes(count, worldSize);
+
+        DynamicBvh bvh{};
+        std::vector<uint32_t> proxies(count);
+        const double buildNs = MeasureNs([&]()
+            {
+                bvh.Clear();
+                for (uint32_t i = 0; i < count; i++)
+                    proxies[i] = bvh.Insert(boxes[i], i);
+            });
+
+        // Back and forth, so the boxes stay inside their fat boxes
+        float step = 0.1f;
+        const double smallNs = MeasureNs([&]()
+            {
+                step = -step;
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    boxes[i] = { boxes[i].Min + V3{ step, 0.0f, step }, boxes[i].Max + V3{ step, 0.0f, step } };
+                    bvh.Update(proxies[i], boxes[i]);
+                }
+            });
+
+        const size_t largeCount = count / 100;
+        uint32_t state = 11;
+        const double largeNs = MeasureNs([&]()
+            {
+                for (size_t n = 0; n < largeCount; n++)
+                {
+                    const uint32_t i = static_cast<uint32_t>(NextRandom(state) * count);
+                    const V3 target = { NextRandom(state) * worldSize, NextRandom(state) * 20.0f, NextRandom(state) * worldSize };
+                    const V3 offset = target - (boxes[i].Min + boxes[i].Max) * 0.5f;
+                    boxes[i] = { boxes[i].Min + offset, boxes[i].Max + offset };
+                    bvh.Update(proxies[i], boxes[i]);
+                }
+            });
+
+        const V3 center = { worldSize * 0.5f, 10.0f, worldSize * 0.5f };
+        const M4 view = MatrixLookAt(center, center + V3{ 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f });
+        const Frustum frustum = ExtractFrustum(view * MatrixPerspective(1.57f, 16.0f / 9.0f, 0.1f, 200.0f));
+
+        std::vector<uint32_t> results{};
+        const double frustumNs = MeasureNs([&]()
+            {
+                results.clear();
+                bvh.QueryFrustum(frustum, results);
+                DoNotOptimize(results.data());
+            });
+        const size_t visible = results.size();
+
+        const AABB region = { center - V3{ 20.0f, 20.0f, 20.0f }, center + V3{ 20.0f, 20.0f, 20.0f } };
+        const double aabbNs = MeasureNs([&]()
+            {
+                results.clear();
+                bvh.QueryAABB(region, results);
+                DoNotOptimize(results.data());
+            });
+
+        // 64 rays fanned out horizontally from the center
+        const double rayNs = MeasureNs([&]()
+            {
+                uint32_t hits = 0;
+                BvhRayHit hit{};
+                for (int ray = 0; ray < 64; ray++)
+                {
+                    const float angle = ray * (6.2831853f / 64.0f);
+                    hits += bvh.Raycast(center, { cosf(angle), -0.05f, sinf(angle) }, 500.0f, hit);
+                }
+                DoNotOptimize(hits);
+            }) / 64.0;
+
+        std::println("{:>7} {:>9.2f} {:>7} {:>13.1f} {:>13.1f} {:>11.2f} {:>11.2f} {:>11.3f} {:>8}",
+            count, buildNs / 1e6, bvh.GetHeight(), smallNs / count, largeNs / std::max<size_t>(largeCount, 1),
+            frustumNs / 1e3, aabbNs / 1e3, rayNs / 1e3, visible);
+    }
+}
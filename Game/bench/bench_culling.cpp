@@ -0,0 +1,135 @@
+#include "pch.h"
+#include "bench.h"
+#include "assets/animator.h"
+#include "assets/mesh_bounds.h"
+#include "assets/model_loader.h"
+#include "assets/texture_registry.h"
+#include "world/bvh.h"
+
+namespace
+{
+    struct CullObject
+    {
+        AABB Bounds{};
+        BoundingSphere Sphere{};
+        M4 World{};
+    };
+
+    // Uniform in [0, 1), deterministic so every run culls the same scene.
+    float NextRandom(uint32_t& state)
+    {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<float>(state >> 8) / 16777216.0f;
+    }
+
+    // Unit-ish boxes, rotated, scaled and scattered over a 2 km square.
+    std::vector<CullObject> MakeObjects(size_t count)
+    {
+        std::vector<CullObject> objects(count);
+        uint32_t state = 7;
+        for (CullObject& object : objects)
+        {
+            const V3 extents = { 0.2f + NextRandom(state), 0.2f + NextRandom(state), 0.2f + NextRandom(state) };
+            object.Bounds = { V3{} - extents, extents };
+            object.Sphere = { {}, Length(extents) };
+
+            const float scale = 0.5f + NextRandom(state) * 2.0f;
+            object.World = MatrixScaling(scale, scale, scale) * MatrixRotationY(NextRandom(state) * 6.2831853f) *
+                MatrixTranslation(NextRandom(state) * 2000.0f - 1000.0f, NextRandom(state) * 20.0f,
+                    NextRandom(state) * 2000.0f - 1000.0f);
+        }
+        return objects;
+    }
+}
+
+// SubmitScene's per mesh test on 100,000 objects, with the camera at the
+// center looking along +Z, so about a third of them are visible.
+BENCHMARK(FrustumCulling100k)
+{
+    constexpr size_t objectCount = 100000;
+    const std::vector<CullObject> objects = MakeObjects(objectCount);
+
+    const M4 view = MatrixLookAt({ 0.0f, 10.0f, 0.0f }, { 0.0f, 10.0f, 1.0f }, { 0.0f, 1.0f, 0.0f });
+    const M4 projection = MatrixPerspective(1.57f, 16.0f / 9.0f, 0.1f, 1000.0f);
+    const Frustum frustum = ExtractFrustum(view * projection);
+
+    uint32_t visible = 0;
+    const auto measure = [&](auto&& isVisible)
+    {
+        const double ns = MeasureNs([&]()
+            {
+                visible = 0;
+                for (const CullObject& object : objects)
+                    visible += isVisible(object);
+                DoNotOptimize(visible);
+            }, 300.0);
+        return ns;
+    };
+
+    const double scalar = measure([&](const CullObject& object)
+        {
+            return IsAABBInFrustumScalar(frustum, TransformAABBScalar(object.Bounds, object.World));
+        });
+#if HANDMADE_MATH_SSE2
+    // A sphere pre-test, with the box only transformed for the survivors
+    const double withSphere = measure([&](const CullObject& object)
+        {
+            return IsSphereInFrustumSIMD(frustum, TransformSphere(object.Sphere, object.World)) &&
+                IsAABBInFrustumSIMD(frustum, TransformAABBSIMD(object.Bounds, object.World));
+        });
+    // Last, so visible counts what SubmitScene draws
+    const double simd = measure([&](const CullObject& object)
+        {
+            return IsAABBInFrustumSIMD(frustum, TransformAABBSIMD(object.Bounds, object.World));
+        });
+#else
+    const double withSphere = 0.0;
+    const double simd = 0.0;
+#endif
+
+    // The world tree holds the transformed boxes, so a query skips the transforms
+    DynamicBvh bvh{};
+    for (uint32_t i = 0; i < objectCount; i++)
+        bvh.Insert(TransformAABB(objects[i].Bounds, objects[i].World), i);
+
+    std::vector<uint32_t> results{};
+    const double tree = MeasureNs([&]()
+        {
+            results.clear();
+            bvh.QueryFrustum(frustum, results);
+            DoNotOptimize(results.data());
+        }, 300.0);
+
+    std::println("{} objects, {} visible ({} from the tree)", objectCount, visible, results.size());
+    std::println("{:<28} {:>8} {:>10}", "", "ms", "ns/object");
+    for (const auto& [name, ns] : { std::pair{ "box, scalar", scalar }, std::pair{ "box, SIMD", simd },
+        std::pair{ "sphere + box, SIMD", withSphere }, std::pair{ "BVH query", tree } })
+    {
+        std::println("{:<28} {:>8.3f} {:>10.2f}", name, ns / 1e6, ns / objectCount);
+    }
+}
+
+// The extra work a skinned mesh costs culling each frame: its bone boxes
+// moved into the current pose.
+BENCHMARK(PosedBounds)
+{
+    TextureRegistry textures{};
+    ModelLoadOptions options{};
+    options.GenerateLods = false;
+    Model model = ModelLoader::LoadGLTFModel("assets/models/dummy_platformer.gltf", textures, options);
+    PlayAnimation(model.Animator, &model.Animations[0], &model.Skeletons[0], 1.0f, true);
+    UpdateAnimator(model.Animator, 0.3f);
+
+    const Mesh& mesh = model.Meshes[0];
+    size_t boneBoxes = 0;
+    for (const AABB& box : mesh.BoneBounds)
+        boneBoxes += box.IsValid();
+
+    const double ns = MeasureNs([&]()
+        {
+            const AABB bounds = ComputePosedBounds(mesh, model.Animator.FinalBoneTransforms);
+            DoNotOptimize(bounds);
+        });
+
+    std::println("{} vertices, {} bone boxes: {:.0f} ns per mesh", mesh.Vertices.size(), boneBoxes, ns);
+}
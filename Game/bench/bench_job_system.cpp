@@ -0,0 +1,73 @@
+#include "pch.h"
+#include "bench.h"
+#include "assets/animator.h"
+#include "assets/model_loader.h"
+#include "assets/texture_registry.h"
+#include "core/job_system.h"
+
+// Animator updates fanned out the way UpdateGame does it, for growing entity
+// and thread counts. Speedup is relative to a serial loop over the same
+// entities, so it can only exceed 1 with more than one hardware thread.
+BENCHMARK(JobSystemScaling)
+{
+    TextureRegistry textures{};
+    ModelLoadOptions options{};
+    options.CompressAnimations = true;
+    options.GenerateLods = false;
+    Model model = ModelLoader::LoadGLTFModel("assets/models/dummy_platformer.gltf", textures, options);
+    Animation& clip = model.Animations[0];
+
+    const uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::println("{} hardware threads", hardwareThreads);
+
+    std::vector<uint32_t> threadCounts{ 1 };
+    for (uint32_t threads = 2; threads <= std::max(hardwareThreads, 4u); threads *= 2)
+        threadCounts.push_back(threads);
+
+    std::print("{:>8}", "entities");
+    for (const uint32_t threads : threadCounts)
+        std::print(" {:>7}T ms {:>6}", threads, "speedup");
+    std::println("");
+
+    for (const size_t entityCount : { 128, 1024, 4096, 10000 })
+    {
+        std::vector<Animator> animators(entityCount);
+        for (size_t i = 0; i < entityCount; ++i)
+        {
+            PlayAnimation(animators[i], &clip, &model.Skeletons[0], 1.0f, true);
+            animators[i].Layers[0].Time = clip.Duration * static_cast<float>(i) / entityCount;
+        }
+
+        std::print("{:>8}", entityCount);
+
+        double serialNs = 0.0;
+        for (const uint32_t threads : threadCounts)
+        {
+            double ns = 0.0;
+            if (threads == 1)
+            {
+                ns = serialNs = MeasureNs([&]()
+                    {
+                        for (Animator& animator : animators)
+                            UpdateAnimator(animator, 1.0f / 60.0f);
+                    }, 300.0);
+            }
+            else
+            {
+                // The calling thread helps, so threads - 1 workers
+                JobSystem jobs(threads - 1);
+                ns = MeasureNs([&]()
+                    {
+                        jobs.ParallelFor(animators.size(), 16, [&](size_t begin, size_t end)
+                            {
+                                for (size_t i = begin; i < end; ++i)
+                                    UpdateAnimator(animators[i], 1.0f / 60.0f);
+                            });
+                    }, 300.0);
+            }
+            DoNotOptimize(animators.back().FinalBoneTransforms[0]);
+            std::print(" {:>10.2f} {:>6.2f}x", ns / 1e6, serialNs / ns);
+        }
+        std::println("");
+    }
+}
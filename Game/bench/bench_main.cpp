@@ -0,0 +1,30 @@
+#include "pch.h"
+#include "bench.h"
+
+std::vector<Benchmark>& GetBenchmarks()
+{
+    static std::vector<Benchmark> benchmarks{};
+    return benchmarks;
+}
+
+// Usage: bench [name filter]
+int main(int argc, char** argv)
+{
+    const std::string_view filter = argc > 1 ? argv[1] : "";
+
+    std::vector<Benchmark> benchmarks = GetBenchmarks();
+    std::sort(benchmarks.begin(), benchmarks.end(),
+        [](const Benchmark& a, const Benchmark& b) { return std::string_view(a.Name) < b.Name; });
+
+    for (const Benchmark& benchmark : benchmarks)
+    {
+        if (!std::string_view(benchmark.Name).contains(filter))
+            continue;
+
+        std::println("== {}", benchmark.Name);
+        benchmark.Function();
+        std::println("");
+    }
+
+    return 0;
+}
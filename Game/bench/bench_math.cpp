@@ -0,0 +1,104 @@
+#include "pch.h"
+#include "bench.h"
+#include "math/handmade_math.h"
+
+namespace
+{
+    // Uniform in [-1, 1), deterministic so every run does the same work.
+    float NextRandom(uint32_t& state)
+    {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<float>(state >> 8) / 8388608.0f - 1.0f;
+    }
+
+    void PrintRow(const char* name, double scalar, double sse2, double avx2)
+    {
+        const auto column = [](double ns) { return ns > 0.0 ? std::format("{:.2f}", ns) : std::string("-"); };
+        std::println("{:<22} {:>8} {:>8} {:>8}", name, column(scalar), column(sse2), column(avx2));
+    }
+}
+
+// ns per operation of each math backend, over arrays large enough that call
+// overhead does not count but small enough to stay in L1/L2. The AVX2 column
+// is only filled in builds made with --avx2, where the 128-bit TransformV4
+// and TransformPoints kernels switch to FMA and replace their SSE2 versions.
+BENCHMARK(MathKernels)
+{
+    constexpr size_t count = 1024;
+    uint32_t state = 5;
+
+    std::vector<M4> matrices(count);
+    std::vector<V4> vectors(count);
+    std::vector<V3> points(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        for (auto& row : matrices[i].M)
+            for (float& value : row)
+                value = NextRandom(state);
+        vectors[i] = { NextRandom(state), NextRandom(state), NextRandom(state), 1.0f };
+        points[i] = { NextRandom(state), NextRandom(state), NextRandom(state) };
+    }
+
+    const M4 transform = MatrixRotationY(0.3f) * MatrixTranslation(1.0f, 2.0f, 3.0f);
+    std::vector<M4> matrixResults(count);
+    std::vector<V4> vectorResults(count);
+    std::vector<V3> pointResults(count);
+
+    // Lambdas rather than function pointers, so each kernel inlines
+    const auto multiply = [&](auto&& function)
+    {
+        return MeasureNs([&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                    matrixResults[i] = function(matrices[i], transform);
+                DoNotOptimize(matrixResults.data());
+            }) / count;
+    };
+    const auto transformV4 = [&](auto&& function)
+    {
+        return MeasureNs([&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                    vectorResults[i] = function(vectors[i], transform);
+                DoNotOptimize(vectorResults.data());
+            }) / count;
+    };
+    const auto transformPoints = [&](auto&& function)
+    {
+        return MeasureNs([&]()
+            {
+                function(transform, points, pointResults);
+                DoNotOptimize(pointResults.data());
+            }) / count;
+    };
+
+    const double multiplyScalar = multiply([](const M4& a, const M4& b) { return MatrixMultiplyScalar(a, b); });
+    const double v4Scalar = transformV4([](const V4& v, const M4& m) { return TransformV4Scalar(v, m); });
+    const double pointsScalar = transformPoints([](const M4& m, std::span<const V3> in, std::span<V3> out)
+        { TransformPointsScalar(m, in, out); });
+#if HANDMADE_MATH_SSE2
+    const double multiplySse2 = multiply([](const M4& a, const M4& b) { return MatrixMultiplySSE2(a, b); });
+    const double v4Simd = transformV4([](const V4& v, const M4& m) { return TransformV4SIMD(v, m); });
+    const double pointsSimd = transformPoints([](const M4& m, std::span<const V3> in, std::span<V3> out)
+        { TransformPointsSIMD(m, in, out); });
+#else
+    const double multiplySse2 = 0.0;
+    const double v4Simd = 0.0;
+    const double pointsSimd = 0.0;
+#endif
+#if HANDMADE_MATH_AVX2
+    const double multiplyAvx2 = multiply([](const M4& a, const M4& b) { return MatrixMultiplyAVX2(a, b); });
+    // The 128-bit kernels use FMA here, so they count as AVX2
+    const double v4Sse2 = 0.0, pointsSse2 = 0.0;
+    const double v4Avx2 = v4Simd, pointsAvx2 = pointsSimd;
+#else
+    const double multiplyAvx2 = 0.0;
+    const double v4Sse2 = v4Simd, pointsSse2 = pointsSimd;
+    const double v4Avx2 = 0.0, pointsAvx2 = 0.0;
+#endif
+
+    std::println("{:<22} {:>8} {:>8} {:>8}   (ns/op)", "", "scalar", "SSE2", "AVX2");
+    PrintRow("M4 x M4", multiplyScalar, multiplySse2, multiplyAvx2);
+    PrintRow("V4 x M4", v4Scalar, v4Sse2, v4Avx2);
+    PrintRow("TransformPoints/point", pointsScalar, pointsSse2, pointsAvx2);
+}
@@ -0,0 +1,71 @@
+#include "pch.h"
+#include "bench.h"
+#include "assets/model_cache.h"
+#include "assets/model_loader.h"
+#include "assets/texture_registry.h"
+
+// Startup cost of each model through the glTF path (parse, decode images,
+// optimize, build LODs, compress clips) and through its baked copy (map,
+// validate, instantiate), with the options the game loads them with. Each
+// run starts with an empty texture registry, like a fresh process.
+BENCHMARK(ModelStartup)
+{
+    ModelLoadOptions options{};
+    options.CompressAnimations = true;
+
+    struct Row
+    {
+        std::string Name{};
+        uintmax_t SourceBytes{};
+        uintmax_t BakedBytes{};
+        double GltfMs{};
+        double BakedMs{};
+    };
+    std::vector<Row> rows{};
+
+    for (const char* name : { "cube", "ico_sphere", "monkey", "dummy_platformer" })
+    {
+        const std::string filename = std::format("assets/models/{}.gltf", name);
+        const std::string cachePath = (std::filesystem::temp_directory_path() / std::format("bench_{}.mdlcache", name)).string();
+        const ModelCacheSource source{ 1, 2, 3 };
+
+        Row& row = rows.emplace_back();
+        row.Name = name;
+        row.SourceBytes = std::filesystem::file_size(filename);
+        for (const std::string& buffer : ModelLoader::GetBufferFiles(filename))
+            row.SourceBytes += std::filesystem::file_size(buffer);
+
+        {
+            TextureRegistry textures{};
+            const Model model = ModelLoader::LoadGLTFModel(filename, textures, options);
+            ModelCache::Bake(model, textures, source, cachePath);
+        }
+        row.BakedBytes = std::filesystem::file_size(cachePath);
+
+        row.GltfMs = MeasureBestMs([&]()
+            {
+                TextureRegistry textures{};
+                const Model model = ModelLoader::LoadGLTFModel(filename, textures, options);
+                DoNotOptimize(model.Meshes.data());
+            });
+        row.BakedMs = MeasureBestMs([&]()
+            {
+                TextureRegistry textures{};
+                ModelCache cache{};
+                if (cache.Open(cachePath, source))
+                {
+                    const Model model = cache.Instantiate(textures);
+                    DoNotOptimize(model.Meshes.data());
+                }
+            });
+
+        std::filesystem::remove(cachePath);
+    }
+
+    std::println("{:<18} {:>10} {:>10} {:>10} {:>10} {:>8}", "model", "source KB", "baked KB", "glTF ms", "baked ms", "speedup");
+    for (const Row& row : rows)
+    {
+        std::println("{:<18} {:>10} {:>10} {:>10.2f} {:>10.3f} {:>7.0f}x", row.Name, row.SourceBytes / 1024,
+            row.BakedBytes / 1024, row.GltfMs, row.BakedMs, row.GltfMs / row.BakedMs);
+    }
+}
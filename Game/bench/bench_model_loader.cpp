@@ -0,0 +1,160 @@
+#include "pch.h"
+#include "bench.h"
+#include "assets/model_loader.h"
+#include "assets/texture_registry.h"
+
+// Writes a glTF file of primitiveCount 256x256 vertex grids, alternating u16
+// and u32 indices, with its .bin next to it. Returns the accessor bytes a
+// load reads. Every array gets a buffer view wider per element than its data:
+// strided views leave no accessor tightly packed, so the loader reads each
+// element through cgltf; packed views hold the same data contiguously, with
+// the slack at the end, so both files are the same size.
+static size_t WriteGridModel(const std::string& path, size_t primitiveCount, bool strided)
+{
+    constexpr uint32_t side = 256;
+    constexpr uint32_t vertexCount = side * side;
+
+    std::vector<V3> positions(vertexCount);
+    std::vector<V3> normals(vertexCount);
+    std::vector<V2> texcoords(vertexCount);
+    std::vector<uint16_t> joints(vertexCount * 4);
+    std::vector<V4> weights(vertexCount);
+    for (uint32_t z = 0; z < side; z++)
+    {
+        for (uint32_t x = 0; x < side; x++)
+        {
+            const uint32_t v = z * side + x;
+            const float fx = static_cast<float>(x);
+            const float fz = static_cast<float>(z);
+            positions[v] = { fx, sinf(fx * 0.1f) * cosf(fz * 0.1f), fz };
+            normals[v] = Normalize(V3{ -cosf(fx * 0.1f) * 0.1f, 1.0f, sinf(fz * 0.1f) * 0.1f });
+            texcoords[v] = { fx / side, fz / side };
+            for (uint32_t j = 0; j < 4; j++)
+                joints[v * 4 + j] = static_cast<uint16_t>((v + j) % 64);
+            weights[v] = { 0.4f, 0.3f, 0.2f, 0.1f };
+        }
+    }
+
+    std::vector<uint32_t> indices32{};
+    for (uint32_t z = 0; z + 1 < side; z++)
+    {
+        for (uint32_t x = 0; x + 1 < side; x++)
+        {
+            const uint32_t v = z * side + x;
+            indices32.insert(indices32.end(), { v, v + side, v + 1, v + 1, v + side, v + side + 1 });
+        }
+    }
+    const std::vector<uint16_t> indices16(indices32.begin(), indices32.end());
+
+    std::vector<uint8_t> bin{};
+    std::string views{};
+    std::string accessors{};
+    size_t arrayCount = 0;
+    size_t accessorBytes = 0;
+
+    // One buffer view and accessor per array, returns the accessor index
+    const auto addArray = [&](const void* data, size_t count, size_t elementSize, int componentType, const char* type)
+    {
+        const size_t stride = (elementSize + 4 + 3) & ~size_t(3);
+        const size_t offset = bin.size();
+        bin.resize(offset + count * stride);
+        const uint8_t* source = static_cast<const uint8_t*>(data);
+        if (strided)
+        {
+            for (size_t i = 0; i < count; i++)
+                memcpy(bin.data() + offset + i * stride, source + i * elementSize, elementSize);
+        }
+        else
+        {
+            memcpy(bin.data() + offset, source, count * elementSize);
+        }
+
+        const char* separator = arrayCount ? "," : "";
+        views += std::format("{}{{\"buffer\":0,\"byteOffset\":{},\"byteLength\":{}{}}}", separator, offset,
+            count * stride, strided ? std::format(",\"byteStride\":{}", stride) : "");
+        accessors += std::format("{}{{\"bufferView\":{},\"componentType\":{},\"count\":{},\"type\":\"{}\"}}",
+            separator, arrayCount, componentType, count, type);
+        accessorBytes += count * elementSize;
+        return arrayCount++;
+    };
+
+    std::string primitives{};
+    for (size_t p = 0; p < primitiveCount; p++)
+    {
+        const size_t position = addArray(positions.data(), vertexCount, sizeof(V3), 5126, "VEC3");
+        const size_t normal = addArray(normals.data(), vertexCount, sizeof(V3), 5126, "VEC3");
+        const size_t texcoord = addArray(texcoords.data(), vertexCount, sizeof(V2), 5126, "VEC2");
+        const size_t joint = addArray(joints.data(), vertexCount, 4 * sizeof(uint16_t), 5123, "VEC4");
+        const size_t weight = addArray(weights.data(), vertexCount, sizeof(V4), 5126, "VEC4");
+        const size_t index = p % 2 == 0 ?
+            addArray(indices16.data(), indices16.size(), sizeof(uint16_t), 5123, "SCALAR") :
+            addArray(indices32.data(), indices32.size(), sizeof(uint32_t), 5125, "SCALAR");
+
+        primitives += std::format("{}{{\"attributes\":{{\"POSITION\":{},\"NORMAL\":{},\"TEXCOORD_0\":{},"
+            "\"JOINTS_0\":{},\"WEIGHTS_0\":{}}},\"indices\":{}}}",
+            p ? "," : "", position, normal, texcoord, joint, weight, index);
+    }
+
+    const std::filesystem::path binPath = std::filesystem::path(path).replace_extension(".bin");
+    std::ofstream(binPath, std::ios::binary | std::ios::trunc).write(
+        reinterpret_cast<const char*>(bin.data()), static_cast<std::streamsize>(bin.size()));
+    std::ofstream(path, std::ios::trunc) << std::format(
+        "{{\"asset\":{{\"version\":\"2.0\"}},\"scene\":0,\"scenes\":[{{\"nodes\":[0]}}],\"nodes\":[{{\"mesh\":0}}],"
+        "\"meshes\":[{{\"primitives\":[{}]}}],\"buffers\":[{{\"uri\":\"{}\",\"byteLength\":{}}}],"
+        "\"bufferViews\":[{}],\"accessors\":[{}]}}",
+        primitives, binPath.filename().string(), bin.size(), views, accessors);
+
+    return accessorBytes;
+}
+
+// Geometry load throughput of LoadGLTFModel, in accessor MB per second, for
+// the same grids through the bulk accessor path and the per-element path.
+// Mesh optimization and LODs are off so the load is parse, read and convert.
+BENCHMARK(AccessorThroughput)
+{
+    constexpr size_t primitiveCount = 8;
+
+    ModelLoadOptions options{};
+    options.OptimizeMeshes = false;
+    options.GenerateLods = false;
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path();
+    struct Row
+    {
+        const char* Name{};
+        std::string Path{};
+        size_t Bytes{};
+        double Ms{};
+        Model Loaded{};
+    };
+    Row rows[] = {
+        { "bulk", (directory / "bench_accessors_packed.gltf").string() },
+        { "generic", (directory / "bench_accessors_strided.gltf").string() },
+    };
+
+    for (Row& row : rows)
+    {
+        row.Bytes = WriteGridModel(row.Path, primitiveCount, &row == &rows[1]);
+        row.Ms = MeasureBestMs([&]()
+            {
+                TextureRegistry textures{};
+                row.Loaded = ModelLoader::LoadGLTFModel(row.Path, textures, options);
+                DoNotOptimize(row.Loaded.Meshes.data());
+            });
+        std::filesystem::remove(row.Path);
+        std::filesystem::remove(std::filesystem::path(row.Path).replace_extension(".bin"));
+    }
+
+    const Mesh& bulk = rows[0].Loaded.Meshes.at(0);
+    const Mesh& generic = rows[1].Loaded.Meshes.at(0);
+    const bool same = bulk.Indices == generic.Indices && bulk.Vertices.size() == generic.Vertices.size() &&
+        std::memcmp(bulk.Vertices.data(), generic.Vertices.data(), bulk.Vertices.size() * sizeof(Vertex)) == 0;
+
+    std::println("{:<10} {:>10} {:>10} {:>10}", "path", "MB", "ms", "MB/s");
+    for (const Row& row : rows)
+    {
+        const double mb = static_cast<double>(row.Bytes) / (1024.0 * 1024.0);
+        std::println("{:<10} {:>10.1f} {:>10.1f} {:>10.0f}", row.Name, mb, row.Ms, mb / (row.Ms / 1000.0));
+    }
+    std::println("bulk {:.2f}x faster, {} output", rows[1].Ms / rows[0].Ms, same ? "identical" : "DIFFERENT");
+}
@@ -0,0 +1,50 @@
+#include "pch.h"
+#include "bench.h"
+#include "assets/animator.h"
+#include "assets/model_loader.h"
+#include "assets/skinning.h"
+#include "assets/texture_registry.h"
+#include "core/job_system.h"
+
+// Skinning throughput on the test character's mesh, replicated so the job
+// system has several meshes to spread.
+BENCHMARK(SkinningThroughput)
+{
+    TextureRegistry textures{};
+    ModelLoadOptions options{};
+    options.GenerateLods = false;
+    Model model = ModelLoader::LoadGLTFModel("assets/models/dummy_platformer.gltf", textures, options);
+
+    PlayAnimation(model.Animator, &model.Animations[0], &model.Skeletons[0], 1.0f, true);
+    UpdateAnimator(model.Animator, 0.4f);
+    const auto& bones = model.Animator.FinalBoneTransforms;
+
+    const std::vector<Vertex>& vertices = model.Meshes[0].Vertices;
+    std::vector<V3> positions(vertices.size()), normals(vertices.size());
+
+    const auto report = [](const char* name, size_t vertexCount, double ns)
+    {
+        std::println("{:<10} {:8.2f} ns/vertex {:8.1f} M verts/s", name, ns / vertexCount, vertexCount * 1e3 / ns);
+    };
+
+    report("scalar", vertices.size(), MeasureNs([&]()
+        {
+            SkinVerticesScalar(vertices, bones, positions, normals);
+            DoNotOptimize(positions[0]);
+        }));
+    report("simd", vertices.size(), MeasureNs([&]()
+        {
+            SkinVertices(vertices, bones, positions, normals);
+            DoNotOptimize(positions[0]);
+        }));
+
+    constexpr size_t meshCount = 64;
+    const std::vector<Mesh> meshes(meshCount, model.Meshes[0]);
+    std::vector<SkinnedMesh> skinned(meshCount);
+    JobSystem jobs{};
+    report("jobs", vertices.size() * meshCount, MeasureNs([&]()
+        {
+            SkinMeshes(jobs, meshes, bones, skinned);
+            DoNotOptimize(skinned[0].Positions[0]);
+        }));
+}
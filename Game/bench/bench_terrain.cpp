@@ -0,0 +1,138 @@
+#include "pch.h"
+#include "bench.h"
+#include "assets/texture_registry.h"
+#include "renderer/null_renderer.h"
+#include "world/terrain.h"
+
+// Rolling hills, size x size samples.
+static Heightmap MakeBenchHeightmap(int32_t size)
+{
+    Heightmap heightmap{};
+    heightmap.Width = size;
+    heightmap.Height = size;
+    heightmap.Heights.resize(static_cast<size_t>(size) * size);
+    heightmap.MinHeight = FLT_MAX;
+    heightmap.MaxHeight = -FLT_MAX;
+
+    for (int32_t z = 0; z < size; z++)
+    {
+        for (int32_t x = 0; x < size; x++)
+        {
+            const float height = 8.0f * sinf(x * 0.05f) * cosf(z * 0.03f) + 2.0f * sinf((x + z) * 0.21f);
+            heightmap.Heights[static_cast<size_t>(x) + static_cast<size_t>(z) * size] = height;
+            heightmap.MinHeight = std::min(heightmap.MinHeight, height);
+            heightmap.MaxHeight = std::max(heightmap.MaxHeight, height);
+        }
+    }
+
+    return heightmap;
+}
+
+// Tile generation time, and the memory of the tiles resident around a camera
+// in the middle of the map once streaming settles. The per tile columns are
+// what an index copy in every tile, and CPU vertices kept after upload, add.
+BENCHMARK(TerrainTiles)
+{
+    std::println("{:>6} {:>7} {:>10} {:>10} {:>6} {:>12} {:>14} {:>12}",
+        "size", "levels", "root ms", "tile us", "tiles", "resident KB", "per tile IB KB", "CPU verts KB");
+
+    for (const int32_t size : { 257, 513, 1025, 2049, 4097 })
+    {
+        TextureRegistry textures{};
+        const TextureHandle texture = textures.Register("bench", Texture{});
+
+        const auto start = std::chrono::steady_clock::now();
+        Terrain terrain(MakeBenchHeightmap(size), texture, nullptr);
+        const std::chrono::duration<double, std::milli> rootMs = std::chrono::steady_clock::now() - start;
+
+        const uint32_t maxLevel = terrain.GetMaxLevel();
+        const double tileNs = MeasureNs([&]()
+            {
+                const TerrainTile tile = terrain.GenerateTile(maxLevel, 0, 0);
+                DoNotOptimize(tile.Mesh.Bounds);
+            });
+
+        // Without jobs each Update generates up to MaxPendingTiles tiles
+        NullRenderer renderer{};
+        const V3 camera = { size * 0.5f, 20.0f, size * 0.5f };
+        for (int frame = 0; frame < 256; frame++)
+        {
+            terrain.Update(camera, renderer, textures);
+            if (terrain.GetStats().PendingTiles == 0 && frame > 0)
+                break;
+        }
+
+        const TerrainStats stats = terrain.GetStats();
+        const TerrainSettings settings{};
+        const size_t vertexBytes = static_cast<size_t>(settings.TileQuads + 1) * (settings.TileQuads + 1) * sizeof(Vertex);
+        const size_t indexBytes = stats.ResidentBytes - stats.ResidentTiles * vertexBytes;
+
+        std::println("{:>6} {:>7} {:>10.2f} {:>10.1f} {:>6} {:>12} {:>14} {:>12}",
+            size, maxLevel + 1, rootMs.count(), tileNs / 1e3, stats.ResidentTiles, stats.ResidentBytes / 1024,
+            (stats.ResidentTiles - 1) * indexBytes / 1024, stats.ResidentTiles * vertexBytes / 1024);
+    }
+}
+
+// Point queries and raycasts at 4096 scattered positions per call. Grazing
+// rays descend 1 unit per 20, so they walk many cells before hitting.
+BENCHMARK(HeightmapQueries)
+{
+    std::println("{:>6} {:>10} {:>10} {:>10} {:>10} {:>10}   (million queries/s)",
+        "size", "height", "normal", "ray down", "ray 45", "ray graze");
+
+    for (const int32_t size : { 257, 1025, 4097 })
+    {
+        const Heightmap heightmap = MakeBenchHeightmap(size);
+
+        constexpr size_t queryCount = 4096;
+        std::vector<V3> positions(queryCount);
+        std::vector<V3> directions(queryCount);
+        uint32_t state = 12345;
+        const auto next = [&state]()
+        {
+            state = state * 1664525u + 1013904223u;
+            return static_cast<float>(state >> 8) / 16777216.0f;
+        };
+        for (size_t i = 0; i < queryCount; i++)
+        {
+            positions[i] = { next() * (size - 1), heightmap.MaxHeight + 2.0f, next() * (size - 1) };
+            const float angle = next() * 6.2831853f;
+            directions[i] = { cosf(angle), 0.0f, sinf(angle) };
+        }
+
+        const auto rate = [](double ns) { return 1e3 * queryCount / ns; };
+
+        const double height = MeasureNs([&]()
+            {
+                float sum = 0.0f;
+                for (const V3& p : positions)
+                    sum += SampleHeightmapHeight(heightmap, p.X, p.Z);
+                DoNotOptimize(sum);
+            });
+        const double normal = MeasureNs([&]()
+            {
+                V3 sum{};
+                for (const V3& p : positions)
+                    sum = sum + SampleHeightmapNormal(heightmap, p.X, p.Z);
+                DoNotOptimize(sum);
+            });
+
+        const auto raycast = [&](float descent)
+        {
+            return MeasureNs([&]()
+                {
+                    uint32_t hits = 0;
+                    HeightmapHit hit{};
+                    for (size_t i = 0; i < queryCount; i++)
+                    {
+                        const V3 direction = Normalize(V3{ directions[i].X, -descent, directions[i].Z });
+                        hits += RaycastHeightmap(heightmap, positions[i], direction, 1000.0f, hit);
+                    }
+                    DoNotOptimize(hits);
+                });
+        };
+
+        std::println("{:>6} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f}", size,
+            rate(height), rate(normal), rate(raycast(1e6f)), rate(raycast(1.0f)), rate(raycast(0.05f)));
+    }
+}
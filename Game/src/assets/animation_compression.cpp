@@ -0,0 +1,273 @@
+#include "pch.h"
+#include "assets/animation_compression.h"
+#include "assets/animator.h"
+
+// Components other than the largest one lie in [-1/sqrt(2), 1/sqrt(2)].
+static constexpr float QUAT_COMPONENT_RANGE = 0.70710678118f;
+static constexpr uint32_t QUAT_COMPONENT_MAX = (1u << 15) - 1;
+
+PackedQuat PackQuat(const Quat& q)
+{
+    const Quat n = NormalizeQuat(q);
+    const float components[4] = { n.X, n.Y, n.Z, n.W };
+
+    uint32_t largest = 0;
+    for (uint32_t i = 1; i < 4; ++i)
+        if (fabsf(components[i]) > fabsf(components[largest]))
+            largest = i;
+
+    // q and -q are the same rotation, so the largest component is made positive
+    // and does not need to be stored.
+    const float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+    uint64_t bits = largest;
+    uint32_t shift = 2;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        if (i == largest)
+            continue;
+
+        const float normalized = (components[i] * sign / QUAT_COMPONENT_RANGE) * 0.5f + 0.5f;
+        const uint32_t quantized = static_cast<uint32_t>(
+            std::clamp(normalized, 0.0f, 1.0f) * QUAT_COMPONENT_MAX + 0.5f);
+
+        bits |= static_cast<uint64_t>(quantized) << shift;
+        shift += 15;
+    }
+
+    PackedQuat result{};
+    result.Data[0] = static_cast<uint16_t>(bits);
+    result.Data[1] = static_cast<uint16_t>(bits >> 16);
+    result.Data[2] = static_cast<uint16_t>(bits >> 32);
+    return result;
+}
+
+Quat UnpackQuat(const PackedQuat& packed)
+{
+    const uint64_t bits = static_cast<uint64_t>(packed.Data[0]) |
+        (static_cast<uint64_t>(packed.Data[1]) << 16) |
+        (static_cast<uint64_t>(packed.Data[2]) << 32);
+
+    const uint32_t largest = static_cast<uint32_t>(bits & 3);
+
+    float components[4] = {};
+    float sumSq = 0.0f;
+    uint32_t shift = 2;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        if (i == largest)
+            continue;
+
+        const uint32_t quantized = static_cast<uint32_t>(bits >> shift) & QUAT_COMPONENT_MAX;
+        const float value = (static_cast<float>(quantized) / QUAT_COMPONENT_MAX * 2.0f - 1.0f) * QUAT_COMPONENT_RANGE;
+
+        components[i] = value;
+        sumSq += value * value;
+        shift += 15;
+    }
+
+    components[largest] = sqrtf(std::max(1.0f - sumSq, 0.0f));
+    return { components[0], components[1], components[2], components[3] };
+}
+
+size_t AnimationMemoryUsage(const Animation& animation)
+{
+    size_t result = 0;
+    for (const auto& channel : animation.Channels)
+    {
+        result += channel.Times.size() * sizeof(float);
+        result += channel.Translations.size() * sizeof(V3);
+        result += channel.Rotations.size() * sizeof(Quat);
+        result += channel.PackedRotations.size() * sizeof(PackedQuat);
+        result += channel.Scales.size() * sizeof(V3);
+    }
+    return result;
+}
+
+// Angle between two rotations. Uses |a - b| = 2 sin(angle / 4), which unlike
+// acos of the dot product stays accurate for nearly equal rotations.
+static float RotationError(const Quat& a, const Quat& b)
+{
+    const Quat na = NormalizeQuat(a);
+    Quat nb = NormalizeQuat(b);
+    if (Dot(na, nb) < 0.0f)
+        nb = nb * -1.0f;
+
+    const float dx = na.X - nb.X, dy = na.Y - nb.Y, dz = na.Z - nb.Z, dw = na.W - nb.W;
+    const float distance = sqrtf(dx * dx + dy * dy + dz * dz + dw * dw);
+    return 4.0f * asinf(std::min(distance * 0.5f, 1.0f));
+}
+
+// Indices of the keys to keep. From each kept key the span is grown by
+// doubling until interpolating across it leaves tolerance, then the longest
+// span that fits is found by bisection, so a channel costs O(n log n) error
+// evaluations rather than O(n^2). Spans are interpolated between keyValues
+// (the values as stored after compression) and measured against the original
+// values, so every kept span is within tolerance of the source clip.
+template<typename T, typename Interpolate, typename Error>
+static std::vector<size_t> ReduceKeys(const std::vector<float>& times, const std::vector<T>& values,
+    const std::vector<T>& keyValues, float tolerance, Interpolate interpolate, Error error)
+{
+    std::vector<size_t> result;
+    const size_t count = times.size();
+    if (count <= 2)
+    {
+        for (size_t i = 0; i < count; ++i)
+            result.push_back(i);
+        return result;
+    }
+
+    const auto spanFits = [&](size_t first, size_t last)
+    {
+        for (size_t k = first + 1; k < last; ++k)
+        {
+            const float t = (times[k] - times[first]) / (times[last] - times[first]);
+            if (error(interpolate(keyValues[first], keyValues[last], t), values[k]) > tolerance)
+                return false;
+        }
+        return true;
+    };
+
+    result.push_back(0);
+    size_t anchor = 0;
+
+    while (anchor + 1 < count)
+    {
+        // Neighbouring keys always fit, nothing lies between them.
+        size_t fits = anchor + 1;
+        size_t fails = count;
+
+        for (size_t step = 2; fits + 1 < count; step *= 2)
+        {
+            const size_t end = std::min(anchor + step, count - 1);
+            if (!spanFits(anchor, end))
+            {
+                fails = end;
+                break;
+            }
+            fits = end;
+        }
+
+        while (fails < count && fails - fits > 1)
+        {
+            const size_t middle = fits + (fails - fits) / 2;
+            if (spanFits(anchor, middle))
+                fits = middle;
+            else
+                fails = middle;
+        }
+
+        anchor = fits;
+        result.push_back(anchor);
+    }
+
+    return result;
+}
+
+template<typename T>
+static std::vector<T> Gather(const std::vector<T>& values, const std::vector<size_t>& indices)
+{
+    std::vector<T> result;
+    result.reserve(indices.size());
+    for (size_t index : indices)
+        result.push_back(values[index]);
+    return result;
+}
+
+AnimationCompressionStats CompressAnimation(Animation& animation,
+    const AnimationCompressionSettings& settings)
+{
+    AnimationCompressionStats stats{};
+    stats.BytesBefore = AnimationMemoryUsage(animation);
+
+    const auto vectorError = [](const V3& a, const V3& b) { return Length(a - b); };
+
+    for (auto& channel : animation.Channels)
+    {
+        stats.KeysBefore += channel.Times.size();
+
+        const std::vector<float> originalTimes = channel.Times;
+        std::vector<size_t> keep;
+
+        switch (channel.Path)
+        {
+        case AnimationPath::Translation:
+        {
+            const std::vector<V3> original = channel.Translations;
+            keep = ReduceKeys(channel.Times, original, original, settings.TranslationTolerance, V3Lerp, vectorError);
+            channel.Translations = Gather(channel.Translations, keep);
+            channel.Times = Gather(channel.Times, keep);
+
+            uint32_t cursor = 0;
+            for (size_t k = 0; k < originalTimes.size(); ++k)
+            {
+                const V3 sampled = InterpolateVec3(channel.Times, channel.Translations, originalTimes[k], cursor);
+                stats.MaxTranslationError = std::max(stats.MaxTranslationError, vectorError(sampled, original[k]));
+            }
+        } break;
+
+        case AnimationPath::Scale:
+        {
+            const std::vector<V3> original = channel.Scales;
+            keep = ReduceKeys(channel.Times, original, original, settings.ScaleTolerance, V3Lerp, vectorError);
+            channel.Scales = Gather(channel.Scales, keep);
+            channel.Times = Gather(channel.Times, keep);
+
+            uint32_t cursor = 0;
+            for (size_t k = 0; k < originalTimes.size(); ++k)
+            {
+                const V3 sampled = InterpolateVec3(channel.Times, channel.Scales, originalTimes[k], cursor);
+                stats.MaxScaleError = std::max(stats.MaxScaleError, vectorError(sampled, original[k]));
+            }
+        } break;
+
+        case AnimationPath::Rotation:
+        {
+            const std::vector<Quat> original = channel.Rotations;
+
+            // Quantized keys are what playback interpolates, so spans are
+            // checked between them.
+            std::vector<Quat> keyValues = original;
+            if (settings.QuantizeRotations)
+                for (Quat& q : keyValues)
+                    q = UnpackQuat(PackQuat(q));
+
+            keep = ReduceKeys(channel.Times, original, keyValues, settings.RotationTolerance, Slerp, RotationError);
+            channel.Rotations = Gather(channel.Rotations, keep);
+            channel.Times = Gather(channel.Times, keep);
+
+            if (settings.QuantizeRotations)
+            {
+                channel.PackedRotations.clear();
+                channel.PackedRotations.reserve(channel.Rotations.size());
+                for (const Quat& q : channel.Rotations)
+                    channel.PackedRotations.push_back(PackQuat(q));
+
+                channel.Rotations.clear();
+                channel.Rotations.shrink_to_fit();
+            }
+
+            uint32_t cursor = 0;
+            for (size_t k = 0; k < originalTimes.size(); ++k)
+            {
+                const Quat sampled = settings.QuantizeRotations ?
+                    InterpolatePackedQuat(channel.Times, channel.PackedRotations, originalTimes[k], cursor) :
+                    InterpolateQuat(channel.Times, channel.Rotations, originalTimes[k], cursor);
+                stats.MaxRotationError = std::max(stats.MaxRotationError, RotationError(sampled, original[k]));
+            }
+        } break;
+
+        default:
+            break;
+        }
+
+        channel.Times.shrink_to_fit();
+        channel.Translations.shrink_to_fit();
+        channel.Scales.shrink_to_fit();
+
+        stats.KeysAfter += channel.Times.size();
+    }
+
+    stats.BytesAfter = AnimationMemoryUsage(animation);
+    return stats;
+}
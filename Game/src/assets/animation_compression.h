@@ -0,0 +1,39 @@
+#pragma once
+
+#include "assets/assets.h"
+
+struct AnimationCompressionSettings
+{
+    // Maximum error a removed keyframe may introduce.
+    float TranslationTolerance{ 0.001f };
+    float RotationTolerance{ 0.001f };   // Radians.
+    float ScaleTolerance{ 0.001f };
+    bool QuantizeRotations{ true };
+};
+
+struct AnimationCompressionStats
+{
+    size_t BytesBefore{};
+    size_t BytesAfter{};
+    size_t KeysBefore{};
+    size_t KeysAfter{};
+    // Largest error of the compressed clip, measured at the original keyframes.
+    float MaxTranslationError{};
+    float MaxRotationError{};            // Radians.
+    float MaxScaleError{};
+};
+
+// Smallest-three encoding: the index of the largest component in 2 bits and
+// the other three components in 15 bits each.
+PackedQuat PackQuat(const Quat& q);
+Quat UnpackQuat(const PackedQuat& packed);
+
+// Bytes of keyframe data held by a clip.
+size_t AnimationMemoryUsage(const Animation& animation);
+
+// Removes keyframes that interpolation reproduces within tolerance and
+// optionally quantizes rotations in place. The tolerances hold for the
+// quantized clip as long as they exceed the quantization error itself
+// (about 1e-4 radians for rotations).
+AnimationCompressionStats CompressAnimation(Animation& animation,
+    const AnimationCompressionSettings& settings);
@@ -2,10 +2,37 @@
 
 #include <math/handmade_math.h>
 #include <assets/assets.h>
+#include <assets/animation_compression.h>
 
-void UpdateAnimation(Animator& animator, float time);
+static void UpdateAnimation(Animator& animator);
 
-static V3 InterpolateVec3(const std::span<float> times, const std::span<V3> values, float time)
+// Returns the keyframe i with times[i] <= time < times[i + 1].
+// Expects times.front() < time < times.back(). During playback the answer is
+// the cached cursor or the key after it, so no search happens; seeks and loop
+// wraps fall back to a binary search.
+static size_t FindKeyframe(const std::span<const float> times, float time, uint32_t& cursor)
+{
+    const size_t i = cursor;
+    if (i + 1 < times.size() && times[i] <= time)
+    {
+        if (time < times[i + 1])
+            return i;
+
+        if (i + 2 < times.size() && time < times[i + 2])
+        {
+            cursor = static_cast<uint32_t>(i + 1);
+            return i + 1;
+        }
+    }
+
+    const auto it = std::upper_bound(times.begin(), times.end(), time);
+    const size_t key = static_cast<size_t>(it - times.begin()) - 1;
+    cursor = static_cast<uint32_t>(key);
+    return key;
+}
+
+static V3 InterpolateVec3(const std::span<const float> times, const std::span<const V3> values,
+    float time, uint32_t& cursor)
 {
     if (times.empty() || values.empty())
         return {};
@@ -13,18 +40,13 @@ static V3 InterpolateVec3(const std::span<float> times, const std::span<V3> valu
     if (time <= times.front()) return values.front();
     if (time >= times.back())  return values.back();
 
-    for (size_t i = 0; i < times.size() - 1; ++i)
-    {
-        if (time < times[i + 1])
-        {
-            float t = (time - times[i]) / (times[i + 1] - times[i]);
-            return V3Lerp(values[i], values[i + 1], t);
-        }
-    }
-    return values.back();
+    const size_t i = FindKeyframe(times, time, cursor);
+    const float t = (time - times[i]) / (times[i + 1] - times[i]);
+    return V3Lerp(values[i], values[i + 1], t);
 }
 
-static Quat InterpolateQuat(const std::span<float> times, const std::span<Quat> values, float time)
+static Quat InterpolateQuat(const std::span<const float> times, const std::span<const Quat> values,
+    float time, uint32_t& cursor)
 {
     if (times.empty() || values.empty())
         return {};
@@ -32,95 +54,412 @@ static Quat InterpolateQuat(const std::span<float> times, const std::span<Quat>
     if (time <= times.front()) return values.front();
     if (time >= times.back())  return values.back();
 
-    for (size_t i = 0; i < times.size() - 1; ++i)
+    const size_t i = FindKeyframe(times, time, cursor);
+    const float t = (time - times[i]) / (times[i + 1] - times[i]);
+    return Slerp(values[i], values[i + 1], t);
+}
+
+static Quat InterpolatePackedQuat(const std::span<const float> times, const std::span<const PackedQuat> values,
+    float time, uint32_t& cursor)
+{
+    if (times.empty() || values.empty())
+        return { 0.0f, 0.0f, 0.0f, 1.0f };
+
+    if (time <= times.front()) return UnpackQuat(values.front());
+    if (time >= times.back())  return UnpackQuat(values.back());
+
+    const size_t i = FindKeyframe(times, time, cursor);
+    const float t = (time - times[i]) / (times[i + 1] - times[i]);
+    return Slerp(UnpackQuat(values[i]), UnpackQuat(values[i + 1]), t);
+}
+
+// True when the channel has a value for each of at least one keyframe.
+static bool HasKeyframes(const AnimationChannel& channel)
+{
+    const size_t keyCount = channel.Times.size();
+    switch (channel.Path)
     {
-        if (time < times[i + 1])
+    case AnimationPath::Translation: return keyCount > 0 && channel.Translations.size() >= keyCount;
+    case AnimationPath::Rotation:
+        return keyCount > 0 && std::max(channel.Rotations.size(), channel.PackedRotations.size()) >= keyCount;
+    case AnimationPath::Scale:       return keyCount > 0 && channel.Scales.size() >= keyCount;
+    default: return false;
+    }
+}
+
+// Resolves channel target nodes to bones once, grouping the translation,
+// rotation and scale channels of each bone into a single binding.
+static void BindAnimationLayer(AnimationLayer& layer, const Skeleton& skeleton)
+{
+    layer.ChannelCursors.assign(layer.Clip ? layer.Clip->Channels.size() : 0, 0);
+    layer.Bindings.clear();
+
+    if (!layer.Clip)
+        return;
+
+    std::array<int32_t, MAX_BONES> boneToBinding;
+    boneToBinding.fill(-1);
+
+    for (size_t c = 0; c < layer.Clip->Channels.size(); ++c)
+    {
+        const AnimationChannel& channel = layer.Clip->Channels[c];
+        if (!HasKeyframes(channel))
+            continue;
+
+        auto it = skeleton.NodeToBoneIndex.find(channel.TargetNode);
+        if (it == skeleton.NodeToBoneIndex.end())
+            continue;
+
+        const int32_t boneIndex = it->second;
+        if (boneToBinding[boneIndex] < 0)
+        {
+            boneToBinding[boneIndex] = static_cast<int32_t>(layer.Bindings.size());
+            layer.Bindings.push_back({ .Bone = boneIndex });
+        }
+
+        BoneChannelBinding& binding = layer.Bindings[boneToBinding[boneIndex]];
+        switch (channel.Path)
         {
-            float t = (time - times[i]) / (times[i + 1] - times[i]);
-            return Slerp(values[i], values[i + 1], t);
+        case AnimationPath::Translation: binding.Translation = static_cast<int32_t>(c); break;
+        case AnimationPath::Rotation:    binding.Rotation = static_cast<int32_t>(c); break;
+        case AnimationPath::Scale:       binding.Scale = static_cast<int32_t>(c); break;
+        default: break;
         }
     }
-    return values.back();
 }
 
-static void PlayAnimation(Animator& animator, Animation* animation,
-    Skeleton* skeleton, float playbackSpeed = 1.0f, bool looping = false)
+static void SetTargetSkeleton(Animator& animator, Skeleton* skeleton)
 {
     animator.TargetSkeleton = skeleton;
-    animator.CurrentAnimation = animation;
 
-    animator.CurrentTime = 0.0f;
-    animator.PlaybackSpeed = playbackSpeed;
-    animator.Looping = looping;
+    const size_t boneCount = skeleton ? skeleton->Bones.size() : 0;
+    Assert(boneCount <= MAX_BONES);
+
+    for (auto& pose : animator.LayerPoses)
+        pose.resize(boneCount);
+    animator.BlendedPose.resize(boneCount);
 }
 
-static void UpdateAnimator(Animator& animator, float deltaTime)
+// Starts a clip on one layer with a fixed weight, leaving the other layers alone.
+static void PlayAnimationLayer(Animator& animator, int layerIndex, Animation* animation,
+    float weight = 1.0f, float playbackSpeed = 1.0f, bool looping = true)
 {
-    if (!animator.CurrentAnimation || !animator.TargetSkeleton)
-        return;
+    Assert(layerIndex >= 0 && layerIndex < MAX_ANIMATION_LAYERS);
+    Assert(animator.TargetSkeleton);
+
+    AnimationLayer& layer = animator.Layers[layerIndex];
+    layer.Clip = animation;
+    layer.Time = 0.0f;
+    layer.PlaybackSpeed = playbackSpeed;
+    layer.Looping = looping;
+    layer.Weight = weight;
+    layer.TargetWeight = weight;
+    layer.FadeRate = 0.0f;
 
-    animator.CurrentTime += deltaTime * animator.PlaybackSpeed;
+    BindAnimationLayer(layer, *animator.TargetSkeleton);
+}
+
+static void SetLayerWeight(Animator& animator, int layerIndex, float weight, float fadeDuration = 0.0f)
+{
+    Assert(layerIndex >= 0 && layerIndex < MAX_ANIMATION_LAYERS);
 
-    if (animator.Looping)
+    AnimationLayer& layer = animator.Layers[layerIndex];
+    layer.TargetWeight = weight;
+    if (fadeDuration > 0.0f)
     {
-        if (animator.CurrentTime > animator.CurrentAnimation->Duration)
-            animator.CurrentTime = fmod(animator.CurrentTime, animator.CurrentAnimation->Duration);
+        layer.FadeRate = fabsf(weight - layer.Weight) / fadeDuration;
     }
     else
     {
-        animator.CurrentTime = 
-            std::min<float>(animator.CurrentTime, animator.CurrentAnimation->Duration);
+        layer.Weight = weight;
+        layer.FadeRate = 0.0f;
     }
-    // std::println("current time: {}", animator.CurrentTime);
-    UpdateAnimation(animator, animator.CurrentTime);
 }
 
-void UpdateAnimation(Animator& animator, float time)
+// Stops every layer and plays a single clip at full weight.
+static void PlayAnimation(Animator& animator, Animation* animation,
+    Skeleton* skeleton, float playbackSpeed = 1.0f, bool looping = false)
 {
-    if (!animator.CurrentAnimation || !animator.TargetSkeleton)
-        return;
+    SetTargetSkeleton(animator, skeleton);
 
-    auto& anim = *animator.CurrentAnimation;
-    auto& skeleton = *animator.TargetSkeleton;
+    for (auto& layer : animator.Layers)
+    {
+        layer.Clip = nullptr;
+        layer.Weight = layer.TargetWeight = 0.0f;
+    }
 
-    std::array<M4, 100> localTransforms{};
+    if (skeleton)
+        PlayAnimationLayer(animator, 0, animation, 1.0f, playbackSpeed, looping);
+}
 
-    for (auto& bone : skeleton.Bones)
-        localTransforms[skeleton.NodeToBoneIndex[bone.ID]] = MatrixIdentity();
+// Fades the clip in over fadeDuration seconds while every other layer fades out.
+// The clip starts in a free layer, or replaces the lowest-weighted one.
+static void CrossfadeTo(Animator& animator, Animation* animation, float fadeDuration,
+    float playbackSpeed = 1.0f, bool looping = true)
+{
+    Assert(animator.TargetSkeleton);
 
-    for (auto& channel : anim.Channels)
+    int target = 0;
+    for (int i = 0; i < MAX_ANIMATION_LAYERS; ++i)
     {
-        auto it = skeleton.NodeToBoneIndex.find(channel.TargetNode);
-        if (it == skeleton.NodeToBoneIndex.end())
+        const AnimationLayer& layer = animator.Layers[i];
+        if (!layer.Clip)
+        {
+            target = i;
+            break;
+        }
+        if (layer.Weight < animator.Layers[target].Weight)
+            target = i;
+    }
+
+    PlayAnimationLayer(animator, target, animation, 0.0f, playbackSpeed, looping);
+
+    for (int i = 0; i < MAX_ANIMATION_LAYERS; ++i)
+    {
+        if (!animator.Layers[i].Clip)
             continue;
-        int boneIndex = it->second;
+        SetLayerWeight(animator, i, i == target ? 1.0f : 0.0f, fadeDuration);
+    }
+}
 
-        V3 t{ 0,0,0 };
-        Quat r{ 1,0,0,0 };
-        V3 s{ 1,1,1 };
+// Keyframes to interpolate between at time, and the factor between them.
+// Times outside the clip clamp to its first or last key.
+static float FindKeyPair(const std::span<const float> times, float time, uint32_t& cursor,
+    size_t& key, size_t& next)
+{
+    if (time <= times.front())
+    {
+        key = next = 0;
+        return 0.0f;
+    }
+    if (time >= times.back())
+    {
+        key = next = times.size() - 1;
+        return 0.0f;
+    }
 
-        if (!channel.Translations.empty()) t = InterpolateVec3(channel.Times, channel.Translations, time);
-        if (!channel.Rotations.empty())    r = InterpolateQuat(channel.Times, channel.Rotations, time);
-        if (!channel.Scales.empty())       s = InterpolateVec3(channel.Times, channel.Scales, time);
+    key = FindKeyframe(times, time, cursor);
+    next = key + 1;
+    return (time - times[key]) / (times[next] - times[key]);
+}
+
+static void SampleAnimationLayer(AnimationLayer& layer, const Skeleton& skeleton,
+    PoseSampleStreams& streams, std::span<BoneTransform> pose)
+{
+    const Animation& anim = *layer.Clip;
+    const float time = layer.Time;
+
+    // Components that no channel animates keep the bone's bind pose.
+    for (size_t i = 0; i < skeleton.Bones.size(); ++i)
+        pose[i] = skeleton.Bones[i].LocalBindPose;
+
+    Assert(layer.ChannelCursors.size() == anim.Channels.size());
 
-        localTransforms[boneIndex] =
-            MatrixTranslation(t.X, t.Y, t.Z) *
-            MatrixFromQuaternion(r) *
-            MatrixScaling(s.X, s.Y, s.Z);
+    // ------------------- Gather -------------------
+    // Every channel adds its keyframe pair to the streams in binding order,
+    // so the scatter below finds the results by walking the bindings again.
+    size_t vectorCount = 0;
+    size_t rotationCount = 0;
+    for (const BoneChannelBinding& binding : layer.Bindings)
+    {
+        vectorCount += (binding.Translation >= 0) + (binding.Scale >= 0);
+        rotationCount += binding.Rotation >= 0;
     }
 
-    std::function<void(int, const M4&)> Recurse =
-        [&](int boneIndex, const M4& parentTransform)
+    streams.VectorFrom.Resize(vectorCount);
+    streams.VectorTo.Resize(vectorCount);
+    streams.VectorFactors.resize(vectorCount);
+    streams.RotationFrom.Resize(rotationCount);
+    streams.RotationTo.Resize(rotationCount);
+    streams.RotationFactors.resize(rotationCount);
+
+    size_t vector = 0;
+    const auto gatherVectors = [&](int32_t channelIndex, std::vector<V3> AnimationChannel::* values)
+    {
+        if (channelIndex < 0)
+            return;
+
+        const AnimationChannel& channel = anim.Channels[channelIndex];
+        size_t key, next;
+        streams.VectorFactors[vector] = FindKeyPair(channel.Times, time, layer.ChannelCursors[channelIndex], key, next);
+        streams.VectorFrom.Set(vector, (channel.*values)[key]);
+        streams.VectorTo.Set(vector, (channel.*values)[next]);
+        vector++;
+    };
+
+    for (const BoneChannelBinding& binding : layer.Bindings)
+        gatherVectors(binding.Translation, &AnimationChannel::Translations);
+    for (const BoneChannelBinding& binding : layer.Bindings)
+        gatherVectors(binding.Scale, &AnimationChannel::Scales);
+
+    size_t rotation = 0;
+    for (const BoneChannelBinding& binding : layer.Bindings)
+    {
+        if (binding.Rotation < 0)
+            continue;
+
+        const AnimationChannel& channel = anim.Channels[binding.Rotation];
+        size_t key, next;
+        streams.RotationFactors[rotation] = FindKeyPair(channel.Times, time, layer.ChannelCursors[binding.Rotation], key, next);
+        if (channel.PackedRotations.empty())
         {
-            M4 global = parentTransform * localTransforms[boneIndex];
-            BoneInfo& bone = skeleton.Bones[boneIndex];
+            streams.RotationFrom.Set(rotation, channel.Rotations[key]);
+            streams.RotationTo.Set(rotation, channel.Rotations[next]);
+        }
+        else
+        {
+            streams.RotationFrom.Set(rotation, UnpackQuat(channel.PackedRotations[key]));
+            streams.RotationTo.Set(rotation, UnpackQuat(channel.PackedRotations[next]));
+        }
+        rotation++;
+    }
 
-            animator.FinalBoneTransforms[boneIndex] = global * bone.InverseBindMatrix;
+    // ------------------- Interpolate -------------------
+    V3StreamLerp(streams.VectorFrom, streams.VectorTo, streams.VectorFactors, streams.VectorFrom);
+    QuatStreamSlerp(streams.RotationFrom, streams.RotationTo, streams.RotationFactors, streams.RotationFrom);
 
-            for (int childIndex : skeleton.Bones[boneIndex].Children)
-                Recurse(childIndex, global);
-        };
+    // ------------------- Scatter -------------------
+    vector = 0;
+    rotation = 0;
+    for (const BoneChannelBinding& binding : layer.Bindings)
+        if (binding.Translation >= 0)
+            pose[binding.Bone].Translation = streams.VectorFrom.Get(vector++);
+    for (const BoneChannelBinding& binding : layer.Bindings)
+        if (binding.Scale >= 0)
+            pose[binding.Bone].Scale = streams.VectorFrom.Get(vector++);
+    for (const BoneChannelBinding& binding : layer.Bindings)
+        if (binding.Rotation >= 0)
+            pose[binding.Bone].Rotation = streams.RotationFrom.Get(rotation++);
+}
+
+// Weighted average of local poses. Rotations are accumulated on the hemisphere
+// of the first pose and renormalized (nlerp).
+static void BlendPoses(std::span<const BoneTransform> pose, float weight,
+    std::span<BoneTransform> result, bool first)
+{
+    for (size_t i = 0; i < result.size(); ++i)
+    {
+        const BoneTransform& source = pose[i];
+        BoneTransform& target = result[i];
+
+        if (first)
+        {
+            target.Translation = source.Translation * weight;
+            target.Rotation = source.Rotation * weight;
+            target.Scale = source.Scale * weight;
+            continue;
+        }
+
+        const float rotationWeight = Dot(target.Rotation, source.Rotation) < 0.0f ? -weight : weight;
+        target.Translation += source.Translation * weight;
+        target.Rotation = target.Rotation + source.Rotation * rotationWeight;
+        target.Scale += source.Scale * weight;
+    }
+}
+
+static void AdvanceAnimationLayer(AnimationLayer& layer, float deltaTime)
+{
+    layer.Time += deltaTime * layer.PlaybackSpeed;
+
+    if (layer.Looping)
+    {
+        if (layer.Time > layer.Clip->Duration && layer.Clip->Duration > 0.0f)
+            layer.Time = fmodf(layer.Time, layer.Clip->Duration);
+    }
+    else
+    {
+        layer.Time = std::min<float>(layer.Time, layer.Clip->Duration);
+    }
 
-    if (skeleton.RootBone >= 0)
-        Recurse(skeleton.RootBone, MatrixIdentity());
+    if (layer.Weight != layer.TargetWeight)
+    {
+        const float step = layer.FadeRate * deltaTime;
+        layer.Weight = layer.Weight < layer.TargetWeight ?
+            std::min(layer.Weight + step, layer.TargetWeight) :
+            std::max(layer.Weight - step, layer.TargetWeight);
+
+        // A layer that has faded out frees its slot. One set to weight 0
+        // directly keeps its clip, ready to be faded in.
+        if (layer.Weight <= 0.0f && layer.TargetWeight <= 0.0f)
+            layer.Clip = nullptr;
+    }
+}
+
+// True while some layer has a clip, i.e. the pose may change each update.
+static bool IsAnimatorPlaying(const Animator& animator)
+{
+    if (!animator.TargetSkeleton)
+        return false;
+
+    for (const auto& layer : animator.Layers)
+        if (layer.Clip)
+            return true;
+    return false;
+}
+
+static void UpdateAnimator(Animator& animator, float deltaTime)
+{
+    if (!animator.TargetSkeleton)
+        return;
+
+    for (auto& layer : animator.Layers)
+        if (layer.Clip)
+            AdvanceAnimationLayer(layer, deltaTime);
+
+    UpdateAnimation(animator);
+}
+
+static void UpdateAnimation(Animator& animator)
+{
+    if (!animator.TargetSkeleton)
+        return;
+
+    const Skeleton& skeleton = *animator.TargetSkeleton;
+    const size_t boneCount = skeleton.Bones.size();
+
+    Assert(boneCount <= MAX_BONES);
+    Assert(animator.BlendedPose.size() == boneCount);
+
+    float totalWeight = 0.0f;
+    for (const auto& layer : animator.Layers)
+        if (layer.Clip)
+            totalWeight += layer.Weight;
+
+    if (totalWeight <= 0.0f)
+    {
+        // Nothing contributes yet, e.g. the first frame of a crossfade into
+        // an empty animator: hold the bind pose.
+        for (size_t i = 0; i < boneCount; ++i)
+            animator.BlendedPose[i] = skeleton.Bones[i].LocalBindPose;
+    }
+    else
+    {
+        bool first = true;
+        for (int i = 0; i < MAX_ANIMATION_LAYERS; ++i)
+        {
+            AnimationLayer& layer = animator.Layers[i];
+            if (!layer.Clip || layer.Weight <= 0.0f)
+                continue;
+
+            SampleAnimationLayer(layer, skeleton, animator.SampleStreams, animator.LayerPoses[i]);
+            BlendPoses(animator.LayerPoses[i], layer.Weight / totalWeight, animator.BlendedPose, first);
+            first = false;
+        }
+    }
+
+    std::array<M4x3, MAX_BONES> globalTransforms;
+
+    // Parents precede children, so every parent's global transform is ready.
+    for (size_t i = 0; i < boneCount; ++i)
+    {
+        const BoneTransform& pose = animator.BlendedPose[i];
+        const M4x3 local = AffineFromTRS(pose.Translation, NormalizeQuat(pose.Rotation), pose.Scale);
+
+        const int32_t parent = skeleton.ParentIndices[i];
+        globalTransforms[i] = parent >= 0 ? local * globalTransforms[parent] : local;
+
+        const BoneInfo& bone = skeleton.Bones[i];
+        animator.FinalBoneTransforms[bone.JointIndex] =
+            M4FromAffine(bone.InverseBindMatrix * globalTransforms[i]);
+    }
 }
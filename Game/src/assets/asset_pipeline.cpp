@@ -0,0 +1,58 @@
+#include "pch.h"
+
+#include "asset_pipeline.h"
+
+AssetPipeline::~AssetPipeline()
+{
+    WaitForLoads();
+}
+
+AssetHandle<Model> AssetPipeline::LoadModel(const std::string& path, ModelLoadOptions options)
+{
+    // Lets the loader decode the model's images in parallel.
+    options.Jobs = Jobs;
+    return Load<Model>([this, path, options]()
+        {
+            return ModelLoader::LoadModel(path, Textures, options);
+        });
+}
+
+AssetHandle<Sound> AssetPipeline::LoadSound(const std::string& path)
+{
+    return Load<Sound>([path]() { return LoadWavFile(path); });
+}
+
+void AssetPipeline::CommitLoaded()
+{
+    while (!PendingCommits.empty() &&
+        PendingCommits.front().Counter->Pending.load(std::memory_order_acquire) == 0)
+    {
+        PendingCommit commit = std::move(PendingCommits.front());
+        PendingCommits.pop_front();
+        commit.Commit();
+    }
+
+    std::erase_if(InFlight, [](const InFlightLoad& load)
+        {
+            return load.Counter->Pending.load(std::memory_order_acquire) == 0;
+        });
+}
+
+void AssetPipeline::WaitAll()
+{
+    while (!PendingCommits.empty())
+    {
+        if (Jobs)
+            Jobs->Wait(*PendingCommits.front().Counter);
+        CommitLoaded();
+    }
+
+    WaitForLoads();
+}
+
+void AssetPipeline::WaitForLoads()
+{
+    for (const InFlightLoad& load : InFlight)
+        Jobs->Wait(*load.Counter);
+    InFlight.clear();
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "assets.h"
+#include "sound.h"
+#include "model_loader.h"
+#include "texture_registry.h"
+#include "core/job_system.h"
+
+// Result of one load request. Asset may only be touched once IsReady().
+template<typename T>
+struct AssetSlot
+{
+    T Asset{};
+    JobCounter Counter{};
+
+    bool IsReady() const { return Counter.Pending.load(std::memory_order_acquire) == 0; }
+};
+
+template<typename T>
+using AssetHandle = std::shared_ptr<AssetSlot<T>>;
+
+/*
+	NOTE:
+	Loads (file IO, parsing, decoding) run as jobs on the JobSystem. Work that
+	must happen on the main thread, like GPU uploads, is queued with OnLoaded()
+	and runs from CommitLoaded() in request order once its asset is ready.
+	Without a JobSystem every load runs inline, which gives the serial baseline.
+	Load jobs use the pipeline's TextureRegistry, so the destructor waits for
+	every one still running, committed or not.
+*/
+class AssetPipeline
+{
+public:
+    AssetPipeline(JobSystem* jobs, TextureRegistry& textures) : Jobs(jobs), Textures(textures) {}
+    ~AssetPipeline();
+
+    AssetPipeline(const AssetPipeline&) = delete;
+    AssetPipeline& operator=(const AssetPipeline&) = delete;
+
+    template<typename T>
+    AssetHandle<T> Load(std::function<T()> load)
+    {
+        auto slot = std::make_shared<AssetSlot<T>>();
+        if (!Jobs)
+        {
+            slot->Asset = load();
+            return slot;
+        }
+
+        Jobs->Execute([slot, load = std::move(load)]() { slot->Asset = load(); }, slot->Counter);
+        InFlight.push_back({ slot, &slot->Counter });
+        return slot;
+    }
+
+    AssetHandle<Model> LoadModel(const std::string& path, ModelLoadOptions options = {});
+    AssetHandle<Sound> LoadSound(const std::string& path);
+
+    template<typename T>
+    void OnLoaded(const AssetHandle<T>& handle, std::type_identity_t<std::function<void(T&)>> commit)
+    {
+        // The commit owns a reference to the slot, which keeps Counter alive.
+        PendingCommits.push_back({ &handle->Counter,
+            [handle, commit = std::move(commit)]() { commit(handle->Asset); } });
+    }
+
+    // Runs the queued commits whose assets are ready, stopping at the first
+    // one that is not. Main thread only.
+    void CommitLoaded();
+
+    // Blocks until every request is loaded and committed, running jobs meanwhile.
+    void WaitAll();
+
+    // Blocks until no load job is running, without committing anything.
+    void WaitForLoads();
+
+    template<typename T>
+    void Wait(const AssetHandle<T>& handle)
+    {
+        if (Jobs)
+            Jobs->Wait(handle->Counter);
+    }
+
+private:
+    struct PendingCommit
+    {
+        JobCounter* Counter{};
+        std::function<void()> Commit{};
+    };
+
+    // A load job that may still be running. Slot owns Counter.
+    struct InFlightLoad
+    {
+        std::shared_ptr<const void> Slot{};
+        JobCounter* Counter{};
+    };
+
+    JobSystem* Jobs{};
+    TextureRegistry& Textures;
+    std::deque<PendingCommit> PendingCommits{};
+    std::vector<InFlightLoad> InFlight{};
+};
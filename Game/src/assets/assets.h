@@ -1,9 +1,13 @@
 #pragma once
 
 #include "math/handmade_math.h"
+#include "math/bounds.h"
+#include "math/vector_stream.h"
 
 // Maximum number of bones that can influence one vertex.
 static constexpr int MAX_BONE_INFLUENCE = 4;
+// Maximum number of bones in a skeleton, matches the shader constant buffers.
+static constexpr int MAX_BONES = 100;
 struct Vertex
 {
     V3 Position{};
@@ -14,31 +18,62 @@ struct Vertex
     V4 Weights{};
 };
 
+// Decomposed local transform of a bone.
+struct BoneTransform
+{
+    V3 Translation{ 0.0f, 0.0f, 0.0f };
+    Quat Rotation{ 0.0f, 0.0f, 0.0f, 1.0f };
+    V3 Scale{ 1.0f, 1.0f, 1.0f };
+};
+
 struct BoneInfo
 {
-    M4 InverseBindMatrix{};
+    // Stored affine: the last column of an inverse bind matrix is always (0, 0, 0, 1).
+    M4x3 InverseBindMatrix{};
     M4 FinalTransform{};
-    // Bones connected to this bone.
-    std::vector<int> Children{};
+    // Rest pose of the joint node, used for components no channel animates.
+    BoneTransform LocalBindPose{};
 
+    // glTF node index.
     int32_t ID{};
+    // Index into the skin's joint list, which is what vertex BoneIDs refer to.
+    int32_t JointIndex{};
 };
 
+// Bones are stored parent-before-child. ParentIndices[i] is the bone index of
+// the parent of bone i, or -1 for a root.
 struct Skeleton 
 {
     std::vector<BoneInfo> Bones;
+    std::vector<int32_t> ParentIndices;
     std::unordered_map<int, int> NodeToBoneIndex;
     int32_t RootBone{-1};
 };
 
+enum class AnimationPath : uint8_t
+{
+    Unknown,
+    Translation,
+    Rotation,
+    Scale,
+};
+
+// Unit quaternion quantized to 48 bits, see PackQuat().
+struct PackedQuat
+{
+    uint16_t Data[3]{};
+};
+
 struct AnimationChannel 
 {
-    std::string Path{};
     std::vector<float> Times{};
     std::vector<V3> Translations{};
+    // Compressed clips store rotations in PackedRotations instead.
     std::vector<Quat> Rotations{};
+    std::vector<PackedQuat> PackedRotations{};
     std::vector<V3> Scales{};
     int32_t TargetNode{};
+    AnimationPath Path{};
 };
 
 struct Animation 
@@ -49,15 +84,61 @@ struct Animation
     float CurrentTime{};
 };
 
+// The channels of one clip that drive one bone, -1 when not animated.
+struct BoneChannelBinding
+{
+    int32_t Bone{ -1 };
+    int32_t Translation{ -1 };
+    int32_t Rotation{ -1 };
+    int32_t Scale{ -1 };
+};
+
+// Maximum number of clips an Animator can blend at once.
+static constexpr int MAX_ANIMATION_LAYERS = 4;
+
+// One clip sampled by an Animator, blended with the others by Weight.
+struct AnimationLayer
+{
+    Animation* Clip{};
+    // Last keyframe index per channel of Clip.
+    std::vector<uint32_t> ChannelCursors{};
+    // Channel-to-bone bindings of Clip, resolved when the clip is started.
+    std::vector<BoneChannelBinding> Bindings{};
+
+    float Time{};
+    float PlaybackSpeed{ 1.0f };
+    bool Looping{ true };
+
+    float Weight{};
+    // Weight moves towards TargetWeight by FadeRate per second.
+    float TargetWeight{};
+    float FadeRate{};
+};
+
+// Keyframe pairs gathered from the channels of a layer, interpolated a whole
+// stream at a time. Translations come first, then scales.
+struct PoseSampleStreams
+{
+    V3Stream VectorFrom{};
+    V3Stream VectorTo{};
+    std::vector<float> VectorFactors{};
+
+    QuatStream RotationFrom{};
+    QuatStream RotationTo{};
+    std::vector<float> RotationFactors{};
+};
+
 struct Animator
 {
-    std::array<M4, 100> FinalBoneTransforms{};
+    std::array<M4, MAX_BONES> FinalBoneTransforms{};
     Skeleton* TargetSkeleton{};
-    Animation* CurrentAnimation{};
 
-    float CurrentTime{};
-    float PlaybackSpeed{1.0f};
-    bool Looping{true};
+    std::array<AnimationLayer, MAX_ANIMATION_LAYERS> Layers{};
+
+    // Local pose buffers, sized once per skeleton so blending never allocates.
+    std::array<std::vector<BoneTransform>, MAX_ANIMATION_LAYERS> LayerPoses{};
+    std::vector<BoneTransform> BlendedPose{};
+    PoseSampleStreams SampleStreams{};
 };
 
 struct Texture
@@ -67,12 +148,54 @@ struct Texture
     int Height{};
 };
 
+// Index of a texture in a TextureRegistry.
+struct TextureHandle
+{
+    uint32_t Index{ UINT32_MAX };
+
+    bool IsValid() const { return Index != UINT32_MAX; }
+    bool operator==(const TextureHandle&) const = default;
+};
+
+// Index range of one glTF primitive within its Mesh.
+struct Submesh
+{
+    uint32_t IndexOffset{};
+    uint32_t IndexCount{};
+    // Index into Mesh::Textures of the base color texture, -1 when untextured.
+    int32_t Material{ -1 };
+};
+
+// A simplified level of a Mesh. It shares the mesh's vertices and draws its
+// own submesh ranges, which live in Mesh::LodSubmeshes.
+struct MeshLod
+{
+    uint32_t FirstSubmesh{};
+    uint32_t SubmeshCount{};
+    // Estimated distance between this level's surface and the full detail
+    // mesh, in mesh units.
+    float Error{};
+};
+
 struct Mesh
 {
-    std::vector<Texture> Textures{};
+    std::vector<TextureHandle> Textures{};
     std::vector<Vertex> Vertices{};
     std::vector<uint32_t> Indices{};
+    std::vector<Submesh> Submeshes{};
+
+    // Levels 1 and up, coarsest last. Level 0 is Submeshes.
+    std::vector<MeshLod> Lods{};
+    std::vector<Submesh> LodSubmeshes{};
+
+    // Bounds of Vertices in mesh space, see ComputeMeshBounds().
+    AABB Bounds{};
+    // Skinned meshes only: the bind pose bounds of the vertices each bone
+    // id influences, and of the unweighted ones. See ComputePosedBounds().
+    std::vector<AABB> BoneBounds{};
+    AABB UnweightedBounds{};
 
+    // Views of Textures, shared with every mesh that uses the same texture.
     std::vector<void*> TextureViews{};
     void* VertexBuffer{};
     void* IndexBuffer{};
@@ -0,0 +1,58 @@
+#include "pch.h"
+#include "assets/mesh_bounds.h"
+
+void ComputeMeshBounds(Mesh& mesh)
+{
+    mesh.Bounds = {};
+    mesh.BoneBounds.clear();
+    mesh.UnweightedBounds = {};
+    if (mesh.Vertices.empty())
+        return;
+
+    bool skinned = false;
+    for (const Vertex& vertex : mesh.Vertices)
+    {
+        ExpandAABB(mesh.Bounds, vertex.Position);
+
+        const int32_t ids[MAX_BONE_INFLUENCE] = { vertex.BoneIDs.X, vertex.BoneIDs.Y, vertex.BoneIDs.Z, vertex.BoneIDs.W };
+        const float weights[MAX_BONE_INFLUENCE] = { vertex.Weights.X, vertex.Weights.Y, vertex.Weights.Z, vertex.Weights.W };
+
+        bool weighted = false;
+        for (int i = 0; i < MAX_BONE_INFLUENCE; ++i)
+        {
+            if (weights[i] <= 0.0f || ids[i] < 0 || ids[i] >= MAX_BONES)
+                continue;
+
+            if (mesh.BoneBounds.size() <= static_cast<size_t>(ids[i]))
+                mesh.BoneBounds.resize(ids[i] + 1);
+            ExpandAABB(mesh.BoneBounds[ids[i]], vertex.Position);
+            weighted = true;
+        }
+
+        skinned |= weighted;
+        if (!weighted)
+            ExpandAABB(mesh.UnweightedBounds, vertex.Position);
+    }
+
+    // A mesh without weights is not skinned, whatever it is drawn with
+    if (!skinned)
+        mesh.UnweightedBounds = {};
+}
+
+AABB ComputePosedBounds(const Mesh& mesh, const std::array<M4, MAX_BONES>& bones)
+{
+    if (mesh.BoneBounds.empty())
+        return mesh.Bounds;
+
+    // Unweighted vertices are drawn as they are
+    AABB result = mesh.UnweightedBounds;
+    for (size_t bone = 0; bone < mesh.BoneBounds.size(); bone++)
+    {
+        if (!mesh.BoneBounds[bone].IsValid())
+            continue;
+
+        result = MergeAABB(result, TransformAABB(mesh.BoneBounds[bone], bones[bone]));
+    }
+
+    return result;
+}
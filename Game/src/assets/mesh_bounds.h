@@ -0,0 +1,13 @@
+#pragma once
+
+#include "assets/assets.h"
+
+// Fills Mesh::Bounds from the vertex positions, in the bind pose. Skinned
+// meshes also get Mesh::BoneBounds.
+void ComputeMeshBounds(Mesh& mesh);
+
+// Mesh space bounds of a skinned mesh posed by bones: each bone's bind pose
+// box moved by its skinning matrix, merged. A skinned vertex is a weighted
+// average of its position moved by each influencing bone, and weights sum to
+// one, so the merged box contains it. Returns Bounds for unskinned meshes.
+AABB ComputePosedBounds(const Mesh& mesh, const std::array<M4, MAX_BONES>& bones);
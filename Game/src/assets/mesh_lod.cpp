@@ -0,0 +1,522 @@
+#include "pch.h"
+#include "assets/mesh_lod.h"
+#include "assets/mesh_optimizer.h"
+
+/*
+	NOTE:
+	Garland-Heckbert simplification restricted to half-edge collapses: a vertex
+	is only ever merged into one of its neighbours, never moved to the quadric
+	optimum. That gives up a little quality but keeps every level indexing the
+	original vertex buffer, so levels cost an index range and nothing else.
+*/
+
+// Symmetric 4x4 matrix whose form p^T Q p sums squared distances to planes.
+struct Quadric
+{
+    double XX{}, XY{}, XZ{}, XW{};
+    double YY{}, YZ{}, YW{};
+    double ZZ{}, ZW{};
+    double WW{};
+};
+
+static Quadric PlaneQuadric(const double a, const double b, const double c, const double d)
+{
+    return { a * a, a * b, a * c, a * d, b * b, b * c, b * d, c * c, c * d, d * d };
+}
+
+static void AddQuadric(Quadric& q, const Quadric& other)
+{
+    q.XX += other.XX; q.XY += other.XY; q.XZ += other.XZ; q.XW += other.XW;
+    q.YY += other.YY; q.YZ += other.YZ; q.YW += other.YW;
+    q.ZZ += other.ZZ; q.ZW += other.ZW;
+    q.WW += other.WW;
+}
+
+static double EvaluateQuadric(const Quadric& q, const V3& p)
+{
+    const double x = p.X, y = p.Y, z = p.Z;
+    const double result =
+        q.XX * x * x + 2.0 * q.XY * x * y + 2.0 * q.XZ * x * z + 2.0 * q.XW * x +
+        q.YY * y * y + 2.0 * q.YZ * y * z + 2.0 * q.YW * y +
+        q.ZZ * z * z + 2.0 * q.ZW * z +
+        q.WW;
+
+    // Rounding can push an exact fit slightly below zero.
+    return std::max(result, 0.0);
+}
+
+std::vector<uint32_t> SimplifyIndices(std::span<const Vertex> vertices,
+    std::span<const uint32_t> indices, size_t targetIndexCount, float& error)
+{
+    error = 0.0f;
+    std::vector<uint32_t> triangles(indices.begin(), indices.end());
+    if (triangles.size() <= targetIndexCount)
+        return triangles;
+
+    const size_t triangleCount = triangles.size() / 3;
+    const size_t vertexCount = vertices.size();
+
+    std::vector<std::vector<uint32_t>> vertexTriangles(vertexCount);
+    for (uint32_t t = 0; t < triangleCount; t++)
+    {
+        for (size_t corner = 0; corner < 3; corner++)
+        {
+            Assert(triangles[t * 3 + corner] < vertexCount);
+            vertexTriangles[triangles[t * 3 + corner]].push_back(t);
+        }
+    }
+
+    // ------------------- Wedges -------------------
+    // Vertices at the same position are wedges of one corner, split by a UV or
+    // normal seam. Quadrics, borders and locks belong to the corner, which is
+    // named by its first wedge. nextWedge links the wedges of a corner in a ring.
+    std::vector<uint32_t> corner(vertexCount);
+    std::vector<uint32_t> nextWedge(vertexCount);
+    {
+        std::vector<uint32_t> byPosition{};
+        for (uint32_t i = 0; i < vertexCount; i++)
+        {
+            corner[i] = i;
+            nextWedge[i] = i;
+            if (!vertexTriangles[i].empty())
+                byPosition.push_back(i);
+        }
+
+        auto positionLess = [&vertices](const uint32_t a, const uint32_t b)
+        {
+            const int order = memcmp(&vertices[a].Position, &vertices[b].Position, sizeof(V3));
+            return order != 0 ? order < 0 : a < b;
+        };
+        std::sort(byPosition.begin(), byPosition.end(), positionLess);
+
+        for (size_t i = 1; i < byPosition.size(); i++)
+        {
+            const uint32_t previous = byPosition[i - 1];
+            const uint32_t current = byPosition[i];
+            if (memcmp(&vertices[previous].Position, &vertices[current].Position, sizeof(V3)) == 0)
+            {
+                corner[current] = corner[previous];
+                nextWedge[current] = nextWedge[previous];
+                nextWedge[previous] = current;
+            }
+        }
+    }
+
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        const uint32_t* tri = &triangles[t * 3];
+        const V3& p0 = vertices[tri[0]].Position;
+        const V3 normal = Cross(vertices[tri[1]].Position - p0, vertices[tri[2]].Position - p0);
+        const float length = Length(normal);
+        if (length <= 0.0f)
+            continue;
+
+        const V3 n = normal * (1.0f / length);
+        const Quadric plane = PlaneQuadric(n.X, n.Y, n.Z, -Dot(n, p0));
+        for (size_t i = 0; i < 3; i++)
+            AddQuadric(quadrics[corner[tri[i]]], plane);
+    }
+
+    // ------------------- Locked Vertices -------------------
+    // Border corners would open holes and, between submeshes, cracks. Seams
+    // are not borders: counted by corner, a seam edge has a triangle per side.
+    std::vector<bool> locked(vertexCount, false);
+
+    auto edgeKey = [](const uint32_t a, const uint32_t b)
+    {
+        return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+    };
+
+    std::unordered_map<uint64_t, uint32_t> edgeUses{};
+    edgeUses.reserve(triangles.size());
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        const uint32_t* tri = &triangles[t * 3];
+        for (size_t i = 0; i < 3; i++)
+            edgeUses[edgeKey(corner[tri[i]], corner[tri[(i + 1) % 3]])]++;
+    }
+
+    for (const auto& [key, uses] : edgeUses)
+    {
+        if (uses == 1)
+        {
+            locked[key >> 32] = true;
+            locked[key & 0xFFFFFFFF] = true;
+        }
+    }
+    edgeUses = {};
+
+    // ------------------- Collapse -------------------
+    struct Collapse
+    {
+        double Cost{};
+        uint32_t From{};
+        uint32_t To{};
+
+        bool operator>(const Collapse& other) const { return Cost > other.Cost; }
+    };
+
+    auto collapseCost = [&](const uint32_t from, const uint32_t to)
+    {
+        Quadric q = quadrics[corner[from]];
+        AddQuadric(q, quadrics[corner[to]]);
+        return EvaluateQuadric(q, vertices[to].Position);
+    };
+
+    // Heapified once up front, which is much cheaper than pushing every edge
+    std::vector<Collapse> collapses{};
+    collapses.reserve(triangles.size() * 2);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        const uint32_t* tri = &triangles[t * 3];
+        for (size_t i = 0; i < 3; i++)
+        {
+            const uint32_t a = tri[i];
+            const uint32_t b = tri[(i + 1) % 3];
+            if (!locked[corner[a]])
+                collapses.push_back({ collapseCost(a, b), a, b });
+        }
+    }
+
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>> queue(
+        std::greater<>{}, std::move(collapses));
+    auto pushEdge = [&](const uint32_t a, const uint32_t b)
+    {
+        if (!locked[corner[a]])
+            queue.push({ collapseCost(a, b), a, b });
+        if (!locked[corner[b]])
+            queue.push({ collapseCost(b, a), b, a });
+    };
+
+    std::vector<bool> triangleRemoved(triangleCount, false);
+    std::vector<bool> vertexRemoved(vertexCount, false);
+    std::vector<std::pair<uint32_t, uint32_t>> moves{};
+    std::vector<uint32_t> neighbours{};
+    size_t liveTriangles = triangleCount;
+    double maxCost = 0.0;
+
+    auto hasVertex = [&triangles](const uint32_t t, const uint32_t v)
+    {
+        return triangles[t * 3] == v || triangles[t * 3 + 1] == v || triangles[t * 3 + 2] == v;
+    };
+
+    while (liveTriangles * 3 > targetIndexCount && !queue.empty())
+    {
+        const Collapse collapse = queue.top();
+        queue.pop();
+
+        const uint32_t from = collapse.From;
+        const uint32_t to = collapse.To;
+        if (vertexRemoved[from] || vertexRemoved[to])
+            continue;
+
+        // Quadrics only grow, so an entry queued before a merge underestimates
+        // its cost. Re-queue it at the current cost instead of taking it early.
+        const double cost = collapseCost(from, to);
+        if (cost > collapse.Cost * (1.0 + 1e-6) + 1e-12)
+        {
+            queue.push({ cost, from, to });
+            continue;
+        }
+
+        // Every wedge of the corner moves along an edge to a wedge of the
+        // target corner, so a seam is collapsed on both sides or not at all.
+        moves.clear();
+        bool valid = true;
+        uint32_t wedge = from;
+        do
+        {
+            uint32_t target = UINT32_MAX;
+            for (const uint32_t t : vertexTriangles[wedge])
+            {
+                if (triangleRemoved[t])
+                    continue;
+
+                for (size_t i = 0; i < 3 && target == UINT32_MAX; i++)
+                {
+                    const uint32_t other = triangles[t * 3 + i];
+                    if (corner[other] == corner[to] && (wedge != from || other == to))
+                        target = other;
+                }
+            }
+
+            if (target == UINT32_MAX)
+            {
+                valid = false;
+                break;
+            }
+
+            moves.push_back({ wedge, target });
+            wedge = nextWedge[wedge];
+        } while (wedge != from);
+
+        // No triangle that survives the collapse may flip or degenerate
+        const V3& destination = vertices[to].Position;
+        for (size_t m = 0; m < moves.size() && valid; m++)
+        {
+            for (const uint32_t t : vertexTriangles[moves[m].first])
+            {
+                if (triangleRemoved[t] || hasVertex(t, moves[m].second))
+                    continue;
+
+                const uint32_t* tri = &triangles[t * 3];
+                const V3 p[3] = { vertices[tri[0]].Position, vertices[tri[1]].Position, vertices[tri[2]].Position };
+                V3 q[3] = { p[0], p[1], p[2] };
+                for (size_t i = 0; i < 3; i++)
+                    if (tri[i] == moves[m].first)
+                        q[i] = destination;
+
+                const V3 before = Cross(p[1] - p[0], p[2] - p[0]);
+                const V3 after = Cross(q[1] - q[0], q[2] - q[0]);
+                if (Dot(before, after) <= 1e-3f * Length(before) * Length(after))
+                {
+                    valid = false;
+                    break;
+                }
+            }
+        }
+
+        if (!valid)
+            continue;
+
+        for (const auto& [source, target] : moves)
+        {
+            for (const uint32_t t : vertexTriangles[source])
+            {
+                if (triangleRemoved[t])
+                    continue;
+
+                if (hasVertex(t, target))
+                {
+                    triangleRemoved[t] = true;
+                    liveTriangles--;
+                    continue;
+                }
+
+                uint32_t* tri = &triangles[t * 3];
+                for (size_t i = 0; i < 3; i++)
+                    if (tri[i] == source)
+                        tri[i] = target;
+                vertexTriangles[target].push_back(t);
+            }
+
+            vertexTriangles[source] = {};
+            vertexRemoved[source] = true;
+        }
+
+        AddQuadric(quadrics[corner[to]], quadrics[corner[from]]);
+        maxCost = std::max(maxCost, cost);
+
+        // Edges around the merged corner changed cost
+        for (const auto& [source, target] : moves)
+        {
+            std::erase_if(vertexTriangles[target], [&triangleRemoved](const uint32_t t) { return triangleRemoved[t]; });
+
+            neighbours.clear();
+            for (const uint32_t t : vertexTriangles[target])
+                for (size_t i = 0; i < 3; i++)
+                    if (triangles[t * 3 + i] != target)
+                        neighbours.push_back(triangles[t * 3 + i]);
+
+            std::sort(neighbours.begin(), neighbours.end());
+            neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+            for (const uint32_t neighbour : neighbours)
+                pushEdge(target, neighbour);
+        }
+    }
+
+    std::vector<uint32_t> result{};
+    result.reserve(liveTriangles * 3);
+    for (size_t t = 0; t < triangleCount; t++)
+        if (!triangleRemoved[t])
+            result.insert(result.end(), &triangles[t * 3], &triangles[t * 3] + 3);
+
+    // The quadric sums squared distances to every merged plane, which bounds
+    // the distance to any one of them.
+    error = static_cast<float>(sqrt(maxCost));
+    return result;
+}
+
+// For each vertex, the first vertex at the same position.
+static std::vector<uint32_t> GetPositionRepresentatives(std::span<const Vertex> vertices)
+{
+    std::vector<uint32_t> order(vertices.size());
+    for (uint32_t i = 0; i < order.size(); i++)
+        order[i] = i;
+
+    auto positionLess = [&vertices](const uint32_t a, const uint32_t b)
+    {
+        const int compare = memcmp(&vertices[a].Position, &vertices[b].Position, sizeof(V3));
+        return compare != 0 ? compare < 0 : a < b;
+    };
+    std::sort(order.begin(), order.end(), positionLess);
+
+    std::vector<uint32_t> result(vertices.size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        const bool samePosition = i > 0 &&
+            memcmp(&vertices[order[i - 1]].Position, &vertices[order[i]].Position, sizeof(V3)) == 0;
+        result[order[i]] = samePosition ? result[order[i - 1]] : order[i];
+    }
+    return result;
+}
+
+// Gives every triangle its own three vertices with the face normal, appended
+// to the mesh, and points indices at them.
+static void AppendFlatShadedVertices(Mesh& mesh, std::vector<uint32_t>& indices)
+{
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        const V3& p0 = mesh.Vertices[indices[i]].Position;
+        const V3 normal = Cross(mesh.Vertices[indices[i + 1]].Position - p0, mesh.Vertices[indices[i + 2]].Position - p0);
+        const float length = Length(normal);
+
+        for (size_t corner = 0; corner < 3; corner++)
+        {
+            Vertex vertex = mesh.Vertices[indices[i + corner]];
+            if (length > 0.0f)
+                vertex.Normal = normal * (1.0f / length);
+
+            indices[i + corner] = static_cast<uint32_t>(mesh.Vertices.size());
+            mesh.Vertices.push_back(vertex);
+        }
+    }
+}
+
+void BuildMeshLods(Mesh& mesh, const MeshLodSettings& settings)
+{
+    // Previous levels sit after the full detail ranges, and flat-shaded ones
+    // after the full detail vertices
+    if (!mesh.Lods.empty())
+    {
+        size_t end = 0;
+        uint32_t vertexEnd = 0;
+        for (const Submesh& submesh : mesh.Submeshes)
+        {
+            end = std::max<size_t>(end, submesh.IndexOffset + submesh.IndexCount);
+            for (uint32_t i = 0; i < submesh.IndexCount; i++)
+                vertexEnd = std::max(vertexEnd, mesh.Indices[submesh.IndexOffset + i] + 1);
+        }
+        mesh.Indices.resize(end);
+        mesh.Vertices.resize(vertexEnd);
+    }
+    mesh.Lods.clear();
+    mesh.LodSubmeshes.clear();
+
+    uint32_t previousTriangles = GetLodTriangleCount(mesh, 0);
+    float previousError = 0.0f;
+
+    // Set once the seam-preserving simplifier gets stuck on the first level
+    bool positionsOnly = false;
+    std::vector<uint32_t> representatives{};
+
+    for (uint32_t level = 1; level <= settings.MaxLods; level++)
+    {
+        if (previousTriangles < settings.MinTriangles)
+            break;
+
+        const uint32_t firstIndex = static_cast<uint32_t>(mesh.Indices.size());
+        const size_t firstVertex = mesh.Vertices.size();
+        std::vector<uint32_t> levelIndices{};
+        std::vector<Submesh> levelSubmeshes{};
+        float levelError = 0.0f;
+
+        for (const Submesh& source : GetLodSubmeshes(mesh, level - 1))
+        {
+            std::vector<uint32_t> sourceIndices(mesh.Indices.begin() + source.IndexOffset,
+                mesh.Indices.begin() + source.IndexOffset + source.IndexCount);
+            const size_t targetIndexCount = static_cast<size_t>(source.IndexCount / 3 * settings.Reduction) * 3;
+
+            // One vertex per position leaves no seams for the simplifier to keep
+            if (positionsOnly)
+                for (uint32_t& index : sourceIndices)
+                    index = representatives[index];
+
+            float error = 0.0f;
+            std::vector<uint32_t> simplified = SimplifyIndices(
+                std::span(mesh.Vertices).first(firstVertex), sourceIndices, targetIndexCount, error);
+            if (simplified.empty())
+                continue;
+
+            if (positionsOnly)
+                AppendFlatShadedVertices(mesh, simplified);
+            OptimizeVertexCache(simplified, mesh.Vertices.size());
+
+            levelError = std::max(levelError, error);
+            levelSubmeshes.push_back({ firstIndex + static_cast<uint32_t>(levelIndices.size()),
+                static_cast<uint32_t>(simplified.size()), source.Material });
+            levelIndices.insert(levelIndices.end(), simplified.begin(), simplified.end());
+        }
+
+        const uint32_t triangles = static_cast<uint32_t>(levelIndices.size() / 3);
+        if (triangles > previousTriangles * settings.MinReduction)
+        {
+            mesh.Vertices.resize(firstVertex);
+            if (level > 1 || positionsOnly || !settings.FlatShadingFallback)
+                break;
+
+            positionsOnly = true;
+            representatives = GetPositionRepresentatives(mesh.Vertices);
+            level--;
+            continue;
+        }
+
+        // Each level is simplified from the previous one, so errors add up
+        MeshLod lod{};
+        lod.FirstSubmesh = static_cast<uint32_t>(mesh.LodSubmeshes.size());
+        lod.SubmeshCount = static_cast<uint32_t>(levelSubmeshes.size());
+        lod.Error = previousError + levelError;
+
+        mesh.Indices.insert(mesh.Indices.end(), levelIndices.begin(), levelIndices.end());
+        mesh.LodSubmeshes.insert(mesh.LodSubmeshes.end(), levelSubmeshes.begin(), levelSubmeshes.end());
+        mesh.Lods.push_back(lod);
+
+        previousTriangles = triangles;
+        previousError = lod.Error;
+
+        // Representatives of the vertices just appended, for the next level
+        if (positionsOnly)
+            representatives = GetPositionRepresentatives(mesh.Vertices);
+    }
+}
+
+uint32_t GetLodCount(const Mesh& mesh)
+{
+    return static_cast<uint32_t>(mesh.Lods.size()) + 1;
+}
+
+std::span<const Submesh> GetLodSubmeshes(const Mesh& mesh, uint32_t lod)
+{
+    if (lod == 0 || mesh.Lods.empty())
+        return mesh.Submeshes;
+
+    const MeshLod& level = mesh.Lods[std::min<size_t>(lod, mesh.Lods.size()) - 1];
+    return std::span(mesh.LodSubmeshes).subspan(level.FirstSubmesh, level.SubmeshCount);
+}
+
+uint32_t GetLodTriangleCount(const Mesh& mesh, uint32_t lod)
+{
+    uint32_t result = 0;
+    for (const Submesh& submesh : GetLodSubmeshes(mesh, lod))
+        result += submesh.IndexCount / 3;
+    return result;
+}
+
+uint32_t SelectLod(const Mesh& mesh, float distance, float pixelsPerUnit,
+    float maxPixelError)
+{
+    // Inside or at the mesh, every error is visible
+    if (distance <= 0.0f)
+        return 0;
+
+    uint32_t result = 0;
+    for (size_t i = 0; i < mesh.Lods.size(); i++)
+    {
+        const float projectedError = mesh.Lods[i].Error * pixelsPerUnit / distance;
+        if (projectedError > maxPixelError)
+            break;
+        result = static_cast<uint32_t>(i) + 1;
+    }
+    return result;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "assets/assets.h"
+
+struct MeshLodSettings
+{
+    // Levels generated in addition to the full detail mesh.
+    uint32_t MaxLods{ 4 };
+    // Triangle count of each level relative to the previous one.
+    float Reduction{ 0.5f };
+    // Stops once a level keeps more than this share of the previous level's
+    // triangles, i.e. when the simplifier is stuck on locked vertices.
+    float MinReduction{ 0.85f };
+    // Meshes with fewer triangles get no further levels.
+    uint32_t MinTriangles{ 64 };
+    // Flat-shaded meshes split every corner into a vertex per face, which
+    // locks all of them as normal seams. When the first level gets stuck like
+    // that, simplify on positions alone instead: UV and normal seams are
+    // ignored, and the levels get new face-normal vertices appended to the
+    // mesh rather than sharing its vertex buffer.
+    bool FlatShadingFallback{ true };
+};
+
+// Collapses edges of a triangle list in order of quadric error until at most
+// targetIndexCount indices remain. Vertices only ever move onto existing
+// vertices, so the result indexes the same vertex buffer. Border and UV or
+// normal seam vertices are locked. error receives the distance estimate of
+// the costliest collapse.
+std::vector<uint32_t> SimplifyIndices(std::span<const Vertex> vertices,
+    std::span<const uint32_t> indices, size_t targetIndexCount, float& error);
+
+// Appends a chain of simplified levels to mesh.Indices and mesh.Lods, each
+// built from the previous one. Every submesh is simplified on its own so
+// materials stay intact. Replaces existing levels; run after OptimizeMesh().
+// Only the flat shading fallback appends to mesh.Vertices.
+void BuildMeshLods(Mesh& mesh, const MeshLodSettings& settings = {});
+
+uint32_t GetLodCount(const Mesh& mesh);
+std::span<const Submesh> GetLodSubmeshes(const Mesh& mesh, uint32_t lod);
+uint32_t GetLodTriangleCount(const Mesh& mesh, uint32_t lod);
+
+// Picks the coarsest level whose error, projected at distance, covers at most
+// maxPixelError pixels. pixelsPerUnit is the on-screen size in pixels of one
+// unit at distance one, see GetPixelsPerUnit().
+uint32_t SelectLod(const Mesh& mesh, float distance, float pixelsPerUnit,
+    float maxPixelError = 1.0f);
+
+// Projection from MatrixPerspective(), screenHeight in pixels.
+inline float GetPixelsPerUnit(const M4& projection, const float screenHeight)
+{
+    return projection.M[1][1] * screenHeight * 0.5f;
+}
@@ -0,0 +1,290 @@
+#include "pch.h"
+#include "assets/mesh_optimizer.h"
+
+VertexCacheStats AnalyzeVertexCache(std::span<const uint32_t> indices,
+    size_t vertexCount, uint32_t cacheSize)
+{
+    // Without a whole triangle there is nothing to average over
+    VertexCacheStats result{};
+    if (indices.size() < 3 || vertexCount == 0)
+        return result;
+
+    // Timestamp each vertex enters the cache; it is still cached while fewer
+    // than cacheSize misses happened since.
+    std::vector<uint32_t> cachedAt(vertexCount, 0);
+    std::vector<bool> referenced(vertexCount, false);
+    size_t referencedCount = 0;
+
+    for (const uint32_t index : indices)
+    {
+        Assert(index < vertexCount);
+
+        if (!referenced[index])
+        {
+            referenced[index] = true;
+            referencedCount++;
+        }
+
+        if (cachedAt[index] == 0 || result.Transforms - cachedAt[index] + 1 > cacheSize)
+        {
+            result.Transforms++;
+            cachedAt[index] = result.Transforms;
+        }
+    }
+
+    result.ACMR = static_cast<float>(result.Transforms) / static_cast<float>(indices.size() / 3);
+    result.ATVR = static_cast<float>(result.Transforms) / static_cast<float>(referencedCount);
+    return result;
+}
+
+size_t WeldVertices(std::vector<Vertex>& vertices, std::span<uint32_t> indices)
+{
+    static_assert(sizeof(Vertex) == sizeof(float) * 16, "Vertex must have no padding to be compared bitwise");
+
+    struct VertexHash
+    {
+        size_t operator()(const Vertex& v) const
+        {
+            // FNV-1a over the raw bytes.
+            const auto* bytes = reinterpret_cast<const uint8_t*>(&v);
+            uint64_t hash = 0xcbf29ce484222325ull;
+            for (size_t i = 0; i < sizeof(Vertex); ++i)
+                hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    struct VertexEqual
+    {
+        bool operator()(const Vertex& a, const Vertex& b) const
+        {
+            return memcmp(&a, &b, sizeof(Vertex)) == 0;
+        }
+    };
+
+    std::unordered_map<Vertex, uint32_t, VertexHash, VertexEqual> unique{};
+    unique.reserve(vertices.size());
+
+    std::vector<uint32_t> remap(vertices.size());
+    std::vector<Vertex> welded{};
+    welded.reserve(vertices.size());
+
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        auto [it, inserted] = unique.try_emplace(vertices[i], static_cast<uint32_t>(welded.size()));
+        if (inserted)
+            welded.push_back(vertices[i]);
+        remap[i] = it->second;
+    }
+
+    for (uint32_t& index : indices)
+        index = remap[index];
+
+    vertices = std::move(welded);
+    return vertices.size();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//								FORSYTH										//
+//////////////////////////////////////////////////////////////////////////////
+
+static constexpr int32_t FORSYTH_CACHE_SIZE = 32;
+
+// Tuned constants from Forsyth's "Linear-Speed Vertex Cache Optimisation".
+static float ForsythVertexScore(int32_t cachePosition, uint32_t remainingTriangles)
+{
+    if (remainingTriangles == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        // The last triangle's vertices get a fixed score so the next triangle
+        // does not simply reuse the same edge.
+        if (cachePosition < 3)
+        {
+            score = 0.75f;
+        }
+        else
+        {
+            const float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+            score = powf(1.0f - (cachePosition - 3) * scaler, 1.5f);
+        }
+    }
+
+    // Prefer vertices with few triangles left so they can leave the cache.
+    score += 2.0f / sqrtf(static_cast<float>(remainingTriangles));
+    return score;
+}
+
+void OptimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount)
+{
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2)
+        return;
+
+    // Triangles of each vertex, as offsets into one array.
+    std::vector<uint32_t> triangleOffsets(vertexCount + 1, 0);
+    for (const uint32_t index : indices)
+        triangleOffsets[index + 1]++;
+    for (size_t v = 0; v < vertexCount; ++v)
+        triangleOffsets[v + 1] += triangleOffsets[v];
+
+    std::vector<uint32_t> vertexTriangles(triangleOffsets.back());
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        for (size_t corner = 0; corner < 3; ++corner)
+        {
+            const uint32_t v = indices[t * 3 + corner];
+            vertexTriangles[triangleOffsets[v] + remaining[v]++] = static_cast<uint32_t>(t);
+        }
+    }
+
+    std::vector<int32_t> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+        vertexScore[v] = ForsythVertexScore(-1, remaining[v]);
+
+    auto triangleScore = [&](size_t t)
+    {
+        return vertexScore[indices[t * 3 + 0]] + vertexScore[indices[t * 3 + 1]] +
+            vertexScore[indices[t * 3 + 2]];
+    };
+
+    int64_t bestTriangle = 0;
+    for (size_t t = 1; t < triangleCount; ++t)
+        if (triangleScore(t) > triangleScore(static_cast<size_t>(bestTriangle)))
+            bestTriangle = static_cast<int64_t>(t);
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> result{};
+    result.reserve(indices.size());
+
+    std::array<uint32_t, FORSYTH_CACHE_SIZE + 3> cache{};
+    std::array<uint32_t, FORSYTH_CACHE_SIZE + 3> nextCache{};
+    size_t cacheCount = 0;
+
+    size_t scanCursor = 0;
+
+    while (result.size() < indices.size())
+    {
+        if (bestTriangle < 0)
+        {
+            // Dead end: nothing in the cache has triangles left, continue in
+            // source order.
+            while (emitted[scanCursor])
+                scanCursor++;
+            bestTriangle = static_cast<int64_t>(scanCursor);
+        }
+
+        const size_t t = static_cast<size_t>(bestTriangle);
+        emitted[t] = true;
+
+        const uint32_t corners[3] = { indices[t * 3 + 0], indices[t * 3 + 1], indices[t * 3 + 2] };
+
+        // The emitted triangle's vertices move to the front of the cache.
+        size_t nextCount = 0;
+        for (const uint32_t v : corners)
+        {
+            result.push_back(v);
+            nextCache[nextCount++] = v;
+
+            // Remove t from the vertex's live triangles.
+            uint32_t* begin = vertexTriangles.data() + triangleOffsets[v];
+            uint32_t* end = begin + remaining[v];
+            *std::find(begin, end, static_cast<uint32_t>(t)) = *(end - 1);
+            remaining[v]--;
+        }
+
+        for (size_t i = 0; i < cacheCount; ++i)
+        {
+            const uint32_t v = cache[i];
+            if (v != corners[0] && v != corners[1] && v != corners[2])
+                nextCache[nextCount++] = v;
+        }
+
+        // Vertices pushed past the end leave the cache.
+        for (size_t i = FORSYTH_CACHE_SIZE; i < nextCount; ++i)
+        {
+            const uint32_t v = nextCache[i];
+            cachePosition[v] = -1;
+            vertexScore[v] = ForsythVertexScore(-1, remaining[v]);
+        }
+
+        cacheCount = std::min<size_t>(nextCount, FORSYTH_CACHE_SIZE);
+        std::swap(cache, nextCache);
+
+        for (size_t i = 0; i < cacheCount; ++i)
+        {
+            const uint32_t v = cache[i];
+            cachePosition[v] = static_cast<int32_t>(i);
+            vertexScore[v] = ForsythVertexScore(static_cast<int32_t>(i), remaining[v]);
+        }
+
+        // Only triangles touching the cache changed score, so the next one is
+        // picked among them.
+        bestTriangle = -1;
+        float bestScore = -1.0f;
+        for (size_t i = 0; i < cacheCount; ++i)
+        {
+            const uint32_t v = cache[i];
+            for (uint32_t k = 0; k < remaining[v]; ++k)
+            {
+                const uint32_t candidate = vertexTriangles[triangleOffsets[v] + k];
+                const float score = triangleScore(candidate);
+
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestTriangle = candidate;
+                }
+            }
+        }
+    }
+
+    std::copy(result.begin(), result.end(), indices.begin());
+}
+
+size_t OptimizeVertexFetch(std::vector<Vertex>& vertices, std::span<uint32_t> indices)
+{
+    constexpr uint32_t UNUSED = UINT32_MAX;
+
+    std::vector<uint32_t> remap(vertices.size(), UNUSED);
+    std::vector<Vertex> reordered{};
+    reordered.reserve(vertices.size());
+
+    for (uint32_t& index : indices)
+    {
+        if (remap[index] == UNUSED)
+        {
+            remap[index] = static_cast<uint32_t>(reordered.size());
+            reordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    vertices = std::move(reordered);
+    return vertices.size();
+}
+
+MeshOptimizationStats OptimizeMesh(Mesh& mesh)
+{
+    MeshOptimizationStats result{};
+    result.VerticesBefore = mesh.Vertices.size();
+    result.Before = AnalyzeVertexCache(mesh.Indices, mesh.Vertices.size());
+
+    WeldVertices(mesh.Vertices, mesh.Indices);
+
+    for (const Submesh& submesh : mesh.Submeshes)
+    {
+        OptimizeVertexCache(std::span(mesh.Indices).subspan(submesh.IndexOffset, submesh.IndexCount),
+            mesh.Vertices.size());
+    }
+
+    OptimizeVertexFetch(mesh.Vertices, mesh.Indices);
+
+    result.VerticesAfter = mesh.Vertices.size();
+    result.After = AnalyzeVertexCache(mesh.Indices, mesh.Vertices.size());
+    return result;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "assets/assets.h"
+
+// Post-transform vertex cache efficiency of an index buffer.
+struct VertexCacheStats
+{
+    uint32_t Transforms{};
+    // Average cache miss ratio: transformed vertices per triangle. 0.5 is the
+    // ideal for large grids, 3 means no reuse at all.
+    float ACMR{};
+    // Average transform to vertex ratio: transformed vertices per referenced
+    // vertex. 1 is ideal.
+    float ATVR{};
+};
+
+struct MeshOptimizationStats
+{
+    size_t VerticesBefore{};
+    size_t VerticesAfter{};
+    VertexCacheStats Before{};
+    VertexCacheStats After{};
+};
+
+// Simulates a FIFO post-transform cache of cacheSize entries, which is how
+// most GPUs behave closely enough for comparing index orders.
+VertexCacheStats AnalyzeVertexCache(std::span<const uint32_t> indices,
+    size_t vertexCount, uint32_t cacheSize = 16);
+
+// Merges bitwise identical vertices and remaps indices. Returns the new vertex count.
+size_t WeldVertices(std::vector<Vertex>& vertices, std::span<uint32_t> indices);
+
+// Reorders the triangles of an index range for vertex cache reuse, using
+// Forsyth's linear-speed algorithm.
+void OptimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount);
+
+// Reorders vertices by first use so fetches walk memory linearly, and drops
+// unreferenced vertices. Returns the new vertex count.
+size_t OptimizeVertexFetch(std::vector<Vertex>& vertices, std::span<uint32_t> indices);
+
+// Welds, then optimizes every submesh's triangles for the vertex cache and the
+// whole mesh for vertex fetch. Submesh ranges are preserved.
+MeshOptimizationStats OptimizeMesh(Mesh& mesh);
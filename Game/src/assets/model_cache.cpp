@@ -0,0 +1,415 @@
+#include "pch.h"
+
+#include "model_cache.h"
+#include "texture_registry.h"
+
+static_assert(std::is_trivially_copyable_v<Vertex>);
+static_assert(std::is_trivially_copyable_v<BoneInfo>);
+static_assert(std::is_trivially_copyable_v<PackedQuat>);
+static_assert(std::is_trivially_copyable_v<Submesh>);
+
+static constexpr size_t BLOB_ALIGNMENT = 16;
+
+// Size and write time of a file, both zero when it does not exist.
+static void GetFileStamp(const std::string& path, uint64_t& size, int64_t& writeTime)
+{
+    std::error_code error{};
+    size = std::filesystem::file_size(path, error);
+    if (error)
+        size = 0;
+
+    writeTime = std::filesystem::last_write_time(path, error).time_since_epoch().count();
+    if (error)
+        writeTime = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//								WRITING										//
+//////////////////////////////////////////////////////////////////////////////
+
+struct BlobWriter
+{
+    std::vector<uint8_t> Buffer{};
+
+    void Align()
+    {
+        Buffer.resize((Buffer.size() + BLOB_ALIGNMENT - 1) & ~(BLOB_ALIGNMENT - 1));
+    }
+
+    template<typename T>
+    BlobArray<T> Write(std::span<const T> values)
+    {
+        Align();
+        BlobArray<T> result{ Buffer.size(), values.size() };
+        const auto* bytes = reinterpret_cast<const uint8_t*>(values.data());
+        Buffer.insert(Buffer.end(), bytes, bytes + values.size_bytes());
+        return result;
+    }
+};
+
+bool ModelCache::Bake(const Model& model, const TextureRegistry& textures,
+    const ModelCacheSource& source, const std::string& path,
+    std::span<const std::string> sourceFiles)
+{
+    BlobWriter writer{};
+    writer.Buffer.resize(sizeof(ModelCacheHeader));
+
+    ModelCacheHeader header{};
+    header.Magic = MODEL_CACHE_MAGIC;
+    header.Version = MODEL_CACHE_VERSION;
+    header.Source = source;
+
+    // Children are written before the records that point at them.
+    std::vector<TextureHandle> uniqueTextures{};
+    std::vector<BakedMesh> meshes{};
+    for (const Mesh& mesh : model.Meshes)
+    {
+        std::vector<uint32_t> textureIndices{};
+        for (TextureHandle handle : mesh.Textures)
+        {
+            auto it = std::find(uniqueTextures.begin(), uniqueTextures.end(), handle);
+            textureIndices.push_back(static_cast<uint32_t>(it - uniqueTextures.begin()));
+            if (it == uniqueTextures.end())
+                uniqueTextures.push_back(handle);
+        }
+
+        BakedMesh& baked = meshes.emplace_back();
+        baked.Vertices = writer.Write<Vertex>(mesh.Vertices);
+        baked.Indices = writer.Write<uint32_t>(mesh.Indices);
+        baked.Submeshes = writer.Write<Submesh>(mesh.Submeshes);
+        baked.Lods = writer.Write<MeshLod>(mesh.Lods);
+        baked.LodSubmeshes = writer.Write<Submesh>(mesh.LodSubmeshes);
+        baked.Textures = writer.Write<uint32_t>(textureIndices);
+        baked.Bounds = mesh.Bounds;
+        baked.BoneBounds = writer.Write<AABB>(mesh.BoneBounds);
+        baked.UnweightedBounds = mesh.UnweightedBounds;
+    }
+
+    std::vector<BakedTexture> bakedTextures{};
+    for (TextureHandle handle : uniqueTextures)
+    {
+        const Texture& texture = textures.GetTexture(handle);
+        const std::string& key = textures.GetKey(handle);
+
+        BakedTexture& baked = bakedTextures.emplace_back();
+        baked.Key = writer.Write<char>(key);
+        GetFileStamp(key, baked.SourceFileSize, baked.SourceWriteTime);
+        baked.Width = texture.Width;
+        baked.Height = texture.Height;
+        baked.Pixels = writer.Write<uint8_t>(texture.Pixels);
+    }
+    header.Textures = writer.Write<BakedTexture>(bakedTextures);
+    header.Meshes = writer.Write<BakedMesh>(meshes);
+
+    std::vector<BakedSkeleton> skeletons{};
+    for (const Skeleton& skeleton : model.Skeletons)
+    {
+        BakedSkeleton& baked = skeletons.emplace_back();
+        baked.Bones = writer.Write<BoneInfo>(skeleton.Bones);
+        baked.ParentIndices = writer.Write<int32_t>(skeleton.ParentIndices);
+        baked.RootBone = skeleton.RootBone;
+    }
+    header.Skeletons = writer.Write<BakedSkeleton>(skeletons);
+
+    std::vector<BakedAnimation> animations{};
+    for (const Animation& animation : model.Animations)
+    {
+        std::vector<BakedChannel> channels{};
+        for (const AnimationChannel& channel : animation.Channels)
+        {
+            BakedChannel& baked = channels.emplace_back();
+            baked.Times = writer.Write<float>(channel.Times);
+            baked.Translations = writer.Write<V3>(channel.Translations);
+            baked.Rotations = writer.Write<Quat>(channel.Rotations);
+            baked.PackedRotations = writer.Write<PackedQuat>(channel.PackedRotations);
+            baked.Scales = writer.Write<V3>(channel.Scales);
+            baked.TargetNode = channel.TargetNode;
+            baked.Path = channel.Path;
+        }
+
+        BakedAnimation& baked = animations.emplace_back();
+        baked.Name = writer.Write<char>(animation.Name);
+        baked.Channels = writer.Write<BakedChannel>(channels);
+        baked.Duration = animation.Duration;
+    }
+    header.Animations = writer.Write<BakedAnimation>(animations);
+
+    std::vector<BakedSourceFile> bakedFiles{};
+    for (const std::string& file : sourceFiles)
+    {
+        BakedSourceFile& baked = bakedFiles.emplace_back();
+        baked.Path = writer.Write<char>(file);
+        GetFileStamp(file, baked.FileSize, baked.WriteTime);
+    }
+    header.SourceFiles = writer.Write<BakedSourceFile>(bakedFiles);
+
+    memcpy(writer.Buffer.data(), &header, sizeof(header));
+
+    // Write to a temporary file first so an interrupted bake never leaves a
+    // truncated blob behind.
+    const std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+
+        file.write(reinterpret_cast<const char*>(writer.Buffer.data()),
+            static_cast<std::streamsize>(writer.Buffer.size()));
+        if (!file)
+            return false;
+    }
+
+    std::error_code error{};
+    std::filesystem::rename(tempPath, path, error);
+    return !error;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//								READING										//
+//////////////////////////////////////////////////////////////////////////////
+
+bool ModelCache::Open(const std::string& path, const ModelCacheSource& source)
+{
+    Close();
+
+    if (!File.Open(path))
+        return false;
+
+    if (File.GetData().size() < sizeof(ModelCacheHeader))
+    {
+        Close();
+        return false;
+    }
+
+    Header = reinterpret_cast<const ModelCacheHeader*>(File.GetData().data());
+    if (Header->Magic != MODEL_CACHE_MAGIC || Header->Version != MODEL_CACHE_VERSION ||
+        Header->Source != source || !Validate() || !AreSourceFilesCurrent())
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void ModelCache::Close()
+{
+    File.Close();
+    Header = nullptr;
+}
+
+template<typename T>
+bool ModelCache::IsValid(const BlobArray<T>& array) const
+{
+    const uint64_t size = File.GetData().size();
+    if (array.Count == 0)
+        return array.Offset <= size;
+
+    return array.Offset % alignof(T) == 0 && array.Offset <= size &&
+        array.Count <= (size - array.Offset) / sizeof(T);
+}
+
+// Bounds-checks every array, and every index stored in one, once so the
+// Get() views and the animation and skinning code that consume them need no
+// checks.
+bool ModelCache::Validate() const
+{
+    if (!IsValid(Header->Textures) || !IsValid(Header->Meshes) ||
+        !IsValid(Header->Skeletons) || !IsValid(Header->Animations) || !IsValid(Header->SourceFiles))
+        return false;
+
+    for (const BakedSourceFile& file : GetSourceFiles())
+        if (!IsValid(file.Path))
+            return false;
+
+    for (const BakedTexture& texture : GetTextures())
+    {
+        if (!IsValid(texture.Key) || !IsValid(texture.Pixels) ||
+            texture.Pixels.Count != uint64_t(texture.Width) * uint64_t(texture.Height) * 4)
+            return false;
+    }
+
+    for (const BakedMesh& mesh : GetMeshes())
+    {
+        if (!IsValid(mesh.Vertices) || !IsValid(mesh.Indices) ||
+            !IsValid(mesh.Submeshes) || !IsValid(mesh.Textures) ||
+            !IsValid(mesh.Lods) || !IsValid(mesh.LodSubmeshes) ||
+            !IsValid(mesh.BoneBounds) || mesh.BoneBounds.Count > MAX_BONES)
+            return false;
+
+        for (const BlobArray<Submesh>& submeshes : { mesh.Submeshes, mesh.LodSubmeshes })
+        {
+            for (const Submesh& submesh : Get(submeshes))
+            {
+                if (uint64_t(submesh.IndexOffset) + submesh.IndexCount > mesh.Indices.Count ||
+                    submesh.Material < -1 || submesh.Material >= int64_t(mesh.Textures.Count))
+                    return false;
+            }
+        }
+
+        for (const MeshLod& lod : Get(mesh.Lods))
+            if (uint64_t(lod.FirstSubmesh) + lod.SubmeshCount > mesh.LodSubmeshes.Count)
+                return false;
+
+        for (const uint32_t texture : Get(mesh.Textures))
+            if (texture >= Header->Textures.Count)
+                return false;
+
+        for (const uint32_t index : Get(mesh.Indices))
+            if (index >= mesh.Vertices.Count)
+                return false;
+
+        // The vertex shader indexes its bone array with these unchecked.
+        for (const Vertex& vertex : Get(mesh.Vertices))
+        {
+            for (const int32_t bone : { vertex.BoneIDs.X, vertex.BoneIDs.Y, vertex.BoneIDs.Z, vertex.BoneIDs.W })
+                if (bone < 0 || bone >= MAX_BONES)
+                    return false;
+        }
+    }
+
+    for (const BakedSkeleton& skeleton : GetSkeletons())
+    {
+        if (!IsValid(skeleton.Bones) || !IsValid(skeleton.ParentIndices) ||
+            skeleton.ParentIndices.Count != skeleton.Bones.Count || skeleton.Bones.Count > MAX_BONES ||
+            skeleton.RootBone < -1 || skeleton.RootBone >= int64_t(skeleton.Bones.Count))
+            return false;
+
+        for (const BoneInfo& bone : Get(skeleton.Bones))
+            if (bone.JointIndex < 0 || bone.JointIndex >= MAX_BONES)
+                return false;
+
+        // UpdateAnimation relies on parents preceding their children.
+        const std::span<const int32_t> parents = Get(skeleton.ParentIndices);
+        for (size_t i = 0; i < parents.size(); ++i)
+            if (parents[i] < -1 || parents[i] >= int64_t(i))
+                return false;
+    }
+
+    for (const BakedAnimation& animation : GetAnimations())
+    {
+        if (!IsValid(animation.Name) || !IsValid(animation.Channels))
+            return false;
+
+        for (const BakedChannel& channel : Get(animation.Channels))
+        {
+            if (!IsValid(channel.Times) || !IsValid(channel.Translations) ||
+                !IsValid(channel.Rotations) || !IsValid(channel.PackedRotations) || !IsValid(channel.Scales))
+                return false;
+
+            // Sampling reads the value of every keyframe and the one after it.
+            // Channels of other paths are never sampled.
+            uint64_t valueCount = channel.Times.Count;
+            switch (channel.Path)
+            {
+            case AnimationPath::Translation: valueCount = channel.Translations.Count; break;
+            case AnimationPath::Rotation:    valueCount = channel.Rotations.Count + channel.PackedRotations.Count; break;
+            case AnimationPath::Scale:       valueCount = channel.Scales.Count; break;
+            default: break;
+            }
+
+            if (valueCount < channel.Times.Count ||
+                (channel.Rotations.Count > 0 && channel.PackedRotations.Count > 0))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool ModelCache::AreSourceFilesCurrent() const
+{
+    auto isCurrent = [](std::span<const char> path, uint64_t bakedSize, int64_t bakedWriteTime)
+    {
+        uint64_t size;
+        int64_t writeTime;
+        GetFileStamp({ path.begin(), path.end() }, size, writeTime);
+        return size == bakedSize && writeTime == bakedWriteTime;
+    };
+
+    for (const BakedTexture& texture : GetTextures())
+        if (!isCurrent(Get(texture.Key), texture.SourceFileSize, texture.SourceWriteTime))
+            return false;
+
+    for (const BakedSourceFile& file : GetSourceFiles())
+        if (!isCurrent(Get(file.Path), file.FileSize, file.WriteTime))
+            return false;
+
+    return true;
+}
+
+template<typename T>
+static std::vector<T> ToVector(std::span<const T> values)
+{
+    return { values.begin(), values.end() };
+}
+
+Model ModelCache::Instantiate(TextureRegistry& textures) const
+{
+    Assert(Header);
+
+    Model result{};
+
+    std::vector<TextureHandle> handles{};
+    for (const BakedTexture& baked : GetTextures())
+    {
+        const std::span<const char> key = Get(baked.Key);
+        handles.push_back(textures.Load({ key.begin(), key.end() }, [&]()
+            {
+                Texture texture{};
+                texture.Width = baked.Width;
+                texture.Height = baked.Height;
+                texture.Pixels = ToVector(Get(baked.Pixels));
+                return texture;
+            }));
+    }
+
+    for (const BakedMesh& baked : GetMeshes())
+    {
+        Mesh& mesh = result.Meshes.emplace_back();
+        mesh.Vertices = ToVector(Get(baked.Vertices));
+        mesh.Indices = ToVector(Get(baked.Indices));
+        mesh.Submeshes = ToVector(Get(baked.Submeshes));
+        mesh.Lods = ToVector(Get(baked.Lods));
+        mesh.LodSubmeshes = ToVector(Get(baked.LodSubmeshes));
+        mesh.Bounds = baked.Bounds;
+        mesh.BoneBounds = ToVector(Get(baked.BoneBounds));
+        mesh.UnweightedBounds = baked.UnweightedBounds;
+
+        for (const uint32_t texture : Get(baked.Textures))
+            mesh.Textures.push_back(handles[texture]);
+    }
+
+    for (const BakedSkeleton& baked : GetSkeletons())
+    {
+        Skeleton& skeleton = result.Skeletons.emplace_back();
+        skeleton.Bones = ToVector(Get(baked.Bones));
+        skeleton.ParentIndices = ToVector(Get(baked.ParentIndices));
+        skeleton.RootBone = baked.RootBone;
+
+        for (size_t i = 0; i < skeleton.Bones.size(); ++i)
+            skeleton.NodeToBoneIndex[skeleton.Bones[i].ID] = static_cast<int>(i);
+    }
+
+    for (const BakedAnimation& baked : GetAnimations())
+    {
+        Animation& animation = result.Animations.emplace_back();
+        const std::span<const char> name = Get(baked.Name);
+        animation.Name.assign(name.begin(), name.end());
+        animation.Duration = baked.Duration;
+
+        for (const BakedChannel& bakedChannel : Get(baked.Channels))
+        {
+            AnimationChannel& channel = animation.Channels.emplace_back();
+            channel.Times = ToVector(Get(bakedChannel.Times));
+            channel.Translations = ToVector(Get(bakedChannel.Translations));
+            channel.Rotations = ToVector(Get(bakedChannel.Rotations));
+            channel.PackedRotations = ToVector(Get(bakedChannel.PackedRotations));
+            channel.Scales = ToVector(Get(bakedChannel.Scales));
+            channel.TargetNode = bakedChannel.TargetNode;
+            channel.Path = bakedChannel.Path;
+        }
+    }
+
+    return result;
+}
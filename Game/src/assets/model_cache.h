@@ -0,0 +1,153 @@
+#pragma once
+
+#include "assets.h"
+#include "platform/mapped_file.h"
+
+class TextureRegistry;
+
+/*
+	NOTE:
+	Baked model format. A header followed by 16-byte aligned arrays. Records
+	refer to arrays by offset and element count, so a mapped file is used in
+	place without parsing. Vertices, bones and keyframes are stored as their
+	in-memory structs: bump MODEL_CACHE_VERSION whenever one of them, or the
+	baking they go through, changes.
+*/
+
+static constexpr uint32_t MODEL_CACHE_MAGIC = 0x434C444D; // "MDLC"
+static constexpr uint32_t MODEL_CACHE_VERSION = 12;
+
+template<typename T>
+struct BlobArray
+{
+    uint64_t Offset{};
+    uint64_t Count{};
+};
+
+struct BakedTexture
+{
+    // TextureRegistry key of the source image.
+    BlobArray<char> Key{};
+    // Size and write time of the image file the key names when baked. Zero
+    // for images embedded in the glTF file, whose keys name no file.
+    uint64_t SourceFileSize{};
+    int64_t SourceWriteTime{};
+    int32_t Width{};
+    int32_t Height{};
+    BlobArray<uint8_t> Pixels{};
+};
+
+// A file the model was loaded from besides the glTF file itself, such as an
+// external .bin buffer, with its size and write time when baked.
+struct BakedSourceFile
+{
+    BlobArray<char> Path{};
+    uint64_t FileSize{};
+    int64_t WriteTime{};
+};
+
+struct BakedMesh
+{
+    BlobArray<Vertex> Vertices{};
+    BlobArray<uint32_t> Indices{};
+    BlobArray<Submesh> Submeshes{};
+    BlobArray<MeshLod> Lods{};
+    BlobArray<Submesh> LodSubmeshes{};
+    // Indices into ModelCacheHeader::Textures.
+    BlobArray<uint32_t> Textures{};
+    AABB Bounds{};
+    BlobArray<AABB> BoneBounds{};
+    AABB UnweightedBounds{};
+};
+
+struct BakedSkeleton
+{
+    BlobArray<BoneInfo> Bones{};
+    BlobArray<int32_t> ParentIndices{};
+    int32_t RootBone{ -1 };
+};
+
+struct BakedChannel
+{
+    BlobArray<float> Times{};
+    BlobArray<V3> Translations{};
+    BlobArray<Quat> Rotations{};
+    BlobArray<PackedQuat> PackedRotations{};
+    BlobArray<V3> Scales{};
+    int32_t TargetNode{};
+    AnimationPath Path{};
+};
+
+struct BakedAnimation
+{
+    BlobArray<char> Name{};
+    BlobArray<BakedChannel> Channels{};
+    float Duration{};
+};
+
+// Identifies what a blob was baked from. A mismatch means the blob is stale.
+struct ModelCacheSource
+{
+    uint64_t FileSize{};
+    int64_t FileWriteTime{};
+    // Hash of the load options that change the baked data.
+    uint64_t OptionsHash{};
+
+    bool operator==(const ModelCacheSource&) const = default;
+};
+
+struct ModelCacheHeader
+{
+    uint32_t Magic{};
+    uint32_t Version{};
+    ModelCacheSource Source{};
+
+    BlobArray<BakedTexture> Textures{};
+    BlobArray<BakedMesh> Meshes{};
+    BlobArray<BakedSkeleton> Skeletons{};
+    BlobArray<BakedAnimation> Animations{};
+    BlobArray<BakedSourceFile> SourceFiles{};
+};
+
+class ModelCache
+{
+public:
+    // sourceFiles are the other files the model was read from, checked like
+    // image files on Open().
+    static bool Bake(const Model& model, const TextureRegistry& textures,
+        const ModelCacheSource& source, const std::string& path,
+        std::span<const std::string> sourceFiles = {});
+
+    // Maps a baked file. Fails if it is missing, corrupt, from another version,
+    // baked from a different source or an image or source file it baked has
+    // changed.
+    bool Open(const std::string& path, const ModelCacheSource& source);
+    void Close();
+
+    std::span<const BakedTexture> GetTextures() const { return Get(Header->Textures); }
+    std::span<const BakedMesh> GetMeshes() const { return Get(Header->Meshes); }
+    std::span<const BakedSkeleton> GetSkeletons() const { return Get(Header->Skeletons); }
+    std::span<const BakedAnimation> GetAnimations() const { return Get(Header->Animations); }
+    std::span<const BakedSourceFile> GetSourceFiles() const { return Get(Header->SourceFiles); }
+
+    // Views into the mapped file, valid until the cache is closed.
+    template<typename T>
+    std::span<const T> Get(const BlobArray<T>& array) const
+    {
+        return { reinterpret_cast<const T*>(File.GetData().data() + array.Offset),
+            static_cast<size_t>(array.Count) };
+    }
+
+    // Copies the baked data into a Model, one bulk copy per array. Textures
+    // already in the registry are shared instead of copied.
+    Model Instantiate(TextureRegistry& textures) const;
+
+private:
+    template<typename T>
+    bool IsValid(const BlobArray<T>& array) const;
+    bool Validate() const;
+    bool AreSourceFilesCurrent() const;
+
+    MappedFile File{};
+    const ModelCacheHeader* Header{};
+};
@@ -1,6 +1,13 @@
 #include <pch.h>
 
 #include "model_loader.h"
+#include "model_cache.h"
+#include "texture_registry.h"
+#include "mesh_optimizer.h"
+#include "mesh_lod.h"
+#include "mesh_bounds.h"
+#include "vertex_format.h"
+#include "core/job_system.h"
 #include "math/handmade_math.h"
 #include "stb_image.h"
 
@@ -14,9 +21,9 @@ static Texture CreateErrorTexture()
     pixels.resize(width * height * 4);
 
     // Checkerboard pattern
-    for (auto y = 0; y < height; ++y)
+    for (size_t y = 0; y < height; ++y)
     {
-        for (auto x = 0; x < width; ++x)
+        for (size_t x = 0; x < width; ++x)
         {
             const size_t index = (y * width + x) * 4;
             constexpr int checkSize = 16;
@@ -75,22 +82,102 @@ static std::string GetBasePath(const std::string& path)
     return (pos == std::string::npos) ? "" : path.substr(0, pos + 1);
 }
 
-Model ModelLoader::LoadGLTFModel(const std::string& filename)
+static std::string GetCachePath(const std::string& path)
+{
+    return std::filesystem::path(path).replace_extension(".mdlcache").string();
+}
+
+static ModelCacheSource GetCacheSource(const std::string& filename, const ModelLoadOptions& options)
+{
+    ModelCacheSource result{};
+
+    std::error_code error{};
+    result.FileSize = std::filesystem::file_size(filename, error);
+    result.FileWriteTime = std::filesystem::last_write_time(filename, error).time_since_epoch().count();
+
+    // FNV-1a over the options that change the loaded data.
+    auto hash = [&result](const auto& value)
+    {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+        for (size_t i = 0; i < sizeof(value); ++i)
+            result.OptionsHash = (result.OptionsHash ^ bytes[i]) * 0x100000001b3ull;
+    };
+
+    result.OptionsHash = 0xcbf29ce484222325ull;
+    hash(options.OptimizeMeshes);
+    hash(options.GenerateLods);
+    if (options.GenerateLods)
+    {
+        hash(options.Lods.MaxLods);
+        hash(options.Lods.Reduction);
+        hash(options.Lods.MinReduction);
+        hash(options.Lods.MinTriangles);
+        hash(options.Lods.FlatShadingFallback);
+    }
+    hash(options.CompressAnimations);
+    if (options.CompressAnimations)
+    {
+        hash(options.Compression.TranslationTolerance);
+        hash(options.Compression.RotationTolerance);
+        hash(options.Compression.ScaleTolerance);
+        hash(options.Compression.QuantizeRotations);
+    }
+
+    return result;
+}
+
+Model ModelLoader::LoadModel(const std::string& filename, TextureRegistry& textures,
+    const ModelLoadOptions& options)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+    auto elapsedMs = [&start]()
+    {
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+    };
+
+    const std::string cachePath = GetCachePath(filename);
+    const ModelCacheSource source = GetCacheSource(filename, options);
+
+    ModelCache cache{};
+    if (cache.Open(cachePath, source))
+    {
+        Model result = cache.Instantiate(textures);
+        std::println("Loaded baked model {} in {:.2f} ms", cachePath, elapsedMs());
+        return result;
+    }
+
+    Model result = LoadGLTFModel(filename, textures, options);
+    if (result.Meshes.empty())
+        return result;
+
+    std::println("Loaded glTF model {} in {:.2f} ms", filename, elapsedMs());
+
+    if (ModelCache::Bake(result, textures, source, cachePath, GetBufferFiles(filename)))
+        std::println("Baked model to {}", cachePath);
+    else
+        std::println("Failed to bake model to {}", cachePath);
+
+    return result;
+}
+
+Model ModelLoader::LoadGLTFModel(const std::string& filename, TextureRegistry& textures,
+    const ModelLoadOptions& options)
 {
     std::println("Attempting to load model from file: {}", filename);
 
     Model result{};
-    cgltf_options options = {};
+    cgltf_options gltfOptions = {};
     cgltf_data* data = nullptr;
 
-    cgltf_result res = cgltf_parse_file(&options, filename.c_str(), &data);
+    cgltf_result res = cgltf_parse_file(&gltfOptions, filename.c_str(), &data);
     if (res != cgltf_result_success)
     {
         std::println("Failed to parse glTF: {}", filename);
         return {};
     }
 
-    res = cgltf_load_buffers(&options, data, filename.c_str());
+    res = cgltf_load_buffers(&gltfOptions, data, filename.c_str());
     if (res != cgltf_result_success)
     {
         std::println("Failed to load glTF buffers: {}", filename);
@@ -102,77 +189,152 @@ Model ModelLoader::LoadGLTFModel(const std::string& filename)
 
     // ------------------- Load Textures -------------------
     std::println("Loading textures...");
-    std::vector<Texture> textures;
-    for (size_t i = 0; i < data->images_count; ++i)
+    std::vector<TextureHandle> images(data->images_count);
+    auto loadTextures = [&](size_t begin, size_t end)
     {
-        Texture tex = LoadTextureFromCgltfImage(&data->images[i], basePath);
-        textures.push_back(tex.Pixels.empty() ? CreateErrorTexture() : tex);
-    }
+        for (size_t i = begin; i < end; ++i)
+        {
+            const cgltf_image* image = &data->images[i];
+            images[i] = textures.Load(GetImageKey(filename, basePath, image, i), [&]()
+                {
+                    Texture tex = LoadTextureFromCgltfImage(image, basePath);
+                    return tex.Pixels.empty() ? CreateErrorTexture() : tex;
+                });
+        }
+    };
+
+    if (options.Jobs)
+        options.Jobs->ParallelFor(images.size(), 1, loadTextures);
+    else
+        loadTextures(0, images.size());
 
     // ------------------- Load Meshes -------------------
     std::println("Loading meshes...");
     for (size_t i = 0; i < data->meshes_count; ++i)
     {
-        Mesh mesh = LoadMesh(data, &data->meshes[i], basePath);
+        Mesh mesh = LoadMesh(data, &data->meshes[i], images);
 
-        // Assign materials/textures
-        for (size_t p = 0; p < data->meshes[i].primitives_count; ++p)
+        if (options.OptimizeMeshes)
         {
-            const cgltf_primitive& prim = data->meshes[i].primitives[p];
-            if (!prim.material) continue;
-            const cgltf_material* mat = prim.material;
-            if (mat->has_pbr_metallic_roughness)
+            const MeshOptimizationStats stats = OptimizeMesh(mesh);
+            std::println("Optimized mesh {}: {} -> {} vertices, ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+                i, stats.VerticesBefore, stats.VerticesAfter, stats.Before.ACMR, stats.After.ACMR,
+                stats.Before.ATVR, stats.After.ATVR);
+        }
+
+        if (options.GenerateLods)
+        {
+            BuildMeshLods(mesh, options.Lods);
+            for (uint32_t lod = 0; lod < GetLodCount(mesh); lod++)
             {
-                const cgltf_texture* tex = mat->pbr_metallic_roughness.base_color_texture.texture;
-                if (tex && tex->image)
-                {
-                    ptrdiff_t texOffset = tex->image - data->images;
-                    if (texOffset >= 0 && static_cast<size_t>(texOffset) < data->images_count)
-                    {
-                        int texIndex = static_cast<int>(texOffset);
-                        mesh.Textures.push_back(textures[texIndex]);
-                    }
-                }
+                std::println("Mesh {} LOD {}: {} triangles, error {:.4f}", i, lod,
+                    GetLodTriangleCount(mesh, lod), lod > 0 ? mesh.Lods[lod - 1].Error : 0.0f);
             }
         }
+
+        ComputeMeshBounds(mesh);
+
+        std::println("Mesh {} vertices: {} bytes, {} bytes packed", i,
+            mesh.Vertices.size() * sizeof(Vertex), GetPackedVertexSize(mesh.Vertices));
+
         result.Meshes.push_back(std::move(mesh));
     }
 
+    // Compare against storing a copy of every image per mesh that uses it.
+    size_t referencedBytes = 0;
+    std::vector<TextureHandle> uniqueTextures{};
+    for (const Mesh& mesh : result.Meshes)
+    {
+        for (TextureHandle handle : mesh.Textures)
+        {
+            referencedBytes += textures.GetTexture(handle).Pixels.size();
+            if (std::find(uniqueTextures.begin(), uniqueTextures.end(), handle) == uniqueTextures.end())
+                uniqueTextures.push_back(handle);
+        }
+    }
+
+    size_t uniqueBytes = 0;
+    for (TextureHandle handle : uniqueTextures)
+        uniqueBytes += textures.GetTexture(handle).Pixels.size();
+
+    std::println("Textures: {} unique, {} KB shared ({} KB as per-mesh copies)",
+        uniqueTextures.size(), uniqueBytes / 1024, referencedBytes / 1024);
+
     // ------------------- Load Skeletons -------------------
     std::println("Loading skins...");
     for (size_t i = 0; i < data->skins_count; ++i)
     {
         const cgltf_skin& skin = data->skins[i];
         Skeleton skeleton{};
-        skeleton.Bones.resize(skin.joints_count);
 
         std::vector<M4> inverseBind;
         if (skin.inverse_bind_matrices)
             inverseBind = GetAttributeData<M4>(skin.inverse_bind_matrices);
 
-        std::unordered_map<int, int> nodeToBone;
+        std::unordered_map<const cgltf_node*, int> nodeToJoint;
         for (size_t j = 0; j < skin.joints_count; ++j)
-            nodeToBone[int(skin.joints[j] - data->nodes)] = int(j);
+            nodeToJoint[skin.joints[j]] = int(j);
 
+        // Parent joint of every joint, -1 when the parent node is not part of the skin.
+        std::vector<int> jointParents(skin.joints_count, -1);
         for (size_t j = 0; j < skin.joints_count; ++j)
         {
-            BoneInfo& bone = skeleton.Bones[j];
-            bone.ID = int(skin.joints[j] - data->nodes);
-            if (!inverseBind.empty() && j < inverseBind.size())
-                bone.InverseBindMatrix = inverseBind[j];
-            bone.Children.clear();
-
-            const cgltf_node* node = skin.joints[j];
-            for (size_t c = 0; c < node->children_count; ++c)
-            {
-                int childNode = int(node->children[c] - data->nodes);
-                auto it = nodeToBone.find(childNode);
-                if (it != nodeToBone.end())
-                    bone.Children.push_back(it->second);
-            }
+            auto it = nodeToJoint.find(skin.joints[j]->parent);
+            if (it != nodeToJoint.end())
+                jointParents[j] = it->second;
+        }
+
+        // Order the bones parent-before-child so the global pose is one linear pass.
+        std::vector<int> order;
+        order.reserve(skin.joints_count);
+        for (size_t j = 0; j < skin.joints_count; ++j)
+            if (jointParents[j] < 0)
+                order.push_back(int(j));
+
+        for (size_t head = 0; head < order.size(); ++head)
+            for (size_t j = 0; j < skin.joints_count; ++j)
+                if (jointParents[j] == order[head])
+                    order.push_back(int(j));
+
+        Assert(order.size() == skin.joints_count);
+
+        std::vector<int> jointToBone(skin.joints_count, -1);
+        for (size_t b = 0; b < order.size(); ++b)
+            jointToBone[order[b]] = int(b);
+
+        skeleton.Bones.resize(order.size());
+        skeleton.ParentIndices.resize(order.size());
+        for (size_t b = 0; b < order.size(); ++b)
+        {
+            const int joint = order[b];
+            BoneInfo& bone = skeleton.Bones[b];
+            bone.ID = int(skin.joints[joint] - data->nodes);
+            bone.JointIndex = joint;
+            if (!inverseBind.empty() && size_t(joint) < inverseBind.size())
+                bone.InverseBindMatrix = AffineFromM4(inverseBind[joint]);
+
+            // NOTE: Joints given as a full matrix keep the identity rest pose.
+            const cgltf_node* node = skin.joints[joint];
+            if (node->has_translation)
+                bone.LocalBindPose.Translation = { node->translation[0], node->translation[1], node->translation[2] };
+            if (node->has_rotation)
+                bone.LocalBindPose.Rotation = { node->rotation[0], node->rotation[1], node->rotation[2], node->rotation[3] };
+            if (node->has_scale)
+                bone.LocalBindPose.Scale = { node->scale[0], node->scale[1], node->scale[2] };
+
+            const int parentJoint = jointParents[joint];
+            skeleton.ParentIndices[b] = parentJoint >= 0 ? jointToBone[parentJoint] : -1;
+            skeleton.NodeToBoneIndex[bone.ID] = int(b);
+        }
+
+        skeleton.RootBone = order.empty() ? -1 : 0;
+        if (skin.skeleton)
+        {
+            auto it = nodeToJoint.find(skin.skeleton);
+            if (it != nodeToJoint.end())
+                skeleton.RootBone = jointToBone[it->second];
         }
 
-        skeleton.RootBone = (skin.skeleton) ? nodeToBone[int(skin.skeleton - data->nodes)] : 0;
         result.Skeletons.push_back(std::move(skeleton));
     }
 
@@ -191,16 +353,16 @@ Model ModelLoader::LoadGLTFModel(const std::string& filename)
 
             AnimationChannel ch{};
             ch.TargetNode = int(chData.target_node - data->nodes);
-            ch.Path = cgltf_animation_path_type_translation == chData.target_path ? "translation" :
-                cgltf_animation_path_type_rotation == chData.target_path ? "rotation" :
-                cgltf_animation_path_type_scale == chData.target_path ? "scale" : "unknown";
+            ch.Path = cgltf_animation_path_type_translation == chData.target_path ? AnimationPath::Translation :
+                cgltf_animation_path_type_rotation == chData.target_path ? AnimationPath::Rotation :
+                cgltf_animation_path_type_scale == chData.target_path ? AnimationPath::Scale : AnimationPath::Unknown;
 
             ch.Times = GetAttributeData<float>(samp.input);
-            if (ch.Path == "translation")
+            if (ch.Path == AnimationPath::Translation)
                 ch.Translations = GetAttributeData<V3>(samp.output);
-            else if (ch.Path == "rotation")
+            else if (ch.Path == AnimationPath::Rotation)
                 ch.Rotations = GetAttributeData<Quat>(samp.output);
-            else if (ch.Path == "scale")
+            else if (ch.Path == AnimationPath::Scale)
                 ch.Scales = GetAttributeData<V3>(samp.output);
 
             anim.Channels.push_back(std::move(ch));
@@ -211,6 +373,14 @@ Model ModelLoader::LoadGLTFModel(const std::string& filename)
             if (!ch.Times.empty())
                 anim.Duration = std::max<float>(anim.Duration, ch.Times.back());
 
+        if (options.CompressAnimations)
+        {
+            const AnimationCompressionStats stats = CompressAnimation(anim, options.Compression);
+            std::println("Compressed animation {} '{}': {} -> {} bytes, {} -> {} keys, max error t={:.5f} r={:.5f} s={:.5f}",
+                i, anim.Name, stats.BytesBefore, stats.BytesAfter, stats.KeysBefore, stats.KeysAfter,
+                stats.MaxTranslationError, stats.MaxRotationError, stats.MaxScaleError);
+        }
+
         result.Animations.push_back(std::move(anim));
     }
 
@@ -219,12 +389,36 @@ Model ModelLoader::LoadGLTFModel(const std::string& filename)
     return result;
 }
 
-Mesh ModelLoader::LoadMesh(const cgltf_data* data, const cgltf_mesh* gltfMesh, const std::string&)
+// Base color texture of a primitive, or an invalid handle.
+static TextureHandle GetPrimitiveTexture(const cgltf_data* data, const cgltf_primitive& prim,
+    std::span<const TextureHandle> images)
+{
+    if (!prim.material || !prim.material->has_pbr_metallic_roughness)
+        return {};
+
+    const cgltf_texture* tex = prim.material->pbr_metallic_roughness.base_color_texture.texture;
+    if (!tex || !tex->image)
+        return {};
+
+    const ptrdiff_t texOffset = tex->image - data->images;
+    if (texOffset < 0 || static_cast<size_t>(texOffset) >= images.size())
+        return {};
+
+    return images[texOffset];
+}
+
+// Concatenates all primitives into one vertex and index buffer, with a
+// Submesh per primitive.
+Mesh ModelLoader::LoadMesh(const cgltf_data* data, const cgltf_mesh* gltfMesh,
+    std::span<const TextureHandle> images)
 {
     Mesh result;
     for (size_t p = 0; p < gltfMesh->primitives_count; ++p)
     {
         const cgltf_primitive& prim = gltfMesh->primitives[p];
+        if (prim.type != cgltf_primitive_type_triangles)
+            continue;
+
         const cgltf_accessor* pos = nullptr;
         const cgltf_accessor* normal = nullptr;
         const cgltf_accessor* uv = nullptr;
@@ -234,6 +428,10 @@ Mesh ModelLoader::LoadMesh(const cgltf_data* data, const cgltf_mesh* gltfMesh, c
         for (size_t a = 0; a < prim.attributes_count; ++a)
         {
             const cgltf_attribute& attr = prim.attributes[a];
+            // Only the first set of each attribute is used.
+            if (attr.index != 0)
+                continue;
+
             switch (attr.type)
             {
             case cgltf_attribute_type_position: pos = attr.data; break;
@@ -245,16 +443,20 @@ Mesh ModelLoader::LoadMesh(const cgltf_data* data, const cgltf_mesh* gltfMesh, c
             }
         }
 
-        std::vector<V3> positions = pos ? GetAttributeData<V3>(pos) : std::vector<V3>{};
+        if (!pos)
+            continue;
+
+        std::vector<V3> positions = GetAttributeData<V3>(pos);
         std::vector<V3> normals = normal ? GetAttributeData<V3>(normal) : std::vector<V3>{};
         std::vector<V2> texcoords = uv ? GetAttributeData<V2>(uv) : std::vector<V2>{};
         std::vector<IV4> jointData = joints ? GetAttributeData<IV4>(joints) : std::vector<IV4>{};
         std::vector<V4> weightData = weights ? GetAttributeData<V4>(weights) : std::vector<V4>{};
 
-        result.Vertices.resize(positions.size());
+        const uint32_t baseVertex = static_cast<uint32_t>(result.Vertices.size());
+        result.Vertices.resize(baseVertex + positions.size());
         for (size_t i = 0; i < positions.size(); ++i)
         {
-            Vertex& v = result.Vertices[i];
+            Vertex& v = result.Vertices[baseVertex + i];
             v.Position = positions[i];
             if (i < normals.size()) v.Normal = normals[i];
             if (i < texcoords.size()) v.TexCoord = texcoords[i];
@@ -262,8 +464,34 @@ Mesh ModelLoader::LoadMesh(const cgltf_data* data, const cgltf_mesh* gltfMesh, c
             if (i < weightData.size()) v.Weights = weightData[i];
         }
 
+        Submesh submesh{};
+        submesh.IndexOffset = static_cast<uint32_t>(result.Indices.size());
+
         if (prim.indices)
-            result.Indices = GetIndices(prim.indices);
+        {
+            std::vector<uint32_t> indices = GetIndices(prim.indices);
+            for (uint32_t& index : indices)
+                index += baseVertex;
+            result.Indices.insert(result.Indices.end(), indices.begin(), indices.end());
+        }
+        else
+        {
+            for (size_t i = 0; i < positions.size(); ++i)
+                result.Indices.push_back(baseVertex + static_cast<uint32_t>(i));
+        }
+
+        submesh.IndexCount = static_cast<uint32_t>(result.Indices.size()) - submesh.IndexOffset;
+
+        const TextureHandle texture = GetPrimitiveTexture(data, prim, images);
+        if (texture.IsValid())
+        {
+            auto it = std::find(result.Textures.begin(), result.Textures.end(), texture);
+            submesh.Material = static_cast<int32_t>(it - result.Textures.begin());
+            if (it == result.Textures.end())
+                result.Textures.push_back(texture);
+        }
+
+        result.Submeshes.push_back(submesh);
     }
     return result;
 }
@@ -303,19 +531,140 @@ Texture ModelLoader::LoadTextureFromCgltfImage(const cgltf_image* image, const s
     return result;
 }
 
+// Start of the accessor's elements when they are tightly packed, non-sparse,
+// non-normalized components of the given type; nullptr otherwise.
+static const uint8_t* GetPackedAccessorData(const cgltf_accessor* accessor,
+    cgltf_component_type componentType)
+{
+    if (accessor->is_sparse || accessor->normalized || !accessor->buffer_view ||
+        accessor->component_type != componentType ||
+        accessor->stride != cgltf_calc_size(accessor->type, accessor->component_type))
+        return nullptr;
+
+    const uint8_t* data = cgltf_buffer_view_data(accessor->buffer_view);
+    return data ? data + accessor->offset : nullptr;
+}
+
+static void WidenU16(const uint8_t* source, uint32_t* out, size_t count)
+{
+    size_t i = 0;
+#if HANDMADE_MATH_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 2));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi16(v, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 4), _mm_unpackhi_epi16(v, zero));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        uint16_t value;
+        memcpy(&value, source + i * 2, sizeof(value));
+        out[i] = value;
+    }
+}
+
+std::vector<std::string> ModelLoader::GetBufferFiles(const std::string& filename)
+{
+    // Only the JSON is parsed, the buffers themselves are not read
+    cgltf_options gltfOptions = {};
+    cgltf_data* data = nullptr;
+    if (cgltf_parse_file(&gltfOptions, filename.c_str(), &data) != cgltf_result_success)
+        return {};
+
+    const std::string basePath = GetBasePath(filename);
+    std::vector<std::string> result{};
+    for (size_t i = 0; i < data->buffers_count; ++i)
+    {
+        const char* uri = data->buffers[i].uri;
+        if (!uri || strncmp(uri, "data:", 5) == 0)
+            continue;
+
+        std::string decoded = uri;
+        decoded.resize(cgltf_decode_uri(decoded.data()));
+        result.push_back(std::filesystem::path(basePath + decoded).lexically_normal().generic_string());
+    }
+
+    cgltf_free(data);
+    return result;
+}
+
+// Images from files are keyed by path so models that share a file share the
+// texture; embedded images are keyed by the model file and image index.
+std::string ModelLoader::GetImageKey(const std::string& filename, const std::string& basePath,
+    const cgltf_image* image, size_t imageIndex)
+{
+    if (!image->buffer_view && image->uri && strncmp(image->uri, "data:", 5) != 0)
+        return std::filesystem::path(basePath + image->uri).lexically_normal().generic_string();
+
+    return std::format("{}#image{}", filename, imageIndex);
+}
+
 std::vector<uint32_t> ModelLoader::GetIndices(const cgltf_accessor* accessor)
 {
     std::vector<uint32_t> result(accessor->count);
+
+    if (const uint8_t* data = GetPackedAccessorData(accessor, cgltf_component_type_r_32u))
+    {
+        memcpy(result.data(), data, result.size() * sizeof(uint32_t));
+        return result;
+    }
+    if (const uint8_t* data = GetPackedAccessorData(accessor, cgltf_component_type_r_16u))
+    {
+        WidenU16(data, result.data(), result.size());
+        return result;
+    }
+
     for (size_t i = 0; i < accessor->count; ++i)
         result[i] = (uint32_t)cgltf_accessor_read_index(accessor, i);
     return result;
 }
 
+// IV4 is read as integers (joint indices), every other T as floats.
 template<typename T>
 std::vector<T> ModelLoader::GetAttributeData(const cgltf_accessor* accessor)
 {
     std::vector<T> result(accessor->count);
-    for (size_t i = 0; i < accessor->count; ++i)
-        cgltf_accessor_read_float(accessor, i, reinterpret_cast<float*>(&result[i]), sizeof(T) / sizeof(float));
+    if (result.empty())
+        return result;
+
+    if constexpr (std::is_same_v<T, IV4>)
+    {
+        const size_t components = cgltf_num_components(accessor->type);
+        if (components == 4)
+        {
+            if (const uint8_t* data = GetPackedAccessorData(accessor, cgltf_component_type_r_8u))
+            {
+                int32_t* out = &result[0].X;
+                for (size_t i = 0; i < result.size() * 4; ++i)
+                    out[i] = data[i];
+                return result;
+            }
+            if (const uint8_t* data = GetPackedAccessorData(accessor, cgltf_component_type_r_16u))
+            {
+                WidenU16(data, reinterpret_cast<uint32_t*>(&result[0].X), result.size() * 4);
+                return result;
+            }
+        }
+
+        for (size_t i = 0; i < accessor->count; ++i)
+            cgltf_accessor_read_uint(accessor, i, reinterpret_cast<cgltf_uint*>(&result[i]), 4);
+    }
+    else
+    {
+        if (cgltf_num_components(accessor->type) * sizeof(float) == sizeof(T))
+        {
+            if (const uint8_t* data = GetPackedAccessorData(accessor, cgltf_component_type_r_32f))
+            {
+                memcpy(result.data(), data, result.size() * sizeof(T));
+                return result;
+            }
+        }
+
+        for (size_t i = 0; i < accessor->count; ++i)
+            cgltf_accessor_read_float(accessor, i, reinterpret_cast<float*>(&result[i]), sizeof(T) / sizeof(float));
+    }
+
     return result;
 }
@@ -1,17 +1,49 @@
 #pragma once
 #include "assets.h"
+#include "animation_compression.h"
+#include "mesh_lod.h"
 #include <tiny_gltf.h>
 #include <concepts>
 #include <cgltf.h>
 
+class JobSystem;
+class TextureRegistry;
+
+struct ModelLoadOptions
+{
+    // Reduces keyframes and quantizes rotations, see CompressAnimation().
+    bool CompressAnimations{};
+    AnimationCompressionSettings Compression{};
+    // Welds vertices and reorders them for the vertex cache, see OptimizeMesh().
+    bool OptimizeMeshes{ true };
+    // Simplified levels per mesh for distant rendering, see BuildMeshLods().
+    bool GenerateLods{ true };
+    MeshLodSettings Lods{};
+    // Decodes images on these workers when set.
+    JobSystem* Jobs{};
+};
+
 class ModelLoader
 {
 public:
-    static Model LoadGLTFModel(const std::string& filename);
+    // Images are registered in textures, keyed by source, so each is decoded once.
+    static Model LoadGLTFModel(const std::string& filename, TextureRegistry& textures,
+        const ModelLoadOptions& options = {});
+
+    // Loads the baked copy of a glTF file, baking it first when it is missing or stale.
+    static Model LoadModel(const std::string& filename, TextureRegistry& textures,
+        const ModelLoadOptions& options = {});
+
+    // External buffer files a glTF file reads, on the same base path as
+    // filename. Embedded and data URI buffers have no file and are skipped.
+    static std::vector<std::string> GetBufferFiles(const std::string& filename);
 
 private:
-    static Mesh LoadMesh(const cgltf_data* data, const cgltf_mesh* mesh, const std::string& basePath);
+    static Mesh LoadMesh(const cgltf_data* data, const cgltf_mesh* mesh,
+        std::span<const TextureHandle> images);
     static Texture LoadTextureFromCgltfImage(const cgltf_image* image, const std::string& basePath);
+    static std::string GetImageKey(const std::string& filename, const std::string& basePath,
+        const cgltf_image* image, size_t imageIndex);
     static std::vector<uint32_t> GetIndices(const cgltf_accessor* accessor);
 
     template<typename T>
@@ -0,0 +1,127 @@
+#include "pch.h"
+#include "assets/skinning.h"
+#include "core/job_system.h"
+
+static float WeightSum(const V4& weights)
+{
+    return weights.X + weights.Y + weights.Z + weights.W;
+}
+
+void SkinVerticesScalar(std::span<const Vertex> vertices, const std::array<M4, MAX_BONES>& bones,
+    std::span<V3> outPositions, std::span<V3> outNormals)
+{
+    Assert(outPositions.size() >= vertices.size() && outNormals.size() >= vertices.size());
+
+    for (size_t v = 0; v < vertices.size(); ++v)
+    {
+        const Vertex& vertex = vertices[v];
+
+        if (WeightSum(vertex.Weights) == 0.0f)
+        {
+            outPositions[v] = vertex.Position;
+            outNormals[v] = vertex.Normal;
+            continue;
+        }
+
+        const int32_t ids[MAX_BONE_INFLUENCE] = { vertex.BoneIDs.X, vertex.BoneIDs.Y, vertex.BoneIDs.Z, vertex.BoneIDs.W };
+        const float weights[MAX_BONE_INFLUENCE] = { vertex.Weights.X, vertex.Weights.Y, vertex.Weights.Z, vertex.Weights.W };
+
+        V3 position{};
+        V3 normal{};
+        for (int i = 0; i < MAX_BONE_INFLUENCE; ++i)
+        {
+            Assert(ids[i] >= 0 && ids[i] < MAX_BONES);
+            const M4& m = bones[ids[i]];
+
+            const V4 p = TransformV4Scalar({ vertex.Position.X, vertex.Position.Y, vertex.Position.Z, 1.0f }, m);
+            const V4 n = TransformV4Scalar({ vertex.Normal.X, vertex.Normal.Y, vertex.Normal.Z, 0.0f }, m);
+
+            position += V3{ p.X, p.Y, p.Z } * weights[i];
+            normal += V3{ n.X, n.Y, n.Z } * weights[i];
+        }
+
+        outPositions[v] = position;
+        outNormals[v] = Normalize(normal);
+    }
+}
+
+#if HANDMADE_MATH_SSE2
+static V3 StoreV3(const __m128 value)
+{
+    alignas(16) float result[4];
+    _mm_store_ps(result, value);
+    return { result[0], result[1], result[2] };
+}
+#endif
+
+void SkinVertices(std::span<const Vertex> vertices, const std::array<M4, MAX_BONES>& bones,
+    std::span<V3> outPositions, std::span<V3> outNormals)
+{
+#if HANDMADE_MATH_SSE2
+    Assert(outPositions.size() >= vertices.size() && outNormals.size() >= vertices.size());
+
+    for (size_t v = 0; v < vertices.size(); ++v)
+    {
+        const Vertex& vertex = vertices[v];
+
+        if (WeightSum(vertex.Weights) == 0.0f)
+        {
+            outPositions[v] = vertex.Position;
+            outNormals[v] = vertex.Normal;
+            continue;
+        }
+
+        const int32_t ids[MAX_BONE_INFLUENCE] = { vertex.BoneIDs.X, vertex.BoneIDs.Y, vertex.BoneIDs.Z, vertex.BoneIDs.W };
+        const float weights[MAX_BONE_INFLUENCE] = { vertex.Weights.X, vertex.Weights.Y, vertex.Weights.Z, vertex.Weights.W };
+
+        // Blend the bone matrices first, then transform once.
+        __m128 r0 = _mm_setzero_ps();
+        __m128 r1 = _mm_setzero_ps();
+        __m128 r2 = _mm_setzero_ps();
+        __m128 r3 = _mm_setzero_ps();
+        for (int i = 0; i < MAX_BONE_INFLUENCE; ++i)
+        {
+            Assert(ids[i] >= 0 && ids[i] < MAX_BONES);
+            const M4& m = bones[ids[i]];
+            const __m128 w = _mm_set1_ps(weights[i]);
+
+            r0 = SimdMulAdd(w, _mm_loadu_ps(m.M[0]), r0);
+            r1 = SimdMulAdd(w, _mm_loadu_ps(m.M[1]), r1);
+            r2 = SimdMulAdd(w, _mm_loadu_ps(m.M[2]), r2);
+            r3 = SimdMulAdd(w, _mm_loadu_ps(m.M[3]), r3);
+        }
+
+        __m128 position = SimdMulAdd(_mm_set1_ps(vertex.Position.X), r0, r3);
+        position = SimdMulAdd(_mm_set1_ps(vertex.Position.Y), r1, position);
+        position = SimdMulAdd(_mm_set1_ps(vertex.Position.Z), r2, position);
+
+        __m128 normal = _mm_mul_ps(_mm_set1_ps(vertex.Normal.X), r0);
+        normal = SimdMulAdd(_mm_set1_ps(vertex.Normal.Y), r1, normal);
+        normal = SimdMulAdd(_mm_set1_ps(vertex.Normal.Z), r2, normal);
+
+        outPositions[v] = StoreV3(position);
+        outNormals[v] = Normalize(StoreV3(normal));
+    }
+#else
+    SkinVerticesScalar(vertices, bones, outPositions, outNormals);
+#endif
+}
+
+void SkinMeshes(JobSystem& jobs, std::span<const Mesh> meshes,
+    const std::array<M4, MAX_BONES>& bones, std::span<SkinnedMesh> outMeshes)
+{
+    Assert(outMeshes.size() >= meshes.size());
+
+    // Size the outputs up front so the jobs never allocate.
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {
+        outMeshes[i].Positions.resize(meshes[i].Vertices.size());
+        outMeshes[i].Normals.resize(meshes[i].Vertices.size());
+    }
+
+    jobs.ParallelFor(meshes.size(), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+                SkinVertices(meshes[i].Vertices, bones, outMeshes[i].Positions, outMeshes[i].Normals);
+        });
+}
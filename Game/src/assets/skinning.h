@@ -0,0 +1,31 @@
+#pragma once
+
+#include "assets/assets.h"
+
+class JobSystem;
+
+// CPU-skinned copy of a mesh's positions and normals.
+struct SkinnedMesh
+{
+    std::vector<V3> Positions{};
+    std::vector<V3> Normals{};
+};
+
+/*
+	NOTE:
+	Matches the skinning in shaders.hlsl VSMain: each vertex is transformed as a
+	row vector by the weighted sum of its bone matrices. Vertices whose weights
+	sum to zero (static meshes) are passed through unskinned.
+*/
+
+// Reference implementation.
+void SkinVerticesScalar(std::span<const Vertex> vertices, const std::array<M4, MAX_BONES>& bones,
+    std::span<V3> outPositions, std::span<V3> outNormals);
+
+// SIMD implementation, falls back to the scalar one when SIMD is disabled.
+void SkinVertices(std::span<const Vertex> vertices, const std::array<M4, MAX_BONES>& bones,
+    std::span<V3> outPositions, std::span<V3> outNormals);
+
+// Skins every mesh of a model on the job system, one job per mesh.
+void SkinMeshes(JobSystem& jobs, std::span<const Mesh> meshes,
+    const std::array<M4, MAX_BONES>& bones, std::span<SkinnedMesh> outMeshes);
@@ -0,0 +1,82 @@
+#include "pch.h"
+
+#include "texture_registry.h"
+
+TextureHandle TextureRegistry::Find(const std::string& key) const
+{
+    std::lock_guard lock(Mutex);
+    auto it = KeyToIndex.find(key);
+    return it != KeyToIndex.end() ? TextureHandle{ it->second } : TextureHandle{};
+}
+
+TextureHandle TextureRegistry::Register(const std::string& key, Texture texture)
+{
+    std::lock_guard lock(Mutex);
+
+    if (!key.empty())
+    {
+        auto it = KeyToIndex.find(key);
+        if (it != KeyToIndex.end())
+            return { it->second };
+    }
+
+    const uint32_t index = static_cast<uint32_t>(Entries.size());
+    Entries.push_back({ key, std::move(texture), nullptr });
+    if (!key.empty())
+        KeyToIndex.emplace(key, index);
+
+    return { index };
+}
+
+TextureHandle TextureRegistry::Load(const std::string& key, const std::function<Texture()>& load)
+{
+    const TextureHandle existing = Find(key);
+    if (existing.IsValid())
+        return existing;
+
+    // Decode outside the lock so other loads are not serialized behind it.
+    return Register(key, load());
+}
+
+const Texture& TextureRegistry::GetTexture(TextureHandle handle) const
+{
+    std::lock_guard lock(Mutex);
+    Assert(handle.Index < Entries.size());
+    return Entries[handle.Index].Texture;
+}
+
+const std::string& TextureRegistry::GetKey(TextureHandle handle) const
+{
+    std::lock_guard lock(Mutex);
+    Assert(handle.Index < Entries.size());
+    return Entries[handle.Index].Key;
+}
+
+void* TextureRegistry::GetView(TextureHandle handle) const
+{
+    std::lock_guard lock(Mutex);
+    Assert(handle.Index < Entries.size());
+    return Entries[handle.Index].View;
+}
+
+void TextureRegistry::SetView(TextureHandle handle, void* view)
+{
+    std::lock_guard lock(Mutex);
+    Assert(handle.Index < Entries.size());
+    Entries[handle.Index].View = view;
+}
+
+size_t TextureRegistry::GetCount() const
+{
+    std::lock_guard lock(Mutex);
+    return Entries.size();
+}
+
+size_t TextureRegistry::GetMemoryUsage() const
+{
+    std::lock_guard lock(Mutex);
+    size_t result = 0;
+    for (const Entry& entry : Entries)
+        result += entry.Texture.Pixels.size();
+    return result;
+}
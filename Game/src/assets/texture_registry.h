@@ -0,0 +1,47 @@
+#pragma once
+
+#include "assets.h"
+
+/*
+	NOTE:
+	Owns every texture, keyed by its source (file path, or glTF file and image
+	index), so an image referenced by many meshes or models is decoded, stored
+	and uploaded once. Thread-safe. Entries are never removed, so references
+	returned by GetTexture() stay valid.
+*/
+class TextureRegistry
+{
+public:
+    TextureHandle Find(const std::string& key) const;
+
+    // Keeps the first texture registered under a key. An empty key always
+    // registers a new texture.
+    TextureHandle Register(const std::string& key, Texture texture);
+
+    // Calls load only when key is not registered yet. Concurrent first loads
+    // of the same key may both decode; the first one registered is kept.
+    TextureHandle Load(const std::string& key, const std::function<Texture()>& load);
+
+    const Texture& GetTexture(TextureHandle handle) const;
+    const std::string& GetKey(TextureHandle handle) const;
+
+    // Renderer view of the texture, created once by the first upload.
+    void* GetView(TextureHandle handle) const;
+    void SetView(TextureHandle handle, void* view);
+
+    size_t GetCount() const;
+    // Bytes of pixel data held.
+    size_t GetMemoryUsage() const;
+
+private:
+    struct Entry
+    {
+        std::string Key{};
+        Texture Texture{};
+        void* View{};
+    };
+
+    mutable std::mutex Mutex{};
+    std::deque<Entry> Entries{};
+    std::unordered_map<std::string, uint32_t> KeyToIndex{};
+};
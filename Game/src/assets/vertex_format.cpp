@@ -0,0 +1,252 @@
+#include "pch.h"
+#include "assets/vertex_format.h"
+
+static_assert(sizeof(PackedVertex) == 20);
+static_assert(sizeof(PackedSkin) == 8);
+
+//////////////////////////////////////////////////////////////////////////////
+//								HALF FLOAT									//
+//////////////////////////////////////////////////////////////////////////////
+
+// Rounds to nearest even. Values out of range become infinity, tiny values
+// become half denormals or zero.
+uint16_t FloatToHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const uint32_t exponent = (bits >> 23) & 0xff;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    // Infinity and NaN
+    if (exponent == 0xff)
+        return static_cast<uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+
+    const int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+    if (halfExponent >= 0x1f)
+        return static_cast<uint16_t>(sign | 0x7c00);
+
+    if (halfExponent <= 0)
+    {
+        if (halfExponent < -10)
+            return static_cast<uint16_t>(sign);
+
+        // Denormal: shift the mantissa, with its implicit bit, into place.
+        mantissa |= 0x800000;
+        const uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+        uint32_t half = mantissa >> shift;
+        const uint32_t remainder = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1)))
+            half++;
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    uint32_t half = (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+    const uint32_t remainder = mantissa & 0x1fff;
+    // A carry out of the mantissa correctly bumps the exponent.
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+        half++;
+    return static_cast<uint16_t>(sign | half);
+}
+
+float HalfToFloat(uint16_t value)
+{
+    const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1f;
+    const uint32_t mantissa = value & 0x3ff;
+
+    uint32_t bits;
+    if (exponent == 0)
+    {
+        // Zero or denormal
+        const float magnitude = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+        memcpy(&bits, &magnitude, sizeof(bits));
+        bits |= sign;
+    }
+    else if (exponent == 0x1f)
+    {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    }
+    else
+    {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//								OCTAHEDRAL									//
+//////////////////////////////////////////////////////////////////////////////
+
+static float SignNotZero(float value)
+{
+    return value < 0.0f ? -1.0f : 1.0f;
+}
+
+static int16_t ToSnorm16(float value)
+{
+    return static_cast<int16_t>(roundf(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+// Projects the normal onto the octahedron |x| + |y| + |z| = 1 and unfolds the
+// lower half over the diagonals.
+void PackOctahedral(const V3& normal, int16_t out[2])
+{
+    const float l1 = fabsf(normal.X) + fabsf(normal.Y) + fabsf(normal.Z);
+    Assert(l1 > 0.0f);
+
+    float u = normal.X / l1;
+    float v = normal.Y / l1;
+    if (normal.Z < 0.0f)
+    {
+        const float foldedU = (1.0f - fabsf(v)) * SignNotZero(u);
+        const float foldedV = (1.0f - fabsf(u)) * SignNotZero(v);
+        u = foldedU;
+        v = foldedV;
+    }
+
+    out[0] = ToSnorm16(u);
+    out[1] = ToSnorm16(v);
+}
+
+V3 UnpackOctahedral(const int16_t packed[2])
+{
+    const float u = std::max(packed[0] / 32767.0f, -1.0f);
+    const float v = std::max(packed[1] / 32767.0f, -1.0f);
+
+    V3 result = { u, v, 1.0f - fabsf(u) - fabsf(v) };
+    if (result.Z < 0.0f)
+    {
+        result.X = (1.0f - fabsf(v)) * SignNotZero(u);
+        result.Y = (1.0f - fabsf(u)) * SignNotZero(v);
+    }
+
+    return Normalize(result);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//								SKINNING									//
+//////////////////////////////////////////////////////////////////////////////
+
+PackedSkin PackSkin(const IV4& boneIDs, const V4& weights)
+{
+    PackedSkin result{};
+
+    const int32_t ids[MAX_BONE_INFLUENCE] = { boneIDs.X, boneIDs.Y, boneIDs.Z, boneIDs.W };
+    const float w[MAX_BONE_INFLUENCE] = { weights.X, weights.Y, weights.Z, weights.W };
+
+    float sum = 0.0f;
+    for (int i = 0; i < MAX_BONE_INFLUENCE; ++i)
+    {
+        Assert(ids[i] >= 0 && ids[i] < 256);
+        result.BoneIDs[i] = static_cast<uint8_t>(std::clamp(ids[i], 0, 255));
+        sum += std::max(w[i], 0.0f);
+    }
+
+    if (sum <= 0.0f)
+        return result;
+
+    // Round each weight, then give the rounding error to the largest one so
+    // the weights still sum to exactly 1.
+    int32_t total = 0;
+    int32_t largest = 0;
+    for (int i = 0; i < MAX_BONE_INFLUENCE; ++i)
+    {
+        const int32_t quantized = static_cast<int32_t>(roundf(std::max(w[i], 0.0f) / sum * 255.0f));
+        result.Weights[i] = static_cast<uint8_t>(quantized);
+        total += quantized;
+        if (w[i] > w[largest])
+            largest = i;
+    }
+
+    result.Weights[largest] = static_cast<uint8_t>(result.Weights[largest] + (255 - total));
+    return result;
+}
+
+void UnpackSkin(const PackedSkin& skin, IV4& outBoneIDs, V4& outWeights)
+{
+    outBoneIDs = { skin.BoneIDs[0], skin.BoneIDs[1], skin.BoneIDs[2], skin.BoneIDs[3] };
+
+    constexpr float scale = 1.0f / 255.0f;
+    outWeights = { skin.Weights[0] * scale, skin.Weights[1] * scale,
+        skin.Weights[2] * scale, skin.Weights[3] * scale };
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//								STREAMS										//
+//////////////////////////////////////////////////////////////////////////////
+
+bool HasSkinning(std::span<const Vertex> vertices)
+{
+    for (const Vertex& v : vertices)
+        if (v.Weights.X != 0.0f || v.Weights.Y != 0.0f || v.Weights.Z != 0.0f || v.Weights.W != 0.0f)
+            return true;
+    return false;
+}
+
+PackedVertexStream PackVertices(std::span<const Vertex> vertices)
+{
+    PackedVertexStream result{};
+    result.Vertices.resize(vertices.size());
+
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        const Vertex& v = vertices[i];
+        PackedVertex& packed = result.Vertices[i];
+
+        packed.Position = v.Position;
+
+        // A missing (zero) normal is stored as +Z.
+        const bool hasNormal = v.Normal.X != 0.0f || v.Normal.Y != 0.0f || v.Normal.Z != 0.0f;
+        PackOctahedral(hasNormal ? v.Normal : V3{ 0.0f, 0.0f, 1.0f }, packed.Normal);
+
+        packed.TexCoord[0] = FloatToHalf(v.TexCoord.X);
+        packed.TexCoord[1] = FloatToHalf(v.TexCoord.Y);
+    }
+
+    if (HasSkinning(vertices))
+    {
+        result.Skin.resize(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i)
+            result.Skin[i] = PackSkin(vertices[i].BoneIDs, vertices[i].Weights);
+    }
+
+    return result;
+}
+
+void UnpackVertices(const PackedVertexStream& stream, std::span<Vertex> out)
+{
+    Assert(out.size() >= stream.Vertices.size());
+    Assert(stream.Skin.empty() || stream.Skin.size() == stream.Vertices.size());
+
+    for (size_t i = 0; i < stream.Vertices.size(); ++i)
+    {
+        const PackedVertex& packed = stream.Vertices[i];
+        Vertex& v = out[i];
+
+        v.Position = packed.Position;
+        v.Normal = UnpackOctahedral(packed.Normal);
+        v.TexCoord = { HalfToFloat(packed.TexCoord[0]), HalfToFloat(packed.TexCoord[1]) };
+
+        if (stream.Skin.empty())
+        {
+            v.BoneIDs = {};
+            v.Weights = {};
+        }
+        else
+        {
+            UnpackSkin(stream.Skin[i], v.BoneIDs, v.Weights);
+        }
+    }
+}
+
+size_t GetPackedVertexSize(std::span<const Vertex> vertices)
+{
+    const size_t skinSize = HasSkinning(vertices) ? sizeof(PackedSkin) : 0;
+    return vertices.size() * (sizeof(PackedVertex) + skinSize);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "assets/assets.h"
+
+/*
+	NOTE:
+	Compact alternative to Vertex. The static stream keeps full-float positions
+	but stores normals octahedral-encoded in two snorm16 and UVs as halfs. Bone
+	indices and weights live in a second stream that static meshes omit.
+
+	This is size analysis only for now: the loader logs GetPackedVertexSize(),
+	terrain stats count it per resident tile, and the headless run reports
+	the bytes behind each frame's draws. Meshes, the model cache and both
+	renderers still store and draw Vertex.
+	Switching needs a matching D3D11 input layout and a cache version bump.
+*/
+
+// 20 bytes, against 64 for Vertex.
+struct PackedVertex
+{
+    V3 Position{};
+    int16_t Normal[2]{};
+    uint16_t TexCoord[2]{};
+};
+
+// 8 bytes. Weights are unorm8 and always sum to 255.
+struct PackedSkin
+{
+    uint8_t BoneIDs[MAX_BONE_INFLUENCE]{};
+    uint8_t Weights[MAX_BONE_INFLUENCE]{};
+};
+
+struct PackedVertexStream
+{
+    std::vector<PackedVertex> Vertices{};
+    // Empty for static meshes, else one entry per vertex.
+    std::vector<PackedSkin> Skin{};
+};
+
+uint16_t FloatToHalf(float value);
+float HalfToFloat(uint16_t value);
+
+// Normal must be non-zero. The round trip error is below 0.001 radians.
+void PackOctahedral(const V3& normal, int16_t out[2]);
+V3 UnpackOctahedral(const int16_t packed[2]);
+
+PackedSkin PackSkin(const IV4& boneIDs, const V4& weights);
+void UnpackSkin(const PackedSkin& skin, IV4& outBoneIDs, V4& outWeights);
+
+// True if any vertex has a non-zero bone weight.
+bool HasSkinning(std::span<const Vertex> vertices);
+
+PackedVertexStream PackVertices(std::span<const Vertex> vertices);
+void UnpackVertices(const PackedVertexStream& stream, std::span<Vertex> out);
+
+// Size of PackVertices(vertices) without packing them.
+size_t GetPackedVertexSize(std::span<const Vertex> vertices);
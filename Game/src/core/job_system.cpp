@@ -0,0 +1,179 @@
+#include "pch.h"
+#include "core/job_system.h"
+
+// Queue owned by the current thread in the job system that started it.
+struct WorkerQueue
+{
+    const JobSystem* Owner{};
+    uint32_t Index{};
+};
+
+static thread_local WorkerQueue _WorkerQueue{};
+
+JobSystem::JobSystem(uint32_t workerCount)
+{
+    if (workerCount == 0)
+    {
+        const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    Queues.reserve(workerCount + 1);
+    for (uint32_t i = 0; i < workerCount + 1; ++i)
+        Queues.emplace_back(std::make_unique<JobQueue>());
+
+    Running = true;
+
+    Workers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; ++i)
+        Workers.emplace_back(&JobSystem::WorkerMain, this, i + 1);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard lock(WakeMutex);
+        Running = false;
+    }
+    WakeCondition.notify_all();
+
+    for (auto& worker : Workers)
+        worker.join();
+}
+
+void JobSystem::Execute(Job job, JobCounter& counter)
+{
+    counter.Pending.fetch_add(1, std::memory_order_relaxed);
+
+    {
+        JobQueue& queue = *Queues[GetQueueIndex()];
+        std::lock_guard lock(queue.Mutex);
+        queue.Jobs.push_back({ std::move(job), &counter });
+    }
+
+    {
+        std::lock_guard lock(WakeMutex);
+        QueuedJobs.fetch_add(1, std::memory_order_relaxed);
+    }
+    WakeCondition.notify_one();
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    while (counter.Pending.load(std::memory_order_acquire) > 0)
+    {
+        if (TryRunJob())
+            continue;
+
+        // Nothing left to help with: sleep until the batch finishes or more
+        // jobs are queued.
+        std::unique_lock lock(WakeMutex);
+        WakeCondition.wait(lock, [this, &counter]()
+            {
+                return counter.Pending.load(std::memory_order_acquire) <= 0 ||
+                    QueuedJobs.load(std::memory_order_relaxed) > 0;
+            });
+    }
+}
+
+void JobSystem::ParallelFor(size_t count, size_t batchSize,
+    const std::function<void(size_t, size_t)>& function)
+{
+    if (count == 0)
+        return;
+
+    batchSize = std::max<size_t>(batchSize, 1);
+
+    // A single batch is not worth a round trip through the queues.
+    if (count <= batchSize)
+    {
+        function(0, count);
+        return;
+    }
+
+    JobCounter counter{};
+    for (size_t begin = 0; begin < count; begin += batchSize)
+    {
+        const size_t end = std::min(begin + batchSize, count);
+        Execute([&function, begin, end]() { function(begin, end); }, counter);
+    }
+
+    Wait(counter);
+}
+
+void JobSystem::WorkerMain(uint32_t queueIndex)
+{
+    _WorkerQueue = { this, queueIndex };
+
+    while (true)
+    {
+        if (TryRunJob())
+            continue;
+
+        std::unique_lock lock(WakeMutex);
+        WakeCondition.wait(lock, [this]()
+            {
+                return !Running || QueuedJobs.load(std::memory_order_relaxed) > 0;
+            });
+
+        if (!Running)
+            return;
+    }
+}
+
+bool JobSystem::TryRunJob()
+{
+    const uint32_t queueIndex = GetQueueIndex();
+
+    QueuedJob job{};
+    if (!TryPop(queueIndex, job) && !TrySteal(queueIndex, job))
+        return false;
+
+    QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+
+    job.Function();
+
+    // The counter may be gone as soon as it reaches zero, so only the wake
+    // state is touched afterwards. Taking the mutex orders the notify after
+    // a waiter's predicate check.
+    if (job.Counter->Pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        { std::lock_guard lock(WakeMutex); }
+        WakeCondition.notify_all();
+    }
+    return true;
+}
+
+uint32_t JobSystem::GetQueueIndex() const
+{
+    return _WorkerQueue.Owner == this ? _WorkerQueue.Index : 0;
+}
+
+bool JobSystem::TryPop(uint32_t queueIndex, QueuedJob& job)
+{
+    JobQueue& queue = *Queues[queueIndex];
+    std::lock_guard lock(queue.Mutex);
+    if (queue.Jobs.empty())
+        return false;
+
+    job = std::move(queue.Jobs.back());
+    queue.Jobs.pop_back();
+    return true;
+}
+
+bool JobSystem::TrySteal(uint32_t queueIndex, QueuedJob& job)
+{
+    const uint32_t queueCount = static_cast<uint32_t>(Queues.size());
+    for (uint32_t offset = 1; offset < queueCount; ++offset)
+    {
+        JobQueue& victim = *Queues[(queueIndex + offset) % queueCount];
+        std::lock_guard lock(victim.Mutex);
+        if (victim.Jobs.empty())
+            continue;
+
+        job = std::move(victim.Jobs.front());
+        victim.Jobs.pop_front();
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+using Job = std::function<void()>;
+
+// Number of unfinished jobs in a batch. Wait() on it to join the batch.
+struct JobCounter
+{
+    std::atomic<int32_t> Pending{};
+};
+
+/*
+	NOTE:
+	Small work-stealing job system. Every worker owns a queue; it pops its own
+	jobs LIFO and steals from the front of the other queues when it runs dry.
+	Threads that are not workers of this instance (the main thread, workers of
+	another JobSystem) share queue 0. Wait() runs queued jobs until none are
+	left and then sleeps until the batch finishes.
+*/
+class JobSystem
+{
+public:
+    // 0 workers means one per hardware thread, minus the calling thread.
+    explicit JobSystem(uint32_t workerCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    void Execute(Job job, JobCounter& counter);
+    void Wait(JobCounter& counter);
+
+    // Calls function(begin, end) over [0, count) in ranges of at most
+    // batchSize items and returns once every range has finished.
+    void ParallelFor(size_t count, size_t batchSize,
+        const std::function<void(size_t, size_t)>& function);
+
+    uint32_t GetWorkerCount() const { return static_cast<uint32_t>(Workers.size()); }
+
+private:
+    struct QueuedJob
+    {
+        Job Function{};
+        JobCounter* Counter{};
+    };
+
+    struct JobQueue
+    {
+        std::mutex Mutex{};
+        std::deque<QueuedJob> Jobs{};
+    };
+
+    void WorkerMain(uint32_t queueIndex);
+    bool TryRunJob();
+    uint32_t GetQueueIndex() const;
+    bool TryPop(uint32_t queueIndex, QueuedJob& job);
+    bool TrySteal(uint32_t queueIndex, QueuedJob& job);
+
+    std::vector<std::unique_ptr<JobQueue>> Queues{};
+    std::vector<std::thread> Workers{};
+
+    std::mutex WakeMutex{};
+    std::condition_variable WakeCondition{};
+    std::atomic<int32_t> QueuedJobs{};
+    std::atomic<bool> Running{};
+};
@@ -2,6 +2,9 @@
 
 #include "math/handmade_math.h"
 #include "assets/assets.h"
+#include "world/bvh.h"
+
+class Terrain;
 
 struct DirectionalLight
 {
@@ -36,6 +39,12 @@ struct Entity
 {
     Model Model{};
     M4 WorldMatrix{};
+    // Leaf in GameWorld::EntityBvh, NULL_NODE while the model has no bounds.
+    uint32_t BvhProxy{ DynamicBvh::NULL_NODE };
+    // The world matrix the leaf's bounds were computed with. Set BoundsDirty
+    // when Model changes; UpdateEntityBvh() skips entities that kept both.
+    M4 BvhWorldMatrix{};
+    bool BoundsDirty{ true };
 };
 
 constexpr size_t MAX_ENTITIES = 128;
@@ -43,6 +52,9 @@ struct GameWorld
 {
 	std::array<Entity, MAX_ENTITIES> Entities{};
     DirectionalLight DirectionalLight{};
+    Terrain* Terrain{};
+    // World space entity bounds, user data is the entity index.
+    DynamicBvh EntityBvh{};
 };
 
 struct GameMemory
@@ -15,6 +15,8 @@
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <stb_image.h>
+// Software renderer framebuffer output.
+#include <stb_image_write.h>
 
 #define CGLTF_IMPLEMENTATION
 #include <cgltf.h>
@@ -2,26 +2,38 @@
 
 #include <game.h>
 #include <assets/model_loader.h>
+#include <assets/asset_pipeline.h>
+#include <assets/texture_registry.h>
 #include <assets/animator.h>
+#include <assets/mesh_bounds.h>
+#include <core/job_system.h>
+#include <world/terrain.h>
 
 #ifdef _WIN32
 #include <platform/win32_platform.h>
 #include <renderer/d3d11_renderer.h>
+#else
+#include <platform/null_platform.h>
+#include <renderer/null_renderer.h>
+#include <renderer/software_renderer.h>
 #endif
 
-#include <stb_image.h>
-
 void Init();
 void Run();
 void Shutdown();
 
 void Move(float dt, GameMemory* gameState);
 void InitGame(int gameResolutionWidth, int gameResolutionHeight, GameMemory* gameState);
-void UploadMeshesToGPU(GameMemory* gameState);
+void LoadAssets(GameMemory* gameState);
 void UpdateGame(const float dt, GameMemory* gameState);
+void UpdateEntityBvh(GameWorld& world);
 void UpdateCamera(const float dt, GameMemory* gameState);
 
-Entity LoadTerrain(const std::string& path, const V3& offset);
+std::unique_ptr<Terrain> LoadTerrain(const std::string& path, const V3& offset, TextureRegistry& textures);
+
+#ifndef _WIN32
+std::vector<ScriptedInput> GetHeadlessScript(uint32_t frameCount);
+#endif
 
 // TODO: Make a platform specific read file function.
 std::string ReadEntireFile(const std::string& path);
@@ -34,6 +46,9 @@ static std::unique_ptr<GameMemory> _GameMemory;
 
 static std::unique_ptr<Platform> _Platform;
 static std::unique_ptr<Renderer> _Renderer;
+static std::unique_ptr<JobSystem> _JobSystem;
+static std::unique_ptr<TextureRegistry> _Textures;
+static std::unique_ptr<Terrain> _Terrain;
 
 static uint32_t _WindowWidth = 1280;
 static uint32_t _WindowHeight = 720;
@@ -46,6 +61,18 @@ static std::unordered_map<char, FontGlyph> _LoadedFontGlyphs{};
 std::unordered_map<char, FontGlyph> LoadedFontGlyphs{};
 
 static bool _Running{};
+// Loads startup assets on the job system, false for the serial path. Headless
+// runs take --serial-assets, so one build can time both.
+static bool _AsyncAssetLoading{ true };
+
+// Simulation step in seconds, 0 uses the measured frame time. Headless runs
+// fix it so they are repeatable.
+static float _FixedDeltaTime{};
+// Frames a headless run lasts.
+static uint32_t _HeadlessFrames{ 600 };
+// Headless runs draw with the SoftwareRenderer and save the last frame here
+// when set.
+static std::string _SoftwareFramebufferPath{};
 
 static int _FPS{};
 static bool _VSync{ true };
@@ -61,13 +88,22 @@ void Init()
     _GameResolutionWidth = std::min<uint32_t>(_WindowWidth, _GameResolutionWidth);
 	_GameResolutionHeight = std::min<uint32_t>(_WindowHeight, _GameResolutionHeight);
 
+    _JobSystem = std::make_unique<JobSystem>();
+
 #ifdef _WIN32
     _Platform = std::make_unique<Win32Platform>();
     _Renderer = std::make_unique<D3D11Renderer>();
+#else
+    _Platform = std::make_unique<NullPlatform>(_HeadlessFrames, GetHeadlessScript(_HeadlessFrames));
+    if (_SoftwareFramebufferPath.empty())
+        _Renderer = std::make_unique<NullRenderer>();
+    else
+        _Renderer = std::make_unique<SoftwareRenderer>(_JobSystem.get());
 #endif
     Assert(_Platform && _Renderer);
 
     _GameMemory = std::make_unique<GameMemory>();
+    _Textures = std::make_unique<TextureRegistry>();
 
     _Platform->InitWindow(_WindowWidth, _WindowHeight, L"Window");
 	_Platform->InitConsole();
@@ -110,6 +146,9 @@ void Run()
         Move(deltaTime, _GameMemory.get());
         UpdateGame(deltaTime, _GameMemory.get());
 
+        if (_Terrain)
+            _Terrain->Update(_GameMemory->MainCamera.Position, *_Renderer, *_Textures);
+
         _Renderer->RenderScene(_GameMemory.get());
 
         _Renderer->RenderText(_LoadedFontGlyphs,
@@ -140,12 +179,16 @@ void Run()
         auto currentTime = std::chrono::steady_clock::now();
         std::chrono::duration<double> elapsed = currentTime - previousTime;
         previousTime = currentTime;
-        deltaTime = static_cast<float>(elapsed.count());
+        deltaTime = _FixedDeltaTime > 0.0f ? _FixedDeltaTime : static_cast<float>(elapsed.count());
     }
 }
 
 void Shutdown()
 {
+    // Tiles own GPU buffers, so they go before the renderer
+    if (_Terrain)
+        _Terrain->Shutdown(*_Renderer);
+
     _Platform->Shutdown();
 }
 
@@ -175,42 +218,65 @@ void InitGame(int gameResolutionWidth, int gameResolutionHeight, GameMemory* gam
     gameState->MainCamera.Projection = MatrixPerspective(
         0.5f * 3.14f, static_cast<float>(gameResolutionWidth) / gameResolutionHeight, nearPlane, farPlane);
     
-    _LoadedFontGlyphs = LoadFontGlyphs("C:/Windows/Fonts/Calibri.ttf", _Renderer.get());
-
     gameState->World.DirectionalLight.Direction = { .X = -0.25f, .Y = -0.5f, .Z = -1.0f };
     gameState->World.DirectionalLight.Ambient = { .X = 0.15f, .Y = 0.15f, .Z = 0.15f };
     gameState->World.DirectionalLight.Diffuse = { .X = 0.8f, .Y = 0.8f, .Z = 0.8f };
 
-    UploadMeshesToGPU(_GameMemory.get());
+    LoadAssets(gameState);
 
     //const float frequency = 440.f, duration = 0.2f;
     //_SineWave = GenerateSineWave(_SampleRate, frequency, duration);
-
-    _SineWave = LoadWavFile("assets/audio/jump.wav");
 }
 
-void UploadMeshesToGPU(GameMemory* gameState)
+void LoadAssets(GameMemory* gameState)
 {
     Assert(_Renderer);
 
-    Model model{};
-    model = ModelLoader::LoadGLTFModel("assets/models/dummy_platformer.gltf");
-    for (auto& mesh : model.Meshes)
-    {
-        _Renderer->UploadMeshesToGPU(mesh);
-	}
+    const auto start = std::chrono::steady_clock::now();
 
-    Entity& entity = gameState->World.Entities[0];
-	entity.Model = model;
+    AssetPipeline assets(_AsyncAssetLoading ? _JobSystem.get() : nullptr, *_Textures);
 
-    PlayAnimation(entity.Model.Animator,
-        &entity.Model.Animations[0], &entity.Model.Skeletons[0], 1.0f, true);
+    ModelLoadOptions options{};
+    options.CompressAnimations = true;
+    AssetHandle<Model> model = assets.LoadModel("assets/models/dummy_platformer.gltf", options);
+    AssetHandle<std::unique_ptr<Terrain>> terrain = assets.Load<std::unique_ptr<Terrain>>([]()
+        {
+            return LoadTerrain("assets/textures/terrain.png", { 0.f, -21.f, 0.f }, *_Textures);
+        });
+    AssetHandle<Sound> jumpSound = assets.LoadSound("assets/audio/jump.wav");
 
-    gameState->World.Entities[1] = LoadTerrain("assets/textures/terrain.png", {0.f, -21.f, 0.f});
-    for (auto& mesh : gameState->World.Entities[1].Model.Meshes)
-    {
-        _Renderer->UploadMeshesToGPU(mesh);
-    }
+    // Creates texture views, so it stays on the main thread while the loads run.
+    _LoadedFontGlyphs = LoadFontGlyphs("C:/Windows/Fonts/Calibri.ttf", _Renderer.get());
+
+    assets.OnLoaded(model, [gameState](Model& model)
+        {
+            for (auto& mesh : model.Meshes)
+            {
+                _Renderer->UploadMeshesToGPU(mesh, *_Textures);
+            }
+
+            Entity& entity = gameState->World.Entities[0];
+            entity.Model = std::move(model);
+            entity.BoundsDirty = true;
+
+            PlayAnimation(entity.Model.Animator,
+                &entity.Model.Animations[0], &entity.Model.Skeletons[0], 1.0f, true);
+        });
+
+    // Tiles are uploaded by Terrain::Update() as they finish generating.
+    assets.OnLoaded(terrain, [gameState](std::unique_ptr<Terrain>& terrain)
+        {
+            _Terrain = std::move(terrain);
+            gameState->World.Terrain = _Terrain.get();
+        });
+
+    assets.OnLoaded(jumpSound, [](Sound& sound) { _SineWave = std::move(sound); });
+
+    assets.WaitAll();
+
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::println("Loaded assets in {:.2f} ms ({})", elapsed.count(), _AsyncAssetLoading ? "async" : "serial");
+    std::println("Texture registry: {} textures, {} KB", _Textures->GetCount(), _Textures->GetMemoryUsage() / 1024);
 }
 
 void Move(float dt, GameMemory* gameState)
@@ -325,117 +391,29 @@ void UpdateCamera(const float dt, GameMemory* gameState)
 
 }
 
-Entity LoadTerrain(const std::string& path, const V3& offset)
+std::unique_ptr<Terrain> LoadTerrain(const std::string& path, const V3& offset, TextureRegistry& textures)
 {
-    Entity result{};
-
-    int width, height, nChannels;
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nChannels, 0);
-    if (!data)
-    {
-        std::println("Failed to load heightmap: {}", path);
-        return result;
-    }
-
     const float yScale = 0.25f;
     const float yShift = 16.0f;
 
-    int rez = 1;
-    if (rez > std::min<int>(width, height)) rez = std::min<int>(width, height);
-
-    const int wSteps = width / rez;
-    const int hSteps = height / rez;
-
-    std::vector<Vertex> vertices;
-    vertices.reserve(static_cast<size_t>(wSteps * hSteps));
-
-    for (int z = 0; z < height; z += rez)
-    {
-        for (int x = 0; x < width; x += rez)
-        {
-            unsigned char* pixel = data + (x + width * z) * nChannels;
-            float heightValue = static_cast<float>(pixel[0]) * yScale - yShift;
-
-            Vertex v{};
-            v.Position.X = (-wSteps / 2.0f + (x / (float)rez)) + offset.X;
-            v.Position.Y = heightValue + offset.Y;
-            v.Position.Z = (-hSteps / 2.0f + (z / (float)rez)) + offset.Z;
-
-            v.TexCoord.X = static_cast<float>(x) / (width - 1);
-            v.TexCoord.Y = static_cast<float>(z) / (height - 1);
-
-            vertices.emplace_back(v);
-        }
-    }
-
-    std::println("Loaded {} vertices (rez = {}).", vertices.size(), rez);
-
-    std::vector<uint32_t> indices;
-    indices.reserve(static_cast<size_t>((wSteps - 1) * (hSteps - 1) * 6));
-
-    for (int z = 0; z < hSteps - 1; z++)
-    {
-        for (int x = 0; x < wSteps - 1; x++)
-        {
-            uint32_t topLeft = x + wSteps * z;
-            uint32_t topRight = (x + 1) + wSteps * z;
-            uint32_t bottomLeft = x + wSteps * (z + 1);
-            uint32_t bottomRight = (x + 1) + wSteps * (z + 1);
-
-            indices.push_back(topLeft);
-            indices.push_back(bottomLeft);
-            indices.push_back(topRight);
-
-            indices.push_back(topRight);
-            indices.push_back(bottomLeft);
-            indices.push_back(bottomRight);
-        }
-    }
-
-    std::println("Loaded {} indices.", indices.size());
-
-    std::vector<V3> normals(vertices.size(), { 0, 0, 0 });
-
-    for (size_t i = 0; i < indices.size(); i += 3)
-    {
-        uint32_t i0 = indices[i];
-        uint32_t i1 = indices[i + 1];
-        uint32_t i2 = indices[i + 2];
-
-        const V3& v0 = vertices[i0].Position;
-        const V3& v1 = vertices[i1].Position;
-        const V3& v2 = vertices[i2].Position;
-
-        V3 e1 = v1 - v0;
-        V3 e2 = v2 - v0;
-        V3 normal = Normalize(Cross(e1, e2));
-
-        normals[i0] += normal;
-        normals[i1] += normal;
-        normals[i2] += normal;
-    }
-
-    for (size_t i = 0; i < vertices.size(); i++)
-        vertices[i].Normal = Normalize(normals[i]);
-
-    Texture tex{};
-    tex.Width = width;
-    tex.Height = height;
-    tex.Pixels.assign(data, data + (width * height * nChannels));
+    // The heightmap doubles as the terrain's color texture
+    Texture image{};
+    Heightmap heightmap = LoadHeightmap(path, yScale, yShift, offset, &image);
+    if (!heightmap.IsValid())
+        return nullptr;
 
-    stbi_image_free(data);
+    // Centered on the offset, like the old single mesh terrain
+    heightmap.Origin.X -= heightmap.Width / 2.0f;
+    heightmap.Origin.Z -= heightmap.Height / 2.0f;
 
-    Mesh mesh{};
-    mesh.Vertices = std::move(vertices);
-    mesh.Indices = std::move(indices);
-    mesh.Textures.emplace_back(std::move(tex));
+    const TextureHandle texture = textures.Register(path, std::move(image));
 
-    Model model{};
-    model.Meshes.emplace_back(std::move(mesh));
+    const auto start = std::chrono::steady_clock::now();
+    auto terrain = std::make_unique<Terrain>(std::move(heightmap), texture, _JobSystem.get());
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
 
-    result.Model = std::move(model);
-
-    return result;
+    std::println("Terrain: {} levels, root tile built in {:.2f} ms", terrain->GetMaxLevel() + 1, elapsed.count());
+    return terrain;
 }
 
 Sound GenerateSineWave(uint32_t sampleRate, 
@@ -475,7 +453,7 @@ void UpdateGame(const float dt, GameMemory* gameState)
     gameState->World.DirectionalLight.Color = { 1.0f, 1.0f, 1.0f };
     gameState->World.DirectionalLight.Direction = { lightDir.X, lightDir.Y, lightDir.Z, 0.0f };
 
-    for (int i = 0; i < MAX_ENTITIES; i++)
+    for (size_t i = 0; i < MAX_ENTITIES; i++)
     {
 		Entity& entity = gameState->World.Entities[i];
 
@@ -488,8 +466,64 @@ void UpdateGame(const float dt, GameMemory* gameState)
 		M4 scale = MatrixScaling(1.0f, 1.0f, 1.0f);
 
 		entity.WorldMatrix = scale * translation * rotation;
+    }
+
+    // Every animator only writes its own pose, so entities animate in parallel.
+    // ParallelFor joins before returning, so the tree and rendering see
+    // finished poses.
+    constexpr size_t animationBatchSize = 8;
+    _JobSystem->ParallelFor(MAX_ENTITIES, animationBatchSize,
+        [gameState, dt](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+                UpdateAnimator(gameState->World.Entities[i].Model.Animator, dt);
+        });
+
+    UpdateEntityBvh(gameState->World);
+}
+
+void UpdateEntityBvh(GameWorld& world)
+{
+    for (uint32_t i = 0; i < MAX_ENTITIES; i++)
+    {
+        Entity& entity = world.Entities[i];
+
+        // Only entities that moved or changed pose need new bounds. Small
+        // moves then stay inside the leaf's fat box and cost no tree work.
+        const bool skinned = !entity.Model.Skeletons.empty();
+        const bool animating = skinned && IsAnimatorPlaying(entity.Model.Animator);
+        if (!entity.BoundsDirty && !animating && entity.WorldMatrix == entity.BvhWorldMatrix)
+            continue;
 
-        UpdateAnimator(entity.Model.Animator, dt);
+        // Stays set for one more frame after animation stops, to pick up
+        // the final pose
+        entity.BoundsDirty = animating;
+        entity.BvhWorldMatrix = entity.WorldMatrix;
+
+        // Skinned meshes in this frame's pose, as SubmitScene() culls them
+        AABB bounds{};
+        for (const Mesh& mesh : entity.Model.Meshes)
+        {
+            const AABB meshBounds = skinned ?
+                ComputePosedBounds(mesh, entity.Model.Animator.FinalBoneTransforms) : mesh.Bounds;
+            if (meshBounds.IsValid())
+                bounds = MergeAABB(bounds, TransformAABB(meshBounds, entity.WorldMatrix));
+        }
+
+        if (!bounds.IsValid())
+        {
+            if (entity.BvhProxy != DynamicBvh::NULL_NODE)
+            {
+                world.EntityBvh.Remove(entity.BvhProxy);
+                entity.BvhProxy = DynamicBvh::NULL_NODE;
+            }
+            continue;
+        }
+
+        if (entity.BvhProxy == DynamicBvh::NULL_NODE)
+            entity.BvhProxy = world.EntityBvh.Insert(bounds, i);
+        else
+            world.EntityBvh.Update(entity.BvhProxy, bounds);
     }
 }
 
@@ -500,7 +534,8 @@ std::unordered_map<char, FontGlyph> LoadFontGlyphs(const std::string& path, Rend
     Assert(renderer);
 
     std::string ttfBuffer = ReadEntireFile(path);
-    Assert(ttfBuffer.size()); // Ensure the font file was read successfully
+    if (ttfBuffer.empty())
+        return {};
 
     const unsigned char* data = (unsigned char*)ttfBuffer.data();
 
@@ -580,7 +615,7 @@ std::string ReadEntireFile(const std::string& path)
     return buffer;
 }
 
-#ifdef WIN32
+#ifdef _WIN32
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nShowCmd)
 {
     Init();
@@ -589,4 +624,102 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 
     return 0;
 }
+#else
+// Flies the camera over the terrain: forward, then strafing while turning.
+std::vector<ScriptedInput> GetHeadlessScript(uint32_t frameCount)
+{
+    const uint32_t half = frameCount / 2;
+
+    std::vector<ScriptedInput> script =
+    {
+        { .Frame = 0, .Key = KeyCode::KEY_F2, .Down = true },
+        { .Frame = 1, .Key = KeyCode::KEY_F2, .Down = false },
+        { .Frame = 2, .Key = KeyCode::KEY_W, .Down = true },
+        { .Frame = half, .Key = KeyCode::KEY_W, .Down = false },
+        { .Frame = half, .Key = KeyCode::KEY_D, .Down = true },
+    };
+
+    for (uint32_t frame = half; frame < frameCount; frame++)
+        script.push_back({ .Frame = frame, .Key = KeyCode::KEY_D, .Down = true, .MouseDelta = { 2.0f, 0.0f } });
+
+    return script;
+}
+
+// Headless run for benchmarks: main [frames] [--software image.png]
+// [--serial-assets]. Run from the repository root, like the windowed build, so
+// asset paths resolve. Startup time is printed as "Loaded assets in"; the first
+// run bakes the model cache, so compare the async and serial paths after it.
+int main(int argc, char* argv[])
+{
+    if (argc > 1)
+        _HeadlessFrames = static_cast<uint32_t>(std::max(std::atoi(argv[1]), 1));
+    for (int i = 2; i < argc; i++)
+    {
+        const std::string_view arg = argv[i];
+        if (arg == "--software" && i + 1 < argc)
+            _SoftwareFramebufferPath = argv[++i];
+        else if (arg == "--serial-assets")
+            _AsyncAssetLoading = false;
+    }
+    _FixedDeltaTime = 1.0f / 60.0f;
+
+    Init();
+    Run();
+
+    const NullPlatform& platform = static_cast<const NullPlatform&>(*_Platform);
+
+    std::vector<float> frameTimes(platform.GetFrameTimes().begin(), platform.GetFrameTimes().end());
+    std::sort(frameTimes.begin(), frameTimes.end());
+    if (!frameTimes.empty())
+    {
+        double total = 0.0;
+        for (float time : frameTimes)
+            total += time;
+
+        std::println("Frames: {}, mean {:.3f} ms, p50 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms",
+            frameTimes.size(), total / frameTimes.size(), frameTimes[frameTimes.size() / 2],
+            frameTimes[frameTimes.size() * 99 / 100], frameTimes.back());
+    }
+
+    if (_SoftwareFramebufferPath.empty())
+    {
+        const RenderQueueStats& stats = static_cast<const NullRenderer&>(*_Renderer).GetStats();
+        std::println("Last frame: {} draws, {} shader, {} geometry, {} texture, {} object, {} bone changes",
+            stats.DrawCalls, stats.ShaderChanges, stats.GeometryChanges, stats.TextureChanges,
+            stats.ObjectUploads, stats.BoneUploads);
+    }
+    else
+    {
+        const SoftwareRenderer& renderer = static_cast<const SoftwareRenderer&>(*_Renderer);
+        const SoftwareRasterStats& stats = renderer.GetStats();
+        std::println("Last frame: {} triangles, {} vertices, {} rasterized, {} binned, geometry {:.3f} ms, binning {:.3f} ms, raster {:.3f} ms",
+            stats.Triangles, stats.Vertices, stats.RasterTriangles, stats.BinnedTriangles,
+            stats.GeometryMs, stats.BinningMs, stats.RasterMs);
+        renderer.SaveFramebuffer(_SoftwareFramebufferPath);
+    }
+
+    const SceneCullStats& culling = _SoftwareFramebufferPath.empty() ?
+        static_cast<const NullRenderer&>(*_Renderer).GetCullStats() :
+        static_cast<const SoftwareRenderer&>(*_Renderer).GetCullStats();
+    std::println("Culling: {}/{} entities, {}/{} meshes, {}/{} terrain tiles visible",
+        culling.Entities.Visible, culling.Entities.Visible + culling.Entities.Culled,
+        culling.Meshes.Visible, culling.Meshes.Visible + culling.Meshes.Culled,
+        culling.TerrainTiles.Visible, culling.TerrainTiles.Visible + culling.TerrainTiles.Culled);
+    const DrawnVertexBytes& vertexBytes = culling.VertexBytes;
+    std::println("Drawn vertices: {} KB, {} KB packed ({} KB static, {} KB skinning)",
+        vertexBytes.Vertex / 1024, (vertexBytes.PackedStatic + vertexBytes.PackedSkin) / 1024,
+        vertexBytes.PackedStatic / 1024, vertexBytes.PackedSkin / 1024);
+
+    if (_Terrain)
+    {
+        const TerrainStats terrain = _Terrain->GetStats();
+        std::println("Terrain: {} resident tiles ({} KB), {} generated, {} evicted",
+            terrain.ResidentTiles, terrain.ResidentBytes / 1024, terrain.GeneratedTiles, terrain.EvictedTiles);
+        std::println("Terrain vertices: {} KB, {} KB packed",
+            terrain.ResidentVertexBytes / 1024, terrain.ResidentPackedVertexBytes / 1024);
+    }
+
+    Shutdown();
+    return 0;
+}
 #endif
@@ -0,0 +1,393 @@
+#pragma once
+
+#include "math/handmade_math.h"
+
+#include <cfloat>
+
+/*
+	NOTE:
+	Bounding volumes and view frustum tests. Frustum planes are stored as
+	structure-of-arrays, padded to eight with planes nothing is behind, so the
+	SIMD tests check four planes per instruction. A box is tested by its
+	center and extents: it is outside a plane when the plane distance of the
+	center plus the extents projected onto the plane normal is negative.
+	Tests are conservative, a volume near a frustum corner may pass.
+*/
+
+struct AABB
+{
+	V3 Min{ FLT_MAX, FLT_MAX, FLT_MAX };
+	V3 Max{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+	bool IsValid() const { return Min.X <= Max.X && Min.Y <= Max.Y && Min.Z <= Max.Z; }
+};
+
+struct BoundingSphere
+{
+	V3 Center{};
+	float Radius{ -1.0f };
+};
+
+// Planes as A * x + B * y + C * z + D >= 0 inside, with unit (A, B, C).
+struct Frustum
+{
+	static constexpr size_t PLANE_COUNT = 6;
+
+	alignas(16) float A[8]{};
+	alignas(16) float B[8]{};
+	alignas(16) float C[8]{};
+	alignas(16) float D[8]{};
+};
+
+inline void ExpandAABB(AABB& box, const V3& point)
+{
+	box.Min = { std::min(box.Min.X, point.X), std::min(box.Min.Y, point.Y), std::min(box.Min.Z, point.Z) };
+	box.Max = { std::max(box.Max.X, point.X), std::max(box.Max.Y, point.Y), std::max(box.Max.Z, point.Z) };
+}
+
+inline AABB MergeAABB(const AABB& a, const AABB& b)
+{
+	AABB result = a;
+	ExpandAABB(result, b.Min);
+	ExpandAABB(result, b.Max);
+	return result;
+}
+
+inline V3 GetCenter(const AABB& box)
+{
+	return (box.Min + box.Max) * 0.5f;
+}
+
+inline V3 GetExtents(const AABB& box)
+{
+	return (box.Max - box.Min) * 0.5f;
+}
+
+inline float GetSurfaceArea(const AABB& box)
+{
+	const V3 size = box.Max - box.Min;
+	return 2.0f * (size.X * size.Y + size.Y * size.Z + size.Z * size.X);
+}
+
+inline bool Overlaps(const AABB& a, const AABB& b)
+{
+	return a.Min.X <= b.Max.X && a.Max.X >= b.Min.X &&
+		a.Min.Y <= b.Max.Y && a.Max.Y >= b.Min.Y &&
+		a.Min.Z <= b.Max.Z && a.Max.Z >= b.Min.Z;
+}
+
+inline bool Contains(const AABB& outer, const AABB& inner)
+{
+	return outer.Min.X <= inner.Min.X && outer.Min.Y <= inner.Min.Y && outer.Min.Z <= inner.Min.Z &&
+		outer.Max.X >= inner.Max.X && outer.Max.Y >= inner.Max.Y && outer.Max.Z >= inner.Max.Z;
+}
+
+inline AABB InflateAABB(const AABB& box, float margin)
+{
+	return { box.Min - V3{ margin, margin, margin }, box.Max + V3{ margin, margin, margin } };
+}
+
+// Distance from point to the closest point of the box, 0 inside it.
+inline float DistanceToAABB(const V3& point, const AABB& box)
+{
+	const V3 outside = {
+		std::max({ box.Min.X - point.X, 0.0f, point.X - box.Max.X }),
+		std::max({ box.Min.Y - point.Y, 0.0f, point.Y - box.Max.Y }),
+		std::max({ box.Min.Z - point.Z, 0.0f, point.Z - box.Max.Z }) };
+	return Length(outside);
+}
+
+// Slab test. On a hit, distance is where the ray enters the box, 0 when it
+// starts inside. direction need not be unit length; distances are in
+// multiples of it.
+inline bool IntersectRayAABB(const V3& origin, const V3& direction, const AABB& box,
+	float maxDistance, float& distance)
+{
+	const float o[3] = { origin.X, origin.Y, origin.Z };
+	const float d[3] = { direction.X, direction.Y, direction.Z };
+	const float lo[3] = { box.Min.X, box.Min.Y, box.Min.Z };
+	const float hi[3] = { box.Max.X, box.Max.Y, box.Max.Z };
+
+	float enter = 0.0f;
+	float exit = maxDistance;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		// Parallel to the slab: inside it or never
+		if (std::abs(d[axis]) < 1e-12f)
+		{
+			if (o[axis] < lo[axis] || o[axis] > hi[axis])
+				return false;
+			continue;
+		}
+
+		const float invDirection = 1.0f / d[axis];
+		float t0 = (lo[axis] - o[axis]) * invDirection;
+		float t1 = (hi[axis] - o[axis]) * invDirection;
+		if (t0 > t1)
+			std::swap(t0, t1);
+
+		enter = std::max(enter, t0);
+		exit = std::min(exit, t1);
+		if (enter > exit)
+			return false;
+	}
+
+	distance = enter;
+	return true;
+}
+
+// Box around the transformed box (Arvo): the center is transformed and each
+// new extent is the absolute matrix applied to the old extents.
+inline AABB TransformAABBScalar(const AABB& box, const M4& m)
+{
+	const V3 center = GetCenter(box);
+	const V3 extents = GetExtents(box);
+
+	const V4 newCenter = TransformV4Scalar(V4{ center.X, center.Y, center.Z, 1.0f }, m);
+	V3 newExtents{};
+	newExtents.X = std::abs(m.M[0][0]) * extents.X + std::abs(m.M[1][0]) * extents.Y + std::abs(m.M[2][0]) * extents.Z;
+	newExtents.Y = std::abs(m.M[0][1]) * extents.X + std::abs(m.M[1][1]) * extents.Y + std::abs(m.M[2][1]) * extents.Z;
+	newExtents.Z = std::abs(m.M[0][2]) * extents.X + std::abs(m.M[1][2]) * extents.Y + std::abs(m.M[2][2]) * extents.Z;
+
+	const V3 c = { newCenter.X, newCenter.Y, newCenter.Z };
+	return { c - newExtents, c + newExtents };
+}
+
+#if HANDMADE_MATH_SSE2
+inline AABB TransformAABBSIMD(const AABB& box, const M4& m)
+{
+	const V3 center = GetCenter(box);
+	const V3 extents = GetExtents(box);
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 row0 = _mm_loadu_ps(m.M[0]);
+	const __m128 row1 = _mm_loadu_ps(m.M[1]);
+	const __m128 row2 = _mm_loadu_ps(m.M[2]);
+
+	__m128 newCenter = SimdMulAdd(_mm_set1_ps(center.X), row0, _mm_loadu_ps(m.M[3]));
+	newCenter = SimdMulAdd(_mm_set1_ps(center.Y), row1, newCenter);
+	newCenter = SimdMulAdd(_mm_set1_ps(center.Z), row2, newCenter);
+
+	__m128 newExtents = _mm_mul_ps(_mm_set1_ps(extents.X), _mm_andnot_ps(signMask, row0));
+	newExtents = SimdMulAdd(_mm_set1_ps(extents.Y), _mm_andnot_ps(signMask, row1), newExtents);
+	newExtents = SimdMulAdd(_mm_set1_ps(extents.Z), _mm_andnot_ps(signMask, row2), newExtents);
+
+	alignas(16) float minimum[4];
+	alignas(16) float maximum[4];
+	_mm_store_ps(minimum, _mm_sub_ps(newCenter, newExtents));
+	_mm_store_ps(maximum, _mm_add_ps(newCenter, newExtents));
+	return { { minimum[0], minimum[1], minimum[2] }, { maximum[0], maximum[1], maximum[2] } };
+}
+#endif
+
+inline AABB TransformAABB(const AABB& box, const M4& m)
+{
+#if HANDMADE_MATH_SSE2
+	return TransformAABBSIMD(box, m);
+#else
+	return TransformAABBScalar(box, m);
+#endif
+}
+
+// The radius grows by the largest axis scale, so it stays conservative under
+// non-uniform scale.
+inline BoundingSphere TransformSphere(const BoundingSphere& sphere, const M4& m)
+{
+	const V4 center = V4{ sphere.Center.X, sphere.Center.Y, sphere.Center.Z, 1.0f } * m;
+	const float scale = std::max({
+		Length(V3{ m.M[0][0], m.M[0][1], m.M[0][2] }),
+		Length(V3{ m.M[1][0], m.M[1][1], m.M[1][2] }),
+		Length(V3{ m.M[2][0], m.M[2][1], m.M[2][2] }) });
+	return { { center.X, center.Y, center.Z }, sphere.Radius * scale };
+}
+
+// Gribb-Hartmann extraction for row vectors (clip = v * M), with clip space z
+// in [0, w] as MatrixPerspective produces.
+inline Frustum ExtractFrustum(const M4& viewProjection)
+{
+	const M4& m = viewProjection;
+	const auto column = [&m](int j) { return V4{ m.M[0][j], m.M[1][j], m.M[2][j], m.M[3][j] }; };
+	const V4 x = column(0);
+	const V4 y = column(1);
+	const V4 z = column(2);
+	const V4 w = column(3);
+
+	// Left, right, bottom, top, near, far
+	const V4 planes[Frustum::PLANE_COUNT] =
+	{
+		{ w.X + x.X, w.Y + x.Y, w.Z + x.Z, w.W + x.W },
+		{ w.X - x.X, w.Y - x.Y, w.Z - x.Z, w.W - x.W },
+		{ w.X + y.X, w.Y + y.Y, w.Z + y.Z, w.W + y.W },
+		{ w.X - y.X, w.Y - y.Y, w.Z - y.Z, w.W - y.W },
+		z,
+		{ w.X - z.X, w.Y - z.Y, w.Z - z.Z, w.W - z.W },
+	};
+
+	Frustum result{};
+	for (size_t i = 0; i < Frustum::PLANE_COUNT; i++)
+	{
+		const float invLength = 1.0f / Length(V3{ planes[i].X, planes[i].Y, planes[i].Z });
+		result.A[i] = planes[i].X * invLength;
+		result.B[i] = planes[i].Y * invLength;
+		result.C[i] = planes[i].Z * invLength;
+		result.D[i] = planes[i].W * invLength;
+	}
+
+	// Padding planes (0, 0, 0, 1) contain everything
+	result.D[6] = 1.0f;
+	result.D[7] = 1.0f;
+	return result;
+}
+
+enum class FrustumTest : uint8_t
+{
+	Outside,
+	Intersects,
+	Inside,
+};
+
+inline bool IsAABBInFrustumScalar(const Frustum& frustum, const AABB& box)
+{
+	const V3 center = GetCenter(box);
+	const V3 extents = GetExtents(box);
+
+	for (size_t i = 0; i < Frustum::PLANE_COUNT; i++)
+	{
+		const float distance = frustum.A[i] * center.X + frustum.B[i] * center.Y + frustum.C[i] * center.Z + frustum.D[i];
+		const float radius = std::abs(frustum.A[i]) * extents.X + std::abs(frustum.B[i]) * extents.Y +
+			std::abs(frustum.C[i]) * extents.Z;
+		if (distance + radius < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+inline FrustumTest ClassifyAABBScalar(const Frustum& frustum, const AABB& box)
+{
+	const V3 center = GetCenter(box);
+	const V3 extents = GetExtents(box);
+
+	FrustumTest result = FrustumTest::Inside;
+	for (size_t i = 0; i < Frustum::PLANE_COUNT; i++)
+	{
+		const float distance = frustum.A[i] * center.X + frustum.B[i] * center.Y + frustum.C[i] * center.Z + frustum.D[i];
+		const float radius = std::abs(frustum.A[i]) * extents.X + std::abs(frustum.B[i]) * extents.Y +
+			std::abs(frustum.C[i]) * extents.Z;
+		if (distance + radius < 0.0f)
+			return FrustumTest::Outside;
+		if (distance - radius < 0.0f)
+			result = FrustumTest::Intersects;
+	}
+	return result;
+}
+
+inline bool IsSphereInFrustumScalar(const Frustum& frustum, const BoundingSphere& sphere)
+{
+	for (size_t i = 0; i < Frustum::PLANE_COUNT; i++)
+	{
+		const float distance = frustum.A[i] * sphere.Center.X + frustum.B[i] * sphere.Center.Y +
+			frustum.C[i] * sphere.Center.Z + frustum.D[i];
+		if (distance + sphere.Radius < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+#if HANDMADE_MATH_SSE2
+inline bool IsAABBInFrustumSIMD(const Frustum& frustum, const AABB& box)
+{
+	const V3 center = GetCenter(box);
+	const V3 extents = GetExtents(box);
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+
+	__m128 outside = _mm_setzero_ps();
+	for (size_t i = 0; i < 8; i += 4)
+	{
+		const __m128 a = _mm_load_ps(frustum.A + i);
+		const __m128 b = _mm_load_ps(frustum.B + i);
+		const __m128 c = _mm_load_ps(frustum.C + i);
+
+		__m128 distance = SimdMulAdd(a, _mm_set1_ps(center.X), _mm_load_ps(frustum.D + i));
+		distance = SimdMulAdd(b, _mm_set1_ps(center.Y), distance);
+		distance = SimdMulAdd(c, _mm_set1_ps(center.Z), distance);
+		distance = SimdMulAdd(_mm_andnot_ps(signMask, a), _mm_set1_ps(extents.X), distance);
+		distance = SimdMulAdd(_mm_andnot_ps(signMask, b), _mm_set1_ps(extents.Y), distance);
+		distance = SimdMulAdd(_mm_andnot_ps(signMask, c), _mm_set1_ps(extents.Z), distance);
+		outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+	}
+	return _mm_movemask_ps(outside) == 0;
+}
+
+inline FrustumTest ClassifyAABBSIMD(const Frustum& frustum, const AABB& box)
+{
+	const V3 center = GetCenter(box);
+	const V3 extents = GetExtents(box);
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+
+	__m128 outside = _mm_setzero_ps();
+	__m128 crossing = _mm_setzero_ps();
+	for (size_t i = 0; i < 8; i += 4)
+	{
+		const __m128 a = _mm_load_ps(frustum.A + i);
+		const __m128 b = _mm_load_ps(frustum.B + i);
+		const __m128 c = _mm_load_ps(frustum.C + i);
+
+		__m128 distance = SimdMulAdd(a, _mm_set1_ps(center.X), _mm_load_ps(frustum.D + i));
+		distance = SimdMulAdd(b, _mm_set1_ps(center.Y), distance);
+		distance = SimdMulAdd(c, _mm_set1_ps(center.Z), distance);
+
+		__m128 radius = _mm_mul_ps(_mm_andnot_ps(signMask, a), _mm_set1_ps(extents.X));
+		radius = SimdMulAdd(_mm_andnot_ps(signMask, b), _mm_set1_ps(extents.Y), radius);
+		radius = SimdMulAdd(_mm_andnot_ps(signMask, c), _mm_set1_ps(extents.Z), radius);
+
+		outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+		crossing = _mm_or_ps(crossing, _mm_cmplt_ps(_mm_sub_ps(distance, radius), _mm_setzero_ps()));
+	}
+
+	if (_mm_movemask_ps(outside))
+		return FrustumTest::Outside;
+	return _mm_movemask_ps(crossing) ? FrustumTest::Intersects : FrustumTest::Inside;
+}
+
+inline bool IsSphereInFrustumSIMD(const Frustum& frustum, const BoundingSphere& sphere)
+{
+	__m128 outside = _mm_setzero_ps();
+	for (size_t i = 0; i < 8; i += 4)
+	{
+		__m128 distance = SimdMulAdd(_mm_load_ps(frustum.A + i), _mm_set1_ps(sphere.Center.X),
+			_mm_add_ps(_mm_load_ps(frustum.D + i), _mm_set1_ps(sphere.Radius)));
+		distance = SimdMulAdd(_mm_load_ps(frustum.B + i), _mm_set1_ps(sphere.Center.Y), distance);
+		distance = SimdMulAdd(_mm_load_ps(frustum.C + i), _mm_set1_ps(sphere.Center.Z), distance);
+		outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+	}
+	return _mm_movemask_ps(outside) == 0;
+}
+#endif
+
+inline bool IsAABBInFrustum(const Frustum& frustum, const AABB& box)
+{
+#if HANDMADE_MATH_SSE2
+	return IsAABBInFrustumSIMD(frustum, box);
+#else
+	return IsAABBInFrustumScalar(frustum, box);
+#endif
+}
+
+// Inside means the whole box is, which lets a hierarchy skip the tests
+// below that node.
+inline FrustumTest ClassifyAABB(const Frustum& frustum, const AABB& box)
+{
+#if HANDMADE_MATH_SSE2
+	return ClassifyAABBSIMD(frustum, box);
+#else
+	return ClassifyAABBScalar(frustum, box);
+#endif
+}
+
+inline bool IsSphereInFrustum(const Frustum& frustum, const BoundingSphere& sphere)
+{
+#if HANDMADE_MATH_SSE2
+	return IsSphereInFrustumSIMD(frustum, sphere);
+#else
+	return IsSphereInFrustumScalar(frustum, sphere);
+#endif
+}
@@ -2,6 +2,20 @@
 
 #include <cmath>
 
+// SIMD backend selection. The scalar routines are always compiled and serve as
+// the reference implementation; define HANDMADE_MATH_NO_SIMD to force them.
+#if !defined(HANDMADE_MATH_NO_SIMD)
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define HANDMADE_MATH_SSE2 1
+		#include <emmintrin.h>
+	#endif
+	// MSVC only defines __AVX2__ for /arch:AVX2, which also enables FMA3.
+	#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+		#define HANDMADE_MATH_AVX2 1
+		#include <immintrin.h>
+	#endif
+#endif
+
 static constexpr float PI_32 = 3.14159265359f;
 
 struct V2
@@ -29,6 +43,13 @@ struct M4
 	float M[4][4] = { 0 };
 };
 
+// Affine transform with the implicit last column (0, 0, 0, 1).
+// Rows 0-2 are the basis, row 3 the translation (row-vector convention, like M4).
+struct M4x3
+{
+	float M[4][3] = { 0 };
+};
+
 inline float DegreesToRadians(const float degrees)
 {
 	// 3.14159265359f / 180.0f = 0.01745329252f
@@ -334,7 +355,8 @@ inline M4 operator-(const M4& a, const M4& b)
 	return result;
 }
 
-inline M4 operator*(const M4& a, const M4& b)
+// Reference implementation, kept for validating the SIMD paths.
+inline M4 MatrixMultiplyScalar(const M4& a, const M4& b)
 {
     M4 result = {};
     for (int i = 0; i < 4; i++) 
@@ -348,7 +370,198 @@ inline M4 operator*(const M4& a, const M4& b)
         }
     }
     return result;
-}			
+}
+
+#if HANDMADE_MATH_SSE2
+inline M4 MatrixMultiplySSE2(const M4& a, const M4& b)
+{
+	M4 result;
+
+	const __m128 b0 = _mm_loadu_ps(b.M[0]);
+	const __m128 b1 = _mm_loadu_ps(b.M[1]);
+	const __m128 b2 = _mm_loadu_ps(b.M[2]);
+	const __m128 b3 = _mm_loadu_ps(b.M[3]);
+
+	// Each result row is a linear combination of the rows of b.
+	for (int i = 0; i < 4; i++)
+	{
+		__m128 row = _mm_mul_ps(_mm_set1_ps(a.M[i][0]), b0);
+		row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.M[i][1]), b1));
+		row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.M[i][2]), b2));
+		row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.M[i][3]), b3));
+		_mm_storeu_ps(result.M[i], row);
+	}
+
+	return result;
+}
+#endif
+
+#if HANDMADE_MATH_AVX2
+inline M4 MatrixMultiplyAVX2(const M4& a, const M4& b)
+{
+	M4 result;
+
+	// Rows of b duplicated into both 128-bit lanes.
+	const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b.M[0]));
+	const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b.M[1]));
+	const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b.M[2]));
+	const __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b.M[3]));
+
+	// Two rows of a per iteration, one in each lane.
+	for (int i = 0; i < 4; i += 2)
+	{
+		const __m256 rows = _mm256_loadu_ps(a.M[i]);
+
+		__m256 row = _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0x00), b0);
+		row = _mm256_fmadd_ps(_mm256_shuffle_ps(rows, rows, 0x55), b1, row);
+		row = _mm256_fmadd_ps(_mm256_shuffle_ps(rows, rows, 0xAA), b2, row);
+		row = _mm256_fmadd_ps(_mm256_shuffle_ps(rows, rows, 0xFF), b3, row);
+		_mm256_storeu_ps(result.M[i], row);
+	}
+
+	return result;
+}
+#endif
+
+inline M4 operator*(const M4& a, const M4& b)
+{
+#if HANDMADE_MATH_AVX2
+	return MatrixMultiplyAVX2(a, b);
+#elif HANDMADE_MATH_SSE2
+	return MatrixMultiplySSE2(a, b);
+#else
+	return MatrixMultiplyScalar(a, b);
+#endif
+}
+
+// Transforms a row vector: result = v * m.
+inline V4 TransformV4Scalar(const V4& v, const M4& m)
+{
+	V4 result = {};
+	result.X = v.X * m.M[0][0] + v.Y * m.M[1][0] + v.Z * m.M[2][0] + v.W * m.M[3][0];
+	result.Y = v.X * m.M[0][1] + v.Y * m.M[1][1] + v.Z * m.M[2][1] + v.W * m.M[3][1];
+	result.Z = v.X * m.M[0][2] + v.Y * m.M[1][2] + v.Z * m.M[2][2] + v.W * m.M[3][2];
+	result.W = v.X * m.M[0][3] + v.Y * m.M[1][3] + v.Z * m.M[2][3] + v.W * m.M[3][3];
+	return result;
+}
+
+#if HANDMADE_MATH_SSE2
+// a * b + c, fused when the AVX2/FMA backend is enabled.
+inline __m128 SimdMulAdd(const __m128 a, const __m128 b, const __m128 c)
+{
+#if HANDMADE_MATH_AVX2
+	return _mm_fmadd_ps(a, b, c);
+#else
+	return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+inline V4 TransformV4SIMD(const V4& v, const M4& m)
+{
+	__m128 row = _mm_mul_ps(_mm_set1_ps(v.X), _mm_loadu_ps(m.M[0]));
+	row = SimdMulAdd(_mm_set1_ps(v.Y), _mm_loadu_ps(m.M[1]), row);
+	row = SimdMulAdd(_mm_set1_ps(v.Z), _mm_loadu_ps(m.M[2]), row);
+	row = SimdMulAdd(_mm_set1_ps(v.W), _mm_loadu_ps(m.M[3]), row);
+
+	V4 result;
+	_mm_storeu_ps(&result.X, row);
+	return result;
+}
+#endif
+
+// Scalar even with a SIMD backend: for a single vector the broadcasts cost
+// what the 4-wide multiply saves, and MathKernels measures no gain.
+inline V4 operator*(const V4& v, const M4& m)
+{
+	return TransformV4Scalar(v, m);
+}
+
+// Transforms points (w = 1) by an affine matrix. No perspective divide is done.
+inline void TransformPointsScalar(const M4& m, std::span<const V3> in, std::span<V3> out)
+{
+	Assert(out.size() >= in.size());
+
+	for (size_t i = 0; i < in.size(); i++)
+	{
+		const V3 p = in[i];
+		out[i].X = p.X * m.M[0][0] + p.Y * m.M[1][0] + p.Z * m.M[2][0] + m.M[3][0];
+		out[i].Y = p.X * m.M[0][1] + p.Y * m.M[1][1] + p.Z * m.M[2][1] + m.M[3][1];
+		out[i].Z = p.X * m.M[0][2] + p.Y * m.M[1][2] + p.Z * m.M[2][2] + m.M[3][2];
+	}
+}
+
+#if HANDMADE_MATH_SSE2
+// Processes four points per iteration by transposing xyz|xyz|xyz|xyz into
+// xxxx|yyyy|zzzz, so every lane does useful work and no V3 is overrun.
+inline void TransformPointsSIMD(const M4& m, std::span<const V3> in, std::span<V3> out)
+{
+	Assert(out.size() >= in.size());
+
+	const __m128 m00 = _mm_set1_ps(m.M[0][0]), m01 = _mm_set1_ps(m.M[0][1]), m02 = _mm_set1_ps(m.M[0][2]);
+	const __m128 m10 = _mm_set1_ps(m.M[1][0]), m11 = _mm_set1_ps(m.M[1][1]), m12 = _mm_set1_ps(m.M[1][2]);
+	const __m128 m20 = _mm_set1_ps(m.M[2][0]), m21 = _mm_set1_ps(m.M[2][1]), m22 = _mm_set1_ps(m.M[2][2]);
+	const __m128 m30 = _mm_set1_ps(m.M[3][0]), m31 = _mm_set1_ps(m.M[3][1]), m32 = _mm_set1_ps(m.M[3][2]);
+
+	const size_t count = in.size();
+	const float* src = &in.data()->X;
+	float* dst = &out.data()->X;
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4, src += 12, dst += 12)
+	{
+		const __m128 a0 = _mm_loadu_ps(src + 0);	// x0 y0 z0 x1
+		const __m128 a1 = _mm_loadu_ps(src + 4);	// y1 z1 x2 y2
+		const __m128 a2 = _mm_loadu_ps(src + 8);	// z2 x3 y3 z3
+
+		const __m128 x = _mm_shuffle_ps(a0, _mm_shuffle_ps(a1, a2, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+		const __m128 y = _mm_shuffle_ps(_mm_shuffle_ps(a0, a1, _MM_SHUFFLE(0, 0, 1, 1)),
+										_mm_shuffle_ps(a1, a2, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+		const __m128 z = _mm_shuffle_ps(_mm_shuffle_ps(a0, a1, _MM_SHUFFLE(1, 1, 2, 2)),
+										_mm_shuffle_ps(a2, a2, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+
+		const __m128 rx = SimdMulAdd(x, m00, SimdMulAdd(y, m10, SimdMulAdd(z, m20, m30)));
+		const __m128 ry = SimdMulAdd(x, m01, SimdMulAdd(y, m11, SimdMulAdd(z, m21, m31)));
+		const __m128 rz = SimdMulAdd(x, m02, SimdMulAdd(y, m12, SimdMulAdd(z, m22, m32)));
+
+		const __m128 o0 = _mm_shuffle_ps(_mm_shuffle_ps(rx, ry, _MM_SHUFFLE(0, 0, 0, 0)),
+										 _mm_shuffle_ps(rz, rx, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+		const __m128 o1 = _mm_shuffle_ps(_mm_shuffle_ps(ry, rz, _MM_SHUFFLE(1, 1, 1, 1)),
+										 _mm_shuffle_ps(rx, ry, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+		const __m128 o2 = _mm_shuffle_ps(_mm_shuffle_ps(rz, rx, _MM_SHUFFLE(3, 3, 2, 2)),
+										 _mm_shuffle_ps(ry, rz, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+
+		_mm_storeu_ps(dst + 0, o0);
+		_mm_storeu_ps(dst + 4, o1);
+		_mm_storeu_ps(dst + 8, o2);
+	}
+
+	if (i < count)
+		TransformPointsScalar(m, in.subspan(i), out.subspan(i));
+}
+#endif
+
+inline void TransformPoints(const M4& m, std::span<const V3> in, std::span<V3> out)
+{
+#if HANDMADE_MATH_SSE2
+	TransformPointsSIMD(m, in, out);
+#else
+	TransformPointsScalar(m, in, out);
+#endif
+}
+
+inline bool operator==(const M4& a, const M4& b)
+{
+	for (int i = 0; i < 4; i++)
+		for (int j = 0; j < 4; j++)
+			if (a.M[i][j] != b.M[i][j])
+				return false;
+	return true;
+}
+
+inline bool operator!=(const M4& a, const M4& b)
+{
+	return !(a == b);
+}
 
 inline M4 MatrixTranspose(const M4& in)
 {
@@ -593,3 +806,133 @@ inline M4 MatrixFromQuaternion(const Quat& q)
 
 	return result;
 }
+
+//////////////////////////////////////////////////////////////////////////////
+//								AFFINE 4x3									//
+//////////////////////////////////////////////////////////////////////////////
+
+// Equivalent to MatrixScaling * transposed MatrixFromQuaternion * MatrixTranslation
+// for v * M, built directly without any matrix products.
+// NOTE: Rotation must be normalized.
+inline M4x3 AffineFromTRS(const V3& translation, const Quat& rotation, const V3& scale)
+{
+	const Quat& q = rotation;
+	const float xx = q.X * q.X;
+	const float yy = q.Y * q.Y;
+	const float zz = q.Z * q.Z;
+	const float xy = q.X * q.Y;
+	const float xz = q.X * q.Z;
+	const float yz = q.Y * q.Z;
+	const float wx = q.W * q.X;
+	const float wy = q.W * q.Y;
+	const float wz = q.W * q.Z;
+
+	M4x3 result;
+
+	result.M[0][0] = (1.0f - 2.0f * (yy + zz)) * scale.X;
+	result.M[0][1] = (2.0f * (xy + wz)) * scale.X;
+	result.M[0][2] = (2.0f * (xz - wy)) * scale.X;
+
+	result.M[1][0] = (2.0f * (xy - wz)) * scale.Y;
+	result.M[1][1] = (1.0f - 2.0f * (xx + zz)) * scale.Y;
+	result.M[1][2] = (2.0f * (yz + wx)) * scale.Y;
+
+	result.M[2][0] = (2.0f * (xz + wy)) * scale.Z;
+	result.M[2][1] = (2.0f * (yz - wx)) * scale.Z;
+	result.M[2][2] = (1.0f - 2.0f * (xx + yy)) * scale.Z;
+
+	result.M[3][0] = translation.X;
+	result.M[3][1] = translation.Y;
+	result.M[3][2] = translation.Z;
+
+	return result;
+}
+
+// Applies a, then b. 36 multiplies instead of the 64 of a full M4 product.
+inline M4x3 AffineMultiplyScalar(const M4x3& a, const M4x3& b)
+{
+	M4x3 result;
+	for (int i = 0; i < 4; ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+		{
+			result.M[i][j] =
+				a.M[i][0] * b.M[0][j] +
+				a.M[i][1] * b.M[1][j] +
+				a.M[i][2] * b.M[2][j];
+		}
+	}
+
+	result.M[3][0] += b.M[3][0];
+	result.M[3][1] += b.M[3][1];
+	result.M[3][2] += b.M[3][2];
+
+	return result;
+}
+
+#if HANDMADE_MATH_SSE2
+inline M4x3 AffineMultiplySSE2(const M4x3& a, const M4x3& b)
+{
+	M4x3 result;
+
+	// Basis rows of b, 4 wide. The extra lane is the first element of the
+	// next row: it is carried along but never kept.
+	const __m128 b0 = _mm_loadu_ps(b.M[0]);
+	const __m128 b1 = _mm_loadu_ps(b.M[1]);
+	const __m128 b2 = _mm_loadu_ps(b.M[2]);
+
+	__m128 rows[4];
+	for (int i = 0; i < 4; i++)
+	{
+		rows[i] = _mm_mul_ps(_mm_set1_ps(a.M[i][0]), b0);
+		rows[i] = SimdMulAdd(_mm_set1_ps(a.M[i][1]), b1, rows[i]);
+		rows[i] = SimdMulAdd(_mm_set1_ps(a.M[i][2]), b2, rows[i]);
+	}
+	rows[3] = _mm_add_ps(rows[3], _mm_setr_ps(b.M[3][0], b.M[3][1], b.M[3][2], 0.0f));
+
+	// In order, so each 4-wide store's extra lane is overwritten by the next
+	// row. The last row is stored 3 wide to stay inside result.
+	_mm_storeu_ps(result.M[0], rows[0]);
+	_mm_storeu_ps(result.M[1], rows[1]);
+	_mm_storeu_ps(result.M[2], rows[2]);
+	_mm_storel_pi(reinterpret_cast<__m64*>(result.M[3]), rows[3]);
+	_mm_store_ss(&result.M[3][2], _mm_movehl_ps(rows[3], rows[3]));
+
+	return result;
+}
+#endif
+
+inline M4x3 operator*(const M4x3& a, const M4x3& b)
+{
+#if HANDMADE_MATH_SSE2
+	return AffineMultiplySSE2(a, b);
+#else
+	return AffineMultiplyScalar(a, b);
+#endif
+}
+
+// Drops the last column, which must be (0, 0, 0, 1).
+inline M4x3 AffineFromM4(const M4& m)
+{
+	M4x3 result;
+	for (int i = 0; i < 4; ++i)
+	{
+		result.M[i][0] = m.M[i][0];
+		result.M[i][1] = m.M[i][1];
+		result.M[i][2] = m.M[i][2];
+	}
+	return result;
+}
+
+inline M4 M4FromAffine(const M4x3& m)
+{
+	M4 result;
+	for (int i = 0; i < 4; ++i)
+	{
+		result.M[i][0] = m.M[i][0];
+		result.M[i][1] = m.M[i][1];
+		result.M[i][2] = m.M[i][2];
+	}
+	result.M[3][3] = 1.0f;
+	return result;
+}
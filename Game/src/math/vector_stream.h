@@ -0,0 +1,440 @@
+#pragma once
+
+#include "math/handmade_math.h"
+
+/*
+	NOTE:
+	Structure-of-arrays counterparts to V3 and Quat. With the SSE2 backend
+	every kernel below handles four elements per iteration with explicit
+	intrinsics, since GCC -O2 and MSVC leave these multi-array loops scalar;
+	the scalar loop that follows finishes the tail and is the whole kernel
+	otherwise. Each element is read before it is written, so outputs may
+	alias inputs.
+*/
+
+#if HANDMADE_MATH_SSE2
+// mask ? a : b, per lane. SSE2 has no blendv.
+inline __m128 SimdSelect(const __m128 mask, const __m128 a, const __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// 1 / |v| for lengthSq > 0, else 0, so zero vectors stay zero.
+inline __m128 SimdInverseLength(const __m128 lengthSq)
+{
+	const __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(lengthSq));
+	return _mm_and_ps(_mm_cmpgt_ps(lengthSq, _mm_setzero_ps()), inv);
+}
+
+// sin(x) for x in [0, pi/2], Taylor series to x^11. Absolute error < 1e-7.
+inline __m128 SimdSinHalfPi(const __m128 x)
+{
+	const __m128 x2 = _mm_mul_ps(x, x);
+	__m128 p = _mm_set1_ps(-1.0f / 39916800.0f);
+	p = SimdMulAdd(p, x2, _mm_set1_ps(1.0f / 362880.0f));
+	p = SimdMulAdd(p, x2, _mm_set1_ps(-1.0f / 5040.0f));
+	p = SimdMulAdd(p, x2, _mm_set1_ps(1.0f / 120.0f));
+	p = SimdMulAdd(p, x2, _mm_set1_ps(-1.0f / 6.0f));
+	return SimdMulAdd(_mm_mul_ps(p, x2), x, x);
+}
+
+// acos(x) for x in [0, 1], through the Cephes asinf polynomial:
+// acos(x) = pi/2 - asin(x) up to 0.5, 2 asin(sqrt((1 - x) / 2)) above.
+inline __m128 SimdAcosPositive(const __m128 x)
+{
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 upper = _mm_cmpgt_ps(x, half);
+	const __m128 a = SimdSelect(upper, _mm_sqrt_ps(_mm_mul_ps(half, _mm_sub_ps(_mm_set1_ps(1.0f), x))), x);
+
+	const __m128 z = _mm_mul_ps(a, a);
+	__m128 p = _mm_set1_ps(4.2163199048e-2f);
+	p = SimdMulAdd(p, z, _mm_set1_ps(2.4181311049e-2f));
+	p = SimdMulAdd(p, z, _mm_set1_ps(4.5470025998e-2f));
+	p = SimdMulAdd(p, z, _mm_set1_ps(7.4953002686e-2f));
+	p = SimdMulAdd(p, z, _mm_set1_ps(1.6666752422e-1f));
+	const __m128 asin = SimdMulAdd(_mm_mul_ps(p, z), a, a);
+
+	return SimdSelect(upper, _mm_add_ps(asin, asin), _mm_sub_ps(_mm_set1_ps(PI_32 * 0.5f), asin));
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+//								V3 STREAM									//
+//////////////////////////////////////////////////////////////////////////////
+
+struct V3Stream
+{
+	std::vector<float> X{};
+	std::vector<float> Y{};
+	std::vector<float> Z{};
+
+	size_t Size() const { return X.size(); }
+
+	void Resize(const size_t count)
+	{
+		X.resize(count);
+		Y.resize(count);
+		Z.resize(count);
+	}
+
+	V3 Get(const size_t i) const { return { X[i], Y[i], Z[i] }; }
+
+	void Set(const size_t i, const V3& v)
+	{
+		X[i] = v.X;
+		Y[i] = v.Y;
+		Z[i] = v.Z;
+	}
+};
+
+inline V3Stream ToV3Stream(std::span<const V3> values)
+{
+	V3Stream result{};
+	result.Resize(values.size());
+	for (size_t i = 0; i < values.size(); i++)
+		result.Set(i, values[i]);
+	return result;
+}
+
+inline void FromV3Stream(const V3Stream& stream, std::span<V3> out)
+{
+	Assert(out.size() >= stream.Size());
+	for (size_t i = 0; i < stream.Size(); i++)
+		out[i] = stream.Get(i);
+}
+
+inline void V3StreamAdd(const V3Stream& a, const V3Stream& b, V3Stream& out)
+{
+	Assert(a.Size() == b.Size());
+	const size_t count = a.Size();
+	out.Resize(count);
+
+	const float *ax = a.X.data(), *ay = a.Y.data(), *az = a.Z.data();
+	const float *bx = b.X.data(), *by = b.Y.data(), *bz = b.Z.data();
+	float *ox = out.X.data(), *oy = out.Y.data(), *oz = out.Z.data();
+
+	size_t i = 0;
+#if HANDMADE_MATH_SSE2
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_ps(ox + i, _mm_add_ps(_mm_loadu_ps(ax + i), _mm_loadu_ps(bx + i)));
+		_mm_storeu_ps(oy + i, _mm_add_ps(_mm_loadu_ps(ay + i), _mm_loadu_ps(by + i)));
+		_mm_storeu_ps(oz + i, _mm_add_ps(_mm_loadu_ps(az + i), _mm_loadu_ps(bz + i)));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		ox[i] = ax[i] + bx[i];
+		oy[i] = ay[i] + by[i];
+		oz[i] = az[i] + bz[i];
+	}
+}
+
+// Component-wise multiply.
+inline void V3StreamMul(const V3Stream& a, const V3Stream& b, V3Stream& out)
+{
+	Assert(a.Size() == b.Size());
+	const size_t count = a.Size();
+	out.Resize(count);
+
+	const float *ax = a.X.data(), *ay = a.Y.data(), *az = a.Z.data();
+	const float *bx = b.X.data(), *by = b.Y.data(), *bz = b.Z.data();
+	float *ox = out.X.data(), *oy = out.Y.data(), *oz = out.Z.data();
+
+	size_t i = 0;
+#if HANDMADE_MATH_SSE2
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_ps(ox + i, _mm_mul_ps(_mm_loadu_ps(ax + i), _mm_loadu_ps(bx + i)));
+		_mm_storeu_ps(oy + i, _mm_mul_ps(_mm_loadu_ps(ay + i), _mm_loadu_ps(by + i)));
+		_mm_storeu_ps(oz + i, _mm_mul_ps(_mm_loadu_ps(az + i), _mm_loadu_ps(bz + i)));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		ox[i] = ax[i] * bx[i];
+		oy[i] = ay[i] * by[i];
+		oz[i] = az[i] * bz[i];
+	}
+}
+
+inline void V3StreamMul(const V3Stream& a, const float s, V3Stream& out)
+{
+	const size_t count = a.Size();
+	out.Resize(count);
+
+	const float *ax = a.X.data(), *ay = a.Y.data(), *az = a.Z.data();
+	float *ox = out.X.data(), *oy = out.Y.data(), *oz = out.Z.data();
+
+	size_t i = 0;
+#if HANDMADE_MATH_SSE2
+	const __m128 scale = _mm_set1_ps(s);
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_ps(ox + i, _mm_mul_ps(_mm_loadu_ps(ax + i), scale));
+		_mm_storeu_ps(oy + i, _mm_mul_ps(_mm_loadu_ps(ay + i), scale));
+		_mm_storeu_ps(oz + i, _mm_mul_ps(_mm_loadu_ps(az + i), scale));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		ox[i] = ax[i] * s;
+		oy[i] = ay[i] * s;
+		oz[i] = az[i] * s;
+	}
+}
+
+inline void V3StreamDot(const V3Stream& a, const V3Stream& b, std::span<float> out)
+{
+	Assert(a.Size() == b.Size() && out.size() >= a.Size());
+	const size_t count = a.Size();
+
+	const float *ax = a.X.data(), *ay = a.Y.data(), *az = a.Z.data();
+	const float *bx = b.X.data(), *by = b.Y.data(), *bz = b.Z.data();
+	float* o = out.data();
+
+	size_t i = 0;
+#if HANDMADE_MATH_SSE2
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 dot = _mm_mul_ps(_mm_loadu_ps(ax + i), _mm_loadu_ps(bx + i));
+		dot = SimdMulAdd(_mm_loadu_ps(ay + i), _mm_loadu_ps(by + i), dot);
+		dot = SimdMulAdd(_mm_loadu_ps(az + i), _mm_loadu_ps(bz + i), dot);
+		_mm_storeu_ps(o + i, dot);
+	}
+#endif
+	for (; i < count; i++)
+		o[i] = ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i];
+}
+
+inline void V3StreamCross(const V3Stream& a, const V3Stream& b, V3Stream& out)
+{
+	Assert(a.Size() == b.Size());
+	const size_t count = a.Size();
+	out.Resize(count);
+
+	const float *ax = a.X.data(), *ay = a.Y.data(), *az = a.Z.data();
+	const float *bx = b.X.data(), *by = b.Y.data(), *bz = b.Z.data();
+	float *ox = out.X.data(), *oy = out.Y.data(), *oz = out.Z.data();
+
+	size_t i = 0;
+#if HANDMADE_MATH_SSE2
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 x1 = _mm_loadu_ps(ax + i), y1 = _mm_loadu_ps(ay + i), z1 = _mm_loadu_ps(az + i);
+		const __m128 x2 = _mm_loadu_ps(bx + i), y2 = _mm_loadu_ps(by + i), z2 = _mm_loadu_ps(bz + i);
+		_mm_storeu_ps(ox + i, _mm_sub_ps(_mm_mul_ps(y1, z2), _mm_mul_ps(z1, y2)));
+		_mm_storeu_ps(oy + i, _mm_sub_ps(_mm_mul_ps(z1, x2), _mm_mul_ps(x1, z2)));
+		_mm_storeu_ps(oz + i, _mm_sub_ps(_mm_mul_ps(x1, y2), _mm_mul_ps(y1, x2)));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		const float x = ay[i] * bz[i] - az[i] * by[i];
+		const float y = az[i] * bx[i] - ax[i] * bz[i];
+		const float z = ax[i] * by[i] - ay[i] * bx[i];
+		ox[i] = x;
+		oy[i] = y;
+		oz[i] = z;
+	}
+}
+
+// Zero-length vectors stay zero, matching Normalize(V3).
+inline void V3StreamNormalize(const V3Stream& a, V3Stream& out)
+{
+	const size_t count = a.Size();
+	out.Resize(count);
+
+	const float *ax = a.X.data(), *ay = a.Y.data(), *az = a.Z.data();
+	float *ox = out.X.data(), *oy = out.Y.data(), *oz = out.Z.data();
+
+	size_t i = 0;
+#if HANDMADE_MATH_SSE2
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(ax + i), y = _mm_loadu_ps(ay + i), z = _mm_loadu_ps(az + i);
+		const __m128 lengthSq = SimdMulAdd(z, z, SimdMulAdd(y, y, _mm_mul_ps(x, x)));
+		const __m128 inv = SimdInverseLength(lengthSq);
+		_mm_storeu_ps(ox + i, _mm_mul_ps(x, inv));
+		_mm_storeu_ps(oy + i, _mm_mul_ps(y, inv));
+		_mm_storeu_ps(oz + i, _mm_mul_ps(z, inv));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		const float lengthSq = ax[i] * ax[i] + ay[i] * ay[i] + az[i] * az[i];
+		const float inv = lengthSq > 0.0f ? 1.0f / sqrtf(lengthSq) : 0.0f;
+		ox[i] = ax[i] * inv;
+		oy[i] = ay[i] * inv;
+		oz[i] = az[i] * inv;
+	}
+}
+
+// Per-element interpolation factors, e.g. one keyframe t per bone.
+inline void V3StreamLerp(const V3Stream& from, const V3Stream& to,
+	std::span<const float> t, V3Stream& out)
+{
+	Assert(from.Size() == to.Size() && t.size() >= from.Size());
+	const size_t count = from.Size();
+	out.Resize(count);
+
+	const float *fx = from.X.data(), *fy = from.Y.data(), *fz = from.Z.data();
+	const float *tx = to.X.data(), *ty = to.Y.data(), *tz = to.Z.data();
+	const float* factors = t.data();
+	float *ox = out.X.data(), *oy = out.Y.data(), *oz = out.Z.data();
+
+	size_t i = 0;
+#if HANDMADE_MATH_SSE2
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 s = _mm_loadu_ps(factors + i);
+		const __m128 x = _mm_loadu_ps(fx + i), y = _mm_loadu_ps(fy + i), z = _mm_loadu_ps(fz + i);
+		_mm_storeu_ps(ox + i, SimdMulAdd(_mm_sub_ps(_mm_loadu_ps(tx + i), x), s, x));
+		_mm_storeu_ps(oy + i, SimdMulAdd(_mm_sub_ps(_mm_loadu_ps(ty + i), y), s, y));
+		_mm_storeu_ps(oz + i, SimdMulAdd(_mm_sub_ps(_mm_loadu_ps(tz + i), z), s, z));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		ox[i] = fx[i] + (tx[i] - fx[i]) * factors[i];
+		oy[i] = fy[i] + (ty[i] - fy[i]) * factors[i];
+		oz[i] = fz[i] + (tz[i] - fz[i]) * factors[i];
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//								QUAT STREAM									//
+//////////////////////////////////////////////////////////////////////////////
+
+struct QuatStream
+{
+	std::vector<float> X{};
+	std::vector<float> Y{};
+	std::vector<float> Z{};
+	std::vector<float> W{};
+
+	size_t Size() const { return X.size(); }
+
+	void Resize(const size_t count)
+	{
+		X.resize(count);
+		Y.resize(count);
+		Z.resize(count);
+		W.resize(count);
+	}
+
+	Quat Get(const size_t i) const { return { X[i], Y[i], Z[i], W[i] }; }
+
+	void Set(const size_t i, const Quat& q)
+	{
+		X[i] = q.X;
+		Y[i] = q.Y;
+		Z[i] = q.Z;
+		W[i] = q.W;
+	}
+};
+
+inline QuatStream ToQuatStream(std::span<const Quat> values)
+{
+	QuatStream result{};
+	result.Resize(values.size());
+	for (size_t i = 0; i < values.size(); i++)
+		result.Set(i, values[i]);
+	return result;
+}
+
+inline void FromQuatStream(const QuatStream& stream, std::span<Quat> out)
+{
+	Assert(out.size() >= stream.Size());
+	for (size_t i = 0; i < stream.Size(); i++)
+		out[i] = stream.Get(i);
+}
+
+// Same result as Slerp() per element. Both the slerp and lerp weights are
+// computed and selected, so the loop has no data-dependent branches. The
+// SSE2 path leaves out Slerp()'s division by sin(theta): it scales both
+// weights alike and the final normalize removes it.
+inline void QuatStreamSlerp(const QuatStream& from, const QuatStream& to,
+	std::span<const float> t, QuatStream& out)
+{
+	Assert(from.Size() == to.Size() && t.size() >= from.Size());
+	const size_t count = from.Size();
+	out.Resize(count);
+
+	const float *fx = from.X.data(), *fy = from.Y.data(), *fz = from.Z.data(), *fw = from.W.data();
+	const float *tx = to.X.data(), *ty = to.Y.data(), *tz = to.Z.data(), *tw = to.W.data();
+	const float* factors = t.data();
+	float *ox = out.X.data(), *oy = out.Y.data(), *oz = out.Z.data(), *ow = out.W.data();
+
+	const float epsilon = 1e-5f;
+
+	size_t i = 0;
+#if HANDMADE_MATH_SSE2
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 x1 = _mm_loadu_ps(fx + i), y1 = _mm_loadu_ps(fy + i);
+		const __m128 z1 = _mm_loadu_ps(fz + i), w1 = _mm_loadu_ps(fw + i);
+		const __m128 x2 = _mm_loadu_ps(tx + i), y2 = _mm_loadu_ps(ty + i);
+		const __m128 z2 = _mm_loadu_ps(tz + i), w2 = _mm_loadu_ps(tw + i);
+		const __m128 s = _mm_loadu_ps(factors + i);
+
+		const __m128 rawDot = SimdMulAdd(w1, w2, SimdMulAdd(z1, z2, SimdMulAdd(y1, y2, _mm_mul_ps(x1, x2))));
+
+		// Take the shortest path
+		const __m128 sign = _mm_and_ps(rawDot, signBit);
+		const __m128 dot = _mm_min_ps(_mm_xor_ps(rawDot, sign), one);
+
+		const __m128 theta = SimdAcosPositive(dot);
+		const __m128 nearlyEqual = _mm_cmpgt_ps(dot, _mm_set1_ps(1.0f - epsilon));
+		const __m128 rest = _mm_sub_ps(one, s);
+
+		const __m128 weightFrom = SimdSelect(nearlyEqual, rest, SimdSinHalfPi(_mm_mul_ps(rest, theta)));
+		const __m128 weightTo = _mm_xor_ps(SimdSelect(nearlyEqual, s, SimdSinHalfPi(_mm_mul_ps(s, theta))), sign);
+
+		const __m128 x = SimdMulAdd(x2, weightTo, _mm_mul_ps(x1, weightFrom));
+		const __m128 y = SimdMulAdd(y2, weightTo, _mm_mul_ps(y1, weightFrom));
+		const __m128 z = SimdMulAdd(z2, weightTo, _mm_mul_ps(z1, weightFrom));
+		const __m128 w = SimdMulAdd(w2, weightTo, _mm_mul_ps(w1, weightFrom));
+
+		const __m128 lengthSq = SimdMulAdd(w, w, SimdMulAdd(z, z, SimdMulAdd(y, y, _mm_mul_ps(x, x))));
+		const __m128 inv = SimdInverseLength(lengthSq);
+
+		// A zero result becomes the identity
+		_mm_storeu_ps(ox + i, _mm_mul_ps(x, inv));
+		_mm_storeu_ps(oy + i, _mm_mul_ps(y, inv));
+		_mm_storeu_ps(oz + i, _mm_mul_ps(z, inv));
+		_mm_storeu_ps(ow + i, SimdSelect(_mm_cmpgt_ps(lengthSq, _mm_setzero_ps()), _mm_mul_ps(w, inv), one));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		const float rawDot = fx[i] * tx[i] + fy[i] * ty[i] + fz[i] * tz[i] + fw[i] * tw[i];
+
+		// Take the shortest path
+		const float sign = rawDot < 0.0f ? -1.0f : 1.0f;
+		const float dot = std::min(rawDot * sign, 1.0f);
+
+		const float theta = acosf(dot);
+		const float sinTheta = sinf(theta);
+		const bool nearlyEqual = dot > 1.0f - epsilon;
+		const float invSin = nearlyEqual ? 0.0f : 1.0f / sinTheta;
+
+		const float w1 = nearlyEqual ? 1.0f - factors[i] : sinf((1.0f - factors[i]) * theta) * invSin;
+		const float w2 = (nearlyEqual ? factors[i] : sinf(factors[i] * theta) * invSin) * sign;
+
+		const float x = fx[i] * w1 + tx[i] * w2;
+		const float y = fy[i] * w1 + ty[i] * w2;
+		const float z = fz[i] * w1 + tz[i] * w2;
+		const float w = fw[i] * w1 + tw[i] * w2;
+
+		const float lengthSq = x * x + y * y + z * z + w * w;
+		const float inv = lengthSq > 0.0f ? 1.0f / sqrtf(lengthSq) : 0.0f;
+
+		ox[i] = lengthSq > 0.0f ? x * inv : 0.0f;
+		oy[i] = lengthSq > 0.0f ? y * inv : 0.0f;
+		oz[i] = lengthSq > 0.0f ? z * inv : 0.0f;
+		ow[i] = lengthSq > 0.0f ? w * inv : 1.0f;
+	}
+}
@@ -21,6 +21,7 @@
 //////////////////////////////////////////
 
 #include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -35,7 +36,15 @@
 #include <memory>
 #include <algorithm>
 #include <span>
+#include <bit>
 #include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <queue>
+#include <filesystem>
 
 //////////////////////////////////////////
 // Third party includes					//
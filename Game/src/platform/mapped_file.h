@@ -0,0 +1,31 @@
+#pragma once
+
+// Read-only memory mapping of a whole file. The view stays valid until the
+// MappedFile is closed or destroyed.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool Open(const std::string& path);
+    void Close();
+
+    bool IsOpen() const { return Data != nullptr; }
+    std::span<const uint8_t> GetData() const { return { Data, Size }; }
+
+private:
+    const uint8_t* Data{};
+    size_t Size{};
+
+#ifdef _WIN32
+    HANDLE File{ INVALID_HANDLE_VALUE };
+    HANDLE Mapping{};
+#endif
+};
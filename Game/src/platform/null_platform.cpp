@@ -0,0 +1,122 @@
+#include "pch.h"
+#include "platform/null_platform.h"
+
+NullPlatform::NullPlatform(uint32_t frameCount, std::vector<ScriptedInput> script)
+	: Script(std::move(script)), FrameCount(frameCount)
+{
+	std::stable_sort(Script.begin(), Script.end(),
+		[](const ScriptedInput& a, const ScriptedInput& b) { return a.Frame < b.Frame; });
+}
+
+void NullPlatform::InitWindow(int windowWidth, int windowHeight, const wchar_t* title)
+{
+	FrameTimes.reserve(FrameCount);
+}
+
+void NullPlatform::UpdateWindow(bool& running)
+{
+	const auto now = std::chrono::steady_clock::now();
+	if (Frame > 0)
+		FrameTimes.push_back(std::chrono::duration<float, std::milli>(now - LastFrameTime).count());
+	LastFrameTime = now;
+
+	if (FrameCount && Frame >= FrameCount)
+		running = false;
+
+	Frame++;
+}
+
+void* NullPlatform::GetWindowHandle()
+{
+	return nullptr;
+}
+
+void NullPlatform::InitConsole()
+{
+}
+
+void NullPlatform::Shutdown()
+{
+}
+
+void NullPlatform::InitInput()
+{
+	State = {};
+	NextInput = 0;
+}
+
+void NullPlatform::UpdateInput()
+{
+	// UpdateWindow() has already counted the current frame
+	auto& s = State.KeyStates;
+	while (NextInput < Script.size() && Script[NextInput].Frame < Frame)
+	{
+		const ScriptedInput& input = Script[NextInput++];
+		s.KeysDown[static_cast<size_t>(input.Key)] = input.Down;
+		State.MouseDelta += input.MouseDelta;
+	}
+
+	for (size_t i = 0; i < KEY_COUNT; ++i)
+	{
+		s.KeysPressed[i] = !s.PrevKeysDown[i] && s.KeysDown[i];
+		s.KeysReleased[i] = s.PrevKeysDown[i] && !s.KeysDown[i];
+		s.PrevKeysDown[i] = s.KeysDown[i];
+	}
+}
+
+bool NullPlatform::IsKeyDown(KeyCode key)
+{
+	return State.KeyStates.KeysDown[static_cast<size_t>(key)];
+}
+
+bool NullPlatform::IsKeyPressed(KeyCode key)
+{
+	return State.KeyStates.KeysPressed[static_cast<size_t>(key)];
+}
+
+bool NullPlatform::IsKeyReleased(KeyCode key)
+{
+	return State.KeyStates.KeysReleased[static_cast<size_t>(key)];
+}
+
+V2 NullPlatform::GetMousePosition()
+{
+	return State.MousePosition;
+}
+
+V2 NullPlatform::GetMouseDelta()
+{
+	return State.MouseDelta;
+}
+
+void NullPlatform::SetMouseDelta(const V2& delta)
+{
+	State.MouseDelta = delta;
+}
+
+void NullPlatform::SetCursorVisible(const bool show)
+{
+}
+
+void NullPlatform::ConfineCursorToWindow(const bool confine)
+{
+}
+
+void NullPlatform::InitAudio()
+{
+}
+
+void NullPlatform::PlayAudio(Sound& sound, float volume)
+{
+}
+
+void* NullPlatform::AllocateMemory(size_t capacity)
+{
+	return std::calloc(1, capacity);
+}
+
+void NullPlatform::FreeMemory(void*& memory)
+{
+	std::free(memory);
+	memory = nullptr;
+}
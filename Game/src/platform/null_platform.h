@@ -0,0 +1,68 @@
+#pragma once
+
+#include "platform.h"
+
+// A key change applied at the start of a frame, plus the mouse movement of
+// that frame.
+struct ScriptedInput
+{
+	uint32_t Frame{};
+	KeyCode Key{};
+	bool Down{};
+	V2 MouseDelta{};
+};
+
+/*
+	NOTE:
+	Platform without a window, for headless runs and benchmarks. Input comes
+	from a script sorted by frame, and the window closes after a fixed number
+	of frames. Audio is dropped.
+*/
+class NullPlatform final : public Platform
+{
+public:
+	// A frameCount of 0 runs until the game stops, e.g. on a scripted escape.
+	explicit NullPlatform(uint32_t frameCount = 0, std::vector<ScriptedInput> script = {});
+
+	void InitWindow(int windowWidth, int windowHeight,
+		const wchar_t* title) override;
+	void UpdateWindow(bool& running) override;
+	void* GetWindowHandle() override;
+
+	void InitConsole() override;
+	void Shutdown() override;
+
+	void InitInput() override;
+	void UpdateInput() override;
+
+	bool IsKeyDown(KeyCode key) override;
+	bool IsKeyPressed(KeyCode key) override;
+	bool IsKeyReleased(KeyCode key) override;
+
+	V2 GetMousePosition() override;
+	V2 GetMouseDelta() override;
+	void SetMouseDelta(const V2& delta) override;
+
+	void SetCursorVisible(const bool show) override;
+	void ConfineCursorToWindow(const bool confine) override;
+
+	void InitAudio() override;
+	void PlayAudio(Sound& sound, float volume) override;
+
+	void* AllocateMemory(size_t capacity) override;
+	void FreeMemory(void*& memory) override;
+
+	uint32_t GetFrame() const { return Frame; }
+	// Milliseconds between consecutive UpdateWindow() calls.
+	std::span<const float> GetFrameTimes() const { return FrameTimes; }
+
+private:
+	Input State{};
+	std::vector<ScriptedInput> Script{};
+	size_t NextInput{};
+
+	uint32_t FrameCount{};
+	uint32_t Frame{};
+	std::vector<float> FrameTimes{};
+	std::chrono::steady_clock::time_point LastFrameTime{};
+};
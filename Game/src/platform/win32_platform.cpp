@@ -1,8 +1,9 @@
 #include "pch.h"
-#include "platform/win32_platform.h"
 
 #ifdef _WIN32
 
+#include "platform/win32_platform.h"
+
 static HWND _Hwnd;
 static HINSTANCE _HInstance;
 
@@ -341,7 +342,7 @@ void Win32Platform::InitInput()
 void Win32Platform::UpdateInput()
 {
     auto& s = _Input.KeyStates;
-    for (int i = 0; i < KEY_COUNT; ++i) 
+    for (size_t i = 0; i < KEY_COUNT; ++i)
     {
         s.KeysPressed[i] = !s.PrevKeysDown[i] && s.KeysDown[i];
         s.KeysReleased[i] = s.PrevKeysDown[i] && !s.KeysDown[i];
@@ -1,8 +1,12 @@
 #include "pch.h"
 
+#ifdef _WIN32
+
 #include "renderer/d3d11_renderer.h"
 #include "platform/platform.h"
 #include "game.h"
+#include "assets/texture_registry.h"
+#include "assets/mesh_lod.h"
 
 static void ExitIfFailed(const HRESULT hr)
 {
@@ -28,7 +32,7 @@ static void VerifyShader(const HRESULT hr, ID3D10Blob* errorMessages)
     }
 }
 
-void D3D11Renderer::UploadMeshesToGPU(Mesh& mesh)
+void D3D11Renderer::UploadMeshesToGPU(Mesh& mesh, TextureRegistry& textures)
 {
     // Create Vertex Buffer
     D3D11_BUFFER_DESC vertexBufferDesc = {};
@@ -43,24 +47,52 @@ void D3D11Renderer::UploadMeshesToGPU(Mesh& mesh)
 
     mesh.VertexBuffer = vertexBuffer;
 
-    // Create Index Buffer
+    // Create Index Buffer, unless the mesh shares one
+    mesh.IndexBuffer = mesh.Indices.empty() ? nullptr : UploadIndexBuffer(mesh.Indices);
+
+    for (TextureHandle texture : mesh.Textures)
+    {
+        void* textureView = textures.GetView(texture);
+        if (!textureView)
+        {
+            textureView = CreateTextureView(textures.GetTexture(texture));
+            textures.SetView(texture, textureView);
+        }
+		mesh.TextureViews.emplace_back(textureView);
+	}
+}
+
+void D3D11Renderer::ReleaseMesh(Mesh& mesh)
+{
+    if (mesh.VertexBuffer)
+        static_cast<ID3D11Buffer*>(mesh.VertexBuffer)->Release();
+    if (mesh.IndexBuffer)
+        static_cast<ID3D11Buffer*>(mesh.IndexBuffer)->Release();
+
+    mesh.VertexBuffer = nullptr;
+    mesh.IndexBuffer = nullptr;
+    mesh.TextureViews.clear();
+}
+
+void* D3D11Renderer::UploadIndexBuffer(std::span<const uint32_t> indices)
+{
     D3D11_BUFFER_DESC indexBufferDesc = {};
     indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-    indexBufferDesc.ByteWidth = static_cast<UINT>(sizeof(uint32_t) * mesh.Indices.size());
+    indexBufferDesc.ByteWidth = static_cast<UINT>(sizeof(uint32_t) * indices.size());
     indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
     indexBufferDesc.CPUAccessFlags = 0;
     D3D11_SUBRESOURCE_DATA indexData = {};
-    indexData.pSysMem = mesh.Indices.data();
+    indexData.pSysMem = indices.data();
     ID3D11Buffer* indexBuffer = nullptr;
     ExitIfFailed(D3d11Device->CreateBuffer(&indexBufferDesc, &indexData, &indexBuffer));
 
-	mesh.IndexBuffer = indexBuffer;
+    return indexBuffer;
+}
 
-    for (auto& texture : mesh.Textures)
-    {
-        void* textureView = CreateTextureView(texture);
-		mesh.TextureViews.emplace_back(textureView);
-	}
+void D3D11Renderer::ReleaseIndexBuffer(void* indexBuffer)
+{
+    if (indexBuffer)
+        static_cast<ID3D11Buffer*>(indexBuffer)->Release();
 }
 
 void* D3D11Renderer::CreateTextureView(const Texture& texture)
@@ -355,6 +387,7 @@ void D3D11Renderer::InitRenderer(int gameHeight, int gameWidth, Platform* platfo
     viewport.TopLeftY = 0;
     viewport.Width = static_cast<FLOAT>(gameWidth);
     viewport.Height = static_cast<FLOAT>(gameHeight);
+    ViewportHeight = static_cast<float>(gameHeight);
     viewport.MinDepth = 0.0f;
     viewport.MaxDepth = 1.0f;
 
@@ -376,6 +409,9 @@ void D3D11Renderer::InitRenderer(int gameHeight, int gameWidth, Platform* platfo
 
     ExitIfFailed(D3d11Device->CreateBuffer(&constantBufferDesc, nullptr, &CbPerObjectBuffer));
 
+    constantBufferDesc.ByteWidth = sizeof(CbBones);
+    ExitIfFailed(D3d11Device->CreateBuffer(&constantBufferDesc, nullptr, &CbBonesBuffer));
+
     D3D11_SAMPLER_DESC samplerDesc;
     ZeroMemory(&samplerDesc, sizeof(samplerDesc));
     samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
@@ -452,7 +488,7 @@ void D3D11Renderer::InitRenderer(int gameHeight, int gameWidth, Platform* platfo
     ConstBufferPerFrame.Light = gameState->World.DirectionalLight;
 
     D3d11DeviceContext->UpdateSubresource(cbPerFrameBuffer, 0, NULL, &ConstBufferPerFrame, 0, 0);
-    D3d11DeviceContext->PSSetConstantBuffers(0, 1, &cbPerFrameBuffer);
+    D3d11DeviceContext->PSSetConstantBuffers(2, 1, &cbPerFrameBuffer);
 }
 
 void D3D11Renderer::RenderScene(GameMemory* gameState)
@@ -464,50 +500,76 @@ void D3D11Renderer::RenderScene(GameMemory* gameState)
     //Refresh the Depth/Stencil view
     D3d11DeviceContext->ClearDepthStencilView(DepthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
 
-    //Set Initial Vertex and Pixel Shaders
-    D3d11DeviceContext->VSSetShader(VS, nullptr, 0);
-    D3d11DeviceContext->PSSetShader(PS, nullptr, 0);
+    const Camera& camera = gameState->MainCamera;
 
-    //Set the vertex buffer
-    UINT stride = sizeof(Vertex);
-    UINT offset = 0;
+    Queue.Begin(BuildRenderView(*gameState));
+    CullStats = SubmitScene(*gameState, GetPixelsPerUnit(camera.Projection, ViewportHeight), Queue);
+    Queue.Execute(*this);
+}
+
+void D3D11Renderer::SetView(const RenderView& view)
+{
+    D3d11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+    //Enable the Default Rasterizer State
+    D3d11DeviceContext->RSSetState(nullptr);
+    D3d11DeviceContext->PSSetSamplers(0, 1, &CubesTexSamplerState);
+
+    ConstBufferPerFrame.Light = view.Light;
+    D3d11DeviceContext->UpdateSubresource(cbPerFrameBuffer, 0, NULL, &ConstBufferPerFrame, 0, 0);
+    D3d11DeviceContext->PSSetConstantBuffers(2, 1, &cbPerFrameBuffer);
+
+    CbPerObj = {};
+    CbPerObj.Projection = view.Projection;
+    CbPerObj.View = view.View;
+
+    ID3D11Buffer* vsBuffers[] = { CbPerObjectBuffer, CbBonesBuffer };
+    D3d11DeviceContext->VSSetConstantBuffers(0, 2, vsBuffers);
+}
 
-	for (auto& entity : gameState->World.Entities)
+void D3D11Renderer::SetShader(RenderShader shader)
+{
+    switch (shader)
     {
-        for (auto& mesh : entity.Model.Meshes)
-        {
-            D3d11DeviceContext->IASetIndexBuffer(static_cast<ID3D11Buffer*>(mesh.IndexBuffer), DXGI_FORMAT_R32_UINT, 0);
-            D3d11DeviceContext->IASetVertexBuffers(0, 1, reinterpret_cast<ID3D11Buffer**>(&mesh.VertexBuffer), &stride, &offset);
-            D3d11DeviceContext->IASetInputLayout(VertLayout);
-            D3d11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-
-            //Enable the Default Rasterizer State
-            D3d11DeviceContext->RSSetState(nullptr);
-            //Turn off backface culling
-            //D3d11DeviceContext->RSSetState(NoCull);
-
-            ConstBufferPerFrame.Light = gameState->World.DirectionalLight;
-            D3d11DeviceContext->UpdateSubresource(cbPerFrameBuffer, 0, NULL, &ConstBufferPerFrame, 0, 0);
-            D3d11DeviceContext->PSSetConstantBuffers(0, 1, &cbPerFrameBuffer);
-
-            CbPerObj = {};
-
-            CbPerObj.Projection = gameState->MainCamera.Projection;
-            CbPerObj.View = gameState->MainCamera.View;
-            CbPerObj.World = entity.WorldMatrix;
-
-            CbPerObj.FinalBoneTransforms = entity.Model.Animator.FinalBoneTransforms;
-
-            D3d11DeviceContext->UpdateSubresource(CbPerObjectBuffer, 0, nullptr, &CbPerObj, 0, 0);
-            D3d11DeviceContext->VSSetConstantBuffers(0, 1, &CbPerObjectBuffer);
-            ID3D11ShaderResourceView* textureView = static_cast<ID3D11ShaderResourceView*>(mesh.TextureViews[0]);
-            D3d11DeviceContext->PSSetShaderResources(0, 1, &textureView);
-            D3d11DeviceContext->PSSetSamplers(0, 1, &CubesTexSamplerState);
-            //Draw the mesh
-            D3d11DeviceContext->DrawIndexed(static_cast<UINT>(mesh.Indices.size()), 0, 0);
-        }
+    case RenderShader::Mesh:
+        D3d11DeviceContext->VSSetShader(VS, nullptr, 0);
+        D3d11DeviceContext->PSSetShader(PS, nullptr, 0);
+        D3d11DeviceContext->IASetInputLayout(VertLayout);
+        break;
     }
 }
+
+void D3D11Renderer::SetGeometry(void* vertexBuffer, void* indexBuffer)
+{
+    constexpr UINT stride = sizeof(Vertex);
+    constexpr UINT offset = 0;
+    ID3D11Buffer* buffer = static_cast<ID3D11Buffer*>(vertexBuffer);
+    D3d11DeviceContext->IASetVertexBuffers(0, 1, &buffer, &stride, &offset);
+    D3d11DeviceContext->IASetIndexBuffer(static_cast<ID3D11Buffer*>(indexBuffer), DXGI_FORMAT_R32_UINT, 0);
+}
+
+void D3D11Renderer::SetTexture(void* textureView)
+{
+    ID3D11ShaderResourceView* view = static_cast<ID3D11ShaderResourceView*>(textureView);
+    D3d11DeviceContext->PSSetShaderResources(0, 1, &view);
+}
+
+void D3D11Renderer::SetObject(const RenderObject& object)
+{
+    CbPerObj.World = object.World;
+    D3d11DeviceContext->UpdateSubresource(CbPerObjectBuffer, 0, nullptr, &CbPerObj, 0, 0);
+}
+
+void D3D11Renderer::SetBones(const std::array<M4, MAX_BONES>& bones)
+{
+    D3d11DeviceContext->UpdateSubresource(CbBonesBuffer, 0, nullptr, bones.data(), 0, 0);
+}
+
+void D3D11Renderer::Draw(uint32_t indexCount, uint32_t indexOffset)
+{
+    D3d11DeviceContext->DrawIndexed(indexCount, indexOffset, 0);
+}
+
 //
 //void D3D11Renderer::RenderPoint(const V3& position, const float scale)
 //{
@@ -583,4 +645,6 @@ void D3D11Renderer::PresentSwapChain(bool& vSync)
     SwapChain->Present1(vSync, PresentFlags, &presentParams);
 #endif
     
-}
\ No newline at end of file
+}
+
+#endif // _WIN32
@@ -1,30 +1,39 @@
 #pragma once
 
 #include "renderer.h"
+#include "render_queue.h"
 
 using Microsoft::WRL::ComPtr;
 
 struct CbPerObject
 {
-    std::array<M4, 100> FinalBoneTransforms{};
     M4 Projection{};
     M4 View{};
     M4 World{};
     V4 Color{};
 };
 
+// Uploaded only for objects with a skeleton.
+struct CbBones
+{
+    std::array<M4, MAX_BONES> FinalBoneTransforms{};
+};
+
 struct CbPerFrame
 {
     DirectionalLight Light{};
 };
 
-class D3D11Renderer final : public Renderer
+class D3D11Renderer final : public Renderer, public RenderBackend
 {
 public:
     void InitRenderer(int gameHeight, int gameWidth, 
         Platform* platform, GameMemory* gameState) override;
 
-    void UploadMeshesToGPU(Mesh& mesh) override;
+    void UploadMeshesToGPU(Mesh& mesh, TextureRegistry& textures) override;
+    void ReleaseMesh(Mesh& mesh) override;
+    void* UploadIndexBuffer(std::span<const uint32_t> indices) override;
+    void ReleaseIndexBuffer(void* indexBuffer) override;
 	void* CreateTextureView(const Texture& texture) override;
 
 	void RenderScene(GameMemory* gameState) override;
@@ -35,6 +44,17 @@ public:
 
 	void PresentSwapChain(bool& vSync) override;
 
+    void SetView(const RenderView& view) override;
+    void SetShader(RenderShader shader) override;
+    void SetGeometry(void* vertexBuffer, void* indexBuffer) override;
+    void SetTexture(void* textureView) override;
+    void SetObject(const RenderObject& object) override;
+    void SetBones(const std::array<M4, MAX_BONES>& bones) override;
+    void Draw(uint32_t indexCount, uint32_t indexOffset) override;
+
+    // Frustum culling of the last RenderScene().
+    const SceneCullStats& GetCullStats() const { return CullStats; }
+
 private:
     void InitMainRenderingPipeline();
     void InitFontRenderingPipeline();
@@ -55,6 +75,7 @@ private:
     ID3D11InputLayout* VertLayout{};
 
     ID3D11Buffer* CbPerObjectBuffer{};
+    ID3D11Buffer* CbBonesBuffer{};
     ID3D11RasterizerState* Solid{};
     ID3D11RasterizerState* WireFrame{};
 
@@ -84,4 +105,10 @@ private:
 
     CbPerObject CbPerObj{};
     CbPerFrame ConstBufferPerFrame{};
+
+    RenderQueue Queue{};
+    SceneCullStats CullStats{};
+
+    // Back buffer height in pixels, for LOD selection.
+    float ViewportHeight{};
 };
\ No newline at end of file
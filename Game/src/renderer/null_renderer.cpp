@@ -0,0 +1,82 @@
+#include "pch.h"
+
+#include "renderer/null_renderer.h"
+#include "assets/texture_registry.h"
+#include "assets/mesh_lod.h"
+
+void NullRenderer::InitRenderer(int gameHeight, int gameWidth, Platform* platform, GameMemory* gameState)
+{
+    ViewportHeight = static_cast<float>(gameHeight);
+}
+
+void NullRenderer::UploadMeshesToGPU(Mesh& mesh, TextureRegistry& textures)
+{
+    mesh.VertexBuffer = CreateHandle();
+    mesh.IndexBuffer = mesh.Indices.empty() ? nullptr : CreateHandle();
+    LiveMeshes++;
+
+    for (TextureHandle texture : mesh.Textures)
+    {
+        void* textureView = textures.GetView(texture);
+        if (!textureView)
+        {
+            textureView = CreateTextureView(textures.GetTexture(texture));
+            textures.SetView(texture, textureView);
+        }
+        mesh.TextureViews.emplace_back(textureView);
+    }
+}
+
+void NullRenderer::ReleaseMesh(Mesh& mesh)
+{
+    if (mesh.VertexBuffer)
+        LiveMeshes--;
+
+    mesh.VertexBuffer = nullptr;
+    mesh.IndexBuffer = nullptr;
+    mesh.TextureViews.clear();
+}
+
+void* NullRenderer::UploadIndexBuffer(std::span<const uint32_t> indices)
+{
+    LiveIndexBuffers++;
+    return CreateHandle();
+}
+
+void NullRenderer::ReleaseIndexBuffer(void* indexBuffer)
+{
+    if (indexBuffer)
+        LiveIndexBuffers--;
+}
+
+void* NullRenderer::CreateTextureView(const Texture& texture)
+{
+    return CreateHandle();
+}
+
+void NullRenderer::RenderScene(GameMemory* gameState)
+{
+    const Camera& camera = gameState->MainCamera;
+
+    Queue.Begin(BuildRenderView(*gameState));
+    CullStats = SubmitScene(*gameState, GetPixelsPerUnit(camera.Projection, ViewportHeight), Queue);
+
+    Recording.Clear();
+    Stats = Queue.Execute(Recording);
+}
+
+void NullRenderer::RenderText(std::unordered_map<char, FontGlyph>& glyphs,
+    int w, int h, const std::string_view text, float x, float y,
+    const float scale, const V3& color)
+{
+    for (char c : text)
+    {
+        if (glyphs.contains(c))
+            Glyphs++;
+    }
+}
+
+void NullRenderer::PresentSwapChain(bool& vSync)
+{
+    FrameCount++;
+}
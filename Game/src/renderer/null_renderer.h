@@ -0,0 +1,57 @@
+#pragma once
+
+#include "renderer.h"
+#include "render_queue.h"
+
+/*
+	NOTE:
+	Renderer without a device, for headless runs and benchmarks. Buffers and
+	views are fake non-null handles, and the scene goes through the same
+	render queue as on the GPU, replayed into a RecordingBackend.
+*/
+class NullRenderer final : public Renderer
+{
+public:
+    void InitRenderer(int gameHeight, int gameWidth,
+        Platform* platform, GameMemory* gameState) override;
+
+    void UploadMeshesToGPU(Mesh& mesh, TextureRegistry& textures) override;
+    void ReleaseMesh(Mesh& mesh) override;
+    void* UploadIndexBuffer(std::span<const uint32_t> indices) override;
+    void ReleaseIndexBuffer(void* indexBuffer) override;
+    void* CreateTextureView(const Texture& texture) override;
+
+    void RenderScene(GameMemory* gameState) override;
+    void RenderText(std::unordered_map<char, FontGlyph>& glyphs,
+        int w, int h, const std::string_view text, float x, float y,
+        const float scale, const V3& color) override;
+
+    void PresentSwapChain(bool& vSync) override;
+
+    // Replay of the last RenderScene().
+    const RenderQueueStats& GetStats() const { return Stats; }
+    const RecordingBackend& GetRecording() const { return Recording; }
+    const SceneCullStats& GetCullStats() const { return CullStats; }
+
+    uint64_t GetFrameCount() const { return FrameCount; }
+    uint32_t GetLiveMeshCount() const { return LiveMeshes; }
+    uint32_t GetLiveIndexBufferCount() const { return LiveIndexBuffers; }
+    uint32_t GetGlyphCount() const { return Glyphs; }
+
+private:
+    void* CreateHandle() { return reinterpret_cast<void*>(NextHandle++); }
+
+    RenderQueue Queue{};
+    RecordingBackend Recording{};
+    RenderQueueStats Stats{};
+    SceneCullStats CullStats{};
+
+    uintptr_t NextHandle{ 1 };
+    float ViewportHeight{};
+    uint64_t FrameCount{};
+    uint32_t LiveMeshes{};
+    // Shared buffers from UploadIndexBuffer(), not counted in LiveMeshes.
+    uint32_t LiveIndexBuffers{};
+    // Glyphs drawn by RenderText() over the whole run.
+    uint32_t Glyphs{};
+};
@@ -0,0 +1,281 @@
+#include "pch.h"
+#include "renderer/render_queue.h"
+
+#include "assets/mesh_bounds.h"
+#include "assets/mesh_lod.h"
+#include "assets/vertex_format.h"
+#include "world/terrain.h"
+
+uint64_t RenderQueue::MakeKey(RenderPass pass, RenderShader shader, uint32_t object,
+    const void* geometry, uint32_t texture, float depth)
+{
+    // The bits of a non-negative float sort like its value.
+    const uint32_t depthBits = std::bit_cast<uint32_t>(std::max(depth, 0.0f));
+    const uint64_t passBits = uint64_t(static_cast<uint8_t>(pass) & 0xF) << 60;
+    const uint64_t shaderBits = uint64_t(static_cast<uint8_t>(shader) & 0xF);
+
+    if (pass == RenderPass::Transparent)
+        return passBits | (uint64_t(~depthBits) << 28) | (shaderBits << 24) | (texture & 0xFFFFFF);
+
+    // The exponent, so bucket n holds depths in [2^n, 2^(n+1)) and 0 all below 2
+    const uint32_t bucket = std::clamp(static_cast<int32_t>(depthBits >> 23) - 127, 0, 15);
+
+    // Fibonacci hash, the top bits of the product mix every pointer bit
+    const uint64_t geometryBits = (reinterpret_cast<uintptr_t>(geometry) * 0x9E3779B97F4A7C15ull) >> 48;
+
+    return passBits | (shaderBits << 56) | (uint64_t(bucket) << 52)
+        | (uint64_t(object & 0xFFFFF) << 32) | (geometryBits << 16) | (texture & 0xFFFF);
+}
+
+void RenderQueue::Begin(const RenderView& view)
+{
+    View = view;
+    Objects.clear();
+    Packets.clear();
+}
+
+uint32_t RenderQueue::AddObject(const RenderObject& object)
+{
+    Objects.push_back(object);
+    return static_cast<uint32_t>(Objects.size() - 1);
+}
+
+void RenderQueue::Submit(const DrawPacket& packet)
+{
+    Packets.push_back(packet);
+}
+
+void RenderQueue::Submit(RenderPass pass, RenderShader shader, uint32_t object,
+    const Mesh& mesh, const Submesh& submesh, const V3& position)
+{
+    if (submesh.IndexCount == 0)
+        return;
+
+    // Registry handles are dense, 0 is left for untextured
+    uint32_t texture = 0;
+    void* textureView = nullptr;
+    if (submesh.Material >= 0)
+    {
+        texture = mesh.Textures[submesh.Material].Index + 1;
+        textureView = mesh.TextureViews[submesh.Material];
+    }
+
+    DrawPacket packet{};
+    packet.Key = MakeKey(pass, shader, object, mesh.VertexBuffer, texture,
+        Dot(position - View.Position, View.Direction));
+    packet.Shader = shader;
+    packet.Object = object;
+    packet.VertexBuffer = mesh.VertexBuffer;
+    packet.IndexBuffer = mesh.IndexBuffer;
+    packet.TextureView = textureView;
+    packet.IndexCount = submesh.IndexCount;
+    packet.IndexOffset = submesh.IndexOffset;
+    Packets.push_back(packet);
+}
+
+RenderQueueStats RenderQueue::Execute(RenderBackend& backend)
+{
+    // Equal keys keep their submission order
+    std::stable_sort(Packets.begin(), Packets.end(),
+        [](const DrawPacket& a, const DrawPacket& b) { return a.Key < b.Key; });
+
+    RenderQueueStats stats{};
+    stats.Packets = static_cast<uint32_t>(Packets.size());
+
+    backend.SetView(View);
+
+    // Nothing is bound yet, so the first packet sets everything
+    bool first = true;
+    RenderShader shader{};
+    void* vertexBuffer{};
+    void* indexBuffer{};
+    void* textureView{};
+    uint32_t object{};
+    const std::array<M4, MAX_BONES>* bones{};
+
+    for (const DrawPacket& packet : Packets)
+    {
+        if (first || packet.Shader != shader)
+        {
+            shader = packet.Shader;
+            backend.SetShader(shader);
+            stats.ShaderChanges++;
+        }
+
+        if (first || packet.VertexBuffer != vertexBuffer || packet.IndexBuffer != indexBuffer)
+        {
+            vertexBuffer = packet.VertexBuffer;
+            indexBuffer = packet.IndexBuffer;
+            backend.SetGeometry(vertexBuffer, indexBuffer);
+            stats.GeometryChanges++;
+        }
+
+        if (first || packet.TextureView != textureView)
+        {
+            textureView = packet.TextureView;
+            backend.SetTexture(textureView);
+            stats.TextureChanges++;
+        }
+
+        if (first || packet.Object != object)
+        {
+            object = packet.Object;
+            const RenderObject& renderObject = Objects[object];
+            backend.SetObject(renderObject);
+            stats.ObjectUploads++;
+
+            // Objects without bones leave the last upload bound, unread
+            if (renderObject.Bones && renderObject.Bones != bones)
+            {
+                bones = renderObject.Bones;
+                backend.SetBones(*bones);
+                stats.BoneUploads++;
+            }
+        }
+
+        first = false;
+        backend.Draw(packet.IndexCount, packet.IndexOffset);
+        stats.DrawCalls++;
+    }
+
+    return stats;
+}
+
+namespace
+{
+    // Box only: a bounding sphere pre-test costs more than it rejects,
+    // see FrustumCulling100k. Meshes without bounds are always drawn.
+    bool IsMeshVisible(const Frustum& frustum, const AABB& worldBounds)
+    {
+        return !worldBounds.IsValid() || IsAABBInFrustum(frustum, worldBounds);
+    }
+}
+
+RenderView BuildRenderView(const GameMemory& gameState)
+{
+    const Camera& camera = gameState.MainCamera;
+
+    RenderView view{};
+    view.View = camera.View;
+    view.Projection = camera.Projection;
+    view.Position = camera.Position;
+    view.Direction = camera.Direction;
+    view.Light = gameState.World.DirectionalLight;
+    return view;
+}
+
+SceneCullStats SubmitScene(const GameMemory& gameState, float pixelsPerUnit, RenderQueue& queue)
+{
+    const Camera& camera = gameState.MainCamera;
+    const Frustum frustum = ExtractFrustum(camera.View * camera.Projection);
+    SceneCullStats stats{};
+
+    // ------------------- Entities -------------------
+    // The tree only holds entities with bounds, the rest are always drawn.
+    // Sorted so the queue sees entities in the same order as before.
+    const GameWorld& world = gameState.World;
+    std::vector<uint32_t>& candidates = queue.GetEntityCandidates();
+    candidates.clear();
+    world.EntityBvh.QueryFrustum(frustum, candidates);
+    stats.Entities.Culled = world.EntityBvh.GetProxyCount() - static_cast<uint32_t>(candidates.size());
+    for (uint32_t i = 0; i < MAX_ENTITIES; i++)
+    {
+        if (world.Entities[i].BvhProxy == DynamicBvh::NULL_NODE && !world.Entities[i].Model.Meshes.empty())
+            candidates.push_back(i);
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    for (const uint32_t index : candidates)
+    {
+        const Entity& entity = world.Entities[index];
+        if (entity.Model.Meshes.empty())
+            continue;
+
+        // LOD errors are in mesh units, so distances are scaled into mesh space
+        const M4& worldMatrix = entity.WorldMatrix;
+        const V3 entityPosition = { worldMatrix.M[3][0], worldMatrix.M[3][1], worldMatrix.M[3][2] };
+        const float scale = std::max({
+            Length(V3{ worldMatrix.M[0][0], worldMatrix.M[0][1], worldMatrix.M[0][2] }),
+            Length(V3{ worldMatrix.M[1][0], worldMatrix.M[1][1], worldMatrix.M[1][2] }),
+            Length(V3{ worldMatrix.M[2][0], worldMatrix.M[2][1], worldMatrix.M[2][2] }) });
+        const float inverseScale = 1.0f / std::max(scale, 1e-6f);
+
+        RenderObject renderObject{};
+        renderObject.World = worldMatrix;
+        if (!entity.Model.Skeletons.empty())
+            renderObject.Bones = &entity.Model.Animator.FinalBoneTransforms;
+
+        // Added with the first visible mesh. The vertex shader skins with
+        // the animator's pose, so skinned meshes are bounded in that pose.
+        uint32_t object = UINT32_MAX;
+        for (const Mesh& mesh : entity.Model.Meshes)
+        {
+            if (!mesh.VertexBuffer)
+                continue;
+
+            const bool posed = renderObject.Bones && !mesh.BoneBounds.empty();
+            const AABB meshBounds = posed ? ComputePosedBounds(mesh, *renderObject.Bones) : mesh.Bounds;
+            const AABB worldBounds = meshBounds.IsValid() ? TransformAABB(meshBounds, worldMatrix) : AABB{};
+
+            if (!IsMeshVisible(frustum, worldBounds))
+            {
+                stats.Meshes.Culled++;
+                continue;
+            }
+            stats.Meshes.Visible++;
+
+            // Meshes with bone bounds have weights, see ComputeMeshBounds()
+            const size_t vertexCount = mesh.Vertices.size();
+            stats.VertexBytes.Vertex += vertexCount * sizeof(Vertex);
+            stats.VertexBytes.PackedStatic += vertexCount * sizeof(PackedVertex);
+            if (!mesh.BoneBounds.empty())
+                stats.VertexBytes.PackedSkin += vertexCount * sizeof(PackedSkin);
+
+            if (object == UINT32_MAX)
+                object = queue.AddObject(renderObject);
+
+            // The nearest point of a large mesh can be much closer than its origin
+            const float distance = worldBounds.IsValid() ?
+                DistanceToAABB(camera.Position, worldBounds) * inverseScale :
+                Length(entityPosition - camera.Position) * inverseScale;
+            const uint32_t lod = SelectLod(mesh, distance, pixelsPerUnit);
+            for (const Submesh& submesh : GetLodSubmeshes(mesh, lod))
+                queue.Submit(RenderPass::Opaque, RenderShader::Mesh, object, mesh, submesh, entityPosition);
+        }
+
+        if (object == UINT32_MAX)
+            stats.Entities.Culled++;
+        else
+            stats.Entities.Visible++;
+    }
+
+    // ------------------- Terrain -------------------
+    // Tile positions are already in world space
+    if (const Terrain* terrain = gameState.World.Terrain)
+    {
+        RenderObject renderObject{};
+        renderObject.World = MatrixIdentity();
+        uint32_t object = UINT32_MAX;
+
+        for (const TerrainDrawItem& item : terrain->GetDrawList())
+        {
+            if (item.Mesh->Bounds.IsValid() && !IsAABBInFrustum(frustum, item.Mesh->Bounds))
+            {
+                stats.TerrainTiles.Culled++;
+                continue;
+            }
+            stats.TerrainTiles.Visible++;
+            stats.VertexBytes.Vertex += item.VertexBytes;
+            stats.VertexBytes.PackedStatic += item.PackedVertexBytes;
+
+            if (object == UINT32_MAX)
+                object = queue.AddObject(renderObject);
+
+            // Interior plus each edge, plain or stitched to a coarser neighbour
+            for (const Submesh& submesh : item.Submeshes)
+                queue.Submit(RenderPass::Opaque, RenderShader::Mesh, object, *item.Mesh, submesh, item.Center);
+        }
+    }
+
+    return stats;
+}
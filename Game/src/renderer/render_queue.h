@@ -0,0 +1,199 @@
+#pragma once
+
+#include "game.h"
+
+enum class RenderPass : uint8_t
+{
+    Opaque,
+    // Drawn after the opaque pass, back to front.
+    Transparent,
+};
+
+enum class RenderShader : uint8_t
+{
+    Mesh,
+};
+
+// Constants shared by every packet of one object.
+struct RenderObject
+{
+    M4 World{};
+    // Null for meshes without a skeleton, which then skip the bone upload.
+    const std::array<M4, MAX_BONES>* Bones{};
+};
+
+// One indexed draw and the state it needs. Buffers and views are backend
+// handles, as stored in Mesh.
+struct DrawPacket
+{
+    uint64_t Key{};
+    RenderShader Shader{};
+    uint32_t Object{};
+    void* VertexBuffer{};
+    void* IndexBuffer{};
+    void* TextureView{};
+    uint32_t IndexCount{};
+    uint32_t IndexOffset{};
+};
+
+struct RenderView
+{
+    M4 View{};
+    M4 Projection{};
+    V3 Position{};
+    V3 Direction{};
+    DirectionalLight Light{};
+};
+
+// What a replay sent to the backend.
+struct RenderQueueStats
+{
+    uint32_t Packets{};
+    uint32_t DrawCalls{};
+    uint32_t ShaderChanges{};
+    uint32_t GeometryChanges{};
+    uint32_t TextureChanges{};
+    uint32_t ObjectUploads{};
+    uint32_t BoneUploads{};
+};
+
+// Bounds tested against the view frustum by SubmitScene().
+struct CullStats
+{
+    uint32_t Visible{};
+    uint32_t Culled{};
+};
+
+// Vertex buffer bytes behind the drawn meshes and tiles, as Vertex and as
+// PackVertices() would store them. Whole buffers, whatever LOD is drawn.
+struct DrawnVertexBytes
+{
+    size_t Vertex{};
+    size_t PackedStatic{};
+    // Skinned meshes only.
+    size_t PackedSkin{};
+};
+
+struct SceneCullStats
+{
+    // An entity is visible when any of its meshes is.
+    CullStats Entities{};
+    // Meshes of the entities the world BVH did not cull.
+    CullStats Meshes{};
+    CullStats TerrainTiles{};
+    DrawnVertexBytes VertexBytes{};
+};
+
+// Receives the state changes of a replay. Nothing is set twice in a row.
+class RenderBackend
+{
+public:
+    virtual ~RenderBackend() = default;
+
+    // First call of every replay. Binds everything that is fixed for the
+    // frame; all other state is unknown until set again.
+    virtual void SetView(const RenderView& view) = 0;
+    virtual void SetShader(RenderShader shader) = 0;
+    virtual void SetGeometry(void* vertexBuffer, void* indexBuffer) = 0;
+    virtual void SetTexture(void* textureView) = 0;
+    virtual void SetObject(const RenderObject& object) = 0;
+    virtual void SetBones(const std::array<M4, MAX_BONES>& bones) = 0;
+    virtual void Draw(uint32_t indexCount, uint32_t indexOffset) = 0;
+};
+
+/*
+	NOTE:
+	Draws are collected for a frame, sorted by key and replayed, so packets
+	that share state end up next to each other. Key bits, high to low:
+
+	Opaque:      pass (4), shader (4), depth bucket (4), object (20),
+	             geometry (16), texture (16)
+	Transparent: pass (4), view depth (32), shader (4), texture (24)
+
+	Opaque packets sort front to back only by power of two depth buckets,
+	so every submesh of an object's mesh stays together and objects and
+	geometry are bound about once each. Submeshes of one mesh mostly use
+	different textures, so sorting texture higher trades a few texture
+	binds for a geometry bind and object upload on nearly every packet.
+	Geometry is a hash of the vertex buffer; a collision costs a rebind,
+	never a wrong draw. Transparent packets sort back to front exactly.
+*/
+class RenderQueue
+{
+public:
+    static uint64_t MakeKey(RenderPass pass, RenderShader shader, uint32_t object,
+        const void* geometry, uint32_t texture, float depth);
+
+    // Clears the queue.
+    void Begin(const RenderView& view);
+    // Returns the index packets refer to the object by.
+    uint32_t AddObject(const RenderObject& object);
+    void Submit(const DrawPacket& packet);
+    // Builds the packet and key of a submesh. position is used for depth.
+    void Submit(RenderPass pass, RenderShader shader, uint32_t object,
+        const Mesh& mesh, const Submesh& submesh, const V3& position);
+
+    RenderQueueStats Execute(RenderBackend& backend);
+
+    std::span<const DrawPacket> GetPackets() const { return Packets; }
+    // Entity indices SubmitScene() collects; kept here so the buffer is
+    // reused every frame.
+    std::vector<uint32_t>& GetEntityCandidates() { return EntityCandidates; }
+
+private:
+    RenderView View{};
+    std::vector<RenderObject> Objects{};
+    std::vector<DrawPacket> Packets{};
+    std::vector<uint32_t> EntityCandidates{};
+};
+
+// The main camera and the world's light, as every renderer begins a frame.
+RenderView BuildRenderView(const GameMemory& gameState);
+
+// Submits the entities, at their selected LOD, and the terrain tiles that
+// are in the camera's frustum.
+SceneCullStats SubmitScene(const GameMemory& gameState, float pixelsPerUnit, RenderQueue& queue);
+
+enum class RenderCommand : uint8_t
+{
+    SetView,
+    SetShader,
+    SetGeometry,
+    SetTexture,
+    SetObject,
+    SetBones,
+    Draw,
+    Count,
+};
+
+// Records the calls it receives instead of drawing.
+class RecordingBackend final : public RenderBackend
+{
+public:
+    void SetView(const RenderView& view) override { Record(RenderCommand::SetView); }
+    void SetShader(RenderShader shader) override { Record(RenderCommand::SetShader); }
+    void SetGeometry(void* vertexBuffer, void* indexBuffer) override { Record(RenderCommand::SetGeometry); }
+    void SetTexture(void* textureView) override { Record(RenderCommand::SetTexture); }
+    void SetObject(const RenderObject& object) override { Record(RenderCommand::SetObject); }
+    void SetBones(const std::array<M4, MAX_BONES>& bones) override { Record(RenderCommand::SetBones); }
+    void Draw(uint32_t indexCount, uint32_t indexOffset) override { Record(RenderCommand::Draw); }
+
+    void Clear()
+    {
+        Commands.clear();
+        Counts = {};
+    }
+
+    std::span<const RenderCommand> GetCommands() const { return Commands; }
+    uint32_t GetCount(RenderCommand command) const { return Counts[static_cast<size_t>(command)]; }
+
+private:
+    void Record(RenderCommand command)
+    {
+        Commands.push_back(command);
+        Counts[static_cast<size_t>(command)]++;
+    }
+
+    std::vector<RenderCommand> Commands{};
+    std::array<uint32_t, static_cast<size_t>(RenderCommand::Count)> Counts{};
+};
@@ -3,6 +3,7 @@
 #include "game.h"
 
 class Platform;
+class TextureRegistry;
 
 class Renderer
 {
@@ -14,7 +15,17 @@ public:
 	virtual void InitRenderer(int gameHeight, int gameWidth,
 		Platform* platform, GameMemory* gameState) = 0;
 
-	virtual void UploadMeshesToGPU(Mesh& mesh) = 0;
+	// Creates the views of textures that have none yet, so shared textures
+	// are uploaded once. A mesh without Indices gets no index buffer.
+	virtual void UploadMeshesToGPU(Mesh& mesh, TextureRegistry& textures) = 0;
+	// Frees the buffers made by UploadMeshesToGPU. Texture views are shared
+	// through the registry and stay alive.
+	virtual void ReleaseMesh(Mesh& mesh) = 0;
+
+	// An index buffer for meshes that share one topology. Set it as their
+	// Mesh::IndexBuffer, and reset that to null before ReleaseMesh().
+	virtual void* UploadIndexBuffer(std::span<const uint32_t> indices) = 0;
+	virtual void ReleaseIndexBuffer(void* indexBuffer) = 0;
 
 	virtual void RenderScene(GameMemory* gameState) = 0;
 
@@ -0,0 +1,769 @@
+#include "pch.h"
+
+#include "renderer/software_renderer.h"
+#include "assets/texture_registry.h"
+#include "assets/mesh_lod.h"
+#include "assets/skinning.h"
+#include "core/job_system.h"
+
+#include <stb_image_write.h>
+
+namespace
+{
+    // Triangles are clipped against the near and far planes, and against
+    // x and y at this many times w, which keeps pixel coordinates small.
+    constexpr float GUARD_BAND = 2.0f;
+    constexpr uint32_t CLIP_PLANE_COUNT = 6;
+
+    struct ClipVertex
+    {
+        V4 Position{};
+        V2 TexCoord{};
+        V3 Normal{};
+    };
+
+    float GetClipDistance(const V4& position, uint32_t plane)
+    {
+        switch (plane)
+        {
+        case 0: return position.Z;
+        case 1: return position.W - position.Z;
+        case 2: return GUARD_BAND * position.W + position.X;
+        case 3: return GUARD_BAND * position.W - position.X;
+        case 4: return GUARD_BAND * position.W + position.Y;
+        default: return GUARD_BAND * position.W - position.Y;
+        }
+    }
+
+    // Bit i is set when the position is outside clip plane i.
+    uint32_t GetOutcode(const V4& position)
+    {
+        uint32_t outcode = 0;
+        for (uint32_t plane = 0; plane < CLIP_PLANE_COUNT; plane++)
+        {
+            if (GetClipDistance(position, plane) < 0.0f)
+                outcode |= 1u << plane;
+        }
+        return outcode;
+    }
+
+    ClipVertex LerpClipVertex(const ClipVertex& a, const ClipVertex& b, float t)
+    {
+        ClipVertex result{};
+        result.Position = {
+            a.Position.X + (b.Position.X - a.Position.X) * t,
+            a.Position.Y + (b.Position.Y - a.Position.Y) * t,
+            a.Position.Z + (b.Position.Z - a.Position.Z) * t,
+            a.Position.W + (b.Position.W - a.Position.W) * t };
+        result.TexCoord = a.TexCoord + (b.TexCoord - a.TexCoord) * t;
+        result.Normal = a.Normal + (b.Normal - a.Normal) * t;
+        return result;
+    }
+
+    // Sutherland-Hodgman against every plane in outcode. Returns the vertex count.
+    uint32_t ClipPolygon(std::array<ClipVertex, 9>& polygon, uint32_t count, uint32_t outcode)
+    {
+        std::array<ClipVertex, 9> clipped{};
+        for (uint32_t plane = 0; plane < CLIP_PLANE_COUNT && count >= 3; plane++)
+        {
+            if (!(outcode & (1u << plane)))
+                continue;
+
+            uint32_t clippedCount = 0;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                const ClipVertex& current = polygon[i];
+                const ClipVertex& next = polygon[(i + 1) % count];
+                const float currentDistance = GetClipDistance(current.Position, plane);
+                const float nextDistance = GetClipDistance(next.Position, plane);
+
+                if (currentDistance >= 0.0f)
+                    clipped[clippedCount++] = current;
+                if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+                    clipped[clippedCount++] = LerpClipVertex(current, next,
+                        currentDistance / (currentDistance - nextDistance));
+            }
+
+            polygon = clipped;
+            count = clippedCount;
+        }
+        return count;
+    }
+
+    float EvaluatePlane(const V3& plane, float x, float y)
+    {
+        return plane.X * x + plane.Y * y + plane.Z;
+    }
+
+    // Bilinear with clamped addressing, like the D3D11 sampler. Channels in [0, 1].
+    V4 SampleTexture(const Texture& texture, float u, float v)
+    {
+        const float x = u * static_cast<float>(texture.Width) - 0.5f;
+        const float y = v * static_cast<float>(texture.Height) - 0.5f;
+        const float floorX = std::floor(x);
+        const float floorY = std::floor(y);
+        const float fx = x - floorX;
+        const float fy = y - floorY;
+
+        const int32_t maxX = texture.Width - 1;
+        const int32_t maxY = texture.Height - 1;
+        const int32_t x0 = std::clamp(static_cast<int32_t>(floorX), 0, maxX);
+        const int32_t y0 = std::clamp(static_cast<int32_t>(floorY), 0, maxY);
+        const int32_t x1 = std::clamp(static_cast<int32_t>(floorX) + 1, 0, maxX);
+        const int32_t y1 = std::clamp(static_cast<int32_t>(floorY) + 1, 0, maxY);
+
+        const unsigned char* p00 = &texture.Pixels[(static_cast<size_t>(y0) * texture.Width + x0) * 4];
+        const unsigned char* p10 = &texture.Pixels[(static_cast<size_t>(y0) * texture.Width + x1) * 4];
+        const unsigned char* p01 = &texture.Pixels[(static_cast<size_t>(y1) * texture.Width + x0) * 4];
+        const unsigned char* p11 = &texture.Pixels[(static_cast<size_t>(y1) * texture.Width + x1) * 4];
+
+        V4 result{};
+#if HANDMADE_MATH_SSE2
+        const auto loadTexel = [](const unsigned char* texel)
+        {
+            int32_t bytes;
+            std::memcpy(&bytes, texel, sizeof(bytes));
+            const __m128i zero = _mm_setzero_si128();
+            return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero));
+        };
+
+        const __m128 c00 = loadTexel(p00);
+        const __m128 c01 = loadTexel(p01);
+        const __m128 top = SimdMulAdd(_mm_sub_ps(loadTexel(p10), c00), _mm_set1_ps(fx), c00);
+        const __m128 bottom = SimdMulAdd(_mm_sub_ps(loadTexel(p11), c01), _mm_set1_ps(fx), c01);
+        const __m128 color = SimdMulAdd(_mm_sub_ps(bottom, top), _mm_set1_ps(fy), top);
+        _mm_storeu_ps(&result.X, _mm_mul_ps(color, _mm_set1_ps(1.0f / 255.0f)));
+#else
+        float channels[4];
+        for (int c = 0; c < 4; c++)
+        {
+            const float top = p00[c] + (p10[c] - p00[c]) * fx;
+            const float bottom = p01[c] + (p11[c] - p01[c]) * fx;
+            channels[c] = (top + (bottom - top) * fy) * (1.0f / 255.0f);
+        }
+        result = { channels[0], channels[1], channels[2], channels[3] };
+#endif
+        return result;
+    }
+
+    uint32_t PackColor(float r, float g, float b)
+    {
+        const auto toByte = [](float value)
+        {
+            return static_cast<uint32_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+        };
+        return toByte(r) | (toByte(g) << 8) | (toByte(b) << 16) | 0xFF000000u;
+    }
+}
+
+SoftwareRenderer::SoftwareRenderer(JobSystem* jobs)
+    : Jobs(jobs)
+{
+}
+
+SoftwareRenderer::~SoftwareRenderer() = default;
+
+void SoftwareRenderer::InitRenderer(int gameHeight, int gameWidth, Platform* platform, GameMemory* gameState)
+{
+    Width = gameWidth;
+    Height = gameHeight;
+    // Rows are padded to whole 4 pixel blocks
+    Stride = (gameWidth + 3) & ~3;
+    TilesX = (Width + TILE_SIZE - 1) / TILE_SIZE;
+    TilesY = (Height + TILE_SIZE - 1) / TILE_SIZE;
+
+    Color.assign(static_cast<size_t>(Stride) * Height, 0);
+    Depth.assign(static_cast<size_t>(Stride) * Height, 1.0f);
+    Bins.resize(static_cast<size_t>(TilesX) * TilesY);
+}
+
+void SoftwareRenderer::AddMesh(std::unique_ptr<SoftwareMesh> mesh)
+{
+    mesh->Slot = Meshes.size();
+    Meshes.push_back(std::move(mesh));
+}
+
+void SoftwareRenderer::RemoveMesh(const void* handle)
+{
+    if (!handle)
+        return;
+
+    const size_t slot = static_cast<const SoftwareMesh*>(handle)->Slot;
+    Assert(slot < Meshes.size() && Meshes[slot].get() == handle);
+    std::swap(Meshes[slot], Meshes.back());
+    Meshes[slot]->Slot = slot;
+    Meshes.pop_back();
+}
+
+void SoftwareRenderer::UploadMeshesToGPU(Mesh& mesh, TextureRegistry& textures)
+{
+    auto softwareMesh = std::make_unique<SoftwareMesh>();
+    softwareMesh->Vertices = mesh.Vertices;
+    softwareMesh->Indices = mesh.Indices;
+
+    mesh.VertexBuffer = softwareMesh.get();
+    mesh.IndexBuffer = mesh.Indices.empty() ? nullptr : softwareMesh.get();
+    AddMesh(std::move(softwareMesh));
+
+    for (TextureHandle texture : mesh.Textures)
+    {
+        void* textureView = textures.GetView(texture);
+        if (!textureView)
+        {
+            textureView = CreateTextureView(textures.GetTexture(texture));
+            textures.SetView(texture, textureView);
+        }
+        mesh.TextureViews.emplace_back(textureView);
+    }
+}
+
+void SoftwareRenderer::ReleaseMesh(Mesh& mesh)
+{
+    // The index buffer, when it has one, is the same mesh
+    RemoveMesh(mesh.VertexBuffer);
+
+    mesh.VertexBuffer = nullptr;
+    mesh.IndexBuffer = nullptr;
+    mesh.TextureViews.clear();
+}
+
+void* SoftwareRenderer::UploadIndexBuffer(std::span<const uint32_t> indices)
+{
+    auto softwareMesh = std::make_unique<SoftwareMesh>();
+    softwareMesh->Indices.assign(indices.begin(), indices.end());
+    void* handle = softwareMesh.get();
+    AddMesh(std::move(softwareMesh));
+    return handle;
+}
+
+void SoftwareRenderer::ReleaseIndexBuffer(void* indexBuffer)
+{
+    RemoveMesh(indexBuffer);
+}
+
+void* SoftwareRenderer::CreateTextureView(const Texture& texture)
+{
+    return Textures.emplace_back(std::make_unique<Texture>(texture)).get();
+}
+
+void SoftwareRenderer::RenderScene(GameMemory* gameState)
+{
+    const auto parallelFor = [this](size_t count, const std::function<void(size_t, size_t)>& function)
+    {
+        if (Jobs)
+            Jobs->ParallelFor(count, 1, function);
+        else
+            function(0, count);
+    };
+
+    const Camera& camera = gameState->MainCamera;
+
+    // ------------------- Record Draws -------------------
+    Stats = {};
+    VertexSets.clear();
+    Batches.clear();
+    Ranges.clear();
+    BatchOpen = false;
+    VertexSetOpen = false;
+    CurrentBones = nullptr;
+    CurrentSkinned = false;
+
+    Queue.Begin(BuildRenderView(*gameState));
+    CullStats = SubmitScene(*gameState, GetPixelsPerUnit(camera.Projection, static_cast<float>(Height)), Queue);
+    Queue.Execute(*this);
+
+    // ------------------- Geometry -------------------
+    auto start = std::chrono::steady_clock::now();
+
+    if (Transformed.size() < VertexSets.size())
+        Transformed.resize(VertexSets.size());
+
+    parallelFor(VertexSets.size(), [this](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+                TransformVertexSet(VertexSets[i], Transformed[i]);
+        });
+
+    for (size_t i = 0; i < VertexSets.size(); i++)
+        Stats.Vertices += Transformed[i].End - Transformed[i].First;
+
+    if (BatchTriangles.size() < Batches.size())
+        BatchTriangles.resize(Batches.size());
+
+    parallelFor(Batches.size(), [this](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                BatchTriangles[i].clear();
+                ProcessBatch(Batches[i], BatchTriangles[i]);
+            }
+        });
+
+    auto now = std::chrono::steady_clock::now();
+    Stats.GeometryMs = std::chrono::duration<float, std::milli>(now - start).count();
+    start = now;
+
+    // ------------------- Binning -------------------
+    // Batches in queue order, so every bin keeps the submission order
+    for (auto& bin : Bins)
+        bin.clear();
+
+    for (size_t i = 0; i < Batches.size(); i++)
+    {
+        for (const RasterTriangle& triangle : BatchTriangles[i])
+        {
+            const int32_t minTileX = triangle.MinX / TILE_SIZE;
+            const int32_t maxTileX = triangle.MaxX / TILE_SIZE;
+            const int32_t minTileY = triangle.MinY / TILE_SIZE;
+            const int32_t maxTileY = triangle.MaxY / TILE_SIZE;
+
+            for (int32_t tileY = minTileY; tileY <= maxTileY; tileY++)
+            {
+                for (int32_t tileX = minTileX; tileX <= maxTileX; tileX++)
+                    Bins[static_cast<size_t>(tileY) * TilesX + tileX].push_back(&triangle);
+            }
+
+            Stats.RasterTriangles++;
+            Stats.BinnedTriangles += (maxTileX - minTileX + 1) * (maxTileY - minTileY + 1);
+        }
+    }
+
+    now = std::chrono::steady_clock::now();
+    Stats.BinningMs = std::chrono::duration<float, std::milli>(now - start).count();
+    start = now;
+
+    // ------------------- Raster -------------------
+    parallelFor(Bins.size(), [this](size_t begin, size_t end)
+        {
+            for (size_t tile = begin; tile < end; tile++)
+                RasterizeTile(static_cast<uint32_t>(tile));
+        });
+
+    Stats.RasterMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void SoftwareRenderer::TransformVertexSet(const VertexSet& set, TransformedVertices& transformed) const
+{
+    // The span the set's batches index. Vertices only other levels use,
+    // like the flat-shaded ones appended for coarse LODs, are left out.
+    uint32_t first = UINT32_MAX;
+    uint32_t last = 0;
+    for (uint32_t b = set.FirstBatch; b < set.FirstBatch + set.BatchCount; b++)
+    {
+        // Skipped by ProcessBatch()
+        const DrawBatch& batch = Batches[b];
+        if (!batch.Texture)
+            continue;
+
+        const std::vector<uint32_t>& indices = *batch.Indices;
+        for (uint32_t range = batch.FirstRange; range < batch.FirstRange + batch.RangeCount; range++)
+        {
+            const auto [indexOffset, indexCount] = Ranges[range];
+            for (uint32_t i = indexOffset; i < indexOffset + indexCount; i++)
+            {
+                first = std::min(first, indices[i]);
+                last = std::max(last, indices[i]);
+            }
+        }
+    }
+
+    transformed.First = 0;
+    transformed.End = 0;
+    if (first > last)
+        return;
+    transformed.First = first;
+    transformed.End = last + 1;
+
+    const std::span<const Vertex> vertices = std::span(set.Mesh->Vertices).subspan(first, last + 1 - first);
+    const M4 worldViewProjection = set.World * ViewProjection;
+
+    transformed.ClipPositions.resize(set.Mesh->Vertices.size());
+    transformed.Normals.resize(set.Mesh->Vertices.size());
+    transformed.Outcodes.resize(set.Mesh->Vertices.size());
+
+    // Skinned the way VSMain does, before the world transform
+    thread_local std::vector<V3> skinnedPositions{};
+    thread_local std::vector<V3> skinnedNormals{};
+    if (set.Bones)
+    {
+        skinnedPositions.resize(vertices.size());
+        skinnedNormals.resize(vertices.size());
+        SkinVertices(vertices, *set.Bones, skinnedPositions, skinnedNormals);
+    }
+
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        const V3& position = set.Bones ? skinnedPositions[i] : vertices[i].Position;
+        const V3& vertexNormal = set.Bones ? skinnedNormals[i] : vertices[i].Normal;
+        V4& clipPosition = transformed.ClipPositions[first + i];
+        clipPosition = V4{ position.X, position.Y, position.Z, 1.0f } * worldViewProjection;
+
+        const V4 normal = V4{ vertexNormal.X, vertexNormal.Y, vertexNormal.Z, 0.0f } * set.World;
+        transformed.Normals[first + i] = Normalize(V3{ normal.X, normal.Y, normal.Z });
+        transformed.Outcodes[first + i] = static_cast<uint8_t>(GetOutcode(clipPosition));
+    }
+}
+
+void SoftwareRenderer::ProcessBatch(const DrawBatch& batch, std::vector<RasterTriangle>& triangles) const
+{
+    // Sampling no texture returns zero, which the alpha clip discards
+    if (!batch.Texture)
+        return;
+
+    const std::vector<Vertex>& vertices = batch.Mesh->Vertices;
+    const std::vector<uint32_t>& indices = *batch.Indices;
+
+    // Transformed once for every batch of the set by TransformVertexSet()
+    const TransformedVertices& transformed = Transformed[batch.VertexSet];
+    const std::vector<V4>& clipPositions = transformed.ClipPositions;
+    const std::vector<V3>& normals = transformed.Normals;
+    const std::vector<uint8_t>& outcodes = transformed.Outcodes;
+
+    // ------------------- Clip And Setup -------------------
+    for (uint32_t range = batch.FirstRange; range < batch.FirstRange + batch.RangeCount; range++)
+    {
+        const auto [indexOffset, indexCount] = Ranges[range];
+        for (uint32_t i = indexOffset; i + 2 < indexOffset + indexCount; i += 3)
+        {
+            const uint32_t i0 = indices[i];
+            const uint32_t i1 = indices[i + 1];
+            const uint32_t i2 = indices[i + 2];
+
+            // Entirely outside one plane
+            if (outcodes[i0] & outcodes[i1] & outcodes[i2])
+                continue;
+
+            const std::array<V2, 3> texCoords = { vertices[i0].TexCoord, vertices[i1].TexCoord, vertices[i2].TexCoord };
+            const uint32_t outcode = outcodes[i0] | outcodes[i1] | outcodes[i2];
+            if (!outcode)
+            {
+                SetupTriangle({ clipPositions[i0], clipPositions[i1], clipPositions[i2] }, texCoords,
+                    { normals[i0], normals[i1], normals[i2] }, batch.Texture, triangles);
+                continue;
+            }
+
+            std::array<ClipVertex, 9> polygon{};
+            polygon[0] = { clipPositions[i0], texCoords[0], normals[i0] };
+            polygon[1] = { clipPositions[i1], texCoords[1], normals[i1] };
+            polygon[2] = { clipPositions[i2], texCoords[2], normals[i2] };
+
+            const uint32_t count = ClipPolygon(polygon, 3, outcode);
+            for (uint32_t v = 1; v + 1 < count; v++)
+            {
+                SetupTriangle({ polygon[0].Position, polygon[v].Position, polygon[v + 1].Position },
+                    { polygon[0].TexCoord, polygon[v].TexCoord, polygon[v + 1].TexCoord },
+                    { polygon[0].Normal, polygon[v].Normal, polygon[v + 1].Normal }, batch.Texture, triangles);
+            }
+        }
+    }
+}
+
+void SoftwareRenderer::SetupTriangle(const std::array<V4, 3>& clip, const std::array<V2, 3>& texCoords,
+    const std::array<V3, 3>& normals, const Texture* texture,
+    std::vector<RasterTriangle>& triangles) const
+{
+    float x[3], y[3], z[3], invW[3];
+    for (int i = 0; i < 3; i++)
+    {
+        invW[i] = 1.0f / clip[i].W;
+        x[i] = (clip[i].X * invW[i] * 0.5f + 0.5f) * static_cast<float>(Width);
+        y[i] = (0.5f - clip[i].Y * invW[i] * 0.5f) * static_cast<float>(Height);
+        z[i] = clip[i].Z * invW[i];
+    }
+
+    // Clockwise on screen is front facing, the rest is culled
+    const float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (!(area > 0.0f))
+        return;
+
+    // Pixels whose centers fall inside the bounds
+    RasterTriangle triangle{};
+    triangle.MinX = std::max(static_cast<int32_t>(std::ceil(std::min({ x[0], x[1], x[2] }) - 0.5f)), 0);
+    triangle.MinY = std::max(static_cast<int32_t>(std::ceil(std::min({ y[0], y[1], y[2] }) - 0.5f)), 0);
+    triangle.MaxX = std::min(static_cast<int32_t>(std::floor(std::max({ x[0], x[1], x[2] }) - 0.5f)), Width - 1);
+    triangle.MaxY = std::min(static_cast<int32_t>(std::floor(std::max({ y[0], y[1], y[2] }) - 0.5f)), Height - 1);
+    if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY)
+        return;
+
+    // Edge i is opposite vertex i, so edge i over the area is its barycentric weight
+    for (int i = 0; i < 3; i++)
+    {
+        const int a = (i + 1) % 3;
+        const int b = (i + 2) % 3;
+        const float dx = x[b] - x[a];
+        const float dy = y[b] - y[a];
+        triangle.Edges[i] = { -dy, dx, dy * x[a] - dx * y[a] };
+        triangle.TopLeft[i] = dy < 0.0f || (dy == 0.0f && dx > 0.0f);
+    }
+
+    const float invArea = 1.0f / area;
+    const auto makePlane = [&triangle, invArea](float a0, float a1, float a2) -> V3
+    {
+        return (triangle.Edges[0] * a0 + triangle.Edges[1] * a1 + triangle.Edges[2] * a2) * invArea;
+    };
+
+    triangle.Depth = makePlane(z[0], z[1], z[2]);
+    triangle.InvW = makePlane(invW[0], invW[1], invW[2]);
+    triangle.Attributes[0] = makePlane(texCoords[0].X * invW[0], texCoords[1].X * invW[1], texCoords[2].X * invW[2]);
+    triangle.Attributes[1] = makePlane(texCoords[0].Y * invW[0], texCoords[1].Y * invW[1], texCoords[2].Y * invW[2]);
+    triangle.Attributes[2] = makePlane(normals[0].X * invW[0], normals[1].X * invW[1], normals[2].X * invW[2]);
+    triangle.Attributes[3] = makePlane(normals[0].Y * invW[0], normals[1].Y * invW[1], normals[2].Y * invW[2]);
+    triangle.Attributes[4] = makePlane(normals[0].Z * invW[0], normals[1].Z * invW[1], normals[2].Z * invW[2]);
+    triangle.Texture = texture;
+
+    triangles.push_back(triangle);
+}
+
+void SoftwareRenderer::RasterizeTile(uint32_t tile)
+{
+    const int32_t tileMinX = static_cast<int32_t>(tile % TilesX) * TILE_SIZE;
+    const int32_t tileMinY = static_cast<int32_t>(tile / TilesX) * TILE_SIZE;
+    const int32_t tileMaxX = std::min(tileMinX + TILE_SIZE, Width) - 1;
+    const int32_t tileMaxY = std::min(tileMinY + TILE_SIZE, Height) - 1;
+
+    // ------------------- Clear -------------------
+    const uint32_t clearColor = PackColor(0.0f, 0.2f, 0.4f);
+    for (int32_t y = tileMinY; y <= tileMaxY; y++)
+    {
+        const size_t row = static_cast<size_t>(y) * Stride;
+        std::fill(Color.begin() + row + tileMinX, Color.begin() + row + tileMaxX + 1, clearColor);
+        std::fill(Depth.begin() + row + tileMinX, Depth.begin() + row + tileMaxX + 1, 1.0f);
+    }
+
+    // PSMain lighting terms
+    const V3 lightDirection = { Light.Direction.X, Light.Direction.Y, Light.Direction.Z };
+    const V3 lightColor = { Light.Color.X, Light.Color.Y, Light.Color.Z };
+    const V3 ambient = { Light.Ambient.X * Light.Color.X, Light.Ambient.Y * Light.Color.Y, Light.Ambient.Z * Light.Color.Z };
+
+    for (const RasterTriangle* triangle : Bins[tile])
+    {
+        const int32_t minX = std::max(triangle->MinX, tileMinX);
+        const int32_t maxX = std::min(triangle->MaxX, tileMaxX);
+        const int32_t minY = std::max(triangle->MinY, tileMinY);
+        const int32_t maxY = std::min(triangle->MaxY, tileMaxY);
+
+        // Tiles start on a block, so blocks never cross into another tile
+        const int32_t blockMinX = minX & ~3;
+
+        for (int32_t y = minY; y <= maxY; y++)
+        {
+            const float py = static_cast<float>(y) + 0.5f;
+            float* depthRow = &Depth[static_cast<size_t>(y) * Stride];
+            uint32_t* colorRow = &Color[static_cast<size_t>(y) * Stride];
+
+            for (int32_t blockX = blockMinX; blockX <= maxX; blockX += 4)
+            {
+                const float px = static_cast<float>(blockX) + 0.5f;
+
+                // ------------------- Coverage And Depth -------------------
+                int mask = 0;
+                alignas(16) float depth[4];
+#if HANDMADE_MATH_SSE2
+                const __m128 x = _mm_add_ps(_mm_set1_ps(px), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+                const __m128 zero = _mm_setzero_ps();
+                const __m128i lane = _mm_add_epi32(_mm_set1_epi32(blockX), _mm_setr_epi32(0, 1, 2, 3));
+                __m128 inside = _mm_castsi128_ps(_mm_andnot_si128(
+                    _mm_or_si128(_mm_cmplt_epi32(lane, _mm_set1_epi32(minX)), _mm_cmpgt_epi32(lane, _mm_set1_epi32(maxX))),
+                    _mm_set1_epi32(-1)));
+
+                for (int e = 0; e < 3; e++)
+                {
+                    const V3& edge = triangle->Edges[e];
+                    const __m128 value = SimdMulAdd(_mm_set1_ps(edge.X), x, _mm_set1_ps(edge.Y * py + edge.Z));
+                    __m128 edgeInside = _mm_cmpgt_ps(value, zero);
+                    if (triangle->TopLeft[e])
+                        edgeInside = _mm_or_ps(edgeInside, _mm_cmpeq_ps(value, zero));
+                    inside = _mm_and_ps(inside, edgeInside);
+                }
+
+                const V3& plane = triangle->Depth;
+                const __m128 z = SimdMulAdd(_mm_set1_ps(plane.X), x, _mm_set1_ps(plane.Y * py + plane.Z));
+                inside = _mm_and_ps(inside, _mm_cmplt_ps(z, _mm_loadu_ps(depthRow + blockX)));
+                _mm_store_ps(depth, z);
+                mask = _mm_movemask_ps(inside);
+#else
+                for (int i = 0; i < 4; i++)
+                {
+                    const int32_t pixelX = blockX + i;
+                    if (pixelX < minX || pixelX > maxX)
+                        continue;
+
+                    const float sampleX = px + static_cast<float>(i);
+                    bool covered = true;
+                    for (int e = 0; e < 3; e++)
+                    {
+                        const float value = EvaluatePlane(triangle->Edges[e], sampleX, py);
+                        covered &= value > 0.0f || (value == 0.0f && triangle->TopLeft[e]);
+                    }
+
+                    depth[i] = EvaluatePlane(triangle->Depth, sampleX, py);
+                    if (covered && depth[i] < depthRow[pixelX])
+                        mask |= 1 << i;
+                }
+#endif
+                // ------------------- Pixel Shader -------------------
+                while (mask)
+                {
+                    const int i = std::countr_zero(static_cast<uint32_t>(mask));
+                    mask &= mask - 1;
+
+                    const float sampleX = px + static_cast<float>(i);
+                    const float w = 1.0f / EvaluatePlane(triangle->InvW, sampleX, py);
+                    const float u = EvaluatePlane(triangle->Attributes[0], sampleX, py) * w;
+                    const float v = EvaluatePlane(triangle->Attributes[1], sampleX, py) * w;
+
+                    const V4 objectColor = SampleTexture(*triangle->Texture, u, v);
+                    if (objectColor.W < 0.1f)
+                        continue;
+
+                    // Interpolated without renormalizing, like the shader
+                    const V3 normal = V3{
+                        EvaluatePlane(triangle->Attributes[2], sampleX, py),
+                        EvaluatePlane(triangle->Attributes[3], sampleX, py),
+                        EvaluatePlane(triangle->Attributes[4], sampleX, py) } * w;
+                    const float diffuse = std::max(Dot(normal, lightDirection), 0.0f);
+
+                    colorRow[blockX + i] = PackColor(
+                        (ambient.X + diffuse * lightColor.X) * objectColor.X,
+                        (ambient.Y + diffuse * lightColor.Y) * objectColor.Y,
+                        (ambient.Z + diffuse * lightColor.Z) * objectColor.Z);
+                    depthRow[blockX + i] = depth[i];
+                }
+            }
+        }
+    }
+}
+
+void SoftwareRenderer::RenderText(std::unordered_map<char, FontGlyph>& glyphs,
+    int w, int h, const std::string_view text, float x, float y,
+    const float scale, const V3& color)
+{
+    // Same quads as the D3D11 font pipeline, in pixels from the top left
+    for (char c : text)
+    {
+        auto it = glyphs.find(c);
+        if (it == glyphs.end())
+        {
+            x += 8.f * scale;
+            continue;
+        }
+        const FontGlyph& glyph = it->second;
+        const Texture* texture = static_cast<const Texture*>(glyph.TextureView);
+
+        const float xPos = x + glyph.Bearing.X * scale;
+        const float yPos = y - (glyph.Size.Y - glyph.Bearing.Y) * scale;
+        const float sizeX = glyph.Size.X * scale;
+        const float sizeY = glyph.Size.Y * scale;
+
+        const int32_t minX = std::max(static_cast<int32_t>(std::ceil(std::min(xPos, xPos + sizeX) - 0.5f)), 0);
+        const int32_t maxX = std::min(static_cast<int32_t>(std::floor(std::max(xPos, xPos + sizeX) - 0.5f)), Width - 1);
+        const int32_t minY = std::max(static_cast<int32_t>(std::ceil(std::min(yPos, yPos + sizeY) - 0.5f)), 0);
+        const int32_t maxY = std::min(static_cast<int32_t>(std::floor(std::max(yPos, yPos + sizeY) - 0.5f)), Height - 1);
+
+        for (int32_t pixelY = minY; texture && pixelY <= maxY; pixelY++)
+        {
+            for (int32_t pixelX = minX; pixelX <= maxX; pixelX++)
+            {
+                const float u = (static_cast<float>(pixelX) + 0.5f - xPos) / sizeX;
+                const float v = 1.0f - (static_cast<float>(pixelY) + 0.5f - yPos) / sizeY;
+
+                const V4 diffuse = SampleTexture(*texture, u, v);
+                if (diffuse.W < 0.1f)
+                    continue;
+
+                Color[static_cast<size_t>(pixelY) * Stride + pixelX] =
+                    PackColor(diffuse.X * color.X, diffuse.Y * color.Y, diffuse.Z * color.Z);
+            }
+        }
+
+        x += glyph.Advance * scale;
+    }
+}
+
+void SoftwareRenderer::PresentSwapChain(bool& vSync)
+{
+}
+
+void SoftwareRenderer::SetView(const RenderView& view)
+{
+    ViewProjection = view.View * view.Projection;
+    Light = view.Light;
+    BatchOpen = false;
+    VertexSetOpen = false;
+}
+
+void SoftwareRenderer::SetShader(RenderShader shader)
+{
+}
+
+void SoftwareRenderer::SetGeometry(void* vertexBuffer, void* indexBuffer)
+{
+    CurrentMesh = static_cast<const SoftwareMesh*>(vertexBuffer);
+    CurrentIndices = indexBuffer ? &static_cast<const SoftwareMesh*>(indexBuffer)->Indices : nullptr;
+    BatchOpen = false;
+    VertexSetOpen = false;
+}
+
+void SoftwareRenderer::SetTexture(void* textureView)
+{
+    CurrentTexture = static_cast<const Texture*>(textureView);
+    BatchOpen = false;
+}
+
+void SoftwareRenderer::SetObject(const RenderObject& object)
+{
+    CurrentWorld = object.World;
+    // The queue only sends bones that changed, so this just says whether
+    // the object skins with the bound ones
+    CurrentSkinned = object.Bones != nullptr;
+    BatchOpen = false;
+    VertexSetOpen = false;
+}
+
+void SoftwareRenderer::SetBones(const std::array<M4, MAX_BONES>& bones)
+{
+    CurrentBones = &bones;
+    BatchOpen = false;
+    VertexSetOpen = false;
+}
+
+void SoftwareRenderer::Draw(uint32_t indexCount, uint32_t indexOffset)
+{
+    if (!BatchOpen)
+    {
+        // Only a texture change keeps the set: the queue sorts an object's
+        // draws of one mesh together, so its batches share one transform
+        if (!VertexSetOpen)
+        {
+            VertexSet set{};
+            set.Mesh = CurrentMesh;
+            set.World = CurrentWorld;
+            set.Bones = CurrentSkinned ? CurrentBones : nullptr;
+            set.FirstBatch = static_cast<uint32_t>(Batches.size());
+            VertexSets.push_back(set);
+            VertexSetOpen = true;
+        }
+
+        DrawBatch batch{};
+        batch.Mesh = CurrentMesh;
+        batch.Indices = CurrentIndices;
+        batch.Texture = CurrentTexture;
+        batch.VertexSet = static_cast<uint32_t>(VertexSets.size() - 1);
+        batch.FirstRange = static_cast<uint32_t>(Ranges.size());
+        Batches.push_back(batch);
+        VertexSets.back().BatchCount++;
+        BatchOpen = true;
+    }
+
+    Ranges.emplace_back(indexOffset, indexCount);
+    Batches.back().RangeCount++;
+    Stats.Triangles += indexCount / 3;
+}
+
+bool SoftwareRenderer::SaveFramebuffer(const std::string& path) const
+{
+    const int written = stbi_write_png(path.c_str(), Width, Height, 4, Color.data(), Stride * 4);
+    if (!written)
+        std::println("Failed to write framebuffer: {}", path);
+    return written != 0;
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include "renderer.h"
+#include "render_queue.h"
+
+class JobSystem;
+
+struct SoftwareRasterStats
+{
+    // Triangles in the submitted ranges, and those left after culling and clipping.
+    uint32_t Triangles{};
+    // Vertices skinned and transformed, once per mesh and object.
+    uint32_t Vertices{};
+    uint32_t RasterTriangles{};
+    // Triangle references over all tile bins.
+    uint32_t BinnedTriangles{};
+    float GeometryMs{};
+    float BinningMs{};
+    float RasterMs{};
+};
+
+/*
+	NOTE:
+	Renderer that draws on the CPU into an RGBA8 framebuffer, matching the
+	D3D11 pipeline: the skinning of VSMain (through SkinVertices), default
+	rasterizer state (clockwise front faces, back faces culled), a
+	less-than depth test, and the textured, lit PSMain of shaders.hlsl
+	including its alpha clip.
+
+	The scene goes through the render queue. Draws are grouped into batches
+	that share vertices, object and texture. The batches of one mesh and
+	object share a vertex set, transformed once for all of them over just
+	the vertices they index; sets are transformed, then batches clipped, in
+	parallel, their triangles are binned into screen tiles, and
+	tiles are rasterized in parallel with 4-wide edge functions. Each tile
+	keeps submission order, so the image does not depend on the thread count.
+*/
+class SoftwareRenderer final : public Renderer, public RenderBackend
+{
+public:
+    static constexpr int32_t TILE_SIZE = 64;
+
+    // Runs the stages on jobs when given.
+    explicit SoftwareRenderer(JobSystem* jobs = nullptr);
+    ~SoftwareRenderer() override;
+
+    void InitRenderer(int gameHeight, int gameWidth,
+        Platform* platform, GameMemory* gameState) override;
+
+    void UploadMeshesToGPU(Mesh& mesh, TextureRegistry& textures) override;
+    void ReleaseMesh(Mesh& mesh) override;
+    void* UploadIndexBuffer(std::span<const uint32_t> indices) override;
+    void ReleaseIndexBuffer(void* indexBuffer) override;
+    void* CreateTextureView(const Texture& texture) override;
+
+    void RenderScene(GameMemory* gameState) override;
+    void RenderText(std::unordered_map<char, FontGlyph>& glyphs,
+        int w, int h, const std::string_view text, float x, float y,
+        const float scale, const V3& color) override;
+
+    void PresentSwapChain(bool& vSync) override;
+
+    void SetView(const RenderView& view) override;
+    void SetShader(RenderShader shader) override;
+    void SetGeometry(void* vertexBuffer, void* indexBuffer) override;
+    void SetTexture(void* textureView) override;
+    void SetObject(const RenderObject& object) override;
+    void SetBones(const std::array<M4, MAX_BONES>& bones) override;
+    void Draw(uint32_t indexCount, uint32_t indexOffset) override;
+
+    int32_t GetWidth() const { return Width; }
+    int32_t GetHeight() const { return Height; }
+    // Pixel (x, y) is at y * GetStride() + x, rows top to bottom, bytes in
+    // RGBA order.
+    int32_t GetStride() const { return Stride; }
+    std::span<const uint32_t> GetColorBuffer() const { return Color; }
+
+    bool SaveFramebuffer(const std::string& path) const;
+
+    const SoftwareRasterStats& GetStats() const { return Stats; }
+    // Frustum culling of the last RenderScene().
+    const SceneCullStats& GetCullStats() const { return CullStats; }
+
+private:
+    // Vertex and index buffer handles both point at a mesh; a shared index
+    // buffer is a mesh with no vertices. Slot is the mesh's index in Meshes,
+    // so a release is a swap and pop.
+    struct SoftwareMesh
+    {
+        std::vector<Vertex> Vertices{};
+        std::vector<uint32_t> Indices{};
+        size_t Slot{};
+    };
+
+    // Consecutive batches that share a mesh and object.
+    struct VertexSet
+    {
+        const SoftwareMesh* Mesh{};
+        M4 World{};
+        // Null unless the object is skinned.
+        const std::array<M4, MAX_BONES>* Bones{};
+        uint32_t FirstBatch{};
+        uint32_t BatchCount{};
+    };
+
+    // Clip space vertices of a set, indexed like the mesh's vertices. Only
+    // [First, End), the span its batches index, is filled.
+    struct TransformedVertices
+    {
+        uint32_t First{};
+        uint32_t End{};
+        std::vector<V4> ClipPositions{};
+        std::vector<V3> Normals{};
+        std::vector<uint8_t> Outcodes{};
+    };
+
+    // Draws that share vertices, object and texture.
+    struct DrawBatch
+    {
+        const SoftwareMesh* Mesh{};
+        const std::vector<uint32_t>* Indices{};
+        const Texture* Texture{};
+        uint32_t VertexSet{};
+        uint32_t FirstRange{};
+        uint32_t RangeCount{};
+    };
+
+    // A screen space triangle as plane equations in pixel coordinates:
+    // value(x, y) = A * x + B * y + C.
+    struct RasterTriangle
+    {
+        // Edges opposite each vertex, positive inside.
+        std::array<V3, 3> Edges{};
+        std::array<bool, 3> TopLeft{};
+        V3 Depth{};
+        V3 InvW{};
+        // Texture coordinates and normal, divided by w.
+        std::array<V3, 5> Attributes{};
+        const Texture* Texture{};
+        int32_t MinX{};
+        int32_t MinY{};
+        int32_t MaxX{};
+        int32_t MaxY{};
+    };
+
+    void TransformVertexSet(const VertexSet& set, TransformedVertices& transformed) const;
+    void ProcessBatch(const DrawBatch& batch, std::vector<RasterTriangle>& triangles) const;
+    void SetupTriangle(const std::array<V4, 3>& clip, const std::array<V2, 3>& texCoords,
+        const std::array<V3, 3>& normals, const Texture* texture,
+        std::vector<RasterTriangle>& triangles) const;
+    void RasterizeTile(uint32_t tile);
+    void AddMesh(std::unique_ptr<SoftwareMesh> mesh);
+    void RemoveMesh(const void* handle);
+
+    JobSystem* Jobs{};
+
+    int32_t Width{};
+    int32_t Height{};
+    int32_t Stride{};
+    int32_t TilesX{};
+    int32_t TilesY{};
+    std::vector<uint32_t> Color{};
+    std::vector<float> Depth{};
+
+    std::vector<std::unique_ptr<SoftwareMesh>> Meshes{};
+    std::vector<std::unique_ptr<Texture>> Textures{};
+
+    RenderQueue Queue{};
+
+    // State of the replay in progress
+    M4 ViewProjection{};
+    DirectionalLight Light{};
+    const SoftwareMesh* CurrentMesh{};
+    const std::vector<uint32_t>* CurrentIndices{};
+    const Texture* CurrentTexture{};
+    M4 CurrentWorld{};
+    const std::array<M4, MAX_BONES>* CurrentBones{};
+    bool CurrentSkinned{};
+    bool BatchOpen{};
+    bool VertexSetOpen{};
+
+    std::vector<VertexSet> VertexSets{};
+    std::vector<TransformedVertices> Transformed{};
+    std::vector<DrawBatch> Batches{};
+    std::vector<std::pair<uint32_t, uint32_t>> Ranges{};
+    std::vector<std::vector<RasterTriangle>> BatchTriangles{};
+    std::vector<std::vector<const RasterTriangle*>> Bins{};
+
+    SoftwareRasterStats Stats{};
+    SceneCullStats CullStats{};
+};
@@ -0,0 +1,428 @@
+#include "pch.h"
+#include "world/bvh.h"
+
+DynamicBvh::DynamicBvh(float margin)
+    : Margin(margin)
+{
+}
+
+uint32_t DynamicBvh::Insert(const AABB& bounds, uint32_t userData)
+{
+    Assert(bounds.IsValid());
+
+    const uint32_t leaf = AllocateNode();
+    Node& node = Nodes[leaf];
+    node.Leaf = bounds;
+    node.Bounds = InflateAABB(bounds, Margin);
+    node.UserData = userData;
+    node.Height = 0;
+
+    InsertLeaf(leaf);
+    ProxyCount++;
+    return leaf;
+}
+
+void DynamicBvh::Remove(uint32_t proxy)
+{
+    Assert(proxy < Nodes.size() && Nodes[proxy].IsLeaf() && Nodes[proxy].Height == 0);
+
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+    ProxyCount--;
+}
+
+bool DynamicBvh::Update(uint32_t proxy, const AABB& bounds)
+{
+    Assert(proxy < Nodes.size() && Nodes[proxy].IsLeaf() && Nodes[proxy].Height == 0);
+    Assert(bounds.IsValid());
+
+    Node& node = Nodes[proxy];
+    node.Leaf = bounds;
+
+    // Still inside the fat box, and the fat box is not much too large
+    if (Contains(node.Bounds, bounds) && Contains(InflateAABB(bounds, Margin * 4.0f), node.Bounds))
+        return false;
+
+    RemoveLeaf(proxy);
+    Nodes[proxy].Bounds = InflateAABB(bounds, Margin);
+    InsertLeaf(proxy);
+    return true;
+}
+
+void DynamicBvh::Clear()
+{
+    Nodes.clear();
+    Root = NULL_NODE;
+    FreeList = NULL_NODE;
+    ProxyCount = 0;
+}
+
+uint32_t DynamicBvh::AllocateNode()
+{
+    if (FreeList == NULL_NODE)
+    {
+        Nodes.emplace_back();
+        return static_cast<uint32_t>(Nodes.size() - 1);
+    }
+
+    const uint32_t node = FreeList;
+    FreeList = Nodes[node].Parent;
+    Nodes[node] = {};
+    return node;
+}
+
+void DynamicBvh::FreeNode(uint32_t node)
+{
+    Nodes[node].Parent = FreeList;
+    Nodes[node].Height = -1;
+    FreeList = node;
+}
+
+void DynamicBvh::InsertLeaf(uint32_t leaf)
+{
+    if (Root == NULL_NODE)
+    {
+        Root = leaf;
+        Nodes[leaf].Parent = NULL_NODE;
+        return;
+    }
+
+    // ------------------- Find Sibling -------------------
+    // Descend while a child is cheaper than pairing with this node: the
+    // leaf's box enlarges every ancestor of where it lands.
+    const AABB leafBounds = Nodes[leaf].Bounds;
+    uint32_t index = Root;
+    while (!Nodes[index].IsLeaf())
+    {
+        const Node& node = Nodes[index];
+        const float area = GetSurfaceArea(node.Bounds);
+        const float combinedArea = GetSurfaceArea(MergeAABB(node.Bounds, leafBounds));
+
+        // Cost of a new parent for this node and the leaf
+        const float cost = 2.0f * combinedArea;
+        // Growth pushed onto the ancestors by descending further
+        const float inheritanceCost = 2.0f * (combinedArea - area);
+
+        const auto getChildCost = [&](uint32_t child)
+        {
+            const AABB& childBounds = Nodes[child].Bounds;
+            const float merged = GetSurfaceArea(MergeAABB(leafBounds, childBounds));
+            if (Nodes[child].IsLeaf())
+                return merged + inheritanceCost;
+            return merged - GetSurfaceArea(childBounds) + inheritanceCost;
+        };
+
+        const float leftCost = getChildCost(node.Left);
+        const float rightCost = getChildCost(node.Right);
+        if (cost < leftCost && cost < rightCost)
+            break;
+
+        index = leftCost < rightCost ? node.Left : node.Right;
+    }
+    const uint32_t sibling = index;
+
+    // ------------------- New Parent -------------------
+    const uint32_t oldParent = Nodes[sibling].Parent;
+    const uint32_t newParent = AllocateNode();
+    Nodes[newParent].Parent = oldParent;
+    Nodes[newParent].Bounds = MergeAABB(leafBounds, Nodes[sibling].Bounds);
+    Nodes[newParent].Height = Nodes[sibling].Height + 1;
+    Nodes[newParent].Left = sibling;
+    Nodes[newParent].Right = leaf;
+    Nodes[sibling].Parent = newParent;
+    Nodes[leaf].Parent = newParent;
+
+    if (oldParent == NULL_NODE)
+        Root = newParent;
+    else if (Nodes[oldParent].Left == sibling)
+        Nodes[oldParent].Left = newParent;
+    else
+        Nodes[oldParent].Right = newParent;
+
+    FixUpwards(oldParent);
+}
+
+void DynamicBvh::RemoveLeaf(uint32_t leaf)
+{
+    if (leaf == Root)
+    {
+        Root = NULL_NODE;
+        return;
+    }
+
+    // The sibling takes the parent's place
+    const uint32_t parent = Nodes[leaf].Parent;
+    const uint32_t grandParent = Nodes[parent].Parent;
+    const uint32_t sibling = Nodes[parent].Left == leaf ? Nodes[parent].Right : Nodes[parent].Left;
+
+    Nodes[sibling].Parent = grandParent;
+    FreeNode(parent);
+
+    if (grandParent == NULL_NODE)
+    {
+        Root = sibling;
+        return;
+    }
+
+    if (Nodes[grandParent].Left == parent)
+        Nodes[grandParent].Left = sibling;
+    else
+        Nodes[grandParent].Right = sibling;
+
+    FixUpwards(grandParent);
+}
+
+void DynamicBvh::FixUpwards(uint32_t node)
+{
+    while (node != NULL_NODE)
+    {
+        node = Balance(node);
+
+        Node& current = Nodes[node];
+        const Node& left = Nodes[current.Left];
+        const Node& right = Nodes[current.Right];
+        current.Height = 1 + std::max(left.Height, right.Height);
+        current.Bounds = MergeAABB(left.Bounds, right.Bounds);
+
+        node = current.Parent;
+    }
+}
+
+// Rotates the taller child of node above it when the child heights differ
+// by more than one. Returns the node now in node's place.
+uint32_t DynamicBvh::Balance(uint32_t node)
+{
+    Node& a = Nodes[node];
+    if (a.IsLeaf() || a.Height < 2)
+        return node;
+
+    const uint32_t b = a.Left;
+    const uint32_t c = a.Right;
+    const int32_t balance = Nodes[c].Height - Nodes[b].Height;
+    if (balance >= -1 && balance <= 1)
+        return node;
+
+    // up is the taller child, down the other one. up's taller child stays
+    // with it and its shorter child moves under node.
+    const bool rotateRight = balance > 1;
+    const uint32_t up = rotateRight ? c : b;
+    const uint32_t down = rotateRight ? b : c;
+    Node& upNode = Nodes[up];
+
+    const uint32_t f = upNode.Left;
+    const uint32_t g = upNode.Right;
+    const bool keepLeft = Nodes[f].Height > Nodes[g].Height;
+    const uint32_t kept = keepLeft ? f : g;
+    const uint32_t moved = keepLeft ? g : f;
+
+    // ------------------- Swap Node And Up -------------------
+    upNode.Left = node;
+    upNode.Parent = a.Parent;
+    a.Parent = up;
+
+    if (upNode.Parent == NULL_NODE)
+        Root = up;
+    else if (Nodes[upNode.Parent].Left == node)
+        Nodes[upNode.Parent].Left = up;
+    else
+        Nodes[upNode.Parent].Right = up;
+
+    // ------------------- Reattach Grandchildren -------------------
+    upNode.Right = kept;
+    if (rotateRight)
+        a.Right = moved;
+    else
+        a.Left = moved;
+    Nodes[moved].Parent = node;
+
+    a.Bounds = MergeAABB(Nodes[down].Bounds, Nodes[moved].Bounds);
+    a.Height = 1 + std::max(Nodes[down].Height, Nodes[moved].Height);
+    upNode.Bounds = MergeAABB(a.Bounds, Nodes[kept].Bounds);
+    upNode.Height = 1 + std::max(a.Height, Nodes[kept].Height);
+
+    return up;
+}
+
+void DynamicBvh::CollectLeaves(uint32_t node, std::vector<uint32_t>& results) const
+{
+    uint32_t stack[MAX_STACK];
+    uint32_t count = 0;
+    stack[count++] = node;
+
+    while (count > 0)
+    {
+        const Node& current = Nodes[stack[--count]];
+        if (current.IsLeaf())
+        {
+            results.push_back(current.UserData);
+            continue;
+        }
+
+        Assert(count + 2 <= MAX_STACK);
+        stack[count++] = current.Right;
+        stack[count++] = current.Left;
+    }
+}
+
+void DynamicBvh::QueryFrustum(const Frustum& frustum, std::vector<uint32_t>& results) const
+{
+    if (Root == NULL_NODE)
+        return;
+
+    uint32_t stack[MAX_STACK];
+    uint32_t count = 0;
+    stack[count++] = Root;
+
+    while (count > 0)
+    {
+        const uint32_t index = stack[--count];
+        const Node& node = Nodes[index];
+
+        const FrustumTest test = ClassifyAABB(frustum, node.Bounds);
+        if (test == FrustumTest::Outside)
+            continue;
+
+        // A fat box inside the frustum holds everything below it
+        if (test == FrustumTest::Inside)
+        {
+            CollectLeaves(index, results);
+            continue;
+        }
+
+        if (node.IsLeaf())
+        {
+            if (IsAABBInFrustum(frustum, node.Leaf))
+                results.push_back(node.UserData);
+            continue;
+        }
+
+        Assert(count + 2 <= MAX_STACK);
+        stack[count++] = node.Right;
+        stack[count++] = node.Left;
+    }
+}
+
+void DynamicBvh::QueryAABB(const AABB& bounds, std::vector<uint32_t>& results) const
+{
+    if (Root == NULL_NODE)
+        return;
+
+    uint32_t stack[MAX_STACK];
+    uint32_t count = 0;
+    stack[count++] = Root;
+
+    while (count > 0)
+    {
+        const Node& node = Nodes[stack[--count]];
+        if (!Overlaps(node.Bounds, bounds))
+            continue;
+
+        if (node.IsLeaf())
+        {
+            if (Overlaps(node.Leaf, bounds))
+                results.push_back(node.UserData);
+            continue;
+        }
+
+        Assert(count + 2 <= MAX_STACK);
+        stack[count++] = node.Right;
+        stack[count++] = node.Left;
+    }
+}
+
+bool DynamicBvh::Raycast(const V3& origin, const V3& direction, float maxDistance, BvhRayHit& hit) const
+{
+    if (Root == NULL_NODE)
+        return false;
+
+    float closest = maxDistance;
+    bool found = false;
+
+    uint32_t stack[MAX_STACK];
+    uint32_t count = 0;
+    float distance = 0.0f;
+    if (IntersectRayAABB(origin, direction, Nodes[Root].Bounds, closest, distance))
+        stack[count++] = Root;
+
+    while (count > 0)
+    {
+        const Node& node = Nodes[stack[--count]];
+
+        if (node.IsLeaf())
+        {
+            if (IntersectRayAABB(origin, direction, node.Leaf, closest, distance))
+            {
+                closest = distance;
+                hit.UserData = node.UserData;
+                hit.Distance = distance;
+                hit.Position = origin + direction * distance;
+                found = true;
+            }
+            continue;
+        }
+
+        // Children are checked against the closest hit so far and the
+        // nearer one is visited first, which shrinks the ray sooner.
+        float leftDistance = 0.0f;
+        float rightDistance = 0.0f;
+        const bool hitLeft = IntersectRayAABB(origin, direction, Nodes[node.Left].Bounds, closest, leftDistance);
+        const bool hitRight = IntersectRayAABB(origin, direction, Nodes[node.Right].Bounds, closest, rightDistance);
+
+        Assert(count + 2 <= MAX_STACK);
+        if (hitLeft && hitRight)
+        {
+            const bool leftFirst = leftDistance <= rightDistance;
+            stack[count++] = leftFirst ? node.Right : node.Left;
+            stack[count++] = leftFirst ? node.Left : node.Right;
+        }
+        else if (hitLeft)
+        {
+            stack[count++] = node.Left;
+        }
+        else if (hitRight)
+        {
+            stack[count++] = node.Right;
+        }
+    }
+
+    return found;
+}
+
+bool DynamicBvh::Validate() const
+{
+    if (Root == NULL_NODE)
+        return ProxyCount == 0;
+    if (Nodes[Root].Parent != NULL_NODE)
+        return false;
+
+    uint32_t leaves = 0;
+    std::vector<uint32_t> stack{ Root };
+    while (!stack.empty())
+    {
+        const uint32_t index = stack.back();
+        stack.pop_back();
+        const Node& node = Nodes[index];
+
+        if (node.IsLeaf())
+        {
+            if (node.Height != 0 || node.Right != NULL_NODE || !Contains(node.Bounds, node.Leaf))
+                return false;
+            leaves++;
+            continue;
+        }
+
+        const Node& left = Nodes[node.Left];
+        const Node& right = Nodes[node.Right];
+        if (left.Parent != index || right.Parent != index)
+            return false;
+        if (node.Height != 1 + std::max(left.Height, right.Height))
+            return false;
+        if (!Contains(node.Bounds, left.Bounds) || !Contains(node.Bounds, right.Bounds))
+            return false;
+
+        stack.push_back(node.Left);
+        stack.push_back(node.Right);
+    }
+
+    return leaves == ProxyCount;
+}
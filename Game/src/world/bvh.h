@@ -0,0 +1,95 @@
+#pragma once
+
+#include "math/bounds.h"
+
+struct BvhRayHit
+{
+    uint32_t UserData{};
+    V3 Position{};
+    float Distance{};
+};
+
+/*
+	NOTE:
+	Dynamic AABB tree over world space boxes, after Box2D's b2DynamicTree.
+	Leaves store the caller's box and a fat copy grown by a margin; inner
+	nodes bound their children's fat boxes. Inserts descend by the surface
+	area heuristic and tree rotations keep it height balanced.
+
+	Update() is incremental: a box that still fits its fat box only replaces
+	the leaf's box, so small motion costs no tree work. One that leaves it,
+	or shrinks well inside it, is removed and reinserted, refitting the
+	nodes above. Proxies are leaf indices and stay valid until Remove().
+
+	Queries test the fat boxes on the way down and the leaf boxes at the
+	bottom, so they are exact for the stored boxes.
+*/
+class DynamicBvh
+{
+public:
+    static constexpr uint32_t NULL_NODE = UINT32_MAX;
+
+    // margin is in world units, about how far a box may move before its
+    // leaf is reinserted.
+    explicit DynamicBvh(float margin = 0.5f);
+
+    uint32_t Insert(const AABB& bounds, uint32_t userData);
+    void Remove(uint32_t proxy);
+    // Returns true when the leaf had to be reinserted.
+    bool Update(uint32_t proxy, const AABB& bounds);
+    void Clear();
+
+    // Append the user data of every matching leaf to results.
+    void QueryFrustum(const Frustum& frustum, std::vector<uint32_t>& results) const;
+    void QueryAABB(const AABB& bounds, std::vector<uint32_t>& results) const;
+    // Closest leaf box the ray enters within maxDistance. direction must be
+    // unit length; a ray starting inside a box hits it at distance 0.
+    bool Raycast(const V3& origin, const V3& direction, float maxDistance, BvhRayHit& hit) const;
+
+    uint32_t GetUserData(uint32_t proxy) const { return Nodes[proxy].UserData; }
+    const AABB& GetBounds(uint32_t proxy) const { return Nodes[proxy].Leaf; }
+    const AABB& GetFatBounds(uint32_t proxy) const { return Nodes[proxy].Bounds; }
+
+    uint32_t GetProxyCount() const { return ProxyCount; }
+    // Edges on the longest root to leaf path, 0 for a single leaf.
+    int32_t GetHeight() const { return Root == NULL_NODE ? 0 : Nodes[Root].Height; }
+    size_t GetMemoryUsage() const { return Nodes.capacity() * sizeof(Node); }
+    // Checks links, heights, bounds and the proxy count. For debugging.
+    bool Validate() const;
+
+private:
+    // Enough for any balanced tree that fits in 32 bit indices.
+    static constexpr uint32_t MAX_STACK = 64;
+
+    struct Node
+    {
+        // Fat box for leaves, union of the children otherwise.
+        AABB Bounds{};
+        // The caller's box, leaves only.
+        AABB Leaf{};
+        // Next free node while on the free list.
+        uint32_t Parent{ NULL_NODE };
+        uint32_t Left{ NULL_NODE };
+        uint32_t Right{ NULL_NODE };
+        uint32_t UserData{};
+        // 0 for leaves, -1 while free.
+        int32_t Height{};
+
+        bool IsLeaf() const { return Left == NULL_NODE; }
+    };
+
+    uint32_t AllocateNode();
+    void FreeNode(uint32_t node);
+    void InsertLeaf(uint32_t leaf);
+    void RemoveLeaf(uint32_t leaf);
+    // Refits and rebalances from node up to the root.
+    void FixUpwards(uint32_t node);
+    uint32_t Balance(uint32_t node);
+    void CollectLeaves(uint32_t node, std::vector<uint32_t>& results) const;
+
+    std::vector<Node> Nodes{};
+    uint32_t Root{ NULL_NODE };
+    uint32_t FreeList{ NULL_NODE };
+    uint32_t ProxyCount{};
+    float Margin{};
+};
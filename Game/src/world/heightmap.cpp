@@ -0,0 +1,249 @@
+#include "pch.h"
+#include "world/heightmap.h"
+
+#include <stb_image.h>
+#include <cfloat>
+
+Heightmap LoadHeightmap(const std::string& path, float yScale, float yShift,
+    const V3& origin, Texture* image)
+{
+    Heightmap result{};
+
+    int width, height, nChannels;
+    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nChannels, STBI_rgb_alpha);
+    if (!data)
+    {
+        std::println("Failed to load heightmap: {}", path);
+        return result;
+    }
+
+    result.Width = width;
+    result.Height = height;
+    result.Origin = origin;
+    result.Heights.resize(static_cast<size_t>(width) * height);
+
+    for (size_t i = 0; i < result.Heights.size(); i++)
+        result.Heights[i] = static_cast<float>(data[i * 4]) * yScale - yShift;
+
+    const auto [minHeight, maxHeight] = std::minmax_element(result.Heights.begin(), result.Heights.end());
+    result.MinHeight = *minHeight;
+    result.MaxHeight = *maxHeight;
+
+    if (image)
+    {
+        image->Width = width;
+        image->Height = height;
+        image->Pixels.assign(data, data + static_cast<size_t>(width) * height * 4);
+    }
+
+    stbi_image_free(data);
+
+    std::println("Loaded heightmap {}: {}x{} samples", path, width, height);
+    return result;
+}
+
+V3 GetHeightmapSlope(const Heightmap& heightmap, int32_t x, int32_t z, int32_t spacing)
+{
+    const float left = heightmap.GetSample(x - spacing, z);
+    const float right = heightmap.GetSample(x + spacing, z);
+    const float back = heightmap.GetSample(x, z - spacing);
+    const float front = heightmap.GetSample(x, z + spacing);
+
+    return V3{ left - right, 2.0f * static_cast<float>(spacing), back - front };
+}
+
+V3 GetHeightmapNormal(const Heightmap& heightmap, int32_t x, int32_t z, int32_t spacing)
+{
+    return Normalize(GetHeightmapSlope(heightmap, x, z, spacing));
+}
+
+namespace
+{
+    // The four samples around a grid cell, as a bilinear patch
+    // h(u, v) = H00 + Du * u + Dv * v + Duv * u * v.
+    struct HeightmapCell
+    {
+        float H00{};
+        float Du{};
+        float Dv{};
+        float Duv{};
+    };
+
+    HeightmapCell GetCell(const Heightmap& heightmap, int32_t x, int32_t z)
+    {
+        const int32_t x1 = std::min(x + 1, heightmap.Width - 1);
+        const int32_t z1 = std::min(z + 1, heightmap.Height - 1);
+        const float* row0 = heightmap.Heights.data() + static_cast<size_t>(z) * heightmap.Width;
+        const float* row1 = heightmap.Heights.data() + static_cast<size_t>(z1) * heightmap.Width;
+
+        const float h00 = row0[x];
+        const float h10 = row0[x1];
+        const float h01 = row1[x];
+        const float h11 = row1[x1];
+        return { h00, h10 - h00, h01 - h00, h00 - h10 - h01 + h11 };
+    }
+
+    // Splits a grid coordinate into a clamped cell and the offset inside it.
+    int32_t GetCellCoordinate(float position, int32_t size, float& offset)
+    {
+        position = std::clamp(position, 0.0f, static_cast<float>(size - 1));
+        const int32_t cell = std::min(static_cast<int32_t>(position), std::max(size - 2, 0));
+        offset = position - static_cast<float>(cell);
+        return cell;
+    }
+
+    V3 GetCellNormal(const HeightmapCell& cell, float u, float v)
+    {
+        return Normalize(V3{ -(cell.Du + cell.Duv * v), 1.0f, -(cell.Dv + cell.Duv * u) });
+    }
+}
+
+float SampleHeightmapHeight(const Heightmap& heightmap, float x, float z)
+{
+    float u, v;
+    const int32_t cellX = GetCellCoordinate(x - heightmap.Origin.X, heightmap.Width, u);
+    const int32_t cellZ = GetCellCoordinate(z - heightmap.Origin.Z, heightmap.Height, v);
+    const HeightmapCell cell = GetCell(heightmap, cellX, cellZ);
+
+    return heightmap.Origin.Y + cell.H00 + cell.Du * u + cell.Dv * v + cell.Duv * u * v;
+}
+
+V3 SampleHeightmapNormal(const Heightmap& heightmap, float x, float z)
+{
+    float u, v;
+    const int32_t cellX = GetCellCoordinate(x - heightmap.Origin.X, heightmap.Width, u);
+    const int32_t cellZ = GetCellCoordinate(z - heightmap.Origin.Z, heightmap.Height, v);
+
+    return GetCellNormal(GetCell(heightmap, cellX, cellZ), u, v);
+}
+
+bool RaycastHeightmap(const Heightmap& heightmap, const V3& origin, const V3& direction,
+    float maxDistance, HeightmapHit& hit)
+{
+    if (heightmap.Width < 2 || heightmap.Height < 2)
+        return false;
+
+    const V3 start = origin - heightmap.Origin;
+
+    // ------------------- Clip to the grid -------------------
+    // Only the top is clipped in Y; below it every ray hits.
+    float tMin = 0.0f;
+    float tMax = maxDistance;
+
+    const float lower[3] = { 0.0f, -FLT_MAX, 0.0f };
+    const float upper[3] = { static_cast<float>(heightmap.Width - 1), heightmap.MaxHeight,
+        static_cast<float>(heightmap.Height - 1) };
+    const float starts[3] = { start.X, start.Y, start.Z };
+    const float directions[3] = { direction.X, direction.Y, direction.Z };
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (directions[axis] == 0.0f)
+        {
+            if (starts[axis] < lower[axis] || starts[axis] > upper[axis])
+                return false;
+            continue;
+        }
+
+        const float inverse = 1.0f / directions[axis];
+        float t0 = (lower[axis] - starts[axis]) * inverse;
+        float t1 = (upper[axis] - starts[axis]) * inverse;
+        if (t0 > t1)
+            std::swap(t0, t1);
+
+        tMin = std::max(tMin, t0);
+        tMax = std::min(tMax, t1);
+    }
+
+    if (tMin > tMax)
+        return false;
+
+    // ------------------- Walk the cells -------------------
+    float u, v;
+    int32_t cellX = GetCellCoordinate(start.X + direction.X * tMin, heightmap.Width, u);
+    int32_t cellZ = GetCellCoordinate(start.Z + direction.Z * tMin, heightmap.Height, v);
+
+    const int32_t stepX = direction.X > 0.0f ? 1 : -1;
+    const int32_t stepZ = direction.Z > 0.0f ? 1 : -1;
+    const float deltaX = direction.X != 0.0f ? std::abs(1.0f / direction.X) : FLT_MAX;
+    const float deltaZ = direction.Z != 0.0f ? std::abs(1.0f / direction.Z) : FLT_MAX;
+    float nextX = direction.X != 0.0f
+        ? (static_cast<float>(cellX + (stepX > 0)) - start.X) / direction.X : FLT_MAX;
+    float nextZ = direction.Z != 0.0f
+        ? (static_cast<float>(cellZ + (stepZ > 0)) - start.Z) / direction.Z : FLT_MAX;
+
+    float t = tMin;
+    while (true)
+    {
+        const float tExit = std::min({ nextX, nextZ, tMax });
+        const HeightmapCell cell = GetCell(heightmap, cellX, cellZ);
+
+        // Skip cells the ray passes entirely above.
+        const float cellMax = cell.H00 + std::max({ 0.0f, cell.Du, cell.Dv, cell.Du + cell.Dv + cell.Duv });
+        const float rayMin = start.Y + direction.Y * (direction.Y < 0.0f ? tExit : t);
+        if (rayMin <= cellMax)
+        {
+            // f(s) = ray height - patch height, a quadratic in s = t - tEnter.
+            const float u0 = start.X + direction.X * t - static_cast<float>(cellX);
+            const float v0 = start.Z + direction.Z * t - static_cast<float>(cellZ);
+            const float y0 = start.Y + direction.Y * t;
+
+            const float a = -cell.Duv * direction.X * direction.Z;
+            const float b = direction.Y - (cell.Du * direction.X + cell.Dv * direction.Z
+                + cell.Duv * (u0 * direction.Z + v0 * direction.X));
+            const float c = y0 - (cell.H00 + cell.Du * u0 + cell.Dv * v0 + cell.Duv * u0 * v0);
+            const float sMax = tExit - t;
+
+            float s = -1.0f;
+            if (c <= 0.0f)
+            {
+                s = 0.0f;
+            }
+            else if (std::abs(a) < 1e-7f)
+            {
+                if (b < 0.0f)
+                    s = -c / b;
+            }
+            else
+            {
+                const float discriminant = b * b - 4.0f * a * c;
+                if (discriminant >= 0.0f)
+                {
+                    const float q = -0.5f * (b + std::copysign(std::sqrt(discriminant), b));
+                    const float r0 = q / a;
+                    const float r1 = q != 0.0f ? c / q : -1.0f;
+                    s = std::min(r0 >= 0.0f ? r0 : FLT_MAX, r1 >= 0.0f ? r1 : FLT_MAX);
+                }
+            }
+
+            if (s >= 0.0f && s <= sMax)
+            {
+                hit.Distance = t + s;
+                hit.Position = origin + direction * hit.Distance;
+                hit.Normal = GetCellNormal(cell,
+                    std::clamp(u0 + direction.X * s, 0.0f, 1.0f),
+                    std::clamp(v0 + direction.Z * s, 0.0f, 1.0f));
+                return true;
+            }
+        }
+
+        if (tExit >= tMax)
+            return false;
+
+        if (nextX < nextZ)
+        {
+            cellX += stepX;
+            t = nextX;
+            nextX += deltaX;
+        }
+        else
+        {
+            cellZ += stepZ;
+            t = nextZ;
+            nextZ += deltaZ;
+        }
+
+        if (cellX < 0 || cellX > heightmap.Width - 2 || cellZ < 0 || cellZ > heightmap.Height - 2)
+            return false;
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "assets/assets.h"
+
+// Terrain heights sampled on a regular grid in the XZ plane, one world unit
+// apart. Sample (x, z) sits at Origin + (x, Heights[x + z * Width], z).
+struct Heightmap
+{
+    int32_t Width{};
+    int32_t Height{};
+    std::vector<float> Heights{};
+    V3 Origin{};
+
+    float MinHeight{};
+    float MaxHeight{};
+
+    bool IsValid() const { return Width > 0 && Height > 0; }
+
+    // Coordinates are clamped to the grid.
+    float GetSample(int32_t x, int32_t z) const
+    {
+        x = std::clamp(x, 0, Width - 1);
+        z = std::clamp(z, 0, Height - 1);
+        return Heights[static_cast<size_t>(x) + static_cast<size_t>(z) * Width];
+    }
+};
+
+// Reads the first channel of an image as pixel * yScale - yShift. The
+// decoded RGBA image is returned in image when given, for texturing.
+Heightmap LoadHeightmap(const std::string& path, float yScale, float yShift,
+    const V3& origin, Texture* image = nullptr);
+
+// Unnormalized normal from central differences over spacing samples, for
+// callers that normalize many at once.
+V3 GetHeightmapSlope(const Heightmap& heightmap, int32_t x, int32_t z, int32_t spacing = 1);
+
+// Unit normal from central differences over spacing samples.
+V3 GetHeightmapNormal(const Heightmap& heightmap, int32_t x, int32_t z, int32_t spacing = 1);
+
+// World height at a world XZ position, bilinear between the four samples
+// around it. Positions outside the grid are clamped to its border.
+float SampleHeightmapHeight(const Heightmap& heightmap, float x, float z);
+// Unit normal of the same bilinear surface.
+V3 SampleHeightmapNormal(const Heightmap& heightmap, float x, float z);
+
+struct HeightmapHit
+{
+    V3 Position{};
+    V3 Normal{};
+    float Distance{};
+};
+
+/*
+	NOTE:
+	Walks the grid cells under the ray (DDA) and intersects the bilinear
+	patch of each cell exactly, so hits agree with SampleHeightmapHeight().
+	Cells the ray passes above are skipped after a bounds check. direction
+	must be unit length. A ray starting below the surface hits at its start.
+*/
+bool RaycastHeightmap(const Heightmap& heightmap, const V3& origin, const V3& direction,
+    float maxDistance, HeightmapHit& hit);
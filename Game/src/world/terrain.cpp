@@ -0,0 +1,499 @@
+#include "pch.h"
+#include "world/terrain.h"
+#include "assets/mesh_optimizer.h"
+#include "assets/mesh_bounds.h"
+#include "assets/vertex_format.h"
+#include "math/vector_stream.h"
+#include "renderer/renderer.h"
+
+Terrain::Terrain(Heightmap heightmap, TextureHandle texture, JobSystem* jobs,
+    const TerrainSettings& settings)
+    : Map(std::move(heightmap)), TerrainTexture(texture), Jobs(jobs), Settings(settings)
+{
+    Assert(Map.Width > 1 && Map.Height > 1);
+    Assert(Settings.TileQuads >= 4 && Settings.TileQuads % 2 == 0);
+
+    const uint32_t samples = static_cast<uint32_t>(std::max(Map.Width, Map.Height) - 1);
+    while ((Settings.TileQuads << MaxLevel) < samples)
+        MaxLevel++;
+
+    BuildTopology();
+
+    // The root is the fallback for every node, so it is always resident
+    auto& root = Pending[GetKey(0, 0, 0)] = std::make_unique<PendingTile>();
+    root->Tile = GenerateTile(0, 0, 0);
+}
+
+Terrain::~Terrain()
+{
+    WaitForPending();
+}
+
+void Terrain::WaitForPending()
+{
+    // Jobs write into Pending, so they must finish first
+    if (Jobs)
+    {
+        for (auto& [key, pending] : Pending)
+            Jobs->Wait(pending->Counter);
+    }
+}
+
+void Terrain::Shutdown(Renderer& renderer)
+{
+    WaitForPending();
+    Pending.clear();
+
+    for (auto& [key, tile] : Tiles)
+    {
+        // The shared index buffer is released once, below
+        tile->Mesh.IndexBuffer = nullptr;
+        renderer.ReleaseMesh(tile->Mesh);
+    }
+    Tiles.clear();
+    DrawList.clear();
+
+    if (IndexBuffer)
+        renderer.ReleaseIndexBuffer(IndexBuffer);
+    IndexBuffer = nullptr;
+}
+
+void Terrain::BuildTopology()
+{
+    const uint32_t quads = Settings.TileQuads;
+    const uint32_t rowSize = quads + 1;
+
+    // Odd vertices on an edge are the ones a coarser neighbour does not have
+    auto getOddEdge = [quads](const uint32_t i, const uint32_t j) -> int32_t
+    {
+        if (j == 0 && i % 2 == 1) return EDGE_MIN_Z;
+        if (i == quads && j % 2 == 1) return EDGE_MAX_X;
+        if (j == quads && i % 2 == 1) return EDGE_MAX_Z;
+        if (i == 0 && j % 2 == 1) return EDGE_MIN_X;
+        return -1;
+    };
+
+    // Along the edge, back to the previous even vertex
+    auto collapse = [quads, rowSize](const uint32_t i, const uint32_t j, const int32_t edge)
+    {
+        if (edge == EDGE_MIN_Z || edge == EDGE_MAX_Z)
+            return (i - 1) + j * rowSize;
+        return i + (j - 1) * rowSize;
+    };
+
+    std::vector<uint32_t> interior{};
+    std::array<std::vector<uint32_t>, 4> plain{};
+    std::array<std::vector<uint32_t>, 4> stitched{};
+
+    for (uint32_t z = 0; z < quads; z++)
+    {
+        for (uint32_t x = 0; x < quads; x++)
+        {
+            const std::array<uint32_t, 2> topLeft = { x, z };
+            const std::array<uint32_t, 2> topRight = { x + 1, z };
+            const std::array<uint32_t, 2> bottomLeft = { x, z + 1 };
+            const std::array<uint32_t, 2> bottomRight = { x + 1, z + 1 };
+
+            // The two corner quads whose usual diagonal joins the odd vertices
+            // of two edges are split the other way, so every triangle touches
+            // at most one edge and the edges stitch independently.
+            const bool flip = (x == 0 && z == 0) || (x == quads - 1 && z == quads - 1);
+            std::array<std::array<std::array<uint32_t, 2>, 3>, 2> triangles{};
+            if (flip)
+                triangles = { { { topLeft, bottomLeft, bottomRight }, { topLeft, bottomRight, topRight } } };
+            else
+                triangles = { { { topLeft, bottomLeft, topRight }, { topRight, bottomLeft, bottomRight } } };
+
+            for (const auto& triangle : triangles)
+            {
+                int32_t edge = -1;
+                for (const auto& [i, j] : triangle)
+                {
+                    const int32_t oddEdge = getOddEdge(i, j);
+                    Assert(oddEdge < 0 || edge < 0 || oddEdge == edge);
+                    if (oddEdge >= 0)
+                        edge = oddEdge;
+                }
+
+                std::array<uint32_t, 3> corners{};
+                std::array<uint32_t, 3> collapsed{};
+                for (size_t c = 0; c < 3; c++)
+                {
+                    const auto [i, j] = triangle[c];
+                    corners[c] = i + j * rowSize;
+                    collapsed[c] = getOddEdge(i, j) >= 0 ? collapse(i, j, edge) : corners[c];
+                }
+
+                if (edge < 0)
+                {
+                    interior.insert(interior.end(), corners.begin(), corners.end());
+                    continue;
+                }
+
+                plain[edge].insert(plain[edge].end(), corners.begin(), corners.end());
+
+                // Triangles spanning a collapsed vertex and its target vanish
+                if (collapsed[0] != collapsed[1] && collapsed[1] != collapsed[2] && collapsed[0] != collapsed[2])
+                    stitched[edge].insert(stitched[edge].end(), collapsed.begin(), collapsed.end());
+            }
+        }
+    }
+
+    const size_t vertexCount = static_cast<size_t>(rowSize) * rowSize;
+    auto append = [this, vertexCount](std::vector<uint32_t>& indices) -> Submesh
+    {
+        OptimizeVertexCache(indices, vertexCount);
+
+        const Submesh result{ static_cast<uint32_t>(TileIndices.size()), static_cast<uint32_t>(indices.size()), 0 };
+        TileIndices.insert(TileIndices.end(), indices.begin(), indices.end());
+        return result;
+    };
+
+    TileRanges[0] = append(interior);
+    for (uint32_t edge = 0; edge < 4; edge++)
+    {
+        TileRanges[1 + edge * 2] = append(plain[edge]);
+        TileRanges[2 + edge * 2] = append(stitched[edge]);
+    }
+}
+
+TerrainTile Terrain::GenerateTile(uint32_t level, uint32_t x, uint32_t z) const
+{
+    const uint32_t quads = Settings.TileQuads;
+    const int32_t step = 1 << (MaxLevel - level);
+    const int32_t span = static_cast<int32_t>(quads) * step;
+
+    TerrainTile result{};
+    result.Level = level;
+    result.X = x;
+    result.Z = z;
+
+    Mesh& mesh = result.Mesh;
+    mesh.Vertices.reserve(static_cast<size_t>(quads + 1) * (quads + 1));
+
+    // Slopes are gathered and normalized a row at a time, so the stream
+    // stays in L1 while its vertices are still in cache.
+    V3Stream normals{};
+    normals.Resize(quads + 1);
+
+    // Samples past the heightmap are clamped, which flattens the overhang
+    // into zero area triangles.
+    for (uint32_t j = 0; j <= quads; j++)
+    {
+        const int32_t sampleZ = std::min<int32_t>(z * span + j * step, Map.Height - 1);
+        const size_t rowStart = mesh.Vertices.size();
+        for (uint32_t i = 0; i <= quads; i++)
+        {
+            const int32_t sampleX = std::min<int32_t>(x * span + i * step, Map.Width - 1);
+
+            Vertex v{};
+            v.Position = Map.Origin + V3{ static_cast<float>(sampleX),
+                Map.GetSample(sampleX, sampleZ), static_cast<float>(sampleZ) };
+            v.TexCoord.X = static_cast<float>(sampleX) / (Map.Width - 1);
+            v.TexCoord.Y = static_cast<float>(sampleZ) / (Map.Height - 1);
+
+            normals.Set(i, GetHeightmapSlope(Map, sampleX, sampleZ, step));
+            mesh.Vertices.push_back(v);
+        }
+
+        V3StreamNormalize(normals, normals);
+        for (uint32_t i = 0; i <= quads; i++)
+            mesh.Vertices[rowStart + i].Normal = normals.Get(i);
+    }
+
+    // Indices stay empty, every tile draws with the shared index buffer
+    mesh.Submeshes.assign(TileRanges.begin(), TileRanges.end());
+    mesh.Textures.push_back(TerrainTexture);
+    ComputeMeshBounds(mesh);
+    result.VertexBytes = mesh.Vertices.size() * sizeof(Vertex);
+    result.PackedVertexBytes = GetPackedVertexSize(mesh.Vertices);
+
+    return result;
+}
+
+bool Terrain::IsInside(uint32_t level, uint32_t x, uint32_t z) const
+{
+    const int64_t span = int64_t(Settings.TileQuads) << (MaxLevel - level);
+    return x * span < Map.Width - 1 && z * span < Map.Height - 1;
+}
+
+float Terrain::GetDistance(const V3& position, uint32_t level, uint32_t x, uint32_t z) const
+{
+    const float span = static_cast<float>(Settings.TileQuads << (MaxLevel - level));
+    const float minX = Map.Origin.X + x * span;
+    const float minZ = Map.Origin.Z + z * span;
+    const float maxX = std::min(minX + span, Map.Origin.X + Map.Width - 1);
+    const float maxZ = std::min(minZ + span, Map.Origin.Z + Map.Height - 1);
+
+    const V3 closest = {
+        std::clamp(position.X, minX, maxX),
+        std::clamp(position.Y, Map.Origin.Y + Map.MinHeight, Map.Origin.Y + Map.MaxHeight),
+        std::clamp(position.Z, minZ, maxZ) };
+    return Length(position - closest);
+}
+
+void Terrain::SelectNodes(const V3& cameraPosition, std::vector<Node>& leaves) const
+{
+    std::vector<Node> stack = { Node{ 0, 0, 0 } };
+    while (!stack.empty())
+    {
+        const Node node = stack.back();
+        stack.pop_back();
+
+        const float span = static_cast<float>(Settings.TileQuads << (MaxLevel - node.Level));
+        const bool split = node.Level < MaxLevel &&
+            GetDistance(cameraPosition, node.Level, node.X, node.Z) < Settings.SplitDistance * span;
+
+        if (!split)
+        {
+            leaves.push_back(node);
+            continue;
+        }
+
+        for (uint32_t child = 0; child < 4; child++)
+        {
+            const Node childNode = { node.Level + 1, node.X * 2 + child % 2, node.Z * 2 + child / 2 };
+            if (IsInside(childNode.Level, childNode.X, childNode.Z))
+                stack.push_back(childNode);
+        }
+    }
+}
+
+void Terrain::FillLevelGrid(std::span<const Node> nodes)
+{
+    const uint32_t gridSize = 1u << MaxLevel;
+    LevelGrid.assign(static_cast<size_t>(gridSize) * gridSize, -1);
+
+    for (const Node& node : nodes)
+    {
+        const uint32_t cells = 1u << (MaxLevel - node.Level);
+        for (uint32_t cz = node.Z * cells; cz < (node.Z + 1) * cells; cz++)
+            for (uint32_t cx = node.X * cells; cx < (node.X + 1) * cells; cx++)
+                LevelGrid[cx + static_cast<size_t>(cz) * gridSize] = static_cast<int32_t>(node.Level);
+    }
+}
+
+int32_t Terrain::GetLevelAt(int64_t cellX, int64_t cellZ) const
+{
+    const int64_t gridSize = int64_t(1) << MaxLevel;
+    if (cellX < 0 || cellZ < 0 || cellX >= gridSize || cellZ >= gridSize)
+        return -1;
+    return LevelGrid[static_cast<size_t>(cellX + cellZ * gridSize)];
+}
+
+void Terrain::BalanceNodes(std::vector<Node>& leaves)
+{
+    // Splitting can unbalance nodes that were fine, so repeat until stable
+    bool changed = true;
+    std::vector<Node> balanced{};
+    while (changed)
+    {
+        changed = false;
+        FillLevelGrid(leaves);
+        balanced.clear();
+
+        for (const Node& node : leaves)
+        {
+            const int64_t cells = int64_t(1) << (MaxLevel - node.Level);
+            const int64_t cx = node.X * cells;
+            const int64_t cz = node.Z * cells;
+
+            int32_t finest = -1;
+            for (int64_t k = 0; k < cells; k++)
+            {
+                finest = std::max({ finest,
+                    GetLevelAt(cx + k, cz - 1), GetLevelAt(cx + cells, cz + k),
+                    GetLevelAt(cx + k, cz + cells), GetLevelAt(cx - 1, cz + k) });
+            }
+
+            if (finest <= static_cast<int32_t>(node.Level) + 1)
+            {
+                balanced.push_back(node);
+                continue;
+            }
+
+            changed = true;
+            for (uint32_t child = 0; child < 4; child++)
+            {
+                const Node childNode = { node.Level + 1, node.X * 2 + child % 2, node.Z * 2 + child / 2 };
+                if (IsInside(childNode.Level, childNode.X, childNode.Z))
+                    balanced.push_back(childNode);
+            }
+        }
+
+        std::swap(leaves, balanced);
+    }
+}
+
+void Terrain::RequestTile(uint32_t level, uint32_t x, uint32_t z)
+{
+    const uint64_t key = GetKey(level, x, z);
+    if (Pending.contains(key) || Pending.size() >= Settings.MaxPendingTiles)
+        return;
+
+    PendingTile* pending = (Pending[key] = std::make_unique<PendingTile>()).get();
+    if (!Jobs)
+    {
+        pending->Tile = GenerateTile(level, x, z);
+        return;
+    }
+
+    Jobs->Execute([this, pending, level, x, z]() { pending->Tile = GenerateTile(level, x, z); },
+        pending->Counter);
+}
+
+void Terrain::CollectDraws(std::span<const uint64_t> selected, uint32_t level,
+    uint32_t x, uint32_t z, std::vector<Node>& draws)
+{
+    // Only resident nodes are visited, and they stay resident while visited
+    // so a missing tile never falls back further than its parent.
+    TerrainTile& tile = *Tiles.at(GetKey(level, x, z));
+    tile.LastUsedFrame = Frame;
+
+    if (std::binary_search(selected.begin(), selected.end(), GetKey(level, x, z)))
+    {
+        draws.push_back({ level, x, z });
+        return;
+    }
+
+    // Not selected means some descendants are. Split only once every child
+    // is resident, until then this tile covers them all.
+    bool ready = true;
+    for (uint32_t child = 0; child < 4; child++)
+    {
+        const uint32_t childX = x * 2 + child % 2;
+        const uint32_t childZ = z * 2 + child / 2;
+        if (IsInside(level + 1, childX, childZ) && !Tiles.contains(GetKey(level + 1, childX, childZ)))
+        {
+            RequestTile(level + 1, childX, childZ);
+            ready = false;
+        }
+    }
+
+    if (!ready)
+    {
+        draws.push_back({ level, x, z });
+        return;
+    }
+
+    for (uint32_t child = 0; child < 4; child++)
+    {
+        const uint32_t childX = x * 2 + child % 2;
+        const uint32_t childZ = z * 2 + child / 2;
+        if (IsInside(level + 1, childX, childZ))
+            CollectDraws(selected, level + 1, childX, childZ, draws);
+    }
+}
+
+void Terrain::Update(const V3& cameraPosition, Renderer& renderer, TextureRegistry& textures)
+{
+    // Nothing is left after Shutdown()
+    if (Tiles.empty() && Pending.empty())
+        return;
+
+    Frame++;
+
+    // ------------------- Upload Finished Tiles -------------------
+    if (!IndexBuffer)
+        IndexBuffer = renderer.UploadIndexBuffer(TileIndices);
+
+    for (auto it = Pending.begin(); it != Pending.end();)
+    {
+        if (it->second->Counter.Pending.load(std::memory_order_acquire) != 0)
+        {
+            ++it;
+            continue;
+        }
+
+        auto tile = std::make_unique<TerrainTile>(std::move(it->second->Tile));
+        renderer.UploadMeshesToGPU(tile->Mesh, textures);
+        tile->Mesh.IndexBuffer = IndexBuffer;
+        // Bounds are computed already, the GPU copy is all that is drawn
+        tile->Mesh.Vertices = {};
+        tile->LastUsedFrame = Frame;
+        Tiles[it->first] = std::move(tile);
+        GeneratedTiles++;
+        it = Pending.erase(it);
+    }
+
+    // ------------------- Select Tiles -------------------
+    std::vector<Node> leaves{};
+    SelectNodes(cameraPosition, leaves);
+    BalanceNodes(leaves);
+
+    std::vector<uint64_t> selected{};
+    selected.reserve(leaves.size());
+    for (const Node& node : leaves)
+        selected.push_back(GetKey(node.Level, node.X, node.Z));
+    std::sort(selected.begin(), selected.end());
+
+    std::vector<Node> draws{};
+    CollectDraws(selected, 0, 0, 0, draws);
+
+    // Stitch the edges that border a coarser drawn tile. Fallback tiles can
+    // break the one level rule for a few frames, which leaves small cracks.
+    FillLevelGrid(draws);
+    DrawList.clear();
+    for (const Node& node : draws)
+    {
+        TerrainTile& tile = *Tiles[GetKey(node.Level, node.X, node.Z)];
+        tile.LastUsedFrame = Frame;
+
+        const int64_t cells = int64_t(1) << (MaxLevel - node.Level);
+        const int64_t cx = node.X * cells;
+        const int64_t cz = node.Z * cells;
+        const std::array<int32_t, 4> neighbourLevels = {
+            GetLevelAt(cx, cz - 1), GetLevelAt(cx + cells, cz),
+            GetLevelAt(cx, cz + cells), GetLevelAt(cx - 1, cz) };
+
+        const float span = static_cast<float>(Settings.TileQuads) * static_cast<float>(cells);
+        TerrainDrawItem item{};
+        item.Mesh = &tile.Mesh;
+        item.VertexBytes = tile.VertexBytes;
+        item.PackedVertexBytes = tile.PackedVertexBytes;
+        item.Center = Map.Origin + V3{ (static_cast<float>(node.X) + 0.5f) * span,
+            (Map.MinHeight + Map.MaxHeight) * 0.5f, (static_cast<float>(node.Z) + 0.5f) * span };
+        item.Submeshes[0] = TileRanges[0];
+        for (uint32_t edge = 0; edge < 4; edge++)
+        {
+            const bool coarser = neighbourLevels[edge] >= 0 &&
+                neighbourLevels[edge] < static_cast<int32_t>(node.Level);
+            item.Submeshes[1 + edge] = TileRanges[1 + edge * 2 + (coarser ? 1 : 0)];
+        }
+        DrawList.push_back(item);
+    }
+
+    // ------------------- Evict Stale Tiles -------------------
+    for (auto it = Tiles.begin(); it != Tiles.end();)
+    {
+        if (it->first != GetKey(0, 0, 0) && Frame - it->second->LastUsedFrame > Settings.EvictAfterFrames)
+        {
+            // The shared index buffer outlives the tile
+            it->second->Mesh.IndexBuffer = nullptr;
+            renderer.ReleaseMesh(it->second->Mesh);
+            it = Tiles.erase(it);
+            EvictedTiles++;
+            continue;
+        }
+        ++it;
+    }
+}
+
+TerrainStats Terrain::GetStats() const
+{
+    TerrainStats result{};
+    result.ResidentTiles = static_cast<uint32_t>(Tiles.size());
+    result.PendingTiles = static_cast<uint32_t>(Pending.size());
+    result.DrawnTiles = static_cast<uint32_t>(DrawList.size());
+    result.GeneratedTiles = GeneratedTiles;
+    result.EvictedTiles = EvictedTiles;
+
+    for (const auto& [key, tile] : Tiles)
+    {
+        result.ResidentVertexBytes += tile->VertexBytes;
+        result.ResidentPackedVertexBytes += tile->PackedVertexBytes;
+    }
+    result.ResidentBytes = result.ResidentVertexBytes + TileIndices.size() * sizeof(uint32_t);
+
+    return result;
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "world/heightmap.h"
+#include "core/job_system.h"
+
+class Renderer;
+class TextureRegistry;
+
+struct TerrainSettings
+{
+    // Quads along a tile edge. Every tile has the same grid; a tile one level
+    // up covers twice the area with every other sample.
+    uint32_t TileQuads{ 64 };
+    // A node splits while the camera is closer than this many node widths.
+    float SplitDistance{ 1.5f };
+    // Frames a tile may go unused before it is evicted. The root never is.
+    uint32_t EvictAfterFrames{ 120 };
+    // Tiles generating at once, so a fast camera cannot flood the workers.
+    uint32_t MaxPendingTiles{ 8 };
+};
+
+// One quadtree node's mesh. Level 0 is the root. Mesh::Submeshes holds every
+// interior and edge range, so tiles are drawn through TerrainDrawItem. Tiles
+// have no Indices, and drop their Vertices once uploaded.
+struct TerrainTile
+{
+    Mesh Mesh{};
+    uint32_t Level{};
+    uint32_t X{};
+    uint32_t Z{};
+    // Last frame the tile was selected or drawn.
+    uint64_t LastUsedFrame{};
+    // Vertex bytes as Vertex and as PackVertices() would store them, kept
+    // for the stats since the vertices are dropped on upload.
+    size_t VertexBytes{};
+    size_t PackedVertexBytes{};
+};
+
+// A tile and the ranges that stitch it to its current neighbours.
+struct TerrainDrawItem
+{
+    const Mesh* Mesh{};
+    std::array<Submesh, 5> Submeshes{};
+    // Middle of the tile's bounds, for sorting.
+    V3 Center{};
+    // The tile's TerrainTile::VertexBytes and PackedVertexBytes.
+    size_t VertexBytes{};
+    size_t PackedVertexBytes{};
+};
+
+struct TerrainStats
+{
+    uint32_t ResidentTiles{};
+    uint32_t PendingTiles{};
+    uint32_t DrawnTiles{};
+    uint32_t GeneratedTiles{};
+    uint32_t EvictedTiles{};
+    // Vertex bytes of the resident tiles plus the shared index buffer.
+    size_t ResidentBytes{};
+    // Vertex bytes of the resident tiles, as Vertex and packed.
+    size_t ResidentVertexBytes{};
+    size_t ResidentPackedVertexBytes{};
+};
+
+/*
+	NOTE:
+	Chunked terrain. A quadtree over the heightmap picks tiles by camera
+	distance, then splits nodes until neighbours differ by at most one level.
+	All tiles share one grid topology, uploaded once as a single index
+	buffer. Its border triangles come in two variants per edge; the stitched
+	one collapses every odd edge vertex onto its even neighbour, so the edge
+	matches the coarser tile next to it.
+	Tiles are generated on the job system and uploaded by Update(). A node
+	splits only once all of its children are resident, and is drawn whole
+	until then. Ancestors of drawn tiles stay resident, so a missing tile
+	is covered by its parent rather than by the root.
+*/
+class Terrain
+{
+public:
+    // Edges of a tile, in TerrainTile submesh order after the interior.
+    static constexpr uint32_t EDGE_MIN_Z = 0;
+    static constexpr uint32_t EDGE_MAX_X = 1;
+    static constexpr uint32_t EDGE_MAX_Z = 2;
+    static constexpr uint32_t EDGE_MIN_X = 3;
+
+    // Generates the root tile before returning. Without jobs every tile is
+    // generated inline.
+    Terrain(Heightmap heightmap, TextureHandle texture, JobSystem* jobs,
+        const TerrainSettings& settings = {});
+    ~Terrain();
+
+    Terrain(const Terrain&) = delete;
+    Terrain& operator=(const Terrain&) = delete;
+
+    // Selects the tiles to draw, queues missing ones, uploads finished ones
+    // and evicts stale ones. Main thread only.
+    void Update(const V3& cameraPosition, Renderer& renderer, TextureRegistry& textures);
+    // Releases every tile's GPU mesh and the shared index buffer. Call before
+    // the renderer goes away; the terrain draws nothing afterwards.
+    void Shutdown(Renderer& renderer);
+
+    std::span<const TerrainDrawItem> GetDrawList() const { return DrawList; }
+    const Heightmap& GetHeightmap() const { return Map; }
+    uint32_t GetMaxLevel() const { return MaxLevel; }
+    TerrainStats GetStats() const;
+
+    // Builds a tile's mesh. Thread safe, it only reads the heightmap.
+    TerrainTile GenerateTile(uint32_t level, uint32_t x, uint32_t z) const;
+
+private:
+    struct Node
+    {
+        uint32_t Level{};
+        uint32_t X{};
+        uint32_t Z{};
+    };
+
+    struct PendingTile
+    {
+        TerrainTile Tile{};
+        JobCounter Counter{};
+    };
+
+    static uint64_t GetKey(uint32_t level, uint32_t x, uint32_t z)
+    {
+        return (uint64_t(level) << 48) | (uint64_t(x) << 24) | z;
+    }
+
+    void BuildTopology();
+    bool IsInside(uint32_t level, uint32_t x, uint32_t z) const;
+    float GetDistance(const V3& position, uint32_t level, uint32_t x, uint32_t z) const;
+    void SelectNodes(const V3& cameraPosition, std::vector<Node>& leaves) const;
+    void BalanceNodes(std::vector<Node>& leaves);
+    void CollectDraws(std::span<const uint64_t> selected, uint32_t level,
+        uint32_t x, uint32_t z, std::vector<Node>& draws);
+    void RequestTile(uint32_t level, uint32_t x, uint32_t z);
+    void WaitForPending();
+    void FillLevelGrid(std::span<const Node> nodes);
+    int32_t GetLevelAt(int64_t cellX, int64_t cellZ) const;
+
+    Heightmap Map{};
+    TextureHandle TerrainTexture{};
+    JobSystem* Jobs{};
+    TerrainSettings Settings{};
+    uint32_t MaxLevel{};
+
+    // Interior, then the plain and stitched triangles of each edge. Uploaded
+    // once by the first Update() and shared by every tile.
+    std::vector<uint32_t> TileIndices{};
+    std::array<Submesh, 9> TileRanges{};
+    void* IndexBuffer{};
+
+    std::unordered_map<uint64_t, std::unique_ptr<TerrainTile>> Tiles{};
+    std::unordered_map<uint64_t, std::unique_ptr<PendingTile>> Pending{};
+    std::vector<TerrainDrawItem> DrawList{};
+    // Level of the drawn node over each cell of the finest tile grid, -1 where none.
+    std::vector<int32_t> LevelGrid{};
+
+    uint64_t Frame{};
+    uint32_t GeneratedTiles{};
+    uint32_t EvictedTiles{};
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+/*
+	NOTE:
+	Minimal test registry for the headless tests program. TEST_CASE bodies
+	register themselves before main(); CHECK records a failure and carries
+	on, REQUIRE also returns from the test. Tests run from the repository
+	root, so they can load files under assets/.
+*/
+
+struct TestCase
+{
+    const char* Name{};
+    void (*Function)(){};
+};
+
+std::vector<TestCase>& GetTestCases();
+void ReportFailure(const char* file, int line, const std::string& message);
+
+struct TestRegistrar
+{
+    TestRegistrar(const char* name, void (*function)())
+    {
+        GetTestCases().push_back({ name, function });
+    }
+};
+
+#define TEST_CASE(name) \
+    static void name(); \
+    static TestRegistrar name##Registrar{ #name, name }; \
+    static void name()
+
+#define CHECK(expr) \
+    do { if (!(expr)) ReportFailure(__FILE__, __LINE__, #expr); } while (0)
+
+#define CHECK_NEAR(a, b, tolerance) \
+    do { \
+        const double checkA = (a), checkB = (b); \
+        if (!(std::abs(checkA - checkB) <= (tolerance))) \
+            ReportFailure(__FILE__, __LINE__, std::format("{} = {} vs {} = {}", #a, checkA, #b, checkB)); \
+    } while (0)
+
+#define REQUIRE(expr) \
+    do { if (!(expr)) { ReportFailure(__FILE__, __LINE__, #expr); return; } } while (0)
@@ -0,0 +1,143 @@
+#include "pch.h"
+#include "test.h"
+#include "assets/animator.h"
+#include "assets/model_loader.h"
+#include "assets/texture_registry.h"
+
+static Model LoadTestModel(bool compressAnimations)
+{
+    TextureRegistry textures{};
+    ModelLoadOptions options{};
+    options.CompressAnimations = compressAnimations;
+    options.GenerateLods = false;
+    return ModelLoader::LoadGLTFModel("assets/models/dummy_platformer.gltf", textures, options);
+}
+
+static bool NearlyEqual(V3 a, V3 b, float tolerance)
+{
+    return fabsf(a.X - b.X) <= tolerance && fabsf(a.Y - b.Y) <= tolerance && fabsf(a.Z - b.Z) <= tolerance;
+}
+
+// The streamed sampler has to produce the same pose as interpolating every
+// channel on its own.
+TEST_CASE(StreamSampledPoseMatchesPerChannelInterpolation)
+{
+    for (const bool compressed : { false, true })
+    {
+        Model model = LoadTestModel(compressed);
+        REQUIRE(!model.Animations.empty() && !model.Skeletons.empty());
+
+        Animation& clip = model.Animations[0];
+        const Skeleton& skeleton = model.Skeletons[0];
+        Animator& animator = model.Animator;
+        PlayAnimation(animator, &clip, &model.Skeletons[0], 1.0f, true);
+
+        for (const float time : { 0.0f, 0.1f, clip.Duration * 0.37f, clip.Duration * 0.9f })
+        {
+            AnimationLayer& layer = animator.Layers[0];
+            layer.Time = time;
+            UpdateAnimation(animator);
+
+            for (const BoneChannelBinding& binding : layer.Bindings)
+            {
+                const BoneTransform& pose = animator.BlendedPose[binding.Bone];
+                uint32_t cursor = 0;
+
+                if (binding.Translation >= 0)
+                {
+                    const AnimationChannel& channel = clip.Channels[binding.Translation];
+                    CHECK(NearlyEqual(pose.Translation, InterpolateVec3(channel.Times, channel.Translations, time, cursor), 1e-5f));
+                }
+                if (binding.Scale >= 0)
+                {
+                    const AnimationChannel& channel = clip.Channels[binding.Scale];
+                    CHECK(NearlyEqual(pose.Scale, InterpolateVec3(channel.Times, channel.Scales, time, cursor = 0), 1e-5f));
+                }
+                if (binding.Rotation >= 0)
+                {
+                    const AnimationChannel& channel = clip.Channels[binding.Rotation];
+                    const Quat expected = channel.PackedRotations.empty() ?
+                        InterpolateQuat(channel.Times, channel.Rotations, time, cursor = 0) :
+                        InterpolatePackedQuat(channel.Times, channel.PackedRotations, time, cursor = 0);
+                    CHECK_NEAR(fabsf(Dot(pose.Rotation, expected)), 1.0f, 1e-4f);
+                }
+            }
+        }
+
+        CHECK(skeleton.Bones.size() == animator.BlendedPose.size());
+    }
+}
+
+TEST_CASE(KeyframeCursorMatchesBinarySearch)
+{
+    std::vector<float> times(10000);
+    for (size_t i = 0; i < times.size(); ++i)
+        times[i] = static_cast<float>(i) * 0.25f;
+
+    // Forward playback, a seek backwards, a wrap and a jump several keys ahead
+    uint32_t cursor = 0;
+    for (const float time : { 0.1f, 0.2f, 0.3f, 0.6f, 100.0f, 100.1f, 50.0f, 0.05f, 0.2f, 2.0f, 2499.7f })
+    {
+        const size_t expected = static_cast<size_t>(std::upper_bound(times.begin(), times.end(), time) - times.begin()) - 1;
+        CHECK(FindKeyframe(times, time, cursor) == expected);
+        CHECK(cursor == expected);
+    }
+}
+
+TEST_CASE(SkeletonIsStoredParentBeforeChild)
+{
+    const Model model = LoadTestModel(false);
+    REQUIRE(!model.Skeletons.empty());
+
+    const Skeleton& skeleton = model.Skeletons[0];
+    REQUIRE(skeleton.ParentIndices.size() == skeleton.Bones.size());
+    for (size_t i = 0; i < skeleton.Bones.size(); ++i)
+        CHECK(skeleton.ParentIndices[i] < static_cast<int32_t>(i));
+}
+
+TEST_CASE(LayerStartedAtZeroWeightKeepsItsClip)
+{
+    Model model = LoadTestModel(false);
+    Animator& animator = model.Animator;
+    PlayAnimation(animator, &model.Animations[0], &model.Skeletons[0], 1.0f, true);
+
+    PlayAnimationLayer(animator, 1, &model.Animations[1], 0.0f);
+    UpdateAnimator(animator, 1.0f / 60.0f);
+    CHECK(animator.Layers[1].Clip == &model.Animations[1]);
+
+    // Fading it in later works without restarting the clip
+    SetLayerWeight(animator, 1, 1.0f, 0.1f);
+    UpdateAnimator(animator, 1.0f / 60.0f);
+    CHECK(animator.Layers[1].Weight > 0.0f);
+
+    // Fading it back out frees the slot once the weight reaches zero
+    SetLayerWeight(animator, 1, 0.0f, 0.1f);
+    for (int frame = 0; frame < 20; ++frame)
+        UpdateAnimator(animator, 1.0f / 60.0f);
+    CHECK(animator.Layers[1].Clip == nullptr);
+    CHECK(animator.Layers[0].Clip == &model.Animations[0]);
+}
+
+TEST_CASE(CrossfadeFromEmptyAnimatorStartsInBindPose)
+{
+    Model model = LoadTestModel(false);
+    Animator& animator = model.Animator;
+    SetTargetSkeleton(animator, &model.Skeletons[0]);
+
+    // Whatever an earlier pose left behind
+    animator.FinalBoneTransforms.fill(MatrixTranslation(100.0f, 0.0f, 0.0f));
+
+    CrossfadeTo(animator, &model.Animations[0], 0.25f);
+    UpdateAnimator(animator, 0.0f);
+
+    // In bind pose every skinning matrix is the identity
+    float maxError = 0.0f;
+    for (const BoneInfo& bone : model.Skeletons[0].Bones)
+    {
+        const M4& m = animator.FinalBoneTransforms[bone.JointIndex];
+        for (int row = 0; row < 4; ++row)
+            for (int column = 0; column < 4; ++column)
+                maxError = std::max(maxError, fabsf(m.M[row][column] - (row == column ? 1.0f : 0.0f)));
+    }
+    CHECK_NEAR(maxError, 0.0f, 1e-3f);
+}
@@ -0,0 +1,93 @@
+#include "pch.h"
+#include "test.h"
+#include "assets/animation_compression.h"
+#include "assets/animator.h"
+#include "assets/model_loader.h"
+#include "assets/texture_registry.h"
+
+// Angle between two rotations, from the chord length so it stays accurate
+// for nearly equal rotations where acos of the dot product does not.
+static float AngleBetween(const Quat& a, const Quat& b)
+{
+    const Quat na = NormalizeQuat(a);
+    const Quat nb = NormalizeQuat(b) * (Dot(na, b) < 0.0f ? -1.0f : 1.0f);
+    const float dx = na.X - nb.X, dy = na.Y - nb.Y, dz = na.Z - nb.Z, dw = na.W - nb.W;
+    return 4.0f * asinf(std::min(sqrtf(dx * dx + dy * dy + dz * dz + dw * dw) * 0.5f, 1.0f));
+}
+
+TEST_CASE(PackedQuatRoundTripsWithinQuantizationError)
+{
+    for (int i = 0; i < 1000; ++i)
+    {
+        const float a = i * 0.37f, b = i * 1.13f, c = i * 0.71f;
+        const Quat q = NormalizeQuat({ sinf(a), cosf(b), sinf(c) * 0.5f, cosf(a + c) });
+        CHECK(AngleBetween(q, UnpackQuat(PackQuat(q))) < 2e-4f);
+    }
+}
+
+// Every clip of the test character is compressed with the default settings,
+// then resampled at the original keyframe times. Between keys both the source
+// and the compressed clip interpolate, so the keys are where the error peaks.
+TEST_CASE(CompressedClipsStayWithinTolerance)
+{
+    TextureRegistry textures{};
+    ModelLoadOptions options{};
+    options.GenerateLods = false;
+    const Model model = ModelLoader::LoadGLTFModel("assets/models/dummy_platformer.gltf", textures, options);
+    REQUIRE(!model.Animations.empty());
+
+    const AnimationCompressionSettings settings{};
+    size_t bytesBefore = 0;
+    size_t bytesAfter = 0;
+
+    for (const Animation& source : model.Animations)
+    {
+        Animation compressed = source;
+        const AnimationCompressionStats stats = CompressAnimation(compressed, settings);
+        bytesBefore += stats.BytesBefore;
+        bytesAfter += stats.BytesAfter;
+
+        CHECK(stats.MaxTranslationError <= settings.TranslationTolerance);
+        CHECK(stats.MaxRotationError <= settings.RotationTolerance);
+        CHECK(stats.MaxScaleError <= settings.ScaleTolerance);
+
+        float translationError = 0.0f;
+        float rotationError = 0.0f;
+        float scaleError = 0.0f;
+        for (size_t c = 0; c < source.Channels.size(); ++c)
+        {
+            const AnimationChannel& original = source.Channels[c];
+            const AnimationChannel& channel = compressed.Channels[c];
+            uint32_t cursor = 0;
+
+            for (size_t k = 0; k < original.Times.size(); ++k)
+            {
+                const float time = original.Times[k];
+                switch (original.Path)
+                {
+                case AnimationPath::Translation:
+                    translationError = std::max(translationError,
+                        Length(InterpolateVec3(channel.Times, channel.Translations, time, cursor) - original.Translations[k]));
+                    break;
+                case AnimationPath::Scale:
+                    scaleError = std::max(scaleError,
+                        Length(InterpolateVec3(channel.Times, channel.Scales, time, cursor) - original.Scales[k]));
+                    break;
+                case AnimationPath::Rotation:
+                    rotationError = std::max(rotationError,
+                        AngleBetween(InterpolatePackedQuat(channel.Times, channel.PackedRotations, time, cursor), original.Rotations[k]));
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
+
+        CHECK(translationError <= settings.TranslationTolerance);
+        CHECK(rotationError <= settings.RotationTolerance);
+        CHECK(scaleError <= settings.ScaleTolerance);
+    }
+
+    std::println("  {} clips: {} -> {} bytes", model.Animations.size(), bytesBefore, bytesAfter);
+    CHECK(bytesAfter * 2 < bytesBefore);
+}
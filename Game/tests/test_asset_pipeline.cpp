@@ -0,0 +1,46 @@
+#include "pch.h"
+#include "test.h"
+#include "assets/asset_pipeline.h"
+
+TEST_CASE(AssetPipelineWaitsForUncommittedLoads)
+{
+    JobSystem jobs(1);
+    TextureRegistry textures{};
+    std::atomic<bool> finished{};
+
+    AssetHandle<int> handle{};
+    {
+        AssetPipeline pipeline(&jobs, textures);
+        handle = pipeline.Load<int>([&finished]()
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                finished = true;
+                return 7;
+            });
+        // No OnLoaded(), so WaitAll() would have nothing to wait for
+    }
+
+    CHECK(finished.load());
+    CHECK(handle->IsReady() && handle->Asset == 7);
+}
+
+TEST_CASE(AssetPipelineCommitsInRequestOrder)
+{
+    JobSystem jobs(2);
+    TextureRegistry textures{};
+    AssetPipeline pipeline(&jobs, textures);
+
+    std::vector<int> committed{};
+    for (int i = 0; i < 8; ++i)
+    {
+        const AssetHandle<int> handle = pipeline.Load<int>([i]()
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds((8 - i) % 3));
+                return i;
+            });
+        pipeline.OnLoaded(handle, [&committed](int& value) { committed.push_back(value); });
+    }
+
+    pipeline.WaitAll();
+    CHECK(committed == std::vector<int>({ 0, 1, 2, 3, 4, 5, 6, 7 }));
+}
@@ -0,0 +1,121 @@
+#include "pch.h"
+#include "test.h"
+#include "world/bvh.h"
+
+// Uniform in [0, 1), deterministic so failures reproduce.
+static float NextRandom(uint32_t& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return static_cast<float>(state >> 8) / 16777216.0f;
+}
+
+static AABB MakeRandomBox(uint32_t& state, float worldSize)
+{
+    const V3 center = { NextRandom(state) * worldSize, NextRandom(state) * 20.0f, NextRandom(state) * worldSize };
+    const V3 extents = { 0.1f + NextRandom(state) * 2.0f, 0.1f + NextRandom(state) * 2.0f, 0.1f + NextRandom(state) * 2.0f };
+    return { center - extents, center + extents };
+}
+
+static std::vector<uint32_t> Sorted(std::vector<uint32_t> values)
+{
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+// Every query has to return exactly what testing each box on its own does,
+// after inserts, small and large moves and removals.
+TEST_CASE(BvhQueriesMatchBruteForce)
+{
+    constexpr uint32_t boxCount = 2000;
+    constexpr float worldSize = 200.0f;
+
+    uint32_t state = 1;
+    DynamicBvh bvh{};
+    std::vector<AABB> boxes(boxCount);
+    std::vector<uint32_t> proxies(boxCount, DynamicBvh::NULL_NODE);
+    for (uint32_t i = 0; i < boxCount; i++)
+    {
+        boxes[i] = MakeRandomBox(state, worldSize);
+        proxies[i] = bvh.Insert(boxes[i], i);
+    }
+
+    // Jitter most boxes, teleport some and remove every tenth
+    for (uint32_t i = 0; i < boxCount; i++)
+    {
+        if (i % 10 == 0)
+        {
+            bvh.Remove(proxies[i]);
+            proxies[i] = DynamicBvh::NULL_NODE;
+            continue;
+        }
+
+        if (i % 7 == 0)
+        {
+            boxes[i] = MakeRandomBox(state, worldSize);
+        }
+        else
+        {
+            const V3 offset = { NextRandom(state) - 0.5f, NextRandom(state) - 0.5f, NextRandom(state) - 0.5f };
+            boxes[i] = { boxes[i].Min + offset, boxes[i].Max + offset };
+        }
+        bvh.Update(proxies[i], boxes[i]);
+    }
+
+    REQUIRE(bvh.Validate());
+    CHECK(bvh.GetProxyCount() == boxCount - boxCount / 10);
+
+    auto isLive = [&](uint32_t i) { return proxies[i] != DynamicBvh::NULL_NODE; };
+
+    uint32_t mismatches = 0;
+    uint32_t found = 0;
+    for (int query = 0; query < 50; query++)
+    {
+        // Frustum from a random camera inside the world
+        const V3 eye = { NextRandom(state) * worldSize, 10.0f, NextRandom(state) * worldSize };
+        const float yaw = NextRandom(state) * 6.2831853f;
+        const M4 view = MatrixLookAt(eye, eye + V3{ cosf(yaw), -0.2f, sinf(yaw) }, { 0.0f, 1.0f, 0.0f });
+        const Frustum frustum = ExtractFrustum(view * MatrixPerspective(1.2f, 1.5f, 0.1f, 80.0f));
+
+        std::vector<uint32_t> expected{};
+        for (uint32_t i = 0; i < boxCount; i++)
+            if (isLive(i) && IsAABBInFrustum(frustum, boxes[i]))
+                expected.push_back(i);
+        std::vector<uint32_t> results{};
+        bvh.QueryFrustum(frustum, results);
+        mismatches += Sorted(results) != expected;
+        found += static_cast<uint32_t>(expected.size());
+
+        // Box overlap
+        const AABB region = InflateAABB(MakeRandomBox(state, worldSize), 10.0f);
+        expected.clear();
+        for (uint32_t i = 0; i < boxCount; i++)
+            if (isLive(i) && Overlaps(region, boxes[i]))
+                expected.push_back(i);
+        results.clear();
+        bvh.QueryAABB(region, results);
+        mismatches += Sorted(results) != expected;
+
+        // Ray: the same closest distance as the brute force
+        const V3 origin = { NextRandom(state) * worldSize, 10.0f, NextRandom(state) * worldSize };
+        const V3 direction = Normalize(V3{ NextRandom(state) - 0.5f, NextRandom(state) - 0.5f, NextRandom(state) - 0.5f });
+        float closest = 100.0f;
+        bool expectedHit = false;
+        for (uint32_t i = 0; i < boxCount; i++)
+        {
+            float distance = 0.0f;
+            if (isLive(i) && IntersectRayAABB(origin, direction, boxes[i], closest, distance) && distance <= closest)
+            {
+                closest = distance;
+                expectedHit = true;
+            }
+        }
+
+        BvhRayHit hit{};
+        const bool hitBox = bvh.Raycast(origin, direction, 100.0f, hit);
+        if (hitBox != expectedHit || (hitBox && fabsf(hit.Distance - closest) > 1e-4f))
+            mismatches++;
+    }
+
+    CHECK(found > 0);
+    CHECK(mismatches == 0);
+}
@@ -0,0 +1,123 @@
+#include "pch.h"
+#include "test.h"
+#include "world/heightmap.h"
+
+static Heightmap MakeTestHeightmap(int32_t size)
+{
+    Heightmap heightmap{};
+    heightmap.Width = size;
+    heightmap.Height = size;
+    heightmap.Origin = { -40.0f, -3.0f, 25.0f };
+    heightmap.Heights.resize(static_cast<size_t>(size) * size);
+    heightmap.MinHeight = FLT_MAX;
+    heightmap.MaxHeight = -FLT_MAX;
+
+    for (int32_t z = 0; z < size; z++)
+    {
+        for (int32_t x = 0; x < size; x++)
+        {
+            const float height = 6.0f * sinf(x * 0.13f) * cosf(z * 0.09f) + ((x * 7 + z * 13) % 5) * 0.4f;
+            heightmap.Heights[static_cast<size_t>(x) + static_cast<size_t>(z) * size] = height;
+            heightmap.MinHeight = std::min(heightmap.MinHeight, height);
+            heightmap.MaxHeight = std::max(heightmap.MaxHeight, height);
+        }
+    }
+
+    return heightmap;
+}
+
+// Uniform in [0, 1), xorshift so runs are repeatable.
+static float NextRandom(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return static_cast<float>(state >> 8) / 16777216.0f;
+}
+
+// Hits lie on the sampled surface, and marching the ray finds nothing below
+// it before the hit, or anywhere along a miss.
+TEST_CASE(RaycastAgreesWithSampledHeight)
+{
+    const Heightmap heightmap = MakeTestHeightmap(96);
+    const float size = static_cast<float>(heightmap.Width - 1);
+
+    uint32_t state = 0x9E3779B9u;
+    uint32_t hits = 0;
+    float maxHeightError = 0.0f;
+    float maxNormalError = 0.0f;
+    uint32_t tunnelled = 0;
+
+    for (int ray = 0; ray < 2000; ray++)
+    {
+        const V3 origin = heightmap.Origin + V3{ NextRandom(state) * size,
+            heightmap.MaxHeight + 1.0f + NextRandom(state) * 10.0f, NextRandom(state) * size };
+
+        // From steep to grazing, in every compass direction
+        const float angle = NextRandom(state) * 6.2831853f;
+        const float descent = 0.02f + NextRandom(state) * 1.5f;
+        const V3 direction = Normalize(V3{ cosf(angle), -descent, sinf(angle) });
+        const float maxDistance = 200.0f;
+
+        HeightmapHit hit{};
+        const bool hitSurface = RaycastHeightmap(heightmap, origin, direction, maxDistance, hit);
+        if (hitSurface)
+        {
+            hits++;
+            maxHeightError = std::max(maxHeightError,
+                fabsf(hit.Position.Y - SampleHeightmapHeight(heightmap, hit.Position.X, hit.Position.Z)));
+            maxNormalError = std::max(maxNormalError,
+                Length(hit.Normal - SampleHeightmapNormal(heightmap, hit.Position.X, hit.Position.Z)));
+        }
+
+        // Steps well under a cell; the tolerance covers the surface between steps
+        const float end = hitSurface ? hit.Distance - 0.05f : maxDistance;
+        for (float t = 0.0f; t < end; t += 0.05f)
+        {
+            const V3 point = origin + direction * t;
+            const V3 local = point - heightmap.Origin;
+            if (local.X < 0.0f || local.Z < 0.0f || local.X > size || local.Z > size)
+                continue;
+            if (point.Y < SampleHeightmapHeight(heightmap, point.X, point.Z) - 1e-3f)
+            {
+                tunnelled++;
+                break;
+            }
+        }
+    }
+
+    std::println("  {} of 2000 rays hit, height error {:.2e}, normal error {:.2e}", hits, maxHeightError, maxNormalError);
+    CHECK(hits > 1000);
+    CHECK(maxHeightError < 1e-3f);
+    CHECK(maxNormalError < 1e-3f);
+    CHECK(tunnelled == 0);
+}
+
+TEST_CASE(RaycastHandlesVerticalAndBuriedRays)
+{
+    const Heightmap heightmap = MakeTestHeightmap(32);
+
+    // Straight down lands exactly on the bilinear height, between samples too
+    for (const V2 position : { V2{ 0.0f, 0.0f }, V2{ 3.25f, 7.5f }, V2{ 30.9f, 12.1f }, V2{ 31.0f, 31.0f } })
+    {
+        const float x = heightmap.Origin.X + position.X;
+        const float z = heightmap.Origin.Z + position.Y;
+
+        HeightmapHit hit{};
+        REQUIRE(RaycastHeightmap(heightmap, { x, heightmap.Origin.Y + 50.0f, z }, { 0.0f, -1.0f, 0.0f }, 100.0f, hit));
+        CHECK_NEAR(hit.Position.Y, SampleHeightmapHeight(heightmap, x, z), 1e-4f);
+    }
+
+    // A ray starting under the surface hits where it starts
+    const float x = heightmap.Origin.X + 10.5f;
+    const float z = heightmap.Origin.Z + 10.5f;
+    const V3 buried = { x, SampleHeightmapHeight(heightmap, x, z) - 1.0f, z };
+    HeightmapHit hit{};
+    REQUIRE(RaycastHeightmap(heightmap, buried, Normalize(V3{ 1.0f, 0.2f, 0.0f }), 10.0f, hit));
+    CHECK_NEAR(hit.Distance, 0.0f, 1e-6f);
+
+    // Pointing away from the grid, or upwards above it, misses
+    CHECK(!RaycastHeightmap(heightmap, heightmap.Origin + V3{ -1.0f, 0.0f, 5.0f }, { -1.0f, 0.0f, 0.0f }, 100.0f, hit));
+    CHECK(!RaycastHeightmap(heightmap, heightmap.Origin + V3{ 5.0f, heightmap.MaxHeight + 1.0f, 5.0f },
+        { 0.0f, 1.0f, 0.0f }, 100.0f, hit));
+}
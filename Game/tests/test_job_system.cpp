@@ -0,0 +1,56 @@
+#include "pch.h"
+#include "test.h"
+#include "core/job_system.h"
+
+TEST_CASE(ParallelForCoversEveryIndexOnce)
+{
+    JobSystem jobs(3);
+
+    std::vector<std::atomic<int32_t>> visits(1000);
+    jobs.ParallelFor(visits.size(), 7, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+                visits[i].fetch_add(1, std::memory_order_relaxed);
+        });
+
+    size_t visitedOnce = 0;
+    for (const auto& count : visits)
+        visitedOnce += count.load() == 1;
+    CHECK(visitedOnce == visits.size());
+}
+
+// Workers of one job system queue into another one that has fewer queues.
+TEST_CASE(JobSystemsKeepTheirOwnWorkerQueues)
+{
+    JobSystem outer(4);
+    JobSystem inner(1);
+
+    std::atomic<int32_t> total{};
+    outer.ParallelFor(64, 1, [&](size_t, size_t)
+        {
+            inner.ParallelFor(16, 4, [&](size_t begin, size_t end)
+                {
+                    total.fetch_add(static_cast<int32_t>(end - begin), std::memory_order_relaxed);
+                });
+        });
+
+    CHECK(total.load() == 64 * 16);
+}
+
+TEST_CASE(WaitReturnsWhenAnotherThreadRunsTheJobs)
+{
+    JobSystem jobs(2);
+
+    JobCounter counter{};
+    std::atomic<int32_t> done{};
+    for (int i = 0; i < 8; ++i)
+        jobs.Execute([&done]()
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                done.fetch_add(1);
+            }, counter);
+
+    jobs.Wait(counter);
+    CHECK(done.load() == 8);
+    CHECK(counter.Pending.load() == 0);
+}
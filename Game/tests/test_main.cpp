@@ -0,0 +1,45 @@
+#include "pch.h"
+#include "test.h"
+
+static uint32_t _Failures{};
+
+std::vector<TestCase>& GetTestCases()
+{
+    static std::vector<TestCase> testCases{};
+    return testCases;
+}
+
+void ReportFailure(const char* file, int line, const std::string& message)
+{
+    std::println("  {}:{}: {}", file, line, message);
+    _Failures++;
+}
+
+// Usage: tests [name filter]
+int main(int argc, char** argv)
+{
+    const std::string_view filter = argc > 1 ? argv[1] : "";
+
+    std::vector<TestCase> testCases = GetTestCases();
+    std::sort(testCases.begin(), testCases.end(),
+        [](const TestCase& a, const TestCase& b) { return std::string_view(a.Name) < b.Name; });
+
+    uint32_t run = 0;
+    uint32_t failed = 0;
+    for (const TestCase& testCase : testCases)
+    {
+        if (!std::string_view(testCase.Name).contains(filter))
+            continue;
+
+        const uint32_t failuresBefore = _Failures;
+        testCase.Function();
+        run++;
+
+        const bool passed = _Failures == failuresBefore;
+        failed += !passed;
+        std::println("{} {}", passed ? "PASS" : "FAIL", testCase.Name);
+    }
+
+    std::println("{} tests, {} failed", run, failed);
+    return failed == 0 && run > 0 ? 0 : 1;
+}
@@ -0,0 +1,121 @@
+#include "pch.h"
+#include "test.h"
+#include "math/handmade_math.h"
+
+// Uniform in [-1, 1), deterministic so failures reproduce.
+static float NextRandom(uint32_t& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return static_cast<float>(state >> 8) / 8388608.0f - 1.0f;
+}
+
+// A full matrix, perspective row included, so every element matters.
+static M4 MakeRandomMatrix(uint32_t& state)
+{
+    M4 result{};
+    for (auto& row : result.M)
+        for (float& value : row)
+            value = NextRandom(state) * 4.0f;
+    return result;
+}
+
+static float MaxDifference(const M4& a, const M4& b)
+{
+    float result = 0.0f;
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 4; j++)
+            result = std::max(result, std::abs(a.M[i][j] - b.M[i][j]));
+    return result;
+}
+
+TEST_CASE(SimdMatrixMultiplyMatchesScalar)
+{
+    uint32_t state = 1;
+    float sse2Error = 0.0f;
+    float avx2Error = 0.0f;
+    float dispatchError = 0.0f;
+    for (int i = 0; i < 1000; i++)
+    {
+        const M4 a = MakeRandomMatrix(state);
+        const M4 b = MakeRandomMatrix(state);
+        const M4 expected = MatrixMultiplyScalar(a, b);
+#if HANDMADE_MATH_SSE2
+        sse2Error = std::max(sse2Error, MaxDifference(MatrixMultiplySSE2(a, b), expected));
+#endif
+#if HANDMADE_MATH_AVX2
+        avx2Error = std::max(avx2Error, MaxDifference(MatrixMultiplyAVX2(a, b), expected));
+#endif
+        dispatchError = std::max(dispatchError, MaxDifference(a * b, expected));
+    }
+
+    // Products of 4 sums of values up to 16; FMA rounds differently
+    CHECK_NEAR(sse2Error, 0.0f, 1e-4f);
+    CHECK_NEAR(avx2Error, 0.0f, 1e-4f);
+    CHECK_NEAR(dispatchError, 0.0f, 1e-4f);
+}
+
+TEST_CASE(SimdTransformsMatchScalar)
+{
+    uint32_t state = 2;
+    float v4Error = 0.0f;
+    for (int i = 0; i < 1000; i++)
+    {
+        const M4 m = MakeRandomMatrix(state);
+        const V4 v = { NextRandom(state), NextRandom(state), NextRandom(state), NextRandom(state) };
+        const V4 expected = TransformV4Scalar(v, m);
+#if HANDMADE_MATH_SSE2
+        const V4 result = TransformV4SIMD(v, m);
+#else
+        const V4 result = v * m;
+#endif
+        v4Error = std::max({ v4Error, std::abs(result.X - expected.X), std::abs(result.Y - expected.Y),
+            std::abs(result.Z - expected.Z), std::abs(result.W - expected.W) });
+    }
+    CHECK_NEAR(v4Error, 0.0f, 1e-5f);
+
+    // Every count up to a few SIMD blocks, so each remainder is covered. The
+    // point past the end has to stay untouched.
+    const M4 m = MatrixScaling(2.0f, 3.0f, 0.5f) * MatrixRotationY(0.7f) * MatrixTranslation(1.0f, -2.0f, 5.0f);
+    float pointError = 0.0f;
+    uint32_t overruns = 0;
+    for (size_t count = 0; count <= 13; count++)
+    {
+        std::vector<V3> points(count);
+        for (V3& p : points)
+            p = { NextRandom(state) * 10.0f, NextRandom(state) * 10.0f, NextRandom(state) * 10.0f };
+
+        const V3 sentinel = { 123.0f, 456.0f, 789.0f };
+        std::vector<V3> expected(count + 1, sentinel);
+        std::vector<V3> result(count + 1, sentinel);
+        TransformPointsScalar(m, points, expected);
+        TransformPoints(m, points, result);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const V4 reference = TransformV4Scalar({ points[i].X, points[i].Y, points[i].Z, 1.0f }, m);
+            pointError = std::max({ pointError, Length(result[i] - expected[i]),
+                Length(expected[i] - V3{ reference.X, reference.Y, reference.Z }) });
+        }
+        overruns += result[count].X != sentinel.X || result[count].Y != sentinel.Y || result[count].Z != sentinel.Z;
+    }
+    CHECK_NEAR(pointError, 0.0f, 1e-4f);
+    CHECK(overruns == 0);
+}
+
+// The affine product is the full M4 product of the widened matrices.
+TEST_CASE(AffineMultiplyMatchesM4)
+{
+    uint32_t state = 3;
+    float scalarError = 0.0f;
+    float dispatchError = 0.0f;
+    for (int i = 0; i < 1000; i++)
+    {
+        const M4x3 a = AffineFromM4(MakeRandomMatrix(state));
+        const M4x3 b = AffineFromM4(MakeRandomMatrix(state));
+        const M4 expected = MatrixMultiplyScalar(M4FromAffine(a), M4FromAffine(b));
+        scalarError = std::max(scalarError, MaxDifference(M4FromAffine(AffineMultiplyScalar(a, b)), expected));
+        dispatchError = std::max(dispatchError, MaxDifference(M4FromAffine(a * b), expected));
+    }
+    CHECK_NEAR(scalarError, 0.0f, 1e-4f);
+    CHECK_NEAR(dispatchError, 0.0f, 1e-4f);
+}
@@ -0,0 +1,194 @@
+#include "pch.h"
+#include "test.h"
+#include "assets/mesh_lod.h"
+
+// Unit sphere with shared vertices and smooth normals, one submesh.
+static Mesh MakeSmoothSphere(uint32_t rings, uint32_t segments)
+{
+    Mesh mesh{};
+    for (uint32_t r = 0; r <= rings; r++)
+    {
+        const float theta = 3.14159265f * r / rings;
+        for (uint32_t s = 0; s < segments; s++)
+        {
+            const float phi = 2.0f * 3.14159265f * s / segments;
+            Vertex& v = mesh.Vertices.emplace_back();
+            v.Position = { sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi) };
+            v.Normal = v.Position;
+            // Poles collapse to a single position
+            if (r == 0 || r == rings)
+                v.Position = { 0.0f, cosf(theta), 0.0f };
+        }
+    }
+
+    for (uint32_t r = 0; r < rings; r++)
+    {
+        for (uint32_t s = 0; s < segments; s++)
+        {
+            const uint32_t a = r * segments + s;
+            const uint32_t b = r * segments + (s + 1) % segments;
+            const uint32_t c = a + segments;
+            const uint32_t d = b + segments;
+            if (r > 0)
+                mesh.Indices.insert(mesh.Indices.end(), { a, b, c });
+            if (r + 1 < rings)
+                mesh.Indices.insert(mesh.Indices.end(), { b, d, c });
+        }
+    }
+
+    mesh.Submeshes.push_back({ 0, static_cast<uint32_t>(mesh.Indices.size()), -1 });
+    return mesh;
+}
+
+// The same sphere with three vertices of its own per triangle.
+static Mesh MakeFlatSphere(uint32_t rings, uint32_t segments)
+{
+    const Mesh smooth = MakeSmoothSphere(rings, segments);
+    Mesh mesh{};
+    for (size_t i = 0; i < smooth.Indices.size(); i += 3)
+    {
+        const V3& p0 = smooth.Vertices[smooth.Indices[i]].Position;
+        const V3 normal = Normalize(Cross(smooth.Vertices[smooth.Indices[i + 1]].Position - p0,
+            smooth.Vertices[smooth.Indices[i + 2]].Position - p0));
+        for (size_t corner = 0; corner < 3; corner++)
+        {
+            mesh.Indices.push_back(static_cast<uint32_t>(mesh.Vertices.size()));
+            Vertex& v = mesh.Vertices.emplace_back(smooth.Vertices[smooth.Indices[i + corner]]);
+            v.Normal = normal;
+        }
+    }
+
+    mesh.Submeshes.push_back({ 0, static_cast<uint32_t>(mesh.Indices.size()), -1 });
+    return mesh;
+}
+
+static void PrintLods(const char* name, const Mesh& mesh)
+{
+    for (uint32_t lod = 0; lod < GetLodCount(mesh); lod++)
+    {
+        std::println("  {} LOD {}: {} triangles, error {:.4f}", name, lod,
+            GetLodTriangleCount(mesh, lod), lod > 0 ? mesh.Lods[lod - 1].Error : 0.0f);
+    }
+}
+
+TEST_CASE(SimplifyKeepsFlatSurfacesExact)
+{
+    // A 16x16 grid of quads in the plane z = 0. Collapses inside the plane
+    // introduce no error; the border is locked.
+    std::vector<Vertex> vertices{};
+    std::vector<uint32_t> indices{};
+    const uint32_t size = 16;
+    for (uint32_t y = 0; y <= size; y++)
+        for (uint32_t x = 0; x <= size; x++)
+            vertices.push_back({ .Position = { float(x), float(y), 0.0f }, .Normal = { 0.0f, 0.0f, 1.0f } });
+    for (uint32_t y = 0; y < size; y++)
+    {
+        for (uint32_t x = 0; x < size; x++)
+        {
+            const uint32_t i = y * (size + 1) + x;
+            indices.insert(indices.end(), { i, i + 1, i + size + 1, i + 1, i + size + 2, i + size + 1 });
+        }
+    }
+
+    float error = 1.0f;
+    const std::vector<uint32_t> simplified = SimplifyIndices(vertices, indices, indices.size() / 4, error);
+    CHECK(simplified.size() <= indices.size() / 4);
+    CHECK_NEAR(error, 0.0f, 1e-5f);
+    for (const uint32_t index : simplified)
+        CHECK(index < vertices.size());
+}
+
+TEST_CASE(SmoothMeshGetsHalvingLevelsWithGrowingError)
+{
+    Mesh mesh = MakeSmoothSphere(32, 64);
+    const uint32_t vertexCount = static_cast<uint32_t>(mesh.Vertices.size());
+    BuildMeshLods(mesh);
+    PrintLods("smooth sphere", mesh);
+
+    CHECK(GetLodCount(mesh) >= 4 && GetLodCount(mesh) <= 5);
+    // Levels only add index ranges
+    CHECK(mesh.Vertices.size() == vertexCount);
+
+    for (uint32_t lod = 1; lod < GetLodCount(mesh); lod++)
+    {
+        const float ratio = float(GetLodTriangleCount(mesh, lod)) / GetLodTriangleCount(mesh, lod - 1);
+        CHECK(ratio > 0.4f && ratio <= 0.85f);
+        CHECK(mesh.Lods[lod - 1].Error > (lod > 1 ? mesh.Lods[lod - 2].Error : 0.0f));
+    }
+    // On a unit sphere the first level must stay close to the surface
+    CHECK(mesh.Lods[0].Error < 0.05f);
+
+    // Rebuilding replaces the levels instead of stacking them
+    const size_t indexCount = mesh.Indices.size();
+    BuildMeshLods(mesh);
+    CHECK(mesh.Indices.size() == indexCount);
+}
+
+TEST_CASE(FlatShadedMeshFallsBackToPositionQuadrics)
+{
+    Mesh mesh = MakeFlatSphere(16, 32);
+    const size_t vertexCount = mesh.Vertices.size();
+
+    MeshLodSettings settings{};
+    settings.FlatShadingFallback = false;
+    BuildMeshLods(mesh, settings);
+    CHECK(GetLodCount(mesh) == 1);
+
+    BuildMeshLods(mesh);
+    PrintLods("flat sphere", mesh);
+    REQUIRE(GetLodCount(mesh) >= 4);
+
+    // Level vertices are appended after the full detail ones and carry the
+    // normal of their face
+    for (uint32_t lod = 1; lod < GetLodCount(mesh); lod++)
+    {
+        for (const Submesh& submesh : GetLodSubmeshes(mesh, lod))
+        {
+            for (uint32_t i = 0; i < submesh.IndexCount; i += 3)
+            {
+                const uint32_t* tri = &mesh.Indices[submesh.IndexOffset + i];
+                CHECK(tri[0] >= vertexCount && tri[1] >= vertexCount && tri[2] >= vertexCount);
+                const V3& p0 = mesh.Vertices[tri[0]].Position;
+                const V3 normal = Normalize(Cross(mesh.Vertices[tri[1]].Position - p0, mesh.Vertices[tri[2]].Position - p0));
+                CHECK(Dot(mesh.Vertices[tri[0]].Normal, normal) > 0.999f);
+            }
+        }
+    }
+
+    // Rebuilding drops the appended vertices first
+    const size_t builtVertexCount = mesh.Vertices.size();
+    BuildMeshLods(mesh);
+    CHECK(mesh.Vertices.size() == builtVertexCount);
+}
+
+TEST_CASE(SelectLodCoarsensWithDistance)
+{
+    Mesh mesh = MakeSmoothSphere(32, 64);
+    BuildMeshLods(mesh);
+    REQUIRE(GetLodCount(mesh) > 2);
+
+    const float pixelsPerUnit = 540.0f;
+    CHECK(SelectLod(mesh, 0.0f, pixelsPerUnit) == 0);
+    CHECK(SelectLod(mesh, 0.5f, pixelsPerUnit) == 0);
+    CHECK(SelectLod(mesh, 1e6f, pixelsPerUnit) == GetLodCount(mesh) - 1);
+
+    uint32_t previous = 0;
+    for (float distance = 1.0f; distance < 1e5f; distance *= 1.5f)
+    {
+        const uint32_t lod = SelectLod(mesh, distance, pixelsPerUnit);
+        CHECK(lod >= previous);
+        // The chosen level's error projects to at most one pixel
+        if (lod > 0)
+            CHECK(mesh.Lods[lod - 1].Error * pixelsPerUnit / distance <= 1.0f);
+        previous = lod;
+    }
+}
+
+TEST_CASE(DistanceToAABBMeasuresToNearestPoint)
+{
+    const AABB box{ { -1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, 1.0f } };
+    CHECK(DistanceToAABB({ 0.0f, 0.0f, 0.0f }, box) == 0.0f);
+    CHECK(DistanceToAABB({ 0.5f, 1.0f, -0.5f }, box) == 0.0f);
+    CHECK_NEAR(DistanceToAABB({ 4.0f, 0.0f, 0.0f }, box), 3.0f, 1e-6f);
+    CHECK_NEAR(DistanceToAABB({ 4.0f, -5.0f, 0.0f }, box), 5.0f, 1e-6f);
+}
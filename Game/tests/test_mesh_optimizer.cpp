@@ -0,0 +1,130 @@
+#include "pch.h"
+#include "test.h"
+#include "assets/mesh_optimizer.h"
+#include "assets/model_loader.h"
+#include "assets/texture_registry.h"
+
+// Triangle list of a size x size quad grid, emitted row by row.
+static std::vector<uint32_t> MakeGridIndices(uint32_t size)
+{
+    std::vector<uint32_t> result{};
+    const uint32_t stride = size + 1;
+    for (uint32_t y = 0; y < size; ++y)
+    {
+        for (uint32_t x = 0; x < size; ++x)
+        {
+            const uint32_t i = y * stride + x;
+            result.insert(result.end(), { i, i + stride, i + 1, i + 1, i + stride, i + stride + 1 });
+        }
+    }
+    return result;
+}
+
+// Triangles as sorted corner triples, sorted, for order-independent comparison.
+static std::vector<std::array<uint32_t, 3>> GetTriangles(std::span<const uint32_t> indices)
+{
+    std::vector<std::array<uint32_t, 3>> result{};
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        std::array<uint32_t, 3> triangle = { indices[i], indices[i + 1], indices[i + 2] };
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+        result.push_back(triangle);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+TEST_CASE(VertexCacheMetricsMatchHandCountedCases)
+{
+    const uint32_t triangle[] = { 0, 1, 2 };
+    const VertexCacheStats single = AnalyzeVertexCache(triangle, 3);
+    CHECK(single.Transforms == 3);
+    CHECK_NEAR(single.ACMR, 3.0f, 1e-6f);
+    CHECK_NEAR(single.ATVR, 1.0f, 1e-6f);
+
+    // The second triangle reuses two cached vertices
+    const uint32_t quad[] = { 0, 1, 2, 2, 1, 3 };
+    const VertexCacheStats shared = AnalyzeVertexCache(quad, 4);
+    CHECK(shared.Transforms == 4);
+    CHECK_NEAR(shared.ACMR, 2.0f, 1e-6f);
+
+    // With a 3-entry FIFO, vertex 0 is evicted before its second use
+    const uint32_t evicting[] = { 0, 1, 2, 3, 4, 5, 0, 4, 5 };
+    CHECK(AnalyzeVertexCache(evicting, 6, 3).Transforms == 7);
+    CHECK_NEAR(AnalyzeVertexCache(evicting, 6, 3).ATVR, 7.0f / 6.0f, 1e-6f);
+
+    // Fewer indices than a triangle give zeroed stats, not an infinite ACMR
+    const uint32_t partial[] = { 0, 1 };
+    for (const size_t count : { 0, 1, 2 })
+    {
+        const VertexCacheStats incomplete = AnalyzeVertexCache(std::span(partial, count), 2);
+        CHECK(incomplete.Transforms == 0);
+        CHECK(incomplete.ACMR == 0.0f);
+        CHECK(incomplete.ATVR == 0.0f);
+    }
+}
+
+// A row-by-row grid wider than the cache is the terrain's worst case.
+TEST_CASE(VertexCacheOptimizationImprovesGridAcmr)
+{
+    const uint32_t size = 64;
+    std::vector<uint32_t> indices = MakeGridIndices(size);
+    const size_t vertexCount = (size + 1) * (size + 1);
+
+    const VertexCacheStats before = AnalyzeVertexCache(indices, vertexCount);
+    const auto trianglesBefore = GetTriangles(indices);
+
+    OptimizeVertexCache(indices, vertexCount);
+    const VertexCacheStats after = AnalyzeVertexCache(indices, vertexCount);
+
+    std::println("  grid {}x{}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+        size, size, before.ACMR, after.ACMR, before.ATVR, after.ATVR);
+    CHECK(GetTriangles(indices) == trianglesBefore);
+    CHECK(before.ACMR > 0.95f);
+    CHECK(after.ACMR < 0.75f);
+    CHECK(after.ATVR < 1.45f);
+}
+
+TEST_CASE(WeldAndFetchOrderKeepGeometry)
+{
+    // Two triangles that share an edge through duplicated vertices, plus an
+    // unreferenced vertex
+    std::vector<Vertex> vertices(7);
+    const V3 positions[] = { { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 9, 9, 9 }, { 1, 0, 0 }, { 0, 1, 0 }, { 1, 1, 0 } };
+    for (size_t i = 0; i < vertices.size(); ++i)
+        vertices[i].Position = positions[i];
+    std::vector<uint32_t> indices = { 6, 5, 4, 0, 1, 2 };
+
+    CHECK(WeldVertices(vertices, indices) == 5);
+    CHECK(indices[1] == indices[5] && indices[2] == indices[4]);
+
+    CHECK(OptimizeVertexFetch(vertices, indices) == 4);
+    REQUIRE(vertices.size() == 4);
+
+    // Vertices are numbered by first use
+    CHECK(indices == std::vector<uint32_t>({ 0, 1, 2, 3, 2, 1 }));
+    CHECK(vertices[0].Position.X == 1.0f && vertices[0].Position.Y == 1.0f);
+    CHECK(vertices[3].Position.X == 0.0f && vertices[3].Position.Y == 0.0f);
+}
+
+// Regression bounds for the test character, a little above what the current
+// optimizer reaches (ACMR 1.195, ATVR 1.015 from 1.904 and 1.617).
+TEST_CASE(OptimizedCharacterMeetsCacheBudget)
+{
+    TextureRegistry textures{};
+    ModelLoadOptions options{};
+    options.GenerateLods = false;
+    options.OptimizeMeshes = false;
+    Model model = ModelLoader::LoadGLTFModel("assets/models/dummy_platformer.gltf", textures, options);
+    REQUIRE(!model.Meshes.empty());
+
+    Mesh& mesh = model.Meshes[0];
+    const size_t triangleCount = mesh.Indices.size() / 3;
+    const MeshOptimizationStats stats = OptimizeMesh(mesh);
+
+    CHECK(mesh.Indices.size() / 3 == triangleCount);
+    CHECK(stats.VerticesAfter <= stats.VerticesBefore);
+    CHECK(stats.After.ACMR < 1.25f);
+    CHECK(stats.After.ATVR < 1.05f);
+    CHECK(stats.After.ACMR < stats.Before.ACMR);
+}
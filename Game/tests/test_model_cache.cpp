@@ -0,0 +1,251 @@
+#include "pch.h"
+#include "test.h"
+#include "assets/model_cache.h"
+#include "assets/model_loader.h"
+#include "assets/texture_registry.h"
+
+static std::vector<uint8_t> ReadBytes(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+}
+
+static void WriteBytes(const std::string& path, const std::vector<uint8_t>& bytes)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+// Element index of a baked array, written in place.
+template<typename T>
+static T& At(std::vector<uint8_t>& bytes, const BlobArray<T>& array, size_t index)
+{
+    return reinterpret_cast<T*>(bytes.data() + array.Offset)[index];
+}
+
+static ModelCacheHeader& GetHeader(std::vector<uint8_t>& bytes)
+{
+    return *reinterpret_cast<ModelCacheHeader*>(bytes.data());
+}
+
+// Each corruption is one a stale or damaged blob could carry and that would
+// otherwise be read out of bounds by animation or skinning.
+TEST_CASE(ModelCacheRejectsOutOfRangeIndices)
+{
+    TextureRegistry textures{};
+    ModelLoadOptions options{};
+    options.GenerateLods = false;
+    options.CompressAnimations = true;
+    const Model model = ModelLoader::LoadGLTFModel("assets/models/dummy_platformer.gltf", textures, options);
+    REQUIRE(!model.Meshes.empty() && !model.Skeletons.empty() && !model.Animations.empty());
+
+    const std::string path = (std::filesystem::temp_directory_path() / "test_model_cache.mdlcache").string();
+    const ModelCacheSource source{ 1, 2, 3 };
+    REQUIRE(ModelCache::Bake(model, textures, source, path));
+    const std::vector<uint8_t> original = ReadBytes(path);
+
+    ModelCache cache{};
+    CHECK(cache.Open(path, source));
+    cache.Close();
+
+    const std::pair<const char*, std::function<void(std::vector<uint8_t>&)>> corruptions[] = {
+        { "child before parent", [](std::vector<uint8_t>& bytes)
+            {
+                const BakedSkeleton& skeleton = At(bytes, GetHeader(bytes).Skeletons, 0);
+                At(bytes, skeleton.ParentIndices, 1) = 1;
+            } },
+        { "too many bones", [](std::vector<uint8_t>& bytes)
+            {
+                BakedSkeleton& skeleton = At(bytes, GetHeader(bytes).Skeletons, 0);
+                skeleton.Bones.Count = MAX_BONES + 1;
+                skeleton.ParentIndices.Count = MAX_BONES + 1;
+            } },
+        { "joint index", [](std::vector<uint8_t>& bytes)
+            {
+                const BakedSkeleton& skeleton = At(bytes, GetHeader(bytes).Skeletons, 0);
+                At(bytes, skeleton.Bones, 0).JointIndex = MAX_BONES;
+            } },
+        { "vertex bone", [](std::vector<uint8_t>& bytes)
+            {
+                const BakedMesh& mesh = At(bytes, GetHeader(bytes).Meshes, 0);
+                At(bytes, mesh.Vertices, 0).BoneIDs.Z = MAX_BONES;
+            } },
+        { "channel values", [](std::vector<uint8_t>& bytes)
+            {
+                const BakedAnimation& animation = At(bytes, GetHeader(bytes).Animations, 0);
+                BakedChannel& channel = At(bytes, animation.Channels, 0);
+                channel.Times.Count += 1;
+            } },
+        { "material", [](std::vector<uint8_t>& bytes)
+            {
+                const BakedMesh& mesh = At(bytes, GetHeader(bytes).Meshes, 0);
+                At(bytes, mesh.Submeshes, 0).Material = -2;
+            } },
+    };
+
+    for (const auto& [name, corrupt] : corruptions)
+    {
+        std::vector<uint8_t> bytes = original;
+        corrupt(bytes);
+        WriteBytes(path, bytes);
+
+        const bool opened = cache.Open(path, source);
+        cache.Close();
+        if (opened)
+            ReportFailure(__FILE__, __LINE__, std::format("accepted blob with bad {}", name));
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE(ModelCacheGoesStaleWhenTextureFileChanges)
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path();
+    const std::string imagePath = (directory / "test_model_cache_texture.png").string();
+    const std::string path = (directory / "test_model_cache_texture.mdlcache").string();
+    std::filesystem::copy_file("assets/models/Textures/tex_prototype_map.png", imagePath,
+        std::filesystem::copy_options::overwrite_existing);
+
+    TextureRegistry textures{};
+    ModelLoadOptions options{};
+    options.GenerateLods = false;
+    Model model = ModelLoader::LoadGLTFModel("assets/models/dummy_platformer.gltf", textures, options);
+    REQUIRE(!model.Meshes.empty() && !model.Meshes[0].Textures.empty());
+
+    // Point the mesh at a copy of its image that the test can modify
+    model.Meshes[0].Textures[0] = textures.Register(imagePath, textures.GetTexture(model.Meshes[0].Textures[0]));
+
+    const ModelCacheSource source{ 1, 2, 3 };
+    REQUIRE(ModelCache::Bake(model, textures, source, path));
+
+    ModelCache cache{};
+    CHECK(cache.Open(path, source));
+    cache.Close();
+
+    std::ofstream(imagePath, std::ios::binary | std::ios::app) << '\0';
+    CHECK(!cache.Open(path, source));
+    cache.Close();
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(imagePath);
+}
+
+// Geometry comes from the .bin next to the glTF file, so a changed buffer
+// has to invalidate the blob just like a changed image.
+TEST_CASE(ModelCacheGoesStaleWhenBufferFileChanges)
+{
+    const std::vector<std::string> buffers = ModelLoader::GetBufferFiles("assets/models/dummy_platformer.gltf");
+    REQUIRE(buffers.size() == 1);
+    CHECK(buffers[0] == "assets/models/dummy_platformer.bin");
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path();
+    const std::string bufferPath = (directory / "test_model_cache_buffer.bin").string();
+    const std::string path = (directory / "test_model_cache_buffer.mdlcache").string();
+    std::filesystem::copy_file(buffers[0], bufferPath, std::filesystem::copy_options::overwrite_existing);
+
+    TextureRegistry textures{};
+    ModelLoadOptions options{};
+    options.GenerateLods = false;
+    const Model model = ModelLoader::LoadGLTFModel("assets/models/dummy_platformer.gltf", textures, options);
+    REQUIRE(!model.Meshes.empty());
+
+    const ModelCacheSource source{ 1, 2, 3 };
+    const std::string sourceFiles[] = { bufferPath };
+    REQUIRE(ModelCache::Bake(model, textures, source, path, sourceFiles));
+
+    ModelCache cache{};
+    CHECK(cache.Open(path, source));
+    cache.Close();
+
+    std::ofstream(bufferPath, std::ios::binary | std::ios::app) << '\0';
+    CHECK(!cache.Open(path, source));
+    cache.Close();
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(bufferPath);
+}
+
+template<typename T>
+static bool SameBytes(std::span<const T> a, std::span<const T> b)
+{
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size_bytes()) == 0;
+}
+
+// A baked model instantiates to exactly what the glTF load produced.
+TEST_CASE(ModelCacheRoundTripMatchesGltf)
+{
+    TextureRegistry textures{};
+    ModelLoadOptions options{};
+    options.CompressAnimations = true;
+    const Model model = ModelLoader::LoadGLTFModel("assets/models/dummy_platformer.gltf", textures, options);
+    REQUIRE(!model.Meshes.empty() && !model.Skeletons.empty() && !model.Animations.empty());
+    REQUIRE(!model.Meshes[0].Lods.empty());
+
+    const std::string path = (std::filesystem::temp_directory_path() / "test_model_cache_round_trip.mdlcache").string();
+    const ModelCacheSource source{ 1, 2, 3 };
+    REQUIRE(ModelCache::Bake(model, textures, source, path));
+
+    ModelCache cache{};
+    REQUIRE(cache.Open(path, source));
+    TextureRegistry bakedTextures{};
+    const Model baked = cache.Instantiate(bakedTextures);
+    cache.Close();
+    std::filesystem::remove(path);
+
+    REQUIRE(baked.Meshes.size() == model.Meshes.size());
+    for (size_t i = 0; i < model.Meshes.size(); i++)
+    {
+        const Mesh& expected = model.Meshes[i];
+        const Mesh& mesh = baked.Meshes[i];
+        CHECK(SameBytes<Vertex>(mesh.Vertices, expected.Vertices));
+        CHECK(mesh.Indices == expected.Indices);
+        CHECK(SameBytes<Submesh>(mesh.Submeshes, expected.Submeshes));
+        CHECK(SameBytes<MeshLod>(mesh.Lods, expected.Lods));
+        CHECK(SameBytes<Submesh>(mesh.LodSubmeshes, expected.LodSubmeshes));
+        CHECK(SameBytes<AABB>(mesh.BoneBounds, expected.BoneBounds));
+        CHECK(std::memcmp(&mesh.Bounds, &expected.Bounds, sizeof(AABB)) == 0);
+        CHECK(std::memcmp(&mesh.UnweightedBounds, &expected.UnweightedBounds, sizeof(AABB)) == 0);
+
+        REQUIRE(mesh.Textures.size() == expected.Textures.size());
+        for (size_t t = 0; t < mesh.Textures.size(); t++)
+        {
+            const Texture& texture = bakedTextures.GetTexture(mesh.Textures[t]);
+            const Texture& expectedTexture = textures.GetTexture(expected.Textures[t]);
+            CHECK(bakedTextures.GetKey(mesh.Textures[t]) == textures.GetKey(expected.Textures[t]));
+            CHECK(texture.Width == expectedTexture.Width && texture.Height == expectedTexture.Height);
+            CHECK(texture.Pixels == expectedTexture.Pixels);
+        }
+    }
+
+    REQUIRE(baked.Skeletons.size() == model.Skeletons.size());
+    for (size_t i = 0; i < model.Skeletons.size(); i++)
+    {
+        const Skeleton& expected = model.Skeletons[i];
+        const Skeleton& skeleton = baked.Skeletons[i];
+        CHECK(SameBytes<BoneInfo>(skeleton.Bones, expected.Bones));
+        CHECK(skeleton.ParentIndices == expected.ParentIndices);
+        CHECK(skeleton.RootBone == expected.RootBone);
+        CHECK(skeleton.NodeToBoneIndex == expected.NodeToBoneIndex);
+    }
+
+    REQUIRE(baked.Animations.size() == model.Animations.size());
+    for (size_t i = 0; i < model.Animations.size(); i++)
+    {
+        const Animation& expected = model.Animations[i];
+        const Animation& animation = baked.Animations[i];
+        CHECK(animation.Name == expected.Name);
+        CHECK(animation.Duration == expected.Duration);
+        REQUIRE(animation.Channels.size() == expected.Channels.size());
+        for (size_t c = 0; c < expected.Channels.size(); c++)
+        {
+            const AnimationChannel& channel = animation.Channels[c];
+            const AnimationChannel& expectedChannel = expected.Channels[c];
+            CHECK(channel.Times == expectedChannel.Times);
+            CHECK(SameBytes<V3>(channel.Translations, expectedChannel.Translations));
+            CHECK(SameBytes<Quat>(channel.Rotations, expectedChannel.Rotations));
+            CHECK(SameBytes<PackedQuat>(channel.PackedRotations, expectedChannel.PackedRotations));
+            CHECK(SameBytes<V3>(channel.Scales, expectedChannel.Scales));
+            CHECK(channel.TargetNode == expectedChannel.TargetNode && channel.Path == expectedChannel.Path);
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#include "pch.h"
+#include "test.h"
+#include "assets/model_loader.h"
+#include "assets/texture_registry.h"
+
+// Positions of a submesh's triangle corners, sorted so reordering passes that
+// keep the geometry compare equal.
+static std::vector<std::array<float, 3>> GetSubmeshCorners(const Mesh& mesh, const Submesh& submesh)
+{
+    std::vector<std::array<float, 3>> result{};
+    for (uint32_t i = 0; i < submesh.IndexCount; ++i)
+    {
+        const V3 p = mesh.Vertices[mesh.Indices[submesh.IndexOffset + i]].Position;
+        result.push_back({ p.X, p.Y, p.Z });
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+// multi_primitive.gltf holds one mesh with five primitives: an indexed quad
+// (16-bit indices, texture 0), an indexed triangle (32-bit indices, texture
+// 1), an unindexed triangle (texture 0 again), an untextured triangle and a
+// point list, which is skipped.
+TEST_CASE(LoaderMergesPrimitivesIntoSubmeshes)
+{
+    for (const bool optimize : { false, true })
+    {
+        TextureRegistry textures{};
+        ModelLoadOptions options{};
+        options.OptimizeMeshes = optimize;
+        options.GenerateLods = false;
+        const Model model = ModelLoader::LoadGLTFModel("Game/tests/data/multi_primitive.gltf", textures, options);
+        REQUIRE(model.Meshes.size() == 1);
+
+        const Mesh& mesh = model.Meshes[0];
+        REQUIRE(mesh.Submeshes.size() == 4);
+        CHECK(mesh.Indices.size() == 15);
+        CHECK(mesh.Textures.size() == 2);
+        if (!optimize)
+            CHECK(mesh.Vertices.size() == 13);
+
+        const uint32_t expectedOffsets[] = { 0, 6, 9, 12 };
+        const uint32_t expectedCounts[] = { 6, 3, 3, 3 };
+        const int32_t expectedMaterials[] = { 0, 1, 0, -1 };
+        for (size_t s = 0; s < 4; ++s)
+        {
+            const Submesh& submesh = mesh.Submeshes[s];
+            CHECK(submesh.IndexOffset == expectedOffsets[s]);
+            CHECK(submesh.IndexCount == expectedCounts[s]);
+            CHECK(submesh.Material == expectedMaterials[s]);
+        }
+
+        for (const uint32_t index : mesh.Indices)
+            CHECK(index < mesh.Vertices.size());
+
+        // Each primitive's geometry lands in its own range, wherever the
+        // optimizer moved its vertices
+        using Corners = std::vector<std::array<float, 3>>;
+        CHECK(GetSubmeshCorners(mesh, mesh.Submeshes[0]) == Corners({
+            { 0, 0, 0 }, { 0, 0, 0 }, { 0, 1, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 1, 1, 0 } }));
+        CHECK(GetSubmeshCorners(mesh, mesh.Submeshes[1]) == Corners({ { 2, 0, 0 }, { 2, 1, 0 }, { 3, 0, 0 } }));
+        CHECK(GetSubmeshCorners(mesh, mesh.Submeshes[2]) == Corners({ { 4, 0, 0 }, { 4, 1, 0 }, { 5, 0, 0 } }));
+        CHECK(GetSubmeshCorners(mesh, mesh.Submeshes[3]) == Corners({ { 6, 0, 0 }, { 6, 1, 0 }, { 7, 0, 0 } }));
+
+        // The two embedded images decode to their 2x2 colors
+        const Texture& red = textures.GetTexture(mesh.Textures[0]);
+        const Texture& green = textures.GetTexture(mesh.Textures[1]);
+        CHECK(red.Width == 2 && red.Pixels[0] == 255 && red.Pixels[1] == 0);
+        CHECK(green.Width == 2 && green.Pixels[0] == 0 && green.Pixels[1] == 255);
+    }
+}
+
+// shared_texture.gltf holds three single-triangle meshes. Two glTF textures
+// point at its one embedded 64x64 image, and each mesh uses one of them.
+TEST_CASE(MeshesSharingAnImageShareOneTexture)
+{
+    TextureRegistry textures{};
+    ModelLoadOptions options{};
+    options.GenerateLods = false;
+    const Model model = ModelLoader::LoadGLTFModel("Game/tests/data/shared_texture.gltf", textures, options);
+    REQUIRE(model.Meshes.size() == 3);
+
+    size_t copiedBytes = 0;
+    for (const Mesh& mesh : model.Meshes)
+    {
+        REQUIRE(mesh.Textures.size() == 1);
+        CHECK(mesh.Textures[0] == model.Meshes[0].Textures[0]);
+        copiedBytes += textures.GetTexture(mesh.Textures[0]).Pixels.size();
+    }
+
+    CHECK(textures.GetCount() == 1);
+    CHECK(textures.GetMemoryUsage() == 64 * 64 * 4);
+    std::println("  {} meshes: {} KB of texture data, {} KB as per-mesh copies",
+        model.Meshes.size(), textures.GetMemoryUsage() / 1024, copiedBytes / 1024);
+
+    // A second load of the same file finds the image already registered
+    const Model again = ModelLoader::LoadGLTFModel("Game/tests/data/shared_texture.gltf", textures, options);
+    CHECK(textures.GetCount() == 1);
+    CHECK(again.Meshes[0].Textures[0] == model.Meshes[0].Textures[0]);
+}
@@ -0,0 +1,38 @@
+#include "pch.h"
+#include "test.h"
+#include "platform/null_platform.h"
+
+TEST_CASE(NullPlatformPlaysBackScriptByFrame)
+{
+    // Out of order on purpose, the platform sorts by frame
+    NullPlatform platform(3, {
+        { .Frame = 2, .Key = KeyCode::KEY_W, .Down = false },
+        { .Frame = 1, .Key = KeyCode::KEY_W, .Down = true, .MouseDelta = { 2.0f, -1.0f } },
+    });
+    platform.InitWindow(64, 64, L"test");
+    platform.InitInput();
+
+    bool running = true;
+
+    // Frame 1 applies inputs scripted before it, none here
+    platform.UpdateWindow(running);
+    platform.UpdateInput();
+    CHECK(!platform.IsKeyDown(KeyCode::KEY_W));
+
+    platform.UpdateWindow(running);
+    platform.UpdateInput();
+    CHECK(platform.IsKeyDown(KeyCode::KEY_W));
+    CHECK(platform.IsKeyPressed(KeyCode::KEY_W));
+    CHECK(platform.GetMouseDelta().X == 2.0f && platform.GetMouseDelta().Y == -1.0f);
+
+    platform.UpdateWindow(running);
+    platform.UpdateInput();
+    CHECK(!platform.IsKeyDown(KeyCode::KEY_W));
+    CHECK(platform.IsKeyReleased(KeyCode::KEY_W));
+    CHECK(running);
+
+    // The window closes once frameCount frames have run
+    platform.UpdateWindow(running);
+    CHECK(!running);
+    CHECK(platform.GetFrameTimes().size() == 3);
+}
@@ -0,0 +1,123 @@
+#include "pch.h"
+#include "test.h"
+#include "renderer/render_queue.h"
+
+// Backend handles only need to be distinct, so they point into a buffer.
+struct FakeScene
+{
+    std::vector<uint8_t> Handles{};
+    std::vector<Mesh> EntityMeshes{};
+    std::vector<Mesh> TileMeshes{};
+    std::vector<std::array<M4, MAX_BONES>> Bones{};
+
+    void* GetHandle(size_t index) { return Handles.data() + index; }
+};
+
+// 100 entities with 2 meshes of 4 submeshes each, 10 of them skinned, and
+// 112 terrain tiles of 5 submeshes under one object. Each entity mesh uses 4
+// of 6 textures, like a character with body, face, clothes and gear.
+static void SubmitFixedScene(FakeScene& scene, RenderQueue& queue)
+{
+    constexpr uint32_t entityCount = 100;
+    constexpr uint32_t tileCount = 112;
+    constexpr uint32_t textureCount = 6;
+
+    scene.Handles.assign(1024, 0);
+    scene.Bones.resize(10);
+    size_t nextHandle = 0;
+
+    auto makeMesh = [&](std::span<const uint32_t> textures, uint32_t submeshCount)
+    {
+        Mesh mesh{};
+        mesh.VertexBuffer = scene.GetHandle(nextHandle++);
+        mesh.IndexBuffer = scene.GetHandle(nextHandle++);
+        for (const uint32_t texture : textures)
+        {
+            mesh.Textures.push_back({ texture });
+            mesh.TextureViews.push_back(scene.GetHandle(900 + texture));
+        }
+        for (uint32_t i = 0; i < submeshCount; i++)
+            mesh.Submeshes.push_back({ i * 36, 36, static_cast<int32_t>(i % textures.size()) });
+        return mesh;
+    };
+
+    for (uint32_t e = 0; e < entityCount * 2; e++)
+    {
+        const std::array<uint32_t, 4> textures = {
+            e % textureCount, (e + 1) % textureCount, (e + 2) % textureCount, (e + 3) % textureCount };
+        scene.EntityMeshes.push_back(makeMesh(textures, 4));
+    }
+    for (uint32_t t = 0; t < tileCount; t++)
+        scene.TileMeshes.push_back(makeMesh(std::array<uint32_t, 1>{ textureCount }, 5));
+
+    RenderView view{};
+    view.Direction = { 0.0f, 0.0f, 1.0f };
+    queue.Begin(view);
+
+    for (uint32_t e = 0; e < entityCount; e++)
+    {
+        RenderObject object{};
+        object.Bones = e % 10 == 0 ? &scene.Bones[e / 10] : nullptr;
+        const uint32_t index = queue.AddObject(object);
+
+        // Spread over 1 to 500 units, in no particular order
+        const V3 position = { 0.0f, 0.0f, 1.0f + static_cast<float>((e * 37) % entityCount) * 5.0f };
+        for (const Mesh& mesh : std::span(scene.EntityMeshes).subspan(e * 2, 2))
+            for (const Submesh& submesh : mesh.Submeshes)
+                queue.Submit(RenderPass::Opaque, RenderShader::Mesh, index, mesh, submesh, position);
+    }
+
+    const uint32_t terrain = queue.AddObject(RenderObject{});
+    for (uint32_t t = 0; t < tileCount; t++)
+    {
+        const V3 center = { 0.0f, 0.0f, static_cast<float>(t) * 8.0f };
+        for (const Submesh& submesh : scene.TileMeshes[t].Submeshes)
+            queue.Submit(RenderPass::Opaque, RenderShader::Mesh, terrain, scene.TileMeshes[t], submesh, center);
+    }
+}
+
+TEST_CASE(RenderQueueBindsEachMeshAndObjectOnce)
+{
+    FakeScene scene{};
+    RenderQueue queue{};
+    SubmitFixedScene(scene, queue);
+
+    RecordingBackend backend{};
+    const RenderQueueStats stats = queue.Execute(backend);
+
+    std::println("  {} draws: {} geometry, {} texture, {} object, {} bone changes",
+        stats.DrawCalls, stats.GeometryChanges, stats.TextureChanges, stats.ObjectUploads, stats.BoneUploads);
+
+    CHECK(stats.DrawCalls == 100 * 2 * 4 + 112 * 5);
+    CHECK(stats.ShaderChanges == 1);
+    // One bind per mesh and tile
+    CHECK(stats.GeometryChanges == 200 + 112);
+    // Entities once each. Terrain again in each of the 7 depth buckets it
+    // shares with entities; its last two buckets are adjacent, so they merge.
+    CHECK(stats.ObjectUploads == 100 + 7);
+    CHECK(stats.BoneUploads == 10);
+    // At most one per submesh, plus the terrain texture once per bucket
+    CHECK(stats.TextureChanges <= 200 * 4 + 7);
+    CHECK(backend.GetCount(RenderCommand::SetGeometry) == stats.GeometryChanges);
+    CHECK(backend.GetCount(RenderCommand::SetObject) == stats.ObjectUploads);
+}
+
+TEST_CASE(RenderQueueKeysOrderPassesAndDepth)
+{
+    const int dummy = 0;
+
+    // Opaque sorts front to back by bucket, ahead of object order
+    CHECK(RenderQueue::MakeKey(RenderPass::Opaque, RenderShader::Mesh, 9, &dummy, 0, 1.5f) <
+        RenderQueue::MakeKey(RenderPass::Opaque, RenderShader::Mesh, 0, &dummy, 0, 2.5f));
+    CHECK(RenderQueue::MakeKey(RenderPass::Opaque, RenderShader::Mesh, 0, &dummy, 5, 40.0f) <
+        RenderQueue::MakeKey(RenderPass::Opaque, RenderShader::Mesh, 1, &dummy, 0, 33.0f));
+    // Negative depths are behind the camera and clamp to the nearest bucket
+    CHECK(RenderQueue::MakeKey(RenderPass::Opaque, RenderShader::Mesh, 0, &dummy, 0, -10.0f) ==
+        RenderQueue::MakeKey(RenderPass::Opaque, RenderShader::Mesh, 0, &dummy, 0, 0.5f));
+
+    // Transparent sorts exactly back to front, after every opaque packet
+    CHECK(RenderQueue::MakeKey(RenderPass::Transparent, RenderShader::Mesh, 0, &dummy, 0, 10.01f) <
+        RenderQueue::MakeKey(RenderPass::Transparent, RenderShader::Mesh, 0, &dummy, 0, 10.0f));
+    CHECK(RenderQueue::MakeKey(RenderPass::Opaque, RenderShader::Mesh, 0xFFFFF, &dummy, 0xFFFF, 1e30f) <
+        RenderQueue::MakeKey(RenderPass::Transparent, RenderShader::Mesh, 0, &dummy, 0, 1e30f));
+}
@@ -0,0 +1,108 @@
+#include "pch.h"
+#include "test.h"
+#include "assets/animator.h"
+#include "assets/mesh_bounds.h"
+#include "assets/model_loader.h"
+#include "assets/skinning.h"
+#include "assets/texture_registry.h"
+
+TEST_CASE(SimdSkinningMatchesScalarReference)
+{
+    TextureRegistry textures{};
+    ModelLoadOptions options{};
+    options.GenerateLods = false;
+    Model model = ModelLoader::LoadGLTFModel("assets/models/dummy_platformer.gltf", textures, options);
+    REQUIRE(!model.Meshes.empty() && !model.Animations.empty());
+
+    PlayAnimation(model.Animator, &model.Animations[0], &model.Skeletons[0], 1.0f, true);
+    UpdateAnimator(model.Animator, 0.4f);
+
+    const std::vector<Vertex>& vertices = model.Meshes[0].Vertices;
+    std::vector<V3> scalarPositions(vertices.size()), scalarNormals(vertices.size());
+    std::vector<V3> simdPositions(vertices.size()), simdNormals(vertices.size());
+    SkinVerticesScalar(vertices, model.Animator.FinalBoneTransforms, scalarPositions, scalarNormals);
+    SkinVertices(vertices, model.Animator.FinalBoneTransforms, simdPositions, simdNormals);
+
+    float maxPositionError = 0.0f;
+    float maxNormalError = 0.0f;
+    size_t moved = 0;
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        maxPositionError = std::max(maxPositionError, Length(scalarPositions[i] - simdPositions[i]));
+        maxNormalError = std::max(maxNormalError, Length(scalarNormals[i] - simdNormals[i]));
+        moved += Length(scalarPositions[i] - vertices[i].Position) > 1e-3f;
+    }
+
+    CHECK_NEAR(maxPositionError, 0.0f, 1e-4f);
+    CHECK_NEAR(maxNormalError, 0.0f, 1e-4f);
+    // The pose has to actually deform the mesh for the comparison to mean anything
+    CHECK(moved > vertices.size() / 2);
+}
+
+TEST_CASE(SkinningPassesUnweightedVerticesThrough)
+{
+    std::array<M4, MAX_BONES> bones{};
+    bones.fill(MatrixTranslation(5.0f, 0.0f, 0.0f));
+
+    const Vertex vertex{ .Position = { 1.0f, 2.0f, 3.0f }, .Normal = { 0.0f, 1.0f, 0.0f } };
+    V3 position{}, normal{};
+    SkinVertices({ &vertex, 1 }, bones, { &position, 1 }, { &normal, 1 });
+
+    CHECK(position.X == 1.0f && position.Y == 2.0f && position.Z == 3.0f);
+    CHECK(normal.Y == 1.0f);
+}
+
+// Culling uses these bounds, so every skinned vertex of every frame has to be
+// inside them. Bind pose bounds are checked too, to show the pose leaves them.
+TEST_CASE(PosedBoundsContainSkinnedVertices)
+{
+    TextureRegistry textures{};
+    ModelLoadOptions options{};
+    options.GenerateLods = false;
+    Model model = ModelLoader::LoadGLTFModel("assets/models/dummy_platformer.gltf", textures, options);
+    REQUIRE(!model.Meshes.empty() && !model.Animations.empty());
+
+    const Mesh& mesh = model.Meshes[0];
+    REQUIRE(!mesh.BoneBounds.empty());
+
+    auto contains = [](const AABB& box, const V3& point)
+    {
+        constexpr float epsilon = 1e-4f;
+        return point.X >= box.Min.X - epsilon && point.X <= box.Max.X + epsilon &&
+            point.Y >= box.Min.Y - epsilon && point.Y <= box.Max.Y + epsilon &&
+            point.Z >= box.Min.Z - epsilon && point.Z <= box.Max.Z + epsilon;
+    };
+
+    std::vector<V3> positions(mesh.Vertices.size()), normals(mesh.Vertices.size());
+    size_t outside = 0;
+    size_t outsideBindPose = 0;
+    for (Animation& clip : model.Animations)
+    {
+        PlayAnimation(model.Animator, &clip, &model.Skeletons[0], 1.0f, true);
+        for (int frame = 0; frame < 16; ++frame)
+        {
+            model.Animator.Layers[0].Time = clip.Duration * frame / 16.0f;
+            UpdateAnimator(model.Animator, 0.0f);
+
+            const AABB posed = ComputePosedBounds(mesh, model.Animator.FinalBoneTransforms);
+            SkinVertices(mesh.Vertices, model.Animator.FinalBoneTransforms, positions, normals);
+            for (const V3& position : positions)
+            {
+                outside += !contains(posed, position);
+                outsideBindPose += !contains(mesh.Bounds, position);
+            }
+        }
+    }
+
+    std::println("  {} clips: {} vertex positions outside the bind pose bounds, {} outside the posed bounds",
+        model.Animations.size(), outsideBindPose, outside);
+    CHECK(outside == 0);
+    CHECK(outsideBindPose > 0);
+
+    // Identity skinning matrices give back the bind pose bounds
+    std::array<M4, MAX_BONES> identity{};
+    identity.fill(MatrixIdentity());
+    const AABB rest = ComputePosedBounds(mesh, identity);
+    CHECK(contains(rest, mesh.Bounds.Min) && contains(rest, mesh.Bounds.Max));
+    CHECK(contains(mesh.Bounds, rest.Min) && contains(mesh.Bounds, rest.Max));
+}
@@ -0,0 +1,183 @@
+#include "pch.h"
+#include "test.h"
+#include "assets/animator.h"
+#include "assets/model_loader.h"
+#include "assets/texture_registry.h"
+#include "renderer/software_renderer.h"
+
+#include <stb_image.h>
+#include <stb_image_write.h>
+
+static constexpr int32_t IMAGE_WIDTH = 160;
+static constexpr int32_t IMAGE_HEIGHT = 120;
+static constexpr const char* GOLDEN_PATH = "Game/tests/data/skinned_character.png";
+// Where a failing run leaves its render, outside the source tree.
+static constexpr const char* ACTUAL_PATH = "skinned_character_actual.png";
+
+// The character mid-run, framed from the front left, as tightly packed RGBA rows.
+// bindPose replaces the animated skinning matrices with the identity. prepare
+// may change the model before it is uploaded.
+static std::vector<uint32_t> RenderCharacter(bool bindPose, SoftwareRasterStats* stats = nullptr,
+    const std::function<void(Model&, TextureRegistry&)>& prepare = {})
+{
+    auto gameState = std::make_unique<GameMemory>();
+    TextureRegistry textures{};
+
+    SoftwareRenderer renderer{};
+    renderer.InitRenderer(IMAGE_HEIGHT, IMAGE_WIDTH, nullptr, gameState.get());
+
+    ModelLoadOptions options{};
+    options.GenerateLods = false;
+    Model model = ModelLoader::LoadGLTFModel("assets/models/dummy_platformer.gltf", textures, options);
+    if (prepare)
+        prepare(model, textures);
+    for (Mesh& mesh : model.Meshes)
+        renderer.UploadMeshesToGPU(mesh, textures);
+
+    Entity& entity = gameState->World.Entities[0];
+    entity.Model = std::move(model);
+    entity.WorldMatrix = MatrixRotationY(3.14159265f);
+
+    Animator& animator = entity.Model.Animator;
+    PlayAnimation(animator, &entity.Model.Animations[0], &entity.Model.Skeletons[0], 1.0f, true);
+    animator.Layers[0].Time = entity.Model.Animations[0].Duration * 0.3f;
+    UpdateAnimator(animator, 0.0f);
+    if (bindPose)
+        animator.FinalBoneTransforms.fill(MatrixIdentity());
+
+    Camera& camera = gameState->MainCamera;
+    camera.Position = { 1.4f, 1.1f, -2.6f };
+    camera.Up = { 0.0f, 1.0f, 0.0f };
+    const V3 target = { 0.0f, 0.75f, 0.0f };
+    camera.Direction = Normalize(target - camera.Position);
+    camera.View = MatrixLookAt(camera.Position, target, camera.Up);
+    camera.Projection = MatrixPerspective(0.8f, static_cast<float>(IMAGE_WIDTH) / IMAGE_HEIGHT, 0.1f, 100.0f);
+
+    const V3 lightDirection = Normalize({ 0.5f, 1.0f, -0.5f });
+    gameState->World.DirectionalLight.Ambient = { 0.4f, 0.4f, 0.4f };
+    gameState->World.DirectionalLight.Color = { 1.0f, 1.0f, 1.0f };
+    gameState->World.DirectionalLight.Direction = { lightDirection.X, lightDirection.Y, lightDirection.Z, 0.0f };
+
+    renderer.RenderScene(gameState.get());
+    if (stats)
+        *stats = renderer.GetStats();
+
+    std::vector<uint32_t> image(static_cast<size_t>(IMAGE_WIDTH) * IMAGE_HEIGHT);
+    const std::span<const uint32_t> color = renderer.GetColorBuffer();
+    for (int32_t y = 0; y < IMAGE_HEIGHT; y++)
+    {
+        std::copy_n(color.begin() + static_cast<size_t>(y) * renderer.GetStride(), IMAGE_WIDTH,
+            image.begin() + static_cast<size_t>(y) * IMAGE_WIDTH);
+    }
+    return image;
+}
+
+// Pixels with a channel more than 16 apart, which leaves room for float
+// differences between compilers but not for a moved limb.
+static uint32_t CountDifferentPixels(std::span<const uint32_t> a, std::span<const uint32_t> b)
+{
+    uint32_t count = 0;
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        for (uint32_t shift = 0; shift < 32; shift += 8)
+        {
+            const int32_t difference = static_cast<int32_t>((a[i] >> shift) & 0xFF) - static_cast<int32_t>((b[i] >> shift) & 0xFF);
+            if (std::abs(difference) > 16)
+            {
+                count++;
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+// A missing or different golden image fails and leaves the render at
+// ACTUAL_PATH. To regenerate it on purpose, run the tests with
+// UPDATE_GOLDEN_IMAGES=1 in the environment, which overwrites the golden
+// image and fails that run, then check the new image by eye before
+// committing it.
+TEST_CASE(SoftwareRendererMatchesSkinnedGoldenImage)
+{
+    const std::vector<uint32_t> image = RenderCharacter(false);
+    const auto writeImage = [&image](const char* path)
+    {
+        stbi_write_png(path, IMAGE_WIDTH, IMAGE_HEIGHT, 4, image.data(), IMAGE_WIDTH * 4);
+    };
+
+    if (std::getenv("UPDATE_GOLDEN_IMAGES"))
+    {
+        writeImage(GOLDEN_PATH);
+        ReportFailure(__FILE__, __LINE__,
+            std::format("wrote {}, check it and run again without UPDATE_GOLDEN_IMAGES", GOLDEN_PATH));
+        return;
+    }
+
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    unsigned char* golden = stbi_load(GOLDEN_PATH, &width, &height, &channels, STBI_rgb_alpha);
+    if (!golden)
+    {
+        writeImage(ACTUAL_PATH);
+        ReportFailure(__FILE__, __LINE__, std::format("no golden image at {}, wrote the render to {}", GOLDEN_PATH, ACTUAL_PATH));
+        return;
+    }
+
+    std::vector<uint32_t> expected(static_cast<size_t>(IMAGE_WIDTH) * IMAGE_HEIGHT);
+    const bool sameSize = width == IMAGE_WIDTH && height == IMAGE_HEIGHT;
+    if (sameSize)
+        std::memcpy(expected.data(), golden, expected.size() * sizeof(uint32_t));
+    stbi_image_free(golden);
+    REQUIRE(sameSize);
+
+    const uint32_t different = CountDifferentPixels(image, expected);
+    if (different > image.size() / 200)
+        writeImage(ACTUAL_PATH);
+    std::println("  {} of {} pixels differ from the golden image", different, image.size());
+    CHECK(different <= image.size() / 200);
+
+    // The pose has to show: the same frame in bind pose looks clearly different
+    const std::vector<uint32_t> bindPose = RenderCharacter(true);
+    CHECK(CountDifferentPixels(image, bindPose) > image.size() / 50);
+}
+
+// Batches of one mesh and object share their transformed vertices, and
+// vertices no batch indexes are not transformed at all.
+TEST_CASE(SoftwareRendererTransformsEachVertexOnce)
+{
+    size_t vertexCount = 0;
+    const auto prepare = [&vertexCount](Model& model, TextureRegistry& textures)
+    {
+        Mesh& mesh = model.Meshes[0];
+        vertexCount = mesh.Vertices.size();
+        mesh.Vertices.insert(mesh.Vertices.end(), 100, mesh.Vertices[0]);
+
+        // The second half of every submesh draws with a copy of its texture
+        const size_t submeshCount = mesh.Submeshes.size();
+        for (size_t i = 0; i < submeshCount; i++)
+        {
+            Submesh& submesh = mesh.Submeshes[i];
+            if (submesh.Material < 0)
+                continue;
+
+            const TextureHandle texture = mesh.Textures[submesh.Material];
+            mesh.Textures.push_back(textures.Register(std::format("copy{}", i), textures.GetTexture(texture)));
+
+            Submesh second = submesh;
+            second.IndexCount = submesh.IndexCount / 6 * 3;
+            submesh.IndexCount -= second.IndexCount;
+            second.IndexOffset = submesh.IndexOffset + submesh.IndexCount;
+            second.Material = static_cast<int32_t>(mesh.Textures.size() - 1);
+            mesh.Submeshes.push_back(second);
+        }
+    };
+
+    SoftwareRasterStats stats{};
+    const std::vector<uint32_t> image = RenderCharacter(false, &stats, prepare);
+    REQUIRE(vertexCount > 0);
+    CHECK(stats.Vertices > 0 && stats.Vertices <= vertexCount);
+
+    const std::vector<uint32_t> expected = RenderCharacter(false);
+    CHECK(CountDifferentPixels(image, expected) <= image.size() / 200);
+}
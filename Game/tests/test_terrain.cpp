@@ -0,0 +1,119 @@
+#include "pch.h"
+#include "test.h"
+#include "assets/texture_registry.h"
+#include "assets/vertex_format.h"
+#include "renderer/null_renderer.h"
+#include "world/terrain.h"
+
+static Heightmap MakeTestHeightmap(int32_t size)
+{
+    Heightmap heightmap{};
+    heightmap.Width = size;
+    heightmap.Height = size;
+    heightmap.Heights.resize(static_cast<size_t>(size) * size);
+    for (int32_t z = 0; z < size; z++)
+        for (int32_t x = 0; x < size; x++)
+            heightmap.Heights[static_cast<size_t>(x) + static_cast<size_t>(z) * size] = sinf(x * 0.1f) * cosf(z * 0.1f);
+    heightmap.MinHeight = -1.0f;
+    heightmap.MaxHeight = 1.0f;
+    return heightmap;
+}
+
+TEST_CASE(TerrainTilesShareOneIndexBuffer)
+{
+    TextureRegistry textures{};
+    const TextureHandle texture = textures.Register("terrain", Texture{});
+    Terrain terrain(MakeTestHeightmap(1025), texture, nullptr);
+
+    NullRenderer renderer{};
+    const V3 camera = { 10.0f, 5.0f, 10.0f };
+    for (int frame = 0; frame < 16; frame++)
+        terrain.Update(camera, renderer, textures);
+
+    const std::span<const TerrainDrawItem> draws = terrain.GetDrawList();
+    REQUIRE(draws.size() > 1);
+
+    const void* indexBuffer = draws[0].Mesh->IndexBuffer;
+    CHECK(indexBuffer != nullptr);
+    for (const TerrainDrawItem& item : draws)
+    {
+        CHECK(item.Mesh->IndexBuffer == indexBuffer);
+        CHECK(item.Mesh->VertexBuffer != nullptr);
+        CHECK(item.Mesh->Indices.empty());
+        CHECK(item.Mesh->Vertices.empty());
+        CHECK(item.Mesh->Bounds.IsValid());
+    }
+
+    // Moving away evicts tiles without touching the shared buffer
+    const V3 farCamera = { 1000.0f, 5.0f, 1000.0f };
+    for (int frame = 0; frame < 200; frame++)
+        terrain.Update(farCamera, renderer, textures);
+    CHECK(terrain.GetStats().EvictedTiles > 0);
+    CHECK(terrain.GetDrawList()[0].Mesh->IndexBuffer == indexBuffer);
+    CHECK(renderer.GetLiveMeshCount() == terrain.GetStats().ResidentTiles);
+
+    // Terrain is unskinned, so packing leaves only the static stream
+    const TerrainStats stats = terrain.GetStats();
+    const size_t tileVertices = 65 * 65;
+    CHECK(stats.ResidentVertexBytes == stats.ResidentTiles * tileVertices * sizeof(Vertex));
+    CHECK(stats.ResidentPackedVertexBytes == stats.ResidentTiles * tileVertices * sizeof(PackedVertex));
+}
+
+// Streams tiles on worker threads while the camera crosses the map. Missing
+// tiles are covered by their parents, so once the first tiles are in, the
+// draw list keeps covering the whole map with more than the root.
+TEST_CASE(TerrainStreamingNeverCollapsesToTheRoot)
+{
+    TextureRegistry textures{};
+    const TextureHandle texture = textures.Register("terrain", Texture{});
+    JobSystem jobs(2);
+    constexpr int32_t size = 1025;
+    Terrain terrain(MakeTestHeightmap(size), texture, &jobs);
+
+    NullRenderer renderer{};
+    const float mapArea = static_cast<float>(size - 1) * (size - 1);
+
+    // Frames take real time, so the workers finish tiles while the camera
+    // moves, as they would in the game.
+    const auto nextFrame = []() { std::this_thread::sleep_for(std::chrono::milliseconds(1)); };
+
+    // Warm up over one corner until nothing is pending
+    V3 camera = { 10.0f, 5.0f, 10.0f };
+    for (int frame = 0; frame < 5000 && (frame == 0 || terrain.GetStats().PendingTiles > 0); frame++)
+    {
+        terrain.Update(camera, renderer, textures);
+        nextFrame();
+    }
+    const uint32_t warmDraws = terrain.GetStats().DrawnTiles;
+    CHECK(warmDraws > 4);
+
+    uint32_t fewestDraws = UINT32_MAX;
+    uint32_t gaps = 0;
+    for (int frame = 0; frame < 300; frame++)
+    {
+        camera = { 10.0f + frame * 3.3f, 5.0f, 10.0f + frame * 2.0f };
+        terrain.Update(camera, renderer, textures);
+        nextFrame();
+
+        float area = 0.0f;
+        for (const TerrainDrawItem& item : terrain.GetDrawList())
+        {
+            const V3 extents = item.Mesh->Bounds.Max - item.Mesh->Bounds.Min;
+            area += extents.X * extents.Z;
+        }
+        gaps += fabsf(area - mapArea) > 1.0f;
+        fewestDraws = std::min(fewestDraws, terrain.GetStats().DrawnTiles);
+    }
+
+    std::println("  {} tiles drawn after warm-up, at least {} while moving", warmDraws, fewestDraws);
+    CHECK(gaps == 0);
+    CHECK(fewestDraws > 4);
+
+    // Shutdown releases every tile and the shared index buffer
+    terrain.Shutdown(renderer);
+    CHECK(renderer.GetLiveMeshCount() == 0);
+    CHECK(renderer.GetLiveIndexBufferCount() == 0);
+    terrain.Update(camera, renderer, textures);
+    CHECK(terrain.GetDrawList().empty());
+    CHECK(renderer.GetLiveIndexBufferCount() == 0);
+}
@@ -0,0 +1,163 @@
+#include "pch.h"
+#include "test.h"
+#include "math/vector_stream.h"
+
+// Uniform in [-1, 1), deterministic so failures reproduce.
+static float NextRandom(uint32_t& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return static_cast<float>(state >> 8) / 8388608.0f - 1.0f;
+}
+
+// An odd count, so any unrolled or vectorized tail is exercised too.
+static constexpr size_t STREAM_COUNT = 37;
+
+static std::vector<V3> MakeVectors(uint32_t& state)
+{
+    std::vector<V3> result(STREAM_COUNT);
+    for (V3& v : result)
+        v = { NextRandom(state) * 10.0f, NextRandom(state) * 10.0f, NextRandom(state) * 10.0f };
+    return result;
+}
+
+static std::vector<float> MakeFactors(uint32_t& state)
+{
+    std::vector<float> result(STREAM_COUNT);
+    for (float& t : result)
+        t = NextRandom(state) * 0.5f + 0.5f;
+    return result;
+}
+
+static float MaxDifference(const V3Stream& stream, std::span<const V3> expected)
+{
+    float result = 0.0f;
+    for (size_t i = 0; i < expected.size(); i++)
+        result = std::max(result, Length(stream.Get(i) - expected[i]));
+    return result;
+}
+
+TEST_CASE(V3StreamKernelsMatchScalarHelpers)
+{
+    uint32_t state = 1;
+    const std::vector<V3> a = MakeVectors(state);
+    const std::vector<V3> b = MakeVectors(state);
+    const std::vector<float> t = MakeFactors(state);
+    const V3Stream streamA = ToV3Stream(a);
+    const V3Stream streamB = ToV3Stream(b);
+
+    std::vector<V3> expected(STREAM_COUNT);
+    V3Stream out{};
+
+    V3StreamAdd(streamA, streamB, out);
+    for (size_t i = 0; i < STREAM_COUNT; i++)
+        expected[i] = a[i] + b[i];
+    CHECK_NEAR(MaxDifference(out, expected), 0.0f, 1e-5f);
+
+    V3StreamMul(streamA, streamB, out);
+    for (size_t i = 0; i < STREAM_COUNT; i++)
+        expected[i] = { a[i].X * b[i].X, a[i].Y * b[i].Y, a[i].Z * b[i].Z };
+    CHECK_NEAR(MaxDifference(out, expected), 0.0f, 1e-5f);
+
+    V3StreamMul(streamA, 2.5f, out);
+    for (size_t i = 0; i < STREAM_COUNT; i++)
+        expected[i] = a[i] * 2.5f;
+    CHECK_NEAR(MaxDifference(out, expected), 0.0f, 1e-5f);
+
+    std::vector<float> dots(STREAM_COUNT);
+    V3StreamDot(streamA, streamB, dots);
+    float dotError = 0.0f;
+    for (size_t i = 0; i < STREAM_COUNT; i++)
+        dotError = std::max(dotError, std::abs(dots[i] - Dot(a[i], b[i])));
+    CHECK_NEAR(dotError, 0.0f, 1e-4f);
+
+    V3StreamCross(streamA, streamB, out);
+    for (size_t i = 0; i < STREAM_COUNT; i++)
+        expected[i] = Cross(a[i], b[i]);
+    CHECK_NEAR(MaxDifference(out, expected), 0.0f, 1e-4f);
+
+    V3StreamLerp(streamA, streamB, t, out);
+    for (size_t i = 0; i < STREAM_COUNT; i++)
+        expected[i] = V3Lerp(a[i], b[i], t[i]);
+    CHECK_NEAR(MaxDifference(out, expected), 0.0f, 1e-4f);
+
+    // Outputs may alias inputs; cross reads every component before writing
+    V3Stream aliased = streamA;
+    V3StreamCross(aliased, streamB, aliased);
+    for (size_t i = 0; i < STREAM_COUNT; i++)
+        expected[i] = Cross(a[i], b[i]);
+    CHECK_NEAR(MaxDifference(aliased, expected), 0.0f, 1e-4f);
+}
+
+TEST_CASE(V3StreamNormalizeKeepsZeroVectorsZero)
+{
+    uint32_t state = 2;
+    std::vector<V3> a = MakeVectors(state);
+    a[0] = {};
+    a[STREAM_COUNT - 1] = {};
+    // Tiny but not zero still normalizes
+    a[5] = { 1e-20f, 0.0f, 0.0f };
+
+    V3Stream out{};
+    V3StreamNormalize(ToV3Stream(a), out);
+
+    std::vector<V3> expected(STREAM_COUNT);
+    for (size_t i = 0; i < STREAM_COUNT; i++)
+        expected[i] = Normalize(a[i]);
+    CHECK_NEAR(MaxDifference(out, expected), 0.0f, 1e-5f);
+
+    CHECK(out.Get(0) == V3{});
+    CHECK(out.Get(STREAM_COUNT - 1) == V3{});
+    CHECK_NEAR(out.X[5], 1.0f, 1e-5f);
+    for (size_t i = 0; i < STREAM_COUNT; i++)
+        CHECK(!std::isnan(out.X[i]) && !std::isnan(out.Y[i]) && !std::isnan(out.Z[i]));
+}
+
+static Quat MakeRandomQuat(uint32_t& state)
+{
+    return NormalizeQuat({ NextRandom(state), NextRandom(state), NextRandom(state), NextRandom(state) });
+}
+
+// Rotations around nearby axes, with the to quaternion negated in every
+// other pair so both hemispheres are covered.
+TEST_CASE(QuatStreamSlerpMatchesSlerp)
+{
+    uint32_t state = 3;
+    std::vector<Quat> from(STREAM_COUNT);
+    std::vector<Quat> to(STREAM_COUNT);
+    const std::vector<float> t = MakeFactors(state);
+    for (size_t i = 0; i < STREAM_COUNT; i++)
+    {
+        from[i] = MakeRandomQuat(state);
+        switch (i % 4)
+        {
+        // Unrelated rotations
+        case 0: to[i] = MakeRandomQuat(state); break;
+        // Nearly parallel, inside the lerp fallback
+        case 1: to[i] = NormalizeQuat(from[i] + Quat{ 1e-4f, -1e-4f, 0.0f, 0.0f }); break;
+        // Identical
+        case 2: to[i] = from[i]; break;
+        // Nearly parallel but in the other hemisphere
+        case 3: to[i] = NormalizeQuat(from[i] + Quat{ 0.0f, 1e-4f, 1e-4f, 0.0f }) * -1.0f; break;
+        }
+    }
+
+    QuatStream out{};
+    QuatStreamSlerp(ToQuatStream(from), ToQuatStream(to), t, out);
+
+    float error = 0.0f;
+    float lengthError = 0.0f;
+    uint32_t nans = 0;
+    for (size_t i = 0; i < STREAM_COUNT; i++)
+    {
+        const Quat expected = Slerp(from[i], to[i], t[i]);
+        const Quat result = out.Get(i);
+        error = std::max({ error, std::abs(result.X - expected.X), std::abs(result.Y - expected.Y),
+            std::abs(result.Z - expected.Z), std::abs(result.W - expected.W) });
+        lengthError = std::max(lengthError, std::abs(sqrtf(Dot(result, result)) - 1.0f));
+        nans += std::isnan(result.X) || std::isnan(result.Y) || std::isnan(result.Z) || std::isnan(result.W);
+    }
+
+    CHECK(nans == 0);
+    CHECK_NEAR(error, 0.0f, 1e-4f);
+    CHECK_NEAR(lengthError, 0.0f, 1e-5f);
+}
@@ -0,0 +1,121 @@
+#include "pch.h"
+#include "test.h"
+#include "assets/vertex_format.h"
+
+TEST_CASE(HalfFloatRoundTrip)
+{
+    // Exactly representable values survive unchanged
+    for (const float value : { 0.0f, -0.0f, 1.0f, -2.0f, 0.5f, 0.25f, 1024.0f, 65504.0f, 6.103515625e-05f, 5.9604645e-08f })
+        CHECK(HalfToFloat(FloatToHalf(value)) == value);
+
+    CHECK(std::isinf(HalfToFloat(FloatToHalf(1e6f))));
+    CHECK(std::isinf(HalfToFloat(FloatToHalf(std::numeric_limits<float>::infinity()))));
+    CHECK(std::isnan(HalfToFloat(FloatToHalf(std::numeric_limits<float>::quiet_NaN()))));
+    CHECK(HalfToFloat(FloatToHalf(1e-9f)) == 0.0f);
+
+    // Normal range values round to nearest: relative error at most 2^-11
+    float maxRelativeError = 0.0f;
+    for (int i = 1; i < 20000; ++i)
+    {
+        const float value = (i % 2 ? 1.0f : -1.0f) * i * 0.0137f;
+        maxRelativeError = std::max(maxRelativeError, fabsf(HalfToFloat(FloatToHalf(value)) - value) / fabsf(value));
+    }
+    CHECK(maxRelativeError <= 1.0f / 2048.0f);
+
+    // Ties round to even: 1 + 2^-11 lies halfway between 1 and the next half
+    CHECK(HalfToFloat(FloatToHalf(1.0f + 1.0f / 2048.0f)) == 1.0f);
+}
+
+TEST_CASE(OctahedralNormalRoundTrip)
+{
+    std::vector<V3> normals = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+    // Spiral over the sphere, both hemispheres
+    for (int i = 0; i < 5000; ++i)
+    {
+        const float z = 1.0f - 2.0f * (i + 0.5f) / 5000.0f;
+        const float r = sqrtf(1.0f - z * z);
+        const float phi = i * 2.39996323f;
+        normals.push_back({ r * cosf(phi), r * sinf(phi), z });
+    }
+
+    float maxAngle = 0.0f;
+    for (const V3& normal : normals)
+    {
+        int16_t packed[2];
+        PackOctahedral(normal, packed);
+        const V3 unpacked = UnpackOctahedral(packed);
+        const float cosine = std::clamp(Dot(normal, unpacked), -1.0f, 1.0f);
+        maxAngle = std::max(maxAngle, 2.0f * asinf(std::min(Length(normal - unpacked) * 0.5f, 1.0f)));
+        CHECK(cosine > 0.99f);
+    }
+    CHECK(maxAngle < 0.001f);
+}
+
+TEST_CASE(SkinWeightsRoundTrip)
+{
+    IV4 ids{};
+    V4 weights{};
+
+    UnpackSkin(PackSkin({ 3, 17, 200, 255 }, { 0.5f, 0.25f, 0.125f, 0.125f }), ids, weights);
+    CHECK(ids.X == 3 && ids.Y == 17 && ids.Z == 200 && ids.W == 255);
+    CHECK_NEAR(weights.X, 0.5f, 1.0f / 255.0f);
+    CHECK_NEAR(weights.Y, 0.25f, 1.0f / 255.0f);
+    CHECK_NEAR(weights.X + weights.Y + weights.Z + weights.W, 1.0f, 1e-5f);
+
+    // Unnormalized weights are normalized, and the sum stays exactly 255
+    const PackedSkin thirds = PackSkin({ 0, 1, 2, 0 }, { 1.0f, 1.0f, 1.0f, 0.0f });
+    CHECK(thirds.Weights[0] + thirds.Weights[1] + thirds.Weights[2] + thirds.Weights[3] == 255);
+    CHECK(thirds.Weights[3] == 0);
+
+    // Unskinned vertices stay unweighted
+    const PackedSkin none = PackSkin({ 0, 0, 0, 0 }, { 0.0f, 0.0f, 0.0f, 0.0f });
+    CHECK(none.Weights[0] == 0 && none.Weights[1] == 0 && none.Weights[2] == 0 && none.Weights[3] == 0);
+}
+
+TEST_CASE(PackedVertexStreamsRoundTrip)
+{
+    std::vector<Vertex> vertices(64);
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        Vertex& v = vertices[i];
+        const float t = static_cast<float>(i);
+        v.Position = { t * 0.1f, sinf(t), -t };
+        v.Normal = Normalize(V3{ cosf(t), sinf(t * 0.7f), cosf(t * 1.3f) - 0.2f });
+        v.TexCoord = { t / 64.0f, 1.0f - t / 128.0f };
+    }
+
+    // Static: no skin stream
+    PackedVertexStream stream = PackVertices(vertices);
+    CHECK(stream.Skin.empty());
+    CHECK(GetPackedVertexSize(vertices) == vertices.size() * sizeof(PackedVertex));
+
+    std::vector<Vertex> unpacked(vertices.size());
+    UnpackVertices(stream, unpacked);
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        CHECK(Length(unpacked[i].Position - vertices[i].Position) == 0.0f);
+        CHECK(Dot(unpacked[i].Normal, vertices[i].Normal) > 0.99999f);
+        CHECK_NEAR(unpacked[i].TexCoord.X, vertices[i].TexCoord.X, 1e-3f);
+        CHECK_NEAR(unpacked[i].TexCoord.Y, vertices[i].TexCoord.Y, 1e-3f);
+        CHECK(unpacked[i].Weights.X == 0.0f && unpacked[i].Weights.W == 0.0f);
+    }
+
+    // Skinned: one skin entry per vertex
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        vertices[i].BoneIDs = { static_cast<int32_t>(i), static_cast<int32_t>(i + 1), 0, 0 };
+        vertices[i].Weights = { 0.75f, 0.25f, 0.0f, 0.0f };
+    }
+
+    stream = PackVertices(vertices);
+    CHECK(stream.Skin.size() == vertices.size());
+    CHECK(GetPackedVertexSize(vertices) == vertices.size() * (sizeof(PackedVertex) + sizeof(PackedSkin)));
+
+    UnpackVertices(stream, unpacked);
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        CHECK(unpacked[i].BoneIDs.X == vertices[i].BoneIDs.X && unpacked[i].BoneIDs.Y == vertices[i].BoneIDs.Y);
+        CHECK_NEAR(unpacked[i].Weights.X, 0.75f, 1.0f / 255.0f);
+        CHECK_NEAR(unpacked[i].Weights.Y, 0.25f, 1.0f / 255.0f);
+    }
+}
@@ -1,7 +1,6 @@
 
-cbuffer cbPerObject
+cbuffer cbPerObject : register(b0)
 {
-    float4x4 GlobalBoneTransform[100];
     float4x4 Projection;
     float4x4 View;
     float4x4 World;
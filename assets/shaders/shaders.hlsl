@@ -6,20 +6,25 @@ struct Light
     float4 diffuse;
 };
 
-cbuffer cbPerFrame
+cbuffer cbPerFrame : register(b2)
 {
     Light light;
 };
 
-cbuffer cbPerObject
+cbuffer cbPerObject : register(b0)
 {
-    float4x4 GlobalBoneTransform[100];
     float4x4 Projection;
     float4x4 View;
     float4x4 World;
     float4 Color;
 };
 
+// Only uploaded for meshes with a skeleton.
+cbuffer cbBones : register(b1)
+{
+    float4x4 GlobalBoneTransform[100];
+};
+
 struct PSInput
 {
     float4 position : SV_POSITION;
@@ -37,15 +42,22 @@ PSInput VSMain(float4 position : POSITION, float4 normal : NORMAL, float2 texCoo
 {
     PSInput result;
 
-    float3 worldNormal = normalize(mul((float3x3) World, normal.xyz));
-    
-    float4 skinnedPos = float4(0.0, 0.0, 0.0, 0.0);
-    for (int i = 0; i < 4; ++i)
+    // Unweighted vertices are static meshes, whose bones are not uploaded
+    float4 skinnedPos = float4(position.xyz, 1.0f);
+    float3 skinnedNormal = normal.xyz;
+    if (weights.x + weights.y + weights.z + weights.w > 0.0f)
     {
-        float4 localPosition = mul(GlobalBoneTransform[boneIDs[i]], float4(position.xyz, 1.0f));
-        skinnedPos += localPosition * weights[i];
+        skinnedPos = float4(0.0, 0.0, 0.0, 0.0);
+        skinnedNormal = float3(0.0, 0.0, 0.0);
+        for (int i = 0; i < 4; ++i)
+        {
+            skinnedPos += mul(GlobalBoneTransform[boneIDs[i]], float4(position.xyz, 1.0f)) * weights[i];
+            skinnedNormal += mul((float3x3) GlobalBoneTransform[boneIDs[i]], normal.xyz) * weights[i];
+        }
     }
-    float4 worldPos = mul(World, position);
+
+    float3 worldNormal = normalize(mul((float3x3) World, skinnedNormal));
+    float4 worldPos = mul(World, skinnedPos);
     result.position = mul(Projection, mul(View, worldPos));
     result.normal = float4(worldNormal, 1.0f);
     result.texCoord = texCoord;
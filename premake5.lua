@@ -8,69 +8,135 @@ workspace "game"
 		"Release",
 	}
 
+newoption
+{
+	trigger = "avx2",
+	description = "Build the math library with the AVX2/FMA backend"
+}
+
 outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
 debugdir "%{wks.location}"
 
 IncludeDir = {}
-IncludeDir["stb"] = "game/vendor/stb"
-IncludeDir["json"] = "game/vendor/json"
-IncludeDir["tinygltf"] = "game/vendor/tinygltf"
-IncludeDir["cgltf"] = "game/vendor/cgltf"
+IncludeDir["stb"] = "Game/vendor/stb"
+IncludeDir["json"] = "Game/vendor/json"
+IncludeDir["tinygltf"] = "Game/vendor/tinygltf"
+IncludeDir["cgltf"] = "Game/vendor/cgltf"
 
-project "game"
-	location "game"
-	kind "WindowedApp" --"ConsoleApp"
-	language "C++"
-	cppdialect "C++latest"
-	staticruntime "on"
+-- Every project compiles the game sources the same way
+language "C++"
+cppdialect "C++latest"
+staticruntime "on"
 
-	warnings "Extra"
-	-- 4100: unused funtion parameter
-	disablewarnings {"4100"}
-	flags { "FatalWarnings" }
+warnings "Extra"
+flags { "FatalWarnings" }
 
-	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
-	objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
 
-	pchheader "pch.h"
-	pchsource "game/src/pch.cpp"
+pchheader "pch.h"
+pchsource "Game/src/pch.cpp"
 
-	files
-	{
-		"%{prj.name}/src/**.h",
-		"%{prj.name}/src/**.cpp",
-	}
+defines
+{
+	"_CRT_SECURE_NO_WARNINGS"
+}
+
+includedirs
+{
+	"Game/src",
+	"%{IncludeDir.stb}",
+	"%{IncludeDir.json}",
+	"%{IncludeDir.tinygltf}",
+	"%{IncludeDir.cgltf}",
+}
+
+-- HANDMADE_MATH_AVX2 also needs FMA. MSVC's /arch:AVX2 implies it, GCC's
+-- -mavx2 does not.
+filter "options:avx2"
+	vectorextensions "AVX2"
+	isaextensions { "FMA" }
+
+filter "system:windows"
+	systemversion "latest"
+	-- 4100: unused funtion parameter
+	disablewarnings {"4100"}
 
-	defines
+-- Headless build with NullPlatform and NullRenderer, for CI and
+-- benchmarks: premake5 gmake2 && make config=release
+filter "system:linux"
+	-- Members named after their type, e.g. Animator Animator{}, which MSVC
+	-- accepts, and the GCC counterpart of 4100. The other two are GCC
+	-- -Wextra warnings that MSVC /W4 does not raise.
+	disablewarnings
 	{
-		"_CRT_SECURE_NO_WARNINGS"
+		"changes-meaning",
+		"unused-parameter",
+		"unused-function",
+		"missing-field-initializers"
 	}
+	links { "pthread" }
 
-	includedirs
+filter "configurations:Debug"
+	defines "GAME_DEBUG"
+	runtime "Debug"
+	symbols "on"
+
+filter "configurations:Release"
+	defines "GAME_RELEASE"
+	runtime "Release"
+	optimize "on"
+
+filter {}
+
+project "game"
+	location "Game"
+	kind "WindowedApp" --"ConsoleApp"
+
+	files
 	{
-		"%{prj.name}/src",
-		"%{IncludeDir.stb}",
-		"%{IncludeDir.json}",
-		"%{IncludeDir.tinygltf}",
-		"%{IncludeDir.cgltf}",
+		"Game/src/**.h",
+		"Game/src/**.cpp",
 	}
 
 	filter "system:windows"
-		systemversion "latest"
-		links 
-		{ 
-			"d3d11.lib", 
-			"dxgi.lib", 
+		links
+		{
+			"d3d11.lib",
+			"dxgi.lib",
 			"d3dcompiler.lib",
 			"xaudio2.lib"
 		}
 
-	filter "configurations:Debug"
-		defines "GAME_DEBUG"
-		runtime "Debug"
-		symbols "on"
+	filter "system:linux"
+		kind "ConsoleApp"
+
+-- Unit tests and benchmarks over the game sources. Run them from the
+-- repository root, e.g. bin/Release-linux-x86_64/tests/tests
+if os.istarget("linux") then
+	project "tests"
+		location "Game"
+		kind "ConsoleApp"
+
+		files
+		{
+			"Game/src/**.h",
+			"Game/src/**.cpp",
+			"Game/tests/**.h",
+			"Game/tests/**.cpp",
+		}
+		removefiles { "Game/src/main.cpp" }
+
+	project "bench"
+		location "Game"
+		kind "ConsoleApp"
 
-	filter "configurations:Release"
-		defines "GAME_RELEASE"
-		runtime "Release"
-		optimize "on"
+		files
+		{
+			"Game/src/**.h",
+			"Game/src/**.cpp",
+			"Game/bench/**.h",
+			"Game/bench/**.cpp",
+		}
+		removefiles { "Game/src/main.cpp" }
+end